@@ -35,6 +35,7 @@ If you have questions concerning this license or the applicable additional terms
 */
 
 #include "sys/platform.h"
+#include "idlib/hashing/CRC32.h"
 #include "framework/FileSystem.h"
 #include "renderer/Material.h"
 #include "renderer/RenderWorld.h"
@@ -45,6 +46,13 @@ If you have questions concerning this license or the applicable additional terms
 #define CM_FILEID			"CM"
 #define CM_FILEVERSION		"1.00"
 
+#define CM_BINARYFILE_EXT		"bcm"
+#define CM_BINARYFILE_ID		( ( '1' << 24 ) | ( 'M' << 16 ) | ( 'C' << 8 ) | 'B' )
+#define CM_BINARYFILE_VERSION	1
+#define CM_BINARYFILE_HEADER	32
+
+idCVar cm_binaryFiles( "cm_binaryFiles", "1", CVAR_GAME | CVAR_BOOL, "load collision models from a binary .bcm written after the first .cm parse" );
+
 /*
 ===============================================================================
 
@@ -562,6 +570,22 @@ bool idCollisionModelManagerLocal::LoadCollisionModelFile( const char *name, uns
 	// load it
 	fileName = name;
 	fileName.SetFileExtension( CM_FILE_EXT );
+
+	// use the binary version if it was written from this .cm
+	ID_TIME_T cmTimeStamp;
+	int cmLength = fileSystem->ReadFile( fileName, NULL, &cmTimeStamp );
+	if ( cmLength <= 0 ) {
+		return false;
+	}
+
+	idStr binaryFileName = name;
+	binaryFileName.SetFileExtension( CM_BINARYFILE_EXT );
+	if ( cm_binaryFiles.GetBool() && LoadBinaryCollisionModelFile( binaryFileName, mapFileCRC, cmLength, cmTimeStamp ) ) {
+		return true;
+	}
+
+	int firstModel = numModels;
+
 	src = new idLexer( fileName );
 	src->SetFlags( LEXFL_NOSTRINGCONCAT | LEXFL_NODOLLARPRECOMPILE );
 	if ( !src->IsLoaded() ) {
@@ -613,5 +637,516 @@ bool idCollisionModelManagerLocal::LoadCollisionModelFile( const char *name, uns
 
 	delete src;
 
+	if ( cm_binaryFiles.GetBool() ) {
+		WriteBinaryCollisionModelFile( binaryFileName, firstModel, numModels, crc, cmLength, cmTimeStamp );
+	}
+
+	return true;
+}
+
+
+/*
+===============================================================================
+
+Binary collision model file
+
+The models of a .cm are written to a .bcm after the text is parsed.  Nodes,
+polygons and brushes are stored with indexes instead of pointers and the
+counts are known up front, so loading allocates each kind in a single block
+and only resolves indexes.  The header has the length and timestamp of the
+.cm it was made from and a checksum of the rest of the file.
+
+===============================================================================
+*/
+
+/*
+================
+CM_BinaryIndex
+================
+*/
+template< class type >
+static int CM_BinaryIndex( idList<type *> &list, idHashIndex &hash, type *ptr ) {
+	int key = hash.GenerateKey( (int)( (intptr_t)ptr >> 4 ), (int)( (intptr_t)ptr >> 16 ) );
+	for ( int i = hash.First( key ); i != -1; i = hash.Next( i ) ) {
+		if ( list[i] == ptr ) {
+			return i;
+		}
+	}
+	hash.Add( key, list.Num() );
+	return list.Append( ptr );
+}
+
+/*
+================
+CM_GatherBinaryPrimitives_r
+================
+*/
+static void CM_GatherBinaryPrimitives_r( cm_node_t *node, idList<cm_polygon_t *> &polygons, idHashIndex &polygonHash,
+											idList<cm_brush_t *> &brushes, idHashIndex &brushHash ) {
+	cm_polygonRef_t *pref;
+	cm_brushRef_t *bref;
+
+	for ( pref = node->polygons; pref; pref = pref->next ) {
+		CM_BinaryIndex( polygons, polygonHash, pref->p );
+	}
+	for ( bref = node->brushes; bref; bref = bref->next ) {
+		CM_BinaryIndex( brushes, brushHash, bref->b );
+	}
+	if ( node->planeType != -1 ) {
+		CM_GatherBinaryPrimitives_r( node->children[0], polygons, polygonHash, brushes, brushHash );
+		CM_GatherBinaryPrimitives_r( node->children[1], polygons, polygonHash, brushes, brushHash );
+	}
+}
+
+/*
+================
+CM_WriteBinaryNodes_r
+================
+*/
+static void CM_WriteBinaryNodes_r( idFile *fp, cm_node_t *node, idList<cm_polygon_t *> &polygons, idHashIndex &polygonHash,
+											idList<cm_brush_t *> &brushes, idHashIndex &brushHash ) {
+	cm_polygonRef_t *pref;
+	cm_brushRef_t *bref;
+	int count;
+
+	fp->WriteInt( node->planeType );
+	fp->WriteFloat( node->planeDist );
+
+	// references are written in list order so the lists are rebuilt exactly
+	for ( count = 0, pref = node->polygons; pref; pref = pref->next ) {
+		count++;
+	}
+	fp->WriteInt( count );
+	for ( pref = node->polygons; pref; pref = pref->next ) {
+		fp->WriteInt( CM_BinaryIndex( polygons, polygonHash, pref->p ) );
+	}
+	for ( count = 0, bref = node->brushes; bref; bref = bref->next ) {
+		count++;
+	}
+	fp->WriteInt( count );
+	for ( bref = node->brushes; bref; bref = bref->next ) {
+		fp->WriteInt( CM_BinaryIndex( brushes, brushHash, bref->b ) );
+	}
+
+	if ( node->planeType != -1 ) {
+		CM_WriteBinaryNodes_r( fp, node->children[0], polygons, polygonHash, brushes, brushHash );
+		CM_WriteBinaryNodes_r( fp, node->children[1], polygons, polygonHash, brushes, brushHash );
+	}
+}
+
+/*
+================
+CM_BinaryCountValid
+================
+*/
+static bool CM_BinaryCountValid( idFile_Memory *fp, int count, int elementSize ) {
+	return ( count >= 0 && count <= ( fp->Length() - fp->Tell() ) / elementSize );
+}
+
+/*
+================
+idCollisionModelManagerLocal::WriteBinaryCollisionModel
+================
+*/
+void idCollisionModelManagerLocal::WriteBinaryCollisionModel( idFile *fp, cm_model_t *model ) {
+	idList<cm_polygon_t *> polygons;
+	idList<cm_brush_t *> brushes;
+	idList<const idMaterial *> materials;
+	idHashIndex polygonHash, brushHash, materialHash;
+	int i, j, polygonMemory, brushMemory;
+
+	CM_GatherBinaryPrimitives_r( model->node, polygons, polygonHash, brushes, brushHash );
+
+	polygonMemory = 0;
+	for ( i = 0; i < polygons.Num(); i++ ) {
+		polygonMemory += sizeof( cm_polygon_t ) + ( polygons[i]->numEdges - 1 ) * sizeof( polygons[i]->edges[0] );
+		CM_BinaryIndex( materials, materialHash, polygons[i]->material );
+	}
+	brushMemory = 0;
+	for ( i = 0; i < brushes.Num(); i++ ) {
+		brushMemory += sizeof( cm_brush_t ) + ( brushes[i]->numPlanes - 1 ) * sizeof( brushes[i]->planes[0] );
+	}
+
+	fp->WriteString( model->name );
+	fp->WriteInt( model->numVertices );
+	fp->WriteInt( model->numEdges );
+	fp->WriteInt( model->numNodes );
+	fp->WriteInt( polygons.Num() );
+	fp->WriteInt( polygonMemory );
+	fp->WriteInt( brushes.Num() );
+	fp->WriteInt( brushMemory );
+	fp->WriteInt( model->numPolygonRefs );
+	fp->WriteInt( model->numBrushRefs );
+	fp->WriteInt( model->numInternalEdges );
+	fp->WriteInt( model->numSharpEdges );
+	fp->WriteInt( model->contents );
+	fp->WriteVec3( model->bounds[0] );
+	fp->WriteVec3( model->bounds[1] );
+
+	for ( i = 0; i < model->numVertices; i++ ) {
+		fp->WriteVec3( model->vertices[i].p );
+	}
+	// edge normals are written so they don't have to be calculated again
+	for ( i = 0; i < model->numEdges; i++ ) {
+		fp->WriteInt( model->edges[i].vertexNum[0] );
+		fp->WriteInt( model->edges[i].vertexNum[1] );
+		fp->WriteUnsignedShort( model->edges[i].internal );
+		fp->WriteUnsignedShort( model->edges[i].numUsers );
+		fp->WriteVec3( model->edges[i].normal );
+	}
+
+	fp->WriteInt( materials.Num() );
+	for ( i = 0; i < materials.Num(); i++ ) {
+		fp->WriteString( materials[i]->GetName() );
+	}
+
+	for ( i = 0; i < polygons.Num(); i++ ) {
+		cm_polygon_t *p = polygons[i];
+		fp->WriteInt( p->numEdges );
+		for ( j = 0; j < p->numEdges; j++ ) {
+			fp->WriteInt( p->edges[j] );
+		}
+		fp->WriteVec4( p->plane.ToVec4() );
+		fp->WriteVec3( p->bounds[0] );
+		fp->WriteVec3( p->bounds[1] );
+		fp->WriteInt( CM_BinaryIndex( materials, materialHash, p->material ) );
+	}
+
+	for ( i = 0; i < brushes.Num(); i++ ) {
+		cm_brush_t *b = brushes[i];
+		fp->WriteInt( b->numPlanes );
+		for ( j = 0; j < b->numPlanes; j++ ) {
+			fp->WriteVec4( b->planes[j].ToVec4() );
+		}
+		fp->WriteVec3( b->bounds[0] );
+		fp->WriteVec3( b->bounds[1] );
+		fp->WriteInt( b->contents );
+	}
+
+	CM_WriteBinaryNodes_r( fp, model->node, polygons, polygonHash, brushes, brushHash );
+}
+
+/*
+================
+idCollisionModelManagerLocal::WriteBinaryCollisionModelFile
+================
+*/
+void idCollisionModelManagerLocal::WriteBinaryCollisionModelFile( const char *fileName, int firstModel, int lastModel, unsigned int mapFileCRC, int cmLength, ID_TIME_T cmTimeStamp ) {
+	idFile_Memory payload( fileName );
+	idFile *fp;
+	int i;
+
+	payload.WriteInt( lastModel - firstModel );
+	for ( i = firstModel; i < lastModel; i++ ) {
+		WriteBinaryCollisionModel( &payload, models[i] );
+	}
+
+	fp = fileSystem->OpenFileWrite( fileName );
+	if ( !fp ) {
+		common->Warning( "idCollisionModelManagerLocal::WriteBinaryCollisionModelFile: Error opening file %s\n", fileName );
+		return;
+	}
+
+	fp->WriteInt( CM_BINARYFILE_ID );
+	fp->WriteInt( CM_BINARYFILE_VERSION );
+	fp->WriteUnsignedInt( mapFileCRC );
+	fp->WriteInt( cmLength );
+	fp->WriteInt( (int)cmTimeStamp );
+	fp->WriteInt( payload.Length() );
+	fp->WriteUnsignedInt( CRC32_BlockChecksum( payload.GetDataPtr(), payload.Length() ) );
+	fp->WriteInt( 0 );
+	fp->Write( payload.GetDataPtr(), payload.Length() );
+
+	fileSystem->CloseFile( fp );
+}
+
+/*
+================
+idCollisionModelManagerLocal::ReadBinaryNodes
+================
+*/
+cm_node_t *idCollisionModelManagerLocal::ReadBinaryNodes( idFile_Memory *fp, cm_model_t *model, cm_node_t *parent,
+											const idList<cm_polygon_t *> &polygons, const idList<cm_brush_t *> &brushes ) {
+	cm_node_t *node;
+	cm_polygonRef_t *pref, **prefTail;
+	cm_brushRef_t *bref, **brefTail;
+	int i, count, index;
+
+	// all nodes come from the single block allocated for the first one
+	node = AllocNode( model, model->numNodes );
+	node->brushes = NULL;
+	node->polygons = NULL;
+	node->parent = parent;
+	node->children[0] = node->children[1] = NULL;
+	fp->ReadInt( node->planeType );
+	fp->ReadFloat( node->planeDist );
+
+	fp->ReadInt( count );
+	if ( !CM_BinaryCountValid( fp, count, sizeof( int ) ) ) {
+		return NULL;
+	}
+	prefTail = &node->polygons;
+	for ( i = 0; i < count; i++ ) {
+		fp->ReadInt( index );
+		if ( index < 0 || index >= polygons.Num() ) {
+			return NULL;
+		}
+		pref = AllocPolygonReference( model, Max( 1, model->numPolygonRefs ) );
+		pref->p = polygons[index];
+		pref->next = NULL;
+		*prefTail = pref;
+		prefTail = &pref->next;
+	}
+
+	fp->ReadInt( count );
+	if ( !CM_BinaryCountValid( fp, count, sizeof( int ) ) ) {
+		return NULL;
+	}
+	brefTail = &node->brushes;
+	for ( i = 0; i < count; i++ ) {
+		fp->ReadInt( index );
+		if ( index < 0 || index >= brushes.Num() ) {
+			return NULL;
+		}
+		bref = AllocBrushReference( model, Max( 1, model->numBrushRefs ) );
+		bref->b = brushes[index];
+		bref->next = NULL;
+		*brefTail = bref;
+		brefTail = &bref->next;
+	}
+
+	if ( node->planeType != -1 ) {
+		if ( node->planeType < 0 || node->planeType > 2 ) {
+			return NULL;
+		}
+		node->children[0] = ReadBinaryNodes( fp, model, node, polygons, brushes );
+		if ( !node->children[0] ) {
+			return NULL;
+		}
+		node->children[1] = ReadBinaryNodes( fp, model, node, polygons, brushes );
+		if ( !node->children[1] ) {
+			return NULL;
+		}
+	}
+	return node;
+}
+
+/*
+================
+idCollisionModelManagerLocal::ReadBinaryCollisionModel
+================
+*/
+bool idCollisionModelManagerLocal::ReadBinaryCollisionModel( idFile_Memory *fp ) {
+	cm_model_t *model;
+	idList<cm_polygon_t *> polygons;
+	idList<cm_brush_t *> brushes;
+	idList<const idMaterial *> materials;
+	idStr name;
+	idVec4 plane;
+	int i, j, numPolygons, polygonMemory, numBrushes, brushMemory, numMaterials, materialNum;
+
+	if ( numModels >= MAX_SUBMODELS ) {
+		common->Error( "LoadModel: no free slots" );
+		return false;
+	}
+	model = AllocModel();
+	models[numModels] = model;
+	numModels++;
+
+	fp->ReadString( model->name );
+	fp->ReadInt( model->numVertices );
+	fp->ReadInt( model->numEdges );
+	fp->ReadInt( model->numNodes );
+	fp->ReadInt( numPolygons );
+	fp->ReadInt( polygonMemory );
+	fp->ReadInt( numBrushes );
+	fp->ReadInt( brushMemory );
+	fp->ReadInt( model->numPolygonRefs );
+	fp->ReadInt( model->numBrushRefs );
+	fp->ReadInt( model->numInternalEdges );
+	fp->ReadInt( model->numSharpEdges );
+	fp->ReadInt( model->contents );
+	fp->ReadVec3( model->bounds[0] );
+	fp->ReadVec3( model->bounds[1] );
+
+	if ( !CM_BinaryCountValid( fp, model->numVertices, sizeof( idVec3 ) ) || !CM_BinaryCountValid( fp, model->numEdges, 2 * sizeof( int ) )
+			|| !CM_BinaryCountValid( fp, numPolygons, sizeof( int ) ) || !CM_BinaryCountValid( fp, numBrushes, sizeof( int ) )
+			|| model->numNodes <= 0 || model->numPolygonRefs < 0 || model->numBrushRefs < 0
+			|| polygonMemory < numPolygons * (int)sizeof( cm_polygon_t ) || brushMemory < numBrushes * (int)sizeof( cm_brush_t ) ) {
+		return false;
+	}
+
+	model->maxVertices = model->numVertices;
+	model->vertices = (cm_vertex_t *) Mem_Alloc( model->maxVertices * sizeof( cm_vertex_t ) );
+	for ( i = 0; i < model->numVertices; i++ ) {
+		fp->ReadVec3( model->vertices[i].p );
+		model->vertices[i].side = 0;
+		model->vertices[i].sideSet = 0;
+		model->vertices[i].checkcount = 0;
+	}
+
+	model->maxEdges = model->numEdges;
+	model->edges = (cm_edge_t *) Mem_Alloc( model->maxEdges * sizeof( cm_edge_t ) );
+	for ( i = 0; i < model->numEdges; i++ ) {
+		fp->ReadInt( model->edges[i].vertexNum[0] );
+		fp->ReadInt( model->edges[i].vertexNum[1] );
+		fp->ReadUnsignedShort( model->edges[i].internal );
+		fp->ReadUnsignedShort( model->edges[i].numUsers );
+		fp->ReadVec3( model->edges[i].normal );
+		model->edges[i].side = 0;
+		model->edges[i].sideSet = 0;
+		model->edges[i].checkcount = 0;
+	}
+
+	fp->ReadInt( numMaterials );
+	if ( !CM_BinaryCountValid( fp, numMaterials, sizeof( int ) ) ) {
+		return false;
+	}
+	materials.SetNum( numMaterials );
+	for ( i = 0; i < numMaterials; i++ ) {
+		fp->ReadString( name );
+		materials[i] = declManager->FindMaterial( name );
+	}
+
+	// all polygons and brushes go into a single block each
+	model->polygonBlock = (cm_polygonBlock_t *) Mem_Alloc( sizeof( cm_polygonBlock_t ) + polygonMemory );
+	model->polygonBlock->bytesRemaining = polygonMemory;
+	model->polygonBlock->next = ( (byte *) model->polygonBlock ) + sizeof( cm_polygonBlock_t );
+
+	polygons.SetNum( numPolygons );
+	for ( i = 0; i < numPolygons; i++ ) {
+		int numEdges;
+		fp->ReadInt( numEdges );
+		if ( numEdges < 1 || !CM_BinaryCountValid( fp, numEdges, sizeof( int ) ) ) {
+			return false;
+		}
+		cm_polygon_t *p = AllocPolygon( model, numEdges );
+		polygons[i] = p;
+		p->numEdges = numEdges;
+		for ( j = 0; j < p->numEdges; j++ ) {
+			fp->ReadInt( p->edges[j] );
+			if ( abs( p->edges[j] ) >= model->numEdges ) {
+				return false;
+			}
+		}
+		fp->ReadVec4( plane );
+		p->plane = idPlane( plane[0], plane[1], plane[2], plane[3] );
+		fp->ReadVec3( p->bounds[0] );
+		fp->ReadVec3( p->bounds[1] );
+		fp->ReadInt( materialNum );
+		if ( materialNum < 0 || materialNum >= numMaterials ) {
+			return false;
+		}
+		p->material = materials[materialNum];
+		p->contents = p->material->GetContentFlags();
+		p->checkcount = 0;
+	}
+
+	model->brushBlock = (cm_brushBlock_t *) Mem_Alloc( sizeof( cm_brushBlock_t ) + brushMemory );
+	model->brushBlock->bytesRemaining = brushMemory;
+	model->brushBlock->next = ( (byte *) model->brushBlock ) + sizeof( cm_brushBlock_t );
+
+	brushes.SetNum( numBrushes );
+	for ( i = 0; i < numBrushes; i++ ) {
+		int numPlanes;
+		fp->ReadInt( numPlanes );
+		if ( numPlanes < 1 || !CM_BinaryCountValid( fp, numPlanes, sizeof( idVec4 ) ) ) {
+			return false;
+		}
+		cm_brush_t *b = AllocBrush( model, numPlanes );
+		brushes[i] = b;
+		b->numPlanes = numPlanes;
+		for ( j = 0; j < b->numPlanes; j++ ) {
+			fp->ReadVec4( plane );
+			b->planes[j] = idPlane( plane[0], plane[1], plane[2], plane[3] );
+		}
+		fp->ReadVec3( b->bounds[0] );
+		fp->ReadVec3( b->bounds[1] );
+		fp->ReadInt( b->contents );
+		b->material = NULL;
+		b->checkcount = 0;
+		b->primitiveNum = 0;
+	}
+
+	model->node = ReadBinaryNodes( fp, model, NULL, polygons, brushes );
+	if ( !model->node ) {
+		return false;
+	}
+
+	// total memory used by this model
+	model->usedMemory = model->numVertices * sizeof(cm_vertex_t) +
+						model->numEdges * sizeof(cm_edge_t) +
+						model->polygonMemory +
+						model->brushMemory +
+						model->numNodes * sizeof(cm_node_t) +
+						model->numPolygonRefs * sizeof(cm_polygonRef_t) +
+						model->numBrushRefs * sizeof(cm_brushRef_t);
+
+	return true;
+}
+
+/*
+================
+idCollisionModelManagerLocal::LoadBinaryCollisionModelFile
+
+Returns false if there is no .bcm matching the .cm, no models are added in that case
+================
+*/
+bool idCollisionModelManagerLocal::LoadBinaryCollisionModelFile( const char *fileName, unsigned int mapFileCRC, int cmLength, ID_TIME_T cmTimeStamp ) {
+	void *buffer;
+	int header[CM_BINARYFILE_HEADER / 4];
+	int i, length, numFileModels, firstModel;
+
+	length = fileSystem->ReadFile( fileName, &buffer );
+	if ( length < CM_BINARYFILE_HEADER ) {
+		if ( buffer ) {
+			fileSystem->FreeFile( buffer );
+		}
+		return false;
+	}
+
+	for ( i = 0; i < CM_BINARYFILE_HEADER / 4; i++ ) {
+		header[i] = LittleInt( ((int *)buffer)[i] );
+	}
+
+	const char *payload = (const char *)buffer + CM_BINARYFILE_HEADER;
+	int payloadLength = length - CM_BINARYFILE_HEADER;
+
+	if ( header[0] != CM_BINARYFILE_ID || header[1] != CM_BINARYFILE_VERSION || header[3] != cmLength || header[4] != (int)cmTimeStamp
+			|| header[5] != payloadLength || (unsigned int)header[6] != CRC32_BlockChecksum( payload, payloadLength ) ) {
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
+	// same check as the text file, the .cm is out of date as well
+	if ( mapFileCRC && (unsigned int)header[2] != mapFileCRC ) {
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
+	idFile_Memory fp( fileName, payload, payloadLength );
+
+	firstModel = numModels;
+	numFileModels = 0;
+	fp.ReadInt( numFileModels );
+
+	for ( i = 0; i < numFileModels; i++ ) {
+		if ( !ReadBinaryCollisionModel( &fp ) ) {
+			break;
+		}
+	}
+
+	fileSystem->FreeFile( buffer );
+
+	if ( i < numFileModels ) {
+		common->Warning( "%s is corrupt", fileName );
+		while( numModels > firstModel ) {
+			numModels--;
+			FreeModel( models[numModels] );
+			models[numModels] = NULL;
+		}
+		return false;
+	}
+
 	return true;
 }
@@ -37,6 +37,8 @@ If you have questions concerning this license or the applicable additional terms
 #include "idlib/math/Pluecker.h"
 #include "cm/CollisionModel.h"
 
+class idFile_Memory;
+
 #define MIN_NODE_SIZE						64.0f
 #define MAX_NODE_POLYGONS					128
 #define CM_MAX_POLYGON_EDGES				64
@@ -490,6 +492,11 @@ private:			// CollisionMap_files.cpp
 	void			ParseBrushes( idLexer *src, cm_model_t *model );
 	bool			ParseCollisionModel( idLexer *src );
 	bool			LoadCollisionModelFile( const char *name, unsigned int mapFileCRC );
+	void			WriteBinaryCollisionModel( idFile *fp, cm_model_t *model );
+	void			WriteBinaryCollisionModelFile( const char *fileName, int firstModel, int lastModel, unsigned int mapFileCRC, int cmLength, ID_TIME_T cmTimeStamp );
+	cm_node_t *		ReadBinaryNodes( idFile_Memory *fp, cm_model_t *model, cm_node_t *parent, const idList<cm_polygon_t *> &polygons, const idList<cm_brush_t *> &brushes );
+	bool			ReadBinaryCollisionModel( idFile_Memory *fp );
+	bool			LoadBinaryCollisionModelFile( const char *fileName, unsigned int mapFileCRC, int cmLength, ID_TIME_T cmTimeStamp );
 
 private:			// CollisionMap_debug
 	int				ContentsFromString( const char *string ) const;
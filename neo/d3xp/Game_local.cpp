@@ -311,6 +311,15 @@ bool updateGameDebugger( idInterpreter *interpreter, idProgram *program, int ins
 	return ret;
 }
 
+static bool ( *isDebuggerActiveFnPtr )( void ) = NULL;
+bool gameDebuggerActive( void ) {
+	if ( isDebuggerActiveFnPtr ) {
+		return isDebuggerActiveFnPtr();
+	}
+	// without the query, every statement has to be passed to the debugger
+	return updateDebuggerFnPtr != NULL;
+}
+
 
 /*
 ===========
@@ -423,6 +432,7 @@ void idGameLocal::Init( void ) {
 
 	//debugger support
 	common->GetAdditionalFunction( idCommon::FT_UpdateDebugger,( idCommon::FunctionPointer * ) &updateDebuggerFnPtr,NULL);
+	common->GetAdditionalFunction( idCommon::FT_IsDebuggerActive,( idCommon::FunctionPointer * ) &isDebuggerActiveFnPtr,NULL);
 
 }
 
@@ -241,10 +241,18 @@ private:
 	idList<jointAnimInfo_t>	jointInfo;
 	idList<idJointQuat>		baseFrame;
 	idList<float>			componentFrames;
+	idList<unsigned short>	quantizedFrames;		// replaces componentFrames when the anim is quantized
+	idList<float>			componentScale;			// per component dequantization
+	idList<float>			componentBias;
 	idStr					name;
 	idVec3					totaldelta;
 	mutable int				ref_count;
 
+	const float *			GetFrameComponents( int framenum, int firstComponent, int num, float *buffer ) const;
+	bool					Quantize( void );
+	bool					LoadBinaryAnim( const char *filename, int sourceLength, ID_TIME_T sourceTimeStamp );
+	void					WriteBinaryAnim( int sourceLength, ID_TIME_T sourceTimeStamp ) const;
+
 public:
 							idMD5Anim();
 							~idMD5Anim();
@@ -204,19 +204,221 @@ const idEventDef *idEventDef::FindEvent( const char *name ) {
 	return NULL;
 }
 
+/***********************************************************************
+
+  idEventHeap
+
+  Pending events are kept in a binary heap ordered by time.  Events posted
+  for the same time are serviced in the order they were posted, the same
+  as the sorted list this replaced, so scripts and save games see no change.
+
+***********************************************************************/
+
+class idEventHeap {
+public:
+	void						Clear( void );
+	int							Num( void ) const { return num; }
+	idEvent *					First( void ) const { return num ? heap[ 0 ] : NULL; }
+	void						Insert( idEvent *event );
+	void						Remove( idEvent *event );
+	void						GetSorted( idList<idEvent *> &list ) const;
+
+private:
+	idEvent *					heap[ MAX_EVENTS ];
+	int							num;
+	unsigned int				sequence;
+
+	static bool					Before( const idEvent *a, const idEvent *b );
+	static int					Compare( idEvent * const *a, idEvent * const *b );
+	void						Set( int index, idEvent *event );
+	void						MoveUp( int index );
+	void						MoveDown( int index );
+};
+
+/*
+================
+idEventHeap::Before
+================
+*/
+ID_INLINE bool idEventHeap::Before( const idEvent *a, const idEvent *b ) {
+	if ( a->time != b->time ) {
+		return a->time < b->time;
+	}
+	// the sequence counter may wrap, so compare the distance
+	return static_cast<int>( a->sequence - b->sequence ) < 0;
+}
+
+/*
+================
+idEventHeap::Compare
+================
+*/
+int idEventHeap::Compare( idEvent * const *a, idEvent * const *b ) {
+	if ( Before( *a, *b ) ) {
+		return -1;
+	}
+	if ( Before( *b, *a ) ) {
+		return 1;
+	}
+	return 0;
+}
+
+/*
+================
+idEventHeap::Set
+================
+*/
+ID_INLINE void idEventHeap::Set( int index, idEvent *event ) {
+	heap[ index ] = event;
+	event->queueIndex = index;
+}
+
+/*
+================
+idEventHeap::MoveUp
+================
+*/
+void idEventHeap::MoveUp( int index ) {
+	idEvent *event = heap[ index ];
+
+	while( index > 0 ) {
+		int parent = ( index - 1 ) >> 1;
+		if ( !Before( event, heap[ parent ] ) ) {
+			break;
+		}
+		Set( index, heap[ parent ] );
+		index = parent;
+	}
+	Set( index, event );
+}
+
+/*
+================
+idEventHeap::MoveDown
+================
+*/
+void idEventHeap::MoveDown( int index ) {
+	idEvent *event = heap[ index ];
+
+	while( 1 ) {
+		int child = ( index << 1 ) + 1;
+		if ( child >= num ) {
+			break;
+		}
+		if ( child + 1 < num && Before( heap[ child + 1 ], heap[ child ] ) ) {
+			child++;
+		}
+		if ( !Before( heap[ child ], event ) ) {
+			break;
+		}
+		Set( index, heap[ child ] );
+		index = child;
+	}
+	Set( index, event );
+}
+
+/*
+================
+idEventHeap::Clear
+================
+*/
+void idEventHeap::Clear( void ) {
+	int i;
+
+	for( i = 0; i < num; i++ ) {
+		heap[ i ]->queue = NULL;
+		heap[ i ]->queueIndex = -1;
+	}
+	num = 0;
+	sequence = 0;
+}
+
+/*
+================
+idEventHeap::Insert
+================
+*/
+void idEventHeap::Insert( idEvent *event ) {
+	assert( event->queue == NULL );
+	assert( num < MAX_EVENTS );
+
+	event->queue = this;
+	event->sequence = sequence++;
+	Set( num, event );
+	num++;
+	MoveUp( num - 1 );
+}
+
+/*
+================
+idEventHeap::Remove
+================
+*/
+void idEventHeap::Remove( idEvent *event ) {
+	int index;
+
+	assert( event->queue == this );
+	assert( heap[ event->queueIndex ] == event );
+
+	index = event->queueIndex;
+	num--;
+	if ( index != num ) {
+		// fill the hole with the last event and let it find its place
+		Set( index, heap[ num ] );
+		if ( index > 0 && Before( heap[ index ], heap[ ( index - 1 ) >> 1 ] ) ) {
+			MoveUp( index );
+		} else {
+			MoveDown( index );
+		}
+	}
+
+	event->queue = NULL;
+	event->queueIndex = -1;
+}
+
+/*
+================
+idEventHeap::GetSorted
+
+Returns the pending events in the order they will be serviced.
+================
+*/
+void idEventHeap::GetSorted( idList<idEvent *> &list ) const {
+	int i;
+
+	list.SetNum( num, false );
+	for( i = 0; i < num; i++ ) {
+		list[ i ] = heap[ i ];
+	}
+	list.Sort( Compare );
+}
+
 /***********************************************************************
 
   idEvent
 
 ***********************************************************************/
 
+#define EVENT_OBJECT_HASH_SIZE		1024
+
 static idLinkList<idEvent> FreeEvents;
-static idLinkList<idEvent> EventQueue;
+static idLinkList<idEvent> ObjectEvents[ EVENT_OBJECT_HASH_SIZE ];
+static idEventHeap EventQueue;
 #ifdef _D3XP
-static idLinkList<idEvent> FastEventQueue;
+static idEventHeap FastEventQueue;
 #endif
 static idEvent EventPool[ MAX_EVENTS ];
 
+/*
+================
+ObjectEventsHash
+================
+*/
+static ID_INLINE int ObjectEventsHash( const idClass *obj ) {
+	uintptr_t ptr = reinterpret_cast<uintptr_t>( obj );
+	return static_cast<int>( ( ptr >> 4 ) ^ ( ptr >> 14 ) ) & ( EVENT_OBJECT_HASH_SIZE - 1 );
+}
+
 bool idEvent::initialized = false;
 
 idDynamicBlockAlloc<byte, 16 * 1024, 256>	idEvent::eventDataAllocator;
@@ -360,6 +562,11 @@ idEvent::Free
 ================
 */
 void idEvent::Free( void ) {
+	if ( queue ) {
+		queue->Remove( this );
+	}
+	objectNode.Remove();
+
 	if ( data ) {
 		eventDataAllocator.Free( data );
 		data = NULL;
@@ -372,6 +579,7 @@ void idEvent::Free( void ) {
 
 	eventNode.SetOwner( this );
 	eventNode.AddToEnd( FreeEvents );
+	objectNode.SetOwner( this );
 }
 
 /*
@@ -380,8 +588,6 @@ idEvent::Schedule
 ================
 */
 void idEvent::Schedule( idClass *obj, const idTypeInfo *type, int time ) {
-	idEvent *event;
-
 	assert( initialized );
 	if ( !initialized ) {
 		return;
@@ -393,37 +599,21 @@ void idEvent::Schedule( idClass *obj, const idTypeInfo *type, int time ) {
 	// wraps after 24 days...like I care. ;)
 	this->time = gameLocal.time + time;
 
-	eventNode.Remove();
+	if ( queue ) {
+		queue->Remove( this );
+	}
+	objectNode.AddToEnd( ObjectEvents[ ObjectEventsHash( obj ) ] );
 
 #ifdef _D3XP
 	if ( obj->IsType( idEntity::Type ) && ( ( (idEntity*)(obj) )->timeGroup == TIME_GROUP2 ) ) {
-		event = FastEventQueue.Next();
-		while( ( event != NULL ) && ( this->time >= event->time ) ) {
-			event = event->eventNode.Next();
-		}
-
-		if ( event ) {
-			eventNode.InsertBefore( event->eventNode );
-		} else {
-			eventNode.AddToEnd( FastEventQueue );
-		}
-
+		FastEventQueue.Insert( this );
 		return;
 	} else {
 		this->time = gameLocal.slow.time + time;
 	}
 #endif
 
-	event = EventQueue.Next();
-	while( ( event != NULL ) && ( this->time >= event->time ) ) {
-		event = event->eventNode.Next();
-	}
-
-	if ( event ) {
-		eventNode.InsertBefore( event->eventNode );
-	} else {
-		eventNode.AddToEnd( EventQueue );
-	}
+	EventQueue.Insert( this );
 }
 
 /*
@@ -439,25 +629,15 @@ void idEvent::CancelEvents( const idClass *obj, const idEventDef *evdef ) {
 		return;
 	}
 
-	for( event = EventQueue.Next(); event != NULL; event = next ) {
-		next = event->eventNode.Next();
+	// only the events hashed with the object need to be looked at
+	for( event = ObjectEvents[ ObjectEventsHash( obj ) ].Next(); event != NULL; event = next ) {
+		next = event->objectNode.Next();
 		if ( event->object == obj ) {
 			if ( !evdef || ( evdef == event->eventdef ) ) {
 				event->Free();
 			}
 		}
 	}
-
-#ifdef _D3XP
-	for( event = FastEventQueue.Next(); event != NULL; event = next ) {
-		next = event->eventNode.Next();
-		if ( event->object == obj ) {
-			if ( !evdef || ( evdef == event->eventdef ) ) {
-				event->Free();
-			}
-		}
-	}
-#endif
 }
 
 /*
@@ -473,6 +653,12 @@ void idEvent::ClearEventList( void ) {
 	//
 	FreeEvents.Clear();
 	EventQueue.Clear();
+#ifdef _D3XP
+	FastEventQueue.Clear();
+#endif
+	for( i = 0; i < EVENT_OBJECT_HASH_SIZE; i++ ) {
+		ObjectEvents[ i ].Clear();
+	}
 
 	//
 	// add the events to the free list
@@ -501,8 +687,8 @@ void idEvent::ServiceEvents( void ) {
 	const char  *materialName;
 
 	num = 0;
-	while( !EventQueue.IsListEmpty() ) {
-		event = EventQueue.Next();
+	while( EventQueue.Num() ) {
+		event = EventQueue.First();
 		assert( event );
 
 		if ( event->time > gameLocal.time ) {
@@ -555,9 +741,10 @@ void idEvent::ServiceEvents( void ) {
 			}
 		}
 
-		// the event is removed from its list so that if then object
+		// the event is removed from the queue so that if then object
 		// is deleted, the event won't be freed twice
-		event->eventNode.Remove();
+		EventQueue.Remove( event );
+		event->objectNode.Remove();
 		assert( event->object );
 		event->object->ProcessEventArgPtr( ev, args );
 
@@ -593,8 +780,8 @@ void idEvent::ServiceFastEvents() {
 	const char  *materialName;
 
 	num = 0;
-	while( !FastEventQueue.IsListEmpty() ) {
-		event = FastEventQueue.Next();
+	while( FastEventQueue.Num() ) {
+		event = FastEventQueue.First();
 		assert( event );
 
 		if ( event->time > gameLocal.fast.time ) {
@@ -647,9 +834,10 @@ void idEvent::ServiceFastEvents() {
 			}
 		}
 
-		// the event is removed from its list so that if then object
+		// the event is removed from the queue so that if then object
 		// is deleted, the event won't be freed twice
-		event->eventNode.Remove();
+		FastEventQueue.Remove( event );
+		event->objectNode.Remove();
 		assert( event->object );
 		event->object->ProcessEventArgPtr( ev, args );
 
@@ -728,17 +916,20 @@ idEvent::Save
 */
 void idEvent::Save( idSaveGame *savefile ) {
 	char *str;
-	int i, size;
+	int i, j, size;
 	idEvent	*event;
+	idList<idEvent *> events;
 	byte *dataPtr;
 	bool validTrace;
 	const char	*format;
 	idStr s;
 
-	savefile->WriteInt( EventQueue.Num() );
+	// write the events in the order they will be serviced
+	EventQueue.GetSorted( events );
+	savefile->WriteInt( events.Num() );
 
-	event = EventQueue.Next();
-	while( event != NULL ) {
+	for( j = 0; j < events.Num(); j++ ) {
+		event = events[ j ];
 		savefile->WriteInt( event->time );
 		savefile->WriteString( event->eventdef->GetName() );
 		savefile->WriteString( event->typeinfo->classname );
@@ -791,23 +982,22 @@ void idEvent::Save( idSaveGame *savefile ) {
 			}
 		}
 		assert( size == event->eventdef->GetArgSize() );
-		event = event->eventNode.Next();
 	}
 
 #ifdef _D3XP
 	// Save the Fast EventQueue
-	savefile->WriteInt( FastEventQueue.Num() );
+	// write the events in the order they will be serviced
+	FastEventQueue.GetSorted( events );
+	savefile->WriteInt( events.Num() );
 
-	event = FastEventQueue.Next();
-	while( event != NULL ) {
+	for( j = 0; j < events.Num(); j++ ) {
+		event = events[ j ];
 		savefile->WriteInt( event->time );
 		savefile->WriteString( event->eventdef->GetName() );
 		savefile->WriteString( event->typeinfo->classname );
 		savefile->WriteObject( event->object );
 		savefile->WriteInt( event->eventdef->GetArgSize() );
 		savefile->Write( event->data, event->eventdef->GetArgSize() );
-
-		event = event->eventNode.Next();
 	}
 #endif
 }
@@ -835,7 +1025,6 @@ void idEvent::Restore( idRestoreGame *savefile ) {
 
 		event = FreeEvents.Next();
 		event->eventNode.Remove();
-		event->eventNode.AddToEnd( EventQueue );
 
 		savefile->ReadInt( event->time );
 
@@ -855,6 +1044,10 @@ void idEvent::Restore( idRestoreGame *savefile ) {
 
 		savefile->ReadObject( event->object );
 
+		// events were saved in service order, so queueing them as they're read keeps it
+		event->objectNode.AddToEnd( ObjectEvents[ ObjectEventsHash( event->object ) ] );
+		EventQueue.Insert( event );
+
 		// read the args
 		savefile->ReadInt( argsize );
 		if ( argsize != event->eventdef->GetArgSize() ) {
@@ -924,7 +1117,6 @@ void idEvent::Restore( idRestoreGame *savefile ) {
 
 		event = FreeEvents.Next();
 		event->eventNode.Remove();
-		event->eventNode.AddToEnd( FastEventQueue );
 
 		savefile->ReadInt( event->time );
 
@@ -944,6 +1136,10 @@ void idEvent::Restore( idRestoreGame *savefile ) {
 
 		savefile->ReadObject( event->object );
 
+		// events were saved in service order, so queueing them as they're read keeps it
+		event->objectNode.AddToEnd( ObjectEvents[ ObjectEventsHash( event->object ) ] );
+		FastEventQueue.Insert( event );
+
 		// read the args
 		savefile->ReadInt( argsize );
 		if ( argsize != event->eventdef->GetArgSize() ) {
@@ -52,8 +52,12 @@ extern idCVar	g_hitEffect;
 extern idCVar	g_muzzleFlash;
 
 extern idCVar	g_disasm;
+extern idCVar	g_scriptCache;
 extern idCVar	g_debugBounds;
 extern idCVar	g_debugAnim;
+extern idCVar	g_binaryAnims;
+extern idCVar	g_quantizeAnims;
+extern idCVar	g_quantizeAnimsError;
 extern idCVar	g_debugMove;
 extern idCVar	g_debugDamage;
 extern idCVar	g_debugWeapon;
@@ -269,6 +273,8 @@ extern idCVar	aas_randomPullPlayer;
 extern idCVar	aas_goalArea;
 extern idCVar	aas_showPushIntoArea;
 
+extern idCVar	g_cachePVS;
+
 extern idCVar	net_clientPredictGUI;
 
 extern idCVar	g_voteFlags;
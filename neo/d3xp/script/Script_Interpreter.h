@@ -69,13 +69,16 @@ private:
 	void				PushVector( const idVec3 &vector );
 	void				Push( intptr_t value );
 	const char			*FloatToString( float value );
-	void				AppendString( idVarDef *def, const char *from );
-	void				SetString( idVarDef *def, const char *from );
+	void				AppendString( varEval_t var, const char *from );
+	void				SetString( varEval_t var, const char *from );
 	const char			*GetString( idVarDef *def );
 	varEval_t			GetVariable( idVarDef *def );
+	varEval_t			GetOperand( varEval_t value, bool local );
 	idEntity			*GetEntity( int entnum ) const;
 	idScriptObject		*GetScriptObject( int entnum ) const;
 	void				NextInstruction( int position );
+	void				FusedJump( const scriptOp_t *op, bool result, bool jumpIf );
+	void				DebugStatement( void );
 
 	void				LeaveFunction( idVarDef *returnDef );
 	void				CallEvent( const function_t *func, int argsize );
@@ -121,6 +124,8 @@ public:
 	const function_t	*GetCurrentFunction( void ) const;
 	idThread			*GetThread( void ) const;
 
+	static void			Profile_f( const idCmdArgs &args );
+
 };
 
 /*
@@ -197,12 +202,8 @@ ID_INLINE const char *idInterpreter::FloatToString( float value ) {
 idInterpreter::AppendString
 ====================
 */
-ID_INLINE void idInterpreter::AppendString( idVarDef *def, const char *from ) {
-	if ( def->initialized == idVarDef::stackVariable ) {
-		idStr::Append( ( char * )&localstack[ localstackBase + def->value.stackOffset ], MAX_STRING_LEN, from );
-	} else {
-		idStr::Append( def->value.stringPtr, MAX_STRING_LEN, from );
-	}
+ID_INLINE void idInterpreter::AppendString( varEval_t var, const char *from ) {
+	idStr::Append( var.stringPtr, MAX_STRING_LEN, from );
 }
 
 /*
@@ -210,12 +211,8 @@ ID_INLINE void idInterpreter::AppendString( idVarDef *def, const char *from ) {
 idInterpreter::SetString
 ====================
 */
-ID_INLINE void idInterpreter::SetString( idVarDef *def, const char *from ) {
-	if ( def->initialized == idVarDef::stackVariable ) {
-		idStr::Copynz( ( char * )&localstack[ localstackBase + def->value.stackOffset ], from, MAX_STRING_LEN );
-	} else {
-		idStr::Copynz( def->value.stringPtr, from, MAX_STRING_LEN );
-	}
+ID_INLINE void idInterpreter::SetString( varEval_t var, const char *from ) {
+	idStr::Copynz( var.stringPtr, from, MAX_STRING_LEN );
 }
 
 /*
@@ -246,6 +243,21 @@ ID_INLINE varEval_t idInterpreter::GetVariable( idVarDef *def ) {
 	}
 }
 
+/*
+====================
+idInterpreter::GetOperand
+
+Resolves an operand of a decoded statement.  Stack variables are offsets in
+the current stack frame, everything else already holds its value.
+====================
+*/
+ID_INLINE varEval_t idInterpreter::GetOperand( varEval_t value, bool local ) {
+	if ( local ) {
+		value.intPtr = ( int * )&localstack[ localstackBase + value.stackOffset ];
+	}
+	return value;
+}
+
 /*
 ================
 idInterpreter::GetEntity
@@ -288,4 +300,18 @@ ID_INLINE void idInterpreter::NextInstruction( int position ) {
 	instructionPointer = position - 1;
 }
 
+/*
+====================
+idInterpreter::FusedJump
+
+The second half of a compare superinstruction, the if or ifnot that follows it.
+====================
+*/
+ID_INLINE void idInterpreter::FusedJump( const scriptOp_t *op, bool result, bool jumpIf ) {
+	instructionPointer++;
+	if ( result == jumpIf ) {
+		NextInstruction( instructionPointer + op[ 1 ].b.jumpOffset );
+	}
+}
+
 #endif /* !__SCRIPT_INTERPRETER_H__ */
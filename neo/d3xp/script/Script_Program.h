@@ -108,6 +108,8 @@ Contains type information for variables and functions.
 ***********************************************************************/
 
 class idTypeDef {
+	friend class idProgram;
+
 private:
 	etype_t						type;
 	idStr						name;
@@ -447,6 +449,19 @@ typedef struct statement_s {
 	idVarDef		*c;
 } statement_t;
 
+// a statement decoded for the interpreter, with the values of its defs copied in.
+// the operands of stack variables hold their offset in the current stack frame.
+typedef struct scriptOp_s {
+	unsigned short	op;			// opcode, or a superinstruction that also does the statement after it
+	unsigned short	baseOp;		// opcode of the statement alone, run while debugging
+	bool			localA;
+	bool			localB;
+	bool			localC;
+	varEval_t		a;
+	varEval_t		b;
+	varEval_t		c;
+} scriptOp_t;
+
 /***********************************************************************
 
 idProgram
@@ -461,6 +476,7 @@ single idProgram.
 class idProgram {
 private:
 	idStrList									fileList;
+	idStrList									sourceFiles;		// every file read while compiling, including define-only includes
 	idStr										filename;
 	int											filenum;
 
@@ -469,6 +485,7 @@ private:
 	idStaticList<byte,MAX_GLOBALS>				variableDefaults;
 	idStaticList<function_t,MAX_FUNCS>			functions;
 	idStaticList<statement_t,MAX_STATEMENTS>	statements;
+	idStaticList<scriptOp_t,MAX_STATEMENTS>		decoded;
 	idList<idTypeDef *>							types;
 	idList<idVarDefName *>						varDefNames;
 	idHashIndex									varDefNameHash;
@@ -485,6 +502,15 @@ private:
 	void										CompileStats( void );
 	byte										*ReserveMem(int size);
 	idVarDef									*AllocVarDef(idTypeDef *type, const char *name, idVarDef *scope);
+	void										DecodeStatements( void );
+
+	// compiled script cache
+	bool										LoadCompiled( const char *filename );
+	void										SaveCompiled( const char *filename ) const;
+	int											TypeRef( const idTypeDef *type, const idHashIndex &typeHash ) const;
+	idTypeDef									*TypeForRef( int ref, bool &ok ) const;
+	int											DefRef( const idVarDef *def ) const;
+	idVarDef									*DefForRef( int ref, bool &ok ) const;
 
 public:
 	idVarDef									*returnDef;
@@ -537,7 +563,9 @@ public:
 
 	statement_t									*AllocStatement( void );
 	statement_t									&GetStatement( int index );
+	const scriptOp_t							*GetDecodedStatements( void ) const;
 	int											NumStatements( void ) { return statements.Num(); }
+	int											NumFunctions( void ) { return functions.Num(); }
 
 	int											GetReturnedInteger( void );
 
@@ -559,6 +587,15 @@ ID_INLINE statement_t &idProgram::GetStatement( int index ) {
 	return statements[ index ];
 }
 
+/*
+================
+idProgram::GetDecodedStatements
+================
+*/
+ID_INLINE const scriptOp_t *idProgram::GetDecodedStatements( void ) const {
+	return decoded.Ptr();
+}
+
 /*
 ================
 idProgram::GetFunction
@@ -2337,6 +2337,7 @@ void idCommonLocal::InitCommands( void ) {
 	cmdSystem->AddCommand( "listDictKeys", idDict::ListKeys_f, CMD_FL_SYSTEM|CMD_FL_CHEAT, "lists all keys used by dictionaries" );
 	cmdSystem->AddCommand( "listDictValues", idDict::ListValues_f, CMD_FL_SYSTEM|CMD_FL_CHEAT, "lists all values used by dictionaries" );
 	cmdSystem->AddCommand( "testSIMD", idSIMD::Test_f, CMD_FL_SYSTEM|CMD_FL_CHEAT, "test SIMD code" );
+	cmdSystem->AddCommand( "testLexer", idLexer::Test_f, CMD_FL_SYSTEM, "measures the lexer throughput over a folder of text files" );
 
 	// localization
 	cmdSystem->AddCommand( "localizeGuis", Com_LocalizeGuis_f, CMD_FL_SYSTEM|CMD_FL_CHEAT, "localize guis" );
@@ -2425,6 +2426,9 @@ void idCommonLocal::Frame( void ) {
 
 		eventLoop->RunEventLoop();
 
+		// deliver finished asynchronous file reads
+		fileSystem->ServiceAsyncReads();
+
 		com_frameTime = com_ticNumber * USERCMD_MSEC;
 
 		idAsyncNetwork::RunFrame();
@@ -3331,6 +3335,11 @@ static bool updateDebugger( idInterpreter *interpreter, idProgram *program, int
 	return false;
 }
 
+static bool isDebuggerActive( void )
+{
+	return ( com_editors & EDITOR_DEBUGGER ) != 0;
+}
+
 // returns true if that function is available in this version of dhewm3
 // *out_fnptr will be the function (you'll have to cast it probably)
 // *out_userArg will be an argument you have to pass to the function, if appropriate (else NULL)
@@ -3357,6 +3366,10 @@ bool idCommonLocal::GetAdditionalFunction(idCommon::FunctionType ft, idCommon::F
 			com_debuggerSupported = true;
 			return true;
 
+		case idCommon::FT_IsDebuggerActive:
+			*out_fnptr = (idCommon::FunctionPointer)isDebuggerActive;
+			return true;
+
 		default:
 			*out_fnptr = NULL;
 			Warning("Called idCommon::SetCallback() with unknown FunctionType %d!\n", ft);
@@ -308,6 +308,11 @@ public:
 		// it returns true if the game debugger is active.
 		// relevant for mods.
 		FT_UpdateDebugger,
+		// the function's signature is bool fn(void) - no arguments.
+		// it returns true if the game debugger is active, so FT_UpdateDebugger
+		// has to be called for every script statement.
+		// relevant for mods.
+		FT_IsDebuggerActive,
 	};
 
 	// returns true if that function is available in this version of dhewm3
@@ -29,6 +29,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "sys/platform.h"
 #include "idlib/containers/List.h"
 #include "idlib/containers/HashIndex.h"
+#include "idlib/hashing/CRC32.h"
 #include "idlib/hashing/MD5.h"
 #include "idlib/BitMsg.h"
 #include "framework/FileSystem.h"
@@ -40,6 +41,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "framework/DeclParticle.h"
 #include "framework/DeclSkin.h"
 #include "framework/DeclTable.h"
+#include "framework/ResourceManifest.h"
 #include "renderer/Material.h"
 #include "sound/sound.h"
 
@@ -80,6 +82,20 @@ missing reload over a previously explicit definition
 #define USE_COMPRESSED_DECLS
 //#define GET_HUFFMAN_FREQUENCIES
 
+#ifdef USE_COMPRESSED_DECLS
+	#define USE_COMPRESSED_DECLS_VALUE	1
+#else
+	#define USE_COMPRESSED_DECLS_VALUE	0
+#endif
+
+// decl files read ahead of the one being parsed when a folder is registered
+const int DECL_READ_AHEAD		= 8;
+
+const int MAX_DECL_PARSE_THREADS	= 4;
+
+const int DECLCACHE_ID			= ( ('D'<<24) | ('C'<<16) | ('C'<<8) | 'H' );
+const int DECLCACHE_VERSION		= 2;
+
 class idDeclType {
 public:
 	idStr						typeName;
@@ -96,6 +112,45 @@ public:
 
 class idDeclFile;
 
+// the text of a single decl, checksummed and compressed the way idDeclLocal keeps it
+typedef struct {
+	declType_t					type;
+	idStr						name;
+	int							sourceTextOffset;
+	int							sourceTextLength;
+	int							sourceLine;
+	int							checksum;
+	int							compressedLength;
+	byte *						textSource;				// from malloc, textSourceSize bytes
+	int							textSourceSize;
+} declText_t;
+
+// the decls of a file as they were scanned the last time the folder was registered
+typedef struct {
+	idStr						fileName;
+	int							length;
+	int							checksum;
+	int							numLines;
+	idList<declText_t>			decls;
+} declCacheEntry_t;
+
+// a decl file split up into its decls, this only uses libc so it can be done on the parse threads
+typedef struct {
+	char *						buffer;
+	int							length;
+	ID_TIME_T					timestamp;
+	int							checksum;
+	int							numLines;
+	bool						quiet;					// no warnings can be printed, fail instead
+	bool						failed;					// scan it again on the main thread to report the problem
+	bool						warned;					// don't cache it, or the warnings would be lost
+	declCacheEntry_t *			cached;					// the decls are taken from here if the file didn't change
+	bool						fromCache;
+	idList<declText_t>			decls;
+	bool						loaded;					// set by the main thread once buffer is filled
+	bool						scanned;				// set by the parse thread
+} declFileScan_t;
+
 class idDeclLocal : public idDeclBase {
 	friend class idDeclFile;
 	friend class idDeclManagerLocal;
@@ -144,6 +199,8 @@ protected:
 
 								// Set textSource possible with compression.
 	void						SetTextLocal( const char *text, const int length );
+								// Set textSource from text that was already compressed.
+	void						SetPreparedTextLocal( const declText_t &text );
 
 private:
 	idDecl *					self;
@@ -175,7 +232,11 @@ public:
 								idDeclFile( const char *fileName, declType_t defaultType );
 
 	void						Reload( bool force );
-	int							LoadAndParse();
+	int							LoadAndParse( int asyncHandle = -1 );
+								// Finds the decls in the loaded text of the file.
+	bool						Scan( declFileScan_t &scan ) const;
+								// Creates or updates the decls found by Scan, in file order.
+	int							Merge( declFileScan_t &scan );
 
 public:
 	idStr						fileName;
@@ -252,13 +313,22 @@ private:
 	bool						insideLevelLoad;
 
 	static idCVar				decl_show;
+	static idCVar				decl_parseThreads;
+	static idCVar				decl_cache;
 
 private:
+	const char *				DeclCachePath( const idDeclFolder *declFolder ) const;
+	int							DeclTypesChecksum( const idDeclFolder *declFolder ) const;
+	void						LoadDeclCache( const idDeclFolder *declFolder, idList<declCacheEntry_t *> &cache ) const;
+	void						SaveDeclCache( const idDeclFolder *declFolder, int numFiles, idFile_Memory &entries ) const;
+
 	static void					ListDecls_f( const idCmdArgs &args );
 	static void					ReloadDecls_f( const idCmdArgs &args );
 	static void					TouchDecl_f( const idCmdArgs &args );
 };
 
+idCVar idDeclManagerLocal::decl_parseThreads( "decl_parseThreads", "2", CVAR_SYSTEM | CVAR_INTEGER, "number of threads scanning decl files when a decl folder is registered, 0 does it on the main thread", 0, MAX_DECL_PARSE_THREADS, idCmdSystem::ArgCompletion_Integer<0,MAX_DECL_PARSE_THREADS> );
+idCVar idDeclManagerLocal::decl_cache( "decl_cache", "1", CVAR_SYSTEM | CVAR_BOOL, "keep an index of the decls in each decl folder in the save path, so unchanged files don't have to be scanned again" );
 idCVar idDeclManagerLocal::decl_show( "decl_show", "0", CVAR_SYSTEM, "set to 1 to print parses, 2 to also print references", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2> );
 
 idDeclManagerLocal	declManagerLocal;
@@ -481,8 +551,6 @@ int HuffmanCompressText( const char *text, int textLength, byte *compressed, int
 	int i, j;
 	idBitMsg msg;
 
-	totalUncompressedLength += textLength;
-
 	msg.Init( compressed, maxCompressedSize );
 	msg.BeginWriting();
 	for ( i = 0; i < textLength; i++ ) {
@@ -495,8 +563,6 @@ int HuffmanCompressText( const char *text, int textLength, byte *compressed, int
 		}
 	}
 
-	totalCompressedLength += msg.GetSize();
-
 	return msg.GetSize();
 }
 
@@ -608,49 +674,166 @@ void idDeclFile::Reload( bool force ) {
 
 /*
 ================
-idDeclFile::LoadAndParse
+PrepareDeclText
 
-This is used during both the initial load, and any reloads
+Checksums and compresses the text of a decl into memory from malloc.
 ================
 */
-int c_savedMemory = 0;
+static void PrepareDeclText( const char *text, int length, declText_t &out ) {
+
+	out.checksum = MD5_BlockChecksum( text, length );
+
+#ifdef GET_HUFFMAN_FREQUENCIES
+	// not thread safe, the decl parse threads are not used with GET_HUFFMAN_FREQUENCIES
+	for( int i = 0; i < length; i++ ) {
+		huffmanFrequencies[((const unsigned char *)text)[i]]++;
+	}
+#endif
 
-int idDeclFile::LoadAndParse() {
+#ifdef USE_COMPRESSED_DECLS
+	int maxBytesPerCode = ( maxHuffmanBits + 7 ) >> 3;
+	byte *compressed = (byte *)malloc( length * maxBytesPerCode );
+	out.compressedLength = HuffmanCompressText( text, length, compressed, length * maxBytesPerCode );
+	out.textSource = (byte *)realloc( compressed, out.compressedLength );
+	out.textSourceSize = out.compressedLength;
+#else
+	out.compressedLength = length;
+	out.textSource = (byte *)malloc( length + 1 );
+	memcpy( out.textSource, text, length );
+	out.textSource[length] = '\0';
+	out.textSourceSize = length + 1;
+#endif
+}
+
+/*
+================
+FreeDeclTexts
+================
+*/
+static void FreeDeclTexts( idList<declText_t> &decls ) {
+	for ( int i = 0; i < decls.Num(); i++ ) {
+		free( decls[i].textSource );
+	}
+	decls.Clear();
+}
+
+/*
+================
+FreeDeclFileScan
+================
+*/
+static void FreeDeclFileScan( declFileScan_t &scan ) {
+	FreeDeclTexts( scan.decls );
+	if ( scan.buffer ) {
+		Mem_Free( scan.buffer );
+		scan.buffer = NULL;
+	}
+}
+
+/*
+================
+FreeDeclCache
+================
+*/
+static void FreeDeclCache( idList<declCacheEntry_t *> &cache ) {
+	for ( int i = 0; i < cache.Num(); i++ ) {
+		FreeDeclTexts( cache[i]->decls );
+	}
+	cache.DeleteContents( true );
+}
+
+/*
+================
+WriteDeclCacheEntry
+================
+*/
+static void WriteDeclCacheEntry( idFile *f, const idDeclFile *file, const declFileScan_t &scan ) {
+	f->WriteString( file->fileName );
+	f->WriteInt( scan.length );
+	f->WriteInt( scan.checksum );
+	f->WriteInt( scan.numLines );
+	f->WriteInt( scan.decls.Num() );
+	for ( int i = 0; i < scan.decls.Num(); i++ ) {
+		const declText_t &text = scan.decls[i];
+		f->WriteInt( (int)text.type );
+		f->WriteString( text.name );
+		f->WriteInt( text.sourceTextOffset );
+		f->WriteInt( text.sourceTextLength );
+		f->WriteInt( text.sourceLine );
+		f->WriteInt( text.checksum );
+		f->WriteInt( text.compressedLength );
+		f->WriteInt( text.textSourceSize );
+		f->Write( text.textSource, text.textSourceSize );
+	}
+}
+
+/*
+================
+DeclScanWarning
+
+Returns false when the scan is quiet, it then has to be done again on the main thread.
+================
+*/
+static bool DeclScanWarning( idLexer &src, declFileScan_t &scan, const char *fmt, ... ) id_attribute((format(printf,3,4)));
+
+static bool DeclScanWarning( idLexer &src, declFileScan_t &scan, const char *fmt, ... ) {
+	char text[MAX_STRING_CHARS];
+	va_list argptr;
+
+	scan.warned = true;
+	if ( scan.quiet ) {
+		scan.failed = true;
+		return false;
+	}
+
+	va_start( argptr, fmt );
+	idStr::vsnPrintf( text, sizeof( text ), fmt, argptr );
+	va_end( argptr );
+
+	src.Warning( "%s", text );
+	return true;
+}
+
+/*
+================
+idDeclFile::Scan
+
+Splits the text up into the individual decls without touching the decl
+manager, so a quiet scan can run on a parse thread.
+================
+*/
+bool idDeclFile::Scan( declFileScan_t &scan ) const {
 	int			i, numTypes;
 	idLexer		src;
 	idToken		token;
 	int			startMarker;
-	char *		buffer;
-	int			length, size;
+	int			size;
 	int			sourceLine;
 	idStr		name;
-	idDeclLocal *newDecl;
-	bool		reparse;
 
-	// load the text
-	common->DPrintf( "...loading '%s'\n", fileName.c_str() );
-	length = fileSystem->ReadFile( fileName, (void **)&buffer, &timestamp );
-	if ( length == -1 ) {
-		common->FatalError( "couldn't load %s", fileName.c_str() );
-		return 0;
-	}
+	scan.failed = false;
+	scan.fromCache = false;
 
-	if ( !src.LoadMemory( buffer, length, fileName ) ) {
-		common->Error( "Couldn't parse %s", fileName.c_str() );
-		Mem_Free( buffer );
-		return 0;
-	}
+	// a rescan after a failed quiet scan drops what that one got through
+	FreeDeclTexts( scan.decls );
 
-	// mark all the defs that were from the last reload of this file
-	for ( idDeclLocal *decl = decls; decl; decl = decl->nextInFile ) {
-		decl->redefinedInReload = false;
-	}
+	scan.checksum = MD5_BlockChecksum( scan.buffer, scan.length );
 
-	src.SetFlags( DECL_LEXER_FLAGS );
+	// the decls of an unchanged file come straight from the cache, which hands over its texts
+	if ( scan.cached && scan.cached->length == scan.length && scan.cached->checksum == scan.checksum ) {
+		scan.decls = scan.cached->decls;
+		scan.cached->decls.Clear();
+		scan.numLines = scan.cached->numLines;
+		scan.fromCache = true;
+		return true;
+	}
 
-	checksum = MD5_BlockChecksum( buffer, length );
+	if ( !src.LoadMemory( scan.buffer, scan.length, fileName ) ) {
+		scan.failed = true;
+		return false;
+	}
 
-	fileSize = length;
+	src.SetFlags( scan.quiet ? ( DECL_LEXER_FLAGS | LEXFL_NOWARNINGS | LEXFL_NOERRORS ) : DECL_LEXER_FLAGS );
 
 	// scan through, identifying each individual declaration
 	while( 1 ) {
@@ -680,14 +863,18 @@ int idDeclFile::LoadAndParse() {
 			if ( token.Icmp( "{" ) == 0 ) {
 
 				// if we ever see an open brace, we somehow missed the [type] <name> prefix
-				src.Warning( "Missing decl name" );
+				if ( !DeclScanWarning( src, scan, "Missing decl name" ) ) {
+					return false;
+				}
 				src.SkipBracedSection( false );
 				continue;
 
 			} else {
 
 				if ( defaultType == DECL_MAX_TYPES ) {
-					src.Warning( "No type" );
+					if ( !DeclScanWarning( src, scan, "No type" ) ) {
+						return false;
+					}
 					continue;
 				}
 				src.UnreadToken( &token );
@@ -698,13 +885,17 @@ int idDeclFile::LoadAndParse() {
 
 		// now parse the name
 		if ( !src.ReadToken( &token ) ) {
-			src.Warning( "Type without definition at end of file" );
+			if ( !DeclScanWarning( src, scan, "Type without definition at end of file" ) ) {
+				return false;
+			}
 			break;
 		}
 
 		if ( !token.Icmp( "{" ) ) {
 			// if we ever see an open brace, we somehow missed the [type] <name> prefix
-			src.Warning( "Missing decl name" );
+			if ( !DeclScanWarning( src, scan, "Missing decl name" ) ) {
+				return false;
+			}
 			src.SkipBracedSection( false );
 			continue;
 		}
@@ -719,11 +910,15 @@ int idDeclFile::LoadAndParse() {
 
 		// make sure there's a '{'
 		if ( !src.ReadToken( &token ) ) {
-			src.Warning( "Type without definition at end of file" );
+			if ( !DeclScanWarning( src, scan, "Type without definition at end of file" ) ) {
+				return false;
+			}
 			break;
 		}
 		if ( token != "{" ) {
-			src.Warning( "Expecting '{' but found '%s'", token.c_str() );
+			if ( !DeclScanWarning( src, scan, "Expecting '{' but found '%s'", token.c_str() ) ) {
+				return false;
+			}
 			continue;
 		}
 		src.UnreadToken( &token );
@@ -732,14 +927,59 @@ int idDeclFile::LoadAndParse() {
 		src.SkipBracedSection();
 		size = src.GetFileOffset() - startMarker;
 
+		declText_t &text = scan.decls.Alloc();
+		text.type = identifiedType;
+		text.name = name;
+		text.sourceTextOffset = startMarker;
+		text.sourceTextLength = size;
+		text.sourceLine = sourceLine;
+		PrepareDeclText( scan.buffer + startMarker, size, text );
+	}
+
+	// a lexer error would have been printed by a loud scan
+	if ( scan.quiet && src.HadError() ) {
+		scan.failed = true;
+		return false;
+	}
+
+	scan.numLines = src.GetLineNum();
+
+	return true;
+}
+
+/*
+================
+idDeclFile::Merge
+
+Must run on the main thread, in the order the files are registered, so the
+decl indices and checksums don't depend on how the files were scanned.
+================
+*/
+int idDeclFile::Merge( declFileScan_t &scan ) {
+	idDeclLocal *newDecl;
+	bool		reparse;
+
+	// mark all the defs that were from the last reload of this file
+	for ( idDeclLocal *decl = decls; decl; decl = decl->nextInFile ) {
+		decl->redefinedInReload = false;
+	}
+
+	timestamp = scan.timestamp;
+	checksum = scan.checksum;
+	fileSize = scan.length;
+
+	for ( int i = 0; i < scan.decls.Num(); i++ ) {
+		const declText_t &text = scan.decls[i];
+
 		// look it up, possibly getting a newly created default decl
 		reparse = false;
-		newDecl = declManagerLocal.FindTypeWithoutParsing( identifiedType, name, false );
+		newDecl = declManagerLocal.FindTypeWithoutParsing( text.type, text.name, false );
 		if ( newDecl ) {
 			// update the existing copy
 			if ( newDecl->sourceFile != this || newDecl->redefinedInReload ) {
-				src.Warning( "%s '%s' previously defined at %s:%i", declManagerLocal.GetDeclNameFromType( identifiedType ),
-								name.c_str(), newDecl->sourceFile->fileName.c_str(), newDecl->sourceLine );
+				common->Warning( "file %s, line %d: %s '%s' previously defined at %s:%i", fileName.c_str(), text.sourceLine,
+								declManagerLocal.GetDeclNameFromType( text.type ), text.name.c_str(),
+								newDecl->sourceFile->fileName.c_str(), newDecl->sourceLine );
 				continue;
 			}
 			if ( newDecl->declState != DS_UNPARSED ) {
@@ -747,7 +987,7 @@ int idDeclFile::LoadAndParse() {
 			}
 		} else {
 			// allow it to be created as a default, then add it to the per-file list
-			newDecl = declManagerLocal.FindTypeWithoutParsing( identifiedType, name, true );
+			newDecl = declManagerLocal.FindTypeWithoutParsing( text.type, text.name, true );
 			newDecl->nextInFile = this->decls;
 			this->decls = newDecl;
 		}
@@ -759,11 +999,11 @@ int idDeclFile::LoadAndParse() {
 			newDecl->textSource = NULL;
 		}
 
-		newDecl->SetTextLocal( buffer + startMarker, size );
+		newDecl->SetPreparedTextLocal( text );
 		newDecl->sourceFile = this;
-		newDecl->sourceTextOffset = startMarker;
-		newDecl->sourceTextLength = size;
-		newDecl->sourceLine = sourceLine;
+		newDecl->sourceTextOffset = text.sourceTextOffset;
+		newDecl->sourceTextLength = text.sourceTextLength;
+		newDecl->sourceLine = text.sourceLine;
 		newDecl->declState = DS_UNPARSED;
 
 		// if it is currently in use, reparse it immedaitely
@@ -772,9 +1012,7 @@ int idDeclFile::LoadAndParse() {
 		}
 	}
 
-	numLines = src.GetLineNum();
-
-	Mem_Free( buffer );
+	numLines = scan.numLines;
 
 	// any defs that weren't redefinedInReload should now be defaulted
 	for ( idDeclLocal *decl = decls ; decl ; decl = decl->nextInFile ) {
@@ -789,6 +1027,151 @@ int idDeclFile::LoadAndParse() {
 	return checksum;
 }
 
+/*
+================
+idDeclFile::LoadAndParse
+
+This is used during both the initial load, and any reloads
+The text comes from the given fileSystem->ReadFileAsync handle when there is one
+================
+*/
+int c_savedMemory = 0;
+
+int idDeclFile::LoadAndParse( int asyncHandle ) {
+	declFileScan_t	scan;
+
+	scan.cached = NULL;
+	scan.warned = false;
+
+	// load the text
+	common->DPrintf( "...loading '%s'\n", fileName.c_str() );
+	if ( asyncHandle >= 0 ) {
+		scan.length = fileSystem->WaitAsyncRead( asyncHandle, (void **)&scan.buffer, &scan.timestamp );
+	} else {
+		scan.length = fileSystem->ReadFile( fileName, (void **)&scan.buffer, &scan.timestamp );
+	}
+	if ( scan.length == -1 ) {
+		common->FatalError( "couldn't load %s", fileName.c_str() );
+		return 0;
+	}
+
+	scan.quiet = false;
+	if ( !Scan( scan ) ) {
+		common->Error( "Couldn't parse %s", fileName.c_str() );
+		FreeDeclFileScan( scan );
+		return 0;
+	}
+
+	Merge( scan );
+
+	FreeDeclFileScan( scan );
+
+	return checksum;
+}
+
+/*
+================
+DeclParseThread
+
+Scans every numThreads'th file of the folder as soon as the main thread has loaded it.
+
+The loaded, scanned and abort flags are only read and written inside
+CRITICAL_SECTION_DECL_PARSE, which also makes the buffer filled in by the main
+thread and the decls found by the parse thread visible to the other side.
+A thread that finds a flag not set yet sleeps on its trigger event, a signal
+raised before it waits isn't lost, so the flag just has to be checked again.
+================
+*/
+typedef struct {
+	idDeclFile **				files;
+	declFileScan_t *			scans;
+	int							numFiles;
+	int							thread;
+	int							numThreads;
+	bool						abort;
+	xthreadInfo					threadInfo;
+} declParseThread_t;
+
+static const char *declParseThreadNames[MAX_DECL_PARSE_THREADS] = { "declParse0", "declParse1", "declParse2", "declParse3" };
+
+static int DeclParseThread( void *parm ) {
+	declParseThread_t *parse = (declParseThread_t *)parm;
+
+	for ( int i = parse->thread; i < parse->numFiles; i += parse->numThreads ) {
+		while ( 1 ) {
+			Sys_EnterCriticalSection( CRITICAL_SECTION_DECL_PARSE );
+			const bool loaded = parse->scans[i].loaded;
+			const bool abort = parse->abort;
+			Sys_LeaveCriticalSection( CRITICAL_SECTION_DECL_PARSE );
+
+			if ( abort ) {
+				return 0;
+			}
+			if ( loaded ) {
+				break;
+			}
+			Sys_WaitForEvent( TRIGGER_EVENT_DECL_LOADED0 + parse->thread );
+		}
+
+		parse->files[i]->Scan( parse->scans[i] );
+
+		Sys_EnterCriticalSection( CRITICAL_SECTION_DECL_PARSE );
+		parse->scans[i].scanned = true;
+		Sys_LeaveCriticalSection( CRITICAL_SECTION_DECL_PARSE );
+		Sys_TriggerEvent( TRIGGER_EVENT_DECL_SCANNED );
+	}
+	return 0;
+}
+
+/*
+================
+PublishDeclFileLoaded
+
+Hands a loaded file to the parse thread that scans it.
+================
+*/
+static void PublishDeclFileLoaded( declFileScan_t *scans, int index, int numThreads ) {
+	Sys_EnterCriticalSection( CRITICAL_SECTION_DECL_PARSE );
+	scans[index].loaded = true;
+	Sys_LeaveCriticalSection( CRITICAL_SECTION_DECL_PARSE );
+
+	if ( numThreads ) {
+		Sys_TriggerEvent( TRIGGER_EVENT_DECL_LOADED0 + index % numThreads );
+	}
+}
+
+/*
+================
+IsDeclFileScanned
+================
+*/
+static bool IsDeclFileScanned( const declFileScan_t &scan ) {
+	Sys_EnterCriticalSection( CRITICAL_SECTION_DECL_PARSE );
+	const bool scanned = scan.scanned;
+	Sys_LeaveCriticalSection( CRITICAL_SECTION_DECL_PARSE );
+	return scanned;
+}
+
+/*
+================
+StopDeclParseThreads
+================
+*/
+static void StopDeclParseThreads( declParseThread_t *threads, int numThreads ) {
+	Sys_EnterCriticalSection( CRITICAL_SECTION_DECL_PARSE );
+	for ( int i = 0; i < numThreads; i++ ) {
+		threads[i].abort = true;
+	}
+	Sys_LeaveCriticalSection( CRITICAL_SECTION_DECL_PARSE );
+
+	for ( int i = 0; i < numThreads; i++ ) {
+		Sys_TriggerEvent( TRIGGER_EVENT_DECL_LOADED0 + i );
+	}
+	for ( int i = 0; i < numThreads; i++ ) {
+		Sys_DestroyThread( threads[i].threadInfo );
+	}
+}
+
 /*
 ====================================================================================
 
@@ -988,7 +1371,7 @@ idDeclManagerLocal::RegisterDeclFolder
 ===================
 */
 void idDeclManagerLocal::RegisterDeclFolder( const char *folder, const char *extension, declType_t defaultType ) {
-	int i, j;
+	int i, j, numFiles, numThreads;
 	idStr fileName;
 	idDeclFolder *declFolder;
 	idFileList *fileList;
@@ -1013,8 +1396,11 @@ void idDeclManagerLocal::RegisterDeclFolder( const char *folder, const char *ext
 	// scan for decl files
 	fileList = fileSystem->ListFiles( declFolder->folder, declFolder->extension, true );
 
-	// load and parse decl files
-	for ( i = 0; i < fileList->GetNumFiles(); i++ ) {
+	numFiles = fileList->GetNumFiles();
+
+	idList<idDeclFile *> files;
+	files.SetNum( numFiles );
+	for ( i = 0; i < numFiles; i++ ) {
 		fileName = declFolder->folder + "/" + fileList->GetFile( i );
 
 		// check whether this file has already been loaded
@@ -1029,10 +1415,269 @@ void idDeclManagerLocal::RegisterDeclFolder( const char *folder, const char *ext
 			df = new idDeclFile( fileName, defaultType );
 			loadedFiles.Append( df );
 		}
-		df->LoadAndParse();
+		files[i] = df;
 	}
 
 	fileSystem->FreeFileList( fileList );
+
+	// keep the next few files reading in the background while the current one is parsed
+	idList<int> readHandles;
+	readHandles.SetNum( numFiles );
+	for ( i = 0; i < numFiles; i++ ) {
+		readHandles[i] = ( i < DECL_READ_AHEAD ) ? fileSystem->ReadFileAsync( files[i]->fileName ) : -1;
+	}
+
+	numThreads = decl_parseThreads.GetInteger();
+#ifdef GET_HUFFMAN_FREQUENCIES
+	numThreads = 0;
+#endif
+	numThreads = Min( numThreads, numFiles - 1 );
+
+	// match the files up with their cached decls
+	idList<declCacheEntry_t *> cache;
+	LoadDeclCache( declFolder, cache );
+
+	// the parse threads scan the files as they come in, the main thread merges
+	// them into the decl lists in the original order
+	idList<declFileScan_t> scans;
+	scans.SetNum( numFiles );
+	for ( i = 0; i < numFiles; i++ ) {
+		scans[i].buffer = NULL;
+		scans[i].quiet = ( numThreads > 0 );
+		scans[i].warned = false;
+		scans[i].cached = NULL;
+		scans[i].loaded = false;
+		scans[i].scanned = false;
+		for ( j = 0; j < cache.Num(); j++ ) {
+			if ( cache[j]->fileName.Icmp( files[i]->fileName ) == 0 ) {
+				scans[i].cached = cache[j];
+				break;
+			}
+		}
+	}
+
+	// the first lexer sets up the default punctuation table, that must not race on the parse threads
+	idLexer setupPunctuations;
+
+	declParseThread_t threads[MAX_DECL_PARSE_THREADS];
+	for ( i = 0; i < numThreads; i++ ) {
+		threads[i].files = files.Ptr();
+		threads[i].scans = scans.Ptr();
+		threads[i].numFiles = numFiles;
+		threads[i].thread = i;
+		threads[i].numThreads = numThreads;
+		threads[i].abort = false;
+		Sys_CreateThread( DeclParseThread, &threads[i], threads[i].threadInfo, declParseThreadNames[i] );
+	}
+
+	// the new cache is written if any file had to be scanned or went away
+	idFile_Memory cacheEntries( "declcache" );
+	int numCached = 0;
+	bool cacheModified = ( cache.Num() != numFiles );
+
+	int numMerged = 0;
+	for ( i = 0; i <= numFiles; i++ ) {
+		if ( i < numFiles ) {
+			if ( i + DECL_READ_AHEAD < numFiles ) {
+				readHandles[i + DECL_READ_AHEAD] = fileSystem->ReadFileAsync( files[i + DECL_READ_AHEAD]->fileName );
+			}
+
+			declFileScan_t &scan = scans[i];
+			common->DPrintf( "...loading '%s'\n", files[i]->fileName.c_str() );
+			if ( readHandles[i] >= 0 ) {
+				scan.length = fileSystem->WaitAsyncRead( readHandles[i], (void **)&scan.buffer, &scan.timestamp );
+			} else {
+				scan.length = fileSystem->ReadFile( files[i]->fileName, (void **)&scan.buffer, &scan.timestamp );
+			}
+			if ( scan.length == -1 ) {
+				StopDeclParseThreads( threads, numThreads );
+				FreeDeclCache( cache );
+				common->FatalError( "couldn't load %s", files[i]->fileName.c_str() );
+			}
+			PublishDeclFileLoaded( scans.Ptr(), i, numThreads );
+		}
+
+		// merge everything that is ready, all of it after the last file was loaded
+		while ( numMerged < numFiles && ( !numThreads || i == numFiles || IsDeclFileScanned( scans[numMerged] ) ) ) {
+			declFileScan_t &scan = scans[numMerged];
+			if ( !numThreads ) {
+				files[numMerged]->Scan( scan );
+			}
+			while ( numThreads && !IsDeclFileScanned( scan ) ) {
+				Sys_WaitForEvent( TRIGGER_EVENT_DECL_SCANNED );
+			}
+			if ( scan.failed ) {
+				// do it again with the warnings on
+				scan.quiet = false;
+				if ( !files[numMerged]->Scan( scan ) ) {
+					StopDeclParseThreads( threads, numThreads );
+					FreeDeclCache( cache );
+					common->Error( "Couldn't parse %s", files[numMerged]->fileName.c_str() );
+				}
+			}
+			files[numMerged]->Merge( scan );
+
+			if ( !scan.fromCache ) {
+				cacheModified = true;
+			}
+			if ( !scan.warned && decl_cache.GetBool() ) {
+				WriteDeclCacheEntry( &cacheEntries, files[numMerged], scan );
+				numCached++;
+			}
+
+			FreeDeclFileScan( scan );
+			numMerged++;
+		}
+	}
+
+	StopDeclParseThreads( threads, numThreads );
+	FreeDeclCache( cache );
+
+	if ( cacheModified ) {
+		SaveDeclCache( declFolder, numCached, cacheEntries );
+	}
+}
+
+/*
+===================
+idDeclManagerLocal::DeclCachePath
+===================
+*/
+const char *idDeclManagerLocal::DeclCachePath( const idDeclFolder *declFolder ) const {
+	idStr name = declFolder->folder + declFolder->extension;
+	name.Replace( "/", "_" );
+	name.Replace( ".", "_" );
+	return va( "declcache/%s.dat", name.c_str() );
+}
+
+/*
+===================
+idDeclManagerLocal::DeclTypesChecksum
+
+The type of a decl is found through the registered type names, so the
+cached types are only valid with the same registrations.
+===================
+*/
+int idDeclManagerLocal::DeclTypesChecksum( const idDeclFolder *declFolder ) const {
+	idStr names = va( "%d %d", (int)declFolder->defaultType, USE_COMPRESSED_DECLS_VALUE );
+	for ( int i = 0; i < declTypes.Num(); i++ ) {
+		if ( declTypes[i] ) {
+			names += va( " %d %s", (int)declTypes[i]->type, declTypes[i]->typeName.c_str() );
+		}
+	}
+	return MD5_BlockChecksum( names.c_str(), names.Length() );
+}
+
+/*
+===================
+idDeclManagerLocal::LoadDeclCache
+===================
+*/
+void idDeclManagerLocal::LoadDeclCache( const idDeclFolder *declFolder, idList<declCacheEntry_t *> &cache ) const {
+	if ( !decl_cache.GetBool() ) {
+		return;
+	}
+
+	const char *path = DeclCachePath( declFolder );
+	idFile *file = fileSystem->OpenExplicitFileRead( fileSystem->RelativePathToOSPath( path, "fs_savepath" ) );
+	if ( !file ) {
+		return;
+	}
+	int length = file->Length();
+	char *buffer = (char *)Mem_Alloc( length );
+	int read = file->Read( buffer, length );
+	fileSystem->CloseFile( file );
+
+	idFile_Memory f( path, buffer, read );
+	int id = 0, version = 0, typesChecksum = 0, numFiles = 0, payloadLength = 0, payloadCRC = 0;
+
+	f.ReadInt( id );
+	f.ReadInt( version );
+	f.ReadInt( typesChecksum );
+	f.ReadInt( numFiles );
+	f.ReadInt( payloadLength );
+	f.ReadInt( payloadCRC );
+	if ( id != DECLCACHE_ID || version != DECLCACHE_VERSION || typesChecksum != DeclTypesChecksum( declFolder ) || numFiles < 0 || read != length ) {
+		common->DPrintf( "ignoring out of date %s\n", path );
+		Mem_Free( buffer );
+		return;
+	}
+	if ( payloadLength != f.Length() - f.Tell() || payloadCRC != (int)CRC32_BlockChecksum( buffer + f.Tell(), payloadLength ) ) {
+		common->Warning( "%s is corrupt", path );
+		Mem_Free( buffer );
+		return;
+	}
+
+	for ( int i = 0; i < numFiles; i++ ) {
+		declCacheEntry_t *entry = new declCacheEntry_t;
+		int numDecls = 0;
+
+		cache.Append( entry );
+
+		f.ReadString( entry->fileName );
+		f.ReadInt( entry->length );
+		f.ReadInt( entry->checksum );
+		f.ReadInt( entry->numLines );
+		f.ReadInt( numDecls );
+
+		// every decl takes at least 36 bytes, a truncated file shows up as too many
+		bool corrupt = ( numDecls < 0 || numDecls > ( f.Length() - f.Tell() ) / 36 );
+
+		entry->decls.SetNum( corrupt ? 0 : numDecls );
+		for ( int j = 0; j < entry->decls.Num(); j++ ) {
+			declText_t &text = entry->decls[j];
+			int type = 0;
+
+			text.textSource = NULL;
+			f.ReadInt( type );
+			f.ReadString( text.name );
+			f.ReadInt( text.sourceTextOffset );
+			f.ReadInt( text.sourceTextLength );
+			f.ReadInt( text.sourceLine );
+			f.ReadInt( text.checksum );
+			f.ReadInt( text.compressedLength );
+			f.ReadInt( text.textSourceSize );
+			text.type = (declType_t)type;
+
+			if ( type < 0 || type >= DECL_MAX_TYPES || text.textSourceSize < 0 || text.textSourceSize > f.Length() - f.Tell() ) {
+				corrupt = true;
+				entry->decls.SetNum( j );
+				break;
+			}
+			text.textSource = (byte *)malloc( text.textSourceSize );
+			f.Read( text.textSource, text.textSourceSize );
+		}
+
+		if ( corrupt ) {
+			common->Warning( "%s is corrupt", path );
+			FreeDeclCache( cache );
+			break;
+		}
+	}
+
+	Mem_Free( buffer );
+}
+
+/*
+===================
+idDeclManagerLocal::SaveDeclCache
+===================
+*/
+void idDeclManagerLocal::SaveDeclCache( const idDeclFolder *declFolder, int numFiles, idFile_Memory &entries ) const {
+	if ( !decl_cache.GetBool() ) {
+		return;
+	}
+
+	idFile_Memory f( "declcache" );
+	f.WriteInt( DECLCACHE_ID );
+	f.WriteInt( DECLCACHE_VERSION );
+	f.WriteInt( DeclTypesChecksum( declFolder ) );
+	f.WriteInt( numFiles );
+	f.WriteInt( entries.Length() );
+	f.WriteInt( (int)CRC32_BlockChecksum( entries.GetDataPtr(), entries.Length() ) );
+	f.Write( entries.GetDataPtr(), entries.Length() );
+
+	fileSystem->WriteFile( DeclCachePath( declFolder ), f.GetDataPtr(), f.Length(), "fs_savepath" );
 }
 
 /*
@@ -1152,6 +1797,10 @@ const idDecl *idDeclManagerLocal::FindType( declType_t type, const char *name, b
 		decl->parsedOutsideLevelLoad = false;
 	}
 
+	if ( resourceManifest.IsRecording() ) {
+		resourceManifest.AddDecl( GetDeclNameFromType( type ), decl->GetName() );
+	}
+
 	return decl->self;
 }
 
@@ -1923,30 +2572,31 @@ idDeclLocal::SetTextLocal
 =================
 */
 void idDeclLocal::SetTextLocal( const char *text, const int length ) {
+	declText_t prepared;
 
-	Mem_Free( textSource );
+	PrepareDeclText( text, length, prepared );
+	prepared.sourceTextLength = length;
+	SetPreparedTextLocal( prepared );
+	free( prepared.textSource );
+}
 
-	checksum = MD5_BlockChecksum( text, length );
+/*
+=================
+idDeclLocal::SetPreparedTextLocal
+=================
+*/
+void idDeclLocal::SetPreparedTextLocal( const declText_t &text ) {
 
-#ifdef GET_HUFFMAN_FREQUENCIES
-	for( int i = 0; i < length; i++ ) {
-		huffmanFrequencies[((const unsigned char *)text)[i]]++;
-	}
-#endif
+	Mem_Free( textSource );
 
-#ifdef USE_COMPRESSED_DECLS
-	int maxBytesPerCode = ( maxHuffmanBits + 7 ) >> 3;
-	byte *compressed = (byte *)_alloca( length * maxBytesPerCode );
-	compressedLength = HuffmanCompressText( text, length, compressed, length * maxBytesPerCode );
-	textSource = (char *)Mem_Alloc( compressedLength );
-	memcpy( textSource, compressed, compressedLength );
-#else
-	compressedLength = length;
-	textSource = (char *) Mem_Alloc( length + 1 );
-	memcpy( textSource, text, length );
-	textSource[length] = '\0';
-#endif
-	textLength = length;
+	checksum = text.checksum;
+	compressedLength = text.compressedLength;
+	textSource = (char *)Mem_Alloc( text.textSourceSize );
+	memcpy( textSource, text.textSource, text.textSourceSize );
+	textLength = text.sourceTextLength;
+
+	totalUncompressedLength += textLength;
+	totalCompressedLength += compressedLength;
 }
 
 /*
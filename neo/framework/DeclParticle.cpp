@@ -30,6 +30,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "idlib/geometry/DrawVert.h"
 #include "framework/File.h"
 #include "renderer/RenderWorld.h"
+#include "idlib/math/Simd.h"
 
 #include "framework/DeclParticle.h"
 
@@ -1272,6 +1273,34 @@ void idParticleStage::ParticleColors( particleGen_t *g, idDrawVert *verts ) cons
 	}
 }
 
+/*
+================
+ParticleCrossFade
+
+Doubles the quads of a strip-animated particle and cross fades them
+================
+*/
+static int ParticleCrossFade( idDrawVert *verts, const int numVerts, const float width, const float frac ) {
+	float	iFrac = 1.0f - frac;
+	for ( int i = 0 ; i < numVerts ; i++ ) {
+		verts[numVerts + i] = verts[i];
+
+		verts[numVerts + i].st[0] += width;
+
+		verts[numVerts + i].color[0] *= frac;
+		verts[numVerts + i].color[1] *= frac;
+		verts[numVerts + i].color[2] *= frac;
+		verts[numVerts + i].color[3] *= frac;
+
+		verts[i].color[0] *= iFrac;
+		verts[i].color[1] *= iFrac;
+		verts[i].color[2] *= iFrac;
+		verts[i].color[3] *= iFrac;
+	}
+
+	return numVerts * 2;
+}
+
 /*
 ================
 idParticleStage::CreateParticle
@@ -1311,27 +1340,236 @@ int idParticleStage::CreateParticle( particleGen_t *g, idDrawVert *verts ) const
 		return numVerts;
 	}
 
-	// if we are doing strip-animation, we need to double the quad and cross fade it
-	float	width = 1.0f / animationFrames;
-	float	frac = g->animationFrameFrac;
-	float	iFrac = 1.0f - frac;
-	for ( int i = 0 ; i < numVerts ; i++ ) {
-		verts[numVerts + i] = verts[i];
+	return ParticleCrossFade( verts, numVerts, 1.0f / animationFrames, g->animationFrameFrac );
+}
 
-		verts[numVerts + i].st[0] += width;
+/*
+================
+idParticleStage::CreateParticles
 
-		verts[numVerts + i].color[0] *= frac;
-		verts[numVerts + i].color[1] *= frac;
-		verts[numVerts + i].color[2] *= frac;
-		verts[numVerts + i].color[3] *= frac;
+Produces the same verts as calling CreateParticle for each particle, but the
+work is split in passes over structure of arrays. The fade and the color of
+all the particles are computed first so completely faded particles are culled
+before their origin is evaluated, then the orientation vectors of the surviving
+particles are built with the SIMD processor.
 
-		verts[i].color[0] *= iFrac;
-		verts[i].color[1] *= iFrac;
-		verts[i].color[2] *= iFrac;
-		verts[i].color[3] *= iFrac;
+The random number generators are consumed per particle in exactly the same
+order as the scalar path, so both paths give identical results.
+================
+*/
+int idParticleStage::CreateParticles( particleGen_t *g, const int numParticles, const int *indexes, const float *fracs, const idRandom *randoms, idDrawVert *verts, int &numCulled ) const {
+	int i, j, numLive;
+
+	numCulled = 0;
+
+	if ( numParticles <= 0 ) {
+		return 0;
 	}
 
-	return numVerts * 2;
+	// aimed particles evaluate the origin again for every trail segment
+	if ( orientation == POR_AIMED ) {
+		int numVerts = 0;
+		for ( i = 0; i < numParticles; i++ ) {
+			g->index = indexes[i];
+			g->frac = fracs[i];
+			g->random = randoms[i];
+			g->originalRandom = g->random;
+			g->age = g->frac * particleLife;
+
+			int n = CreateParticle( g, verts + numVerts );
+			if ( n == 0 ) {
+				numCulled++;
+			}
+			numVerts += n;
+		}
+		return numVerts;
+	}
+
+	float *fade = (float *) _alloca16( numParticles * sizeof( float ) );
+	float *invFade = (float *) _alloca16( numParticles * sizeof( float ) );
+	float *fcolor = (float *) _alloca16( numParticles * sizeof( float ) );
+	dword *colors = (dword *) _alloca16( numParticles * sizeof( dword ) );
+	int *live = (int *) _alloca16( numParticles * sizeof( int ) );
+
+	//
+	// fade and color
+	//
+	for ( i = 0; i < numParticles; i++ ) {
+		float frac = fracs[i];
+		float fadeFraction = 1.0f;
+
+		if ( frac < fadeInFraction ) {
+			fadeFraction *= ( frac / fadeInFraction );
+		}
+		if ( 1.0f - frac < fadeOutFraction ) {
+			fadeFraction *= ( ( 1.0f - frac ) / fadeOutFraction );
+		}
+		if ( fadeIndexFraction ) {
+			float	indexFrac = ( totalParticles - indexes[i] ) / (float)totalParticles;
+			if ( indexFrac < fadeIndexFraction ) {
+				fadeFraction *= indexFrac / fadeIndexFraction;
+			}
+		}
+		fade[i] = fadeFraction;
+	}
+
+	SIMDProcessor->Sub( invFade, 1.0f, fade, numParticles );
+
+	for ( j = 0; j < 4; j++ ) {
+		float baseColor = ( entityColor ) ? g->renderEnt->shaderParms[j] : color[j];
+
+		SIMDProcessor->Mul( fcolor, baseColor, fade, numParticles );
+		SIMDProcessor->MulAdd( fcolor, fadeColor[j], invFade, numParticles );
+		SIMDProcessor->Mul( fcolor, 255.0f, fcolor, numParticles );
+
+		for ( i = 0; i < numParticles; i++ ) {
+			int		icolor = idMath::FtoiFast( fcolor[i] );
+			if ( icolor < 0 ) {
+				icolor = 0;
+			} else if ( icolor > 255 ) {
+				icolor = 255;
+			}
+			reinterpret_cast<byte *>( &colors[i] )[j] = icolor;
+		}
+	}
+
+	// if we are completely faded out, kill the particle
+	numLive = 0;
+	for ( i = 0; i < numParticles; i++ ) {
+		if ( colors[i] != 0 ) {
+			live[numLive++] = i;
+		}
+	}
+	numCulled = numParticles - numLive;
+
+	if ( numLive == 0 ) {
+		return 0;
+	}
+
+	//
+	// origin, texcoords, size and angle of the surviving particles
+	//
+	const int	quadVerts = ( animationFrames > 1 ) ? 8 : 4;
+	float *		originX = (float *) _alloca16( numLive * sizeof( float ) );
+	float *		originY = (float *) _alloca16( numLive * sizeof( float ) );
+	float *		originZ = (float *) _alloca16( numLive * sizeof( float ) );
+	float *		width = (float *) _alloca16( numLive * sizeof( float ) );
+	float *		height = (float *) _alloca16( numLive * sizeof( float ) );
+	float *		cosAngle = (float *) _alloca16( numLive * sizeof( float ) );
+	float *		sinAngle = (float *) _alloca16( numLive * sizeof( float ) );
+	float *		frameFrac = (float *) _alloca16( numLive * sizeof( float ) );
+
+	for ( i = 0; i < numLive; i++ ) {
+		int src = live[i];
+		idDrawVert *v = verts + i * quadVerts;
+
+		g->index = indexes[src];
+		g->frac = fracs[src];
+		g->random = randoms[src];
+		g->originalRandom = g->random;
+		g->age = g->frac * particleLife;
+
+		v[0].Clear();
+		v[1].Clear();
+		v[2].Clear();
+		v[3].Clear();
+
+		*reinterpret_cast<dword *>( v[0].color ) =
+		*reinterpret_cast<dword *>( v[1].color ) =
+		*reinterpret_cast<dword *>( v[2].color ) =
+		*reinterpret_cast<dword *>( v[3].color ) = colors[src];
+
+		idVec3 origin;
+		ParticleOrigin( g, origin );
+		originX[i] = origin[0];
+		originY[i] = origin[1];
+		originZ[i] = origin[2];
+
+		ParticleTexCoords( g, v );
+		frameFrac[i] = g->animationFrameFrac;
+
+		// same random order as ParticleVerts
+		float	psize = size.Eval( g->frac, g->random );
+		float	paspect = aspect.Eval( g->frac, g->random );
+
+		width[i] = psize;
+		height[i] = psize * paspect;
+
+		float	angle = ( initialAngle ) ? initialAngle : 360 * g->random.RandomFloat();
+		float	angleMove = rotationSpeed.Integrate( g->frac, g->random ) * particleLife;
+		if ( g->index & 1 ) {
+			angle += angleMove;
+		} else {
+			angle -= angleMove;
+		}
+
+		angle = angle / 180 * idMath::PI;
+		cosAngle[i] = idMath::Cos16( angle );
+		sinAngle[i] = idMath::Sin16( angle );
+	}
+
+	//
+	// orientation, left = leftCos * c + leftSin * s, up = upCos * c - upSin * s
+	//
+	idVec3 leftCos, leftSin, upCos, upSin;
+
+	if ( orientation == POR_Z ) {
+		leftCos.Set( 0, 1, 0 );
+		leftSin.Set( 1, 0, 0 );
+		upCos.Set( 1, 0, 0 );
+		upSin.Set( 0, 1, 0 );
+	} else if ( orientation == POR_X ) {
+		leftCos.Set( 0, 1, 0 );
+		leftSin.Set( 0, 0, 1 );
+		upCos.Set( 0, 0, 1 );
+		upSin.Set( 0, 1, 0 );
+	} else if ( orientation == POR_Y ) {
+		leftCos.Set( 1, 0, 0 );
+		leftSin.Set( 0, 0, 1 );
+		upCos.Set( 0, 0, 1 );
+		upSin.Set( 1, 0, 0 );
+	} else {
+		// oriented in viewer space
+		g->renderEnt->axis.ProjectVector( g->renderView->viewaxis[1], leftCos );
+		g->renderEnt->axis.ProjectVector( g->renderView->viewaxis[2], upCos );
+		leftSin = upCos;
+		upSin = leftCos;
+	}
+
+	float *left[3], *up[3];
+	for ( j = 0; j < 3; j++ ) {
+		left[j] = (float *) _alloca16( numLive * sizeof( float ) );
+		up[j] = (float *) _alloca16( numLive * sizeof( float ) );
+
+		SIMDProcessor->Mul( left[j], leftCos[j], cosAngle, numLive );
+		SIMDProcessor->MulAdd( left[j], leftSin[j], sinAngle, numLive );
+		SIMDProcessor->Mul( left[j], left[j], width, numLive );
+
+		SIMDProcessor->Mul( up[j], upCos[j], cosAngle, numLive );
+		SIMDProcessor->MulSub( up[j], upSin[j], sinAngle, numLive );
+		SIMDProcessor->Mul( up[j], up[j], height, numLive );
+	}
+
+	for ( i = 0; i < numLive; i++ ) {
+		idDrawVert *v = verts + i * quadVerts;
+		const idVec3 origin( originX[i], originY[i], originZ[i] );
+		const idVec3 l( left[0][i], left[1][i], left[2][i] );
+		const idVec3 u( up[0][i], up[1][i], up[2][i] );
+
+		v[0].xyz = origin - l + u;
+		v[1].xyz = origin + l + u;
+		v[2].xyz = origin - l - u;
+		v[3].xyz = origin + l - u;
+	}
+
+	if ( animationFrames > 1 ) {
+		const float frameWidth = 1.0f / animationFrames;
+		for ( i = 0; i < numLive; i++ ) {
+			ParticleCrossFade( verts + i * quadVerts, 4, frameWidth, frameFrac[i] );
+		}
+	}
+
+	return numLive * quadVerts;
 }
 
 /*
@@ -118,6 +118,10 @@ public:
 	virtual int				NumQuadsPerParticle() const;	// includes trails and cross faded animations
 	// returns the number of verts created, which will range from 0 to 4*NumQuadsPerParticle()
 	virtual int				CreateParticle( particleGen_t *g, idDrawVert *verts ) const;
+	// evaluates a batch of particles at once, taking index, frac and random of each particle from
+	// the arrays and computing colors and orientations for the whole batch with the SIMD processor.
+	// returns the number of verts created, numCulled is set to the number of completely faded particles
+	int						CreateParticles( particleGen_t *g, const int numParticles, const int *indexes, const float *fracs, const idRandom *randoms, idDrawVert *verts, int &numCulled ) const;
 
 	void					ParticleOrigin( particleGen_t *g, idVec3 &origin ) const;
 	int						ParticleVerts( particleGen_t *g, const idVec3 origin, idDrawVert *verts ) const;
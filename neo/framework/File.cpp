@@ -1363,3 +1363,209 @@ int idFile_InZip::Seek( long offset, fsOrigin_t origin ) {
 	}
 	return -1;
 }
+
+
+/*
+=================================================================================
+
+idFile_InZipMapped
+
+=================================================================================
+*/
+
+/*
+=================
+idFile_InZipMapped::idFile_InZipMapped
+=================
+*/
+idFile_InZipMapped::idFile_InZipMapped( const char *name, const char *fullPath, const byte *data, int compressedSize, int fileSize, bool deflated ) {
+	this->name = name;
+	this->fullPath = fullPath;
+	this->data = data;
+	this->compressedSize = compressedSize;
+	this->fileSize = fileSize;
+	this->deflated = deflated;
+	filePos = 0;
+	memset( &stream, 0, sizeof( stream ) );
+
+	if ( deflated ) {
+		// pk4 entries are raw deflate streams without a zlib header
+		if ( inflateInit2( &stream, -MAX_WBITS ) != Z_OK ) {
+			common->FatalError( "idFile_InZipMapped: inflateInit2 failed for %s", fullPath );
+		}
+		ResetStream();
+	}
+}
+
+/*
+=================
+idFile_InZipMapped::~idFile_InZipMapped
+=================
+*/
+idFile_InZipMapped::~idFile_InZipMapped( void ) {
+	if ( deflated ) {
+		inflateEnd( &stream );
+	}
+}
+
+/*
+=================
+idFile_InZipMapped::ResetStream
+=================
+*/
+void idFile_InZipMapped::ResetStream( void ) {
+	inflateReset( &stream );
+	stream.next_in = const_cast<Bytef *>( data );
+	stream.avail_in = compressedSize;
+	filePos = 0;
+}
+
+/*
+=================
+idFile_InZipMapped::Read
+
+Stored entries are copied straight out of the mapping, deflated ones are
+inflated from it.
+=================
+*/
+int idFile_InZipMapped::Read( void *buffer, int len ) {
+	int l;
+
+	if ( len > fileSize - filePos ) {
+		len = fileSize - filePos;
+	}
+	if ( len <= 0 ) {
+		return 0;
+	}
+
+	if ( !deflated ) {
+		memcpy( buffer, data + filePos, len );
+		l = len;
+	} else {
+		stream.next_out = (Bytef *)buffer;
+		stream.avail_out = len;
+		while ( stream.avail_out > 0 ) {
+			int err = inflate( &stream, Z_SYNC_FLUSH );
+			if ( err == Z_STREAM_END ) {
+				break;
+			}
+			if ( err != Z_OK ) {
+				common->Warning( "idFile_InZipMapped::Read: inflate error %d in %s", err, fullPath.c_str() );
+				break;
+			}
+		}
+		l = len - stream.avail_out;
+	}
+
+	filePos += l;
+	fileSystem->AddToReadCount( l );
+	return l;
+}
+
+/*
+=================
+idFile_InZipMapped::Write
+=================
+*/
+int idFile_InZipMapped::Write( const void *buffer, int len ) {
+	common->FatalError( "idFile_InZipMapped::Write: cannot write to the zipped file %s", name.c_str() );
+	return 0;
+}
+
+/*
+=================
+idFile_InZipMapped::ForceFlush
+=================
+*/
+void idFile_InZipMapped::ForceFlush( void ) {
+	common->FatalError( "idFile_InZipMapped::ForceFlush: cannot flush the zipped file %s", name.c_str() );
+}
+
+/*
+=================
+idFile_InZipMapped::Flush
+=================
+*/
+void idFile_InZipMapped::Flush( void ) {
+	common->FatalError( "idFile_InZipMapped::Flush: cannot flush the zipped file %s", name.c_str() );
+}
+
+/*
+=================
+idFile_InZipMapped::Tell
+=================
+*/
+int idFile_InZipMapped::Tell( void ) {
+	return filePos;
+}
+
+/*
+================
+idFile_InZipMapped::Length
+================
+*/
+int idFile_InZipMapped::Length( void ) {
+	return fileSize;
+}
+
+/*
+================
+idFile_InZipMapped::Timestamp
+================
+*/
+ID_TIME_T idFile_InZipMapped::Timestamp( void ) {
+	return 0;
+}
+
+/*
+=================
+idFile_InZipMapped::Seek
+
+  returns zero on success and -1 on failure
+=================
+*/
+int idFile_InZipMapped::Seek( long offset, fsOrigin_t origin ) {
+	int pos;
+
+	switch( origin ) {
+		case FS_SEEK_END:
+			pos = fileSize - offset;
+			break;
+		case FS_SEEK_SET:
+			pos = offset;
+			break;
+		case FS_SEEK_CUR:
+			pos = filePos + offset;
+			break;
+		default:
+			common->FatalError( "idFile_InZipMapped::Seek: bad origin for %s\n", name.c_str() );
+			return -1;
+	}
+
+	if ( pos < 0 || pos > fileSize ) {
+		return -1;
+	}
+
+	if ( !deflated ) {
+		filePos = pos;
+		return 0;
+	}
+
+	// deflated data can only be skipped forward
+	if ( pos < filePos ) {
+		ResetStream();
+	}
+	char *buf = (char *) _alloca16( ZIP_SEEK_BUF_SIZE );
+	while ( filePos < pos ) {
+		int n = Min( pos - filePos, ZIP_SEEK_BUF_SIZE );
+		stream.next_out = (Bytef *)buf;
+		stream.avail_out = n;
+		int err = inflate( &stream, Z_SYNC_FLUSH );
+		n -= stream.avail_out;
+		filePos += n;
+		if ( err != Z_OK || n == 0 ) {
+			break;
+		}
+	}
+	return ( filePos == pos ) ? 0 : -1;
+}
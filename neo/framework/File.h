@@ -245,4 +245,40 @@ private:
 	void *					z;				// unzip info
 };
 
+
+// file in a pak that has been mapped into memory, only stored and deflated entries
+class idFile_InZipMapped : public idFile {
+	friend class			idFileSystemLocal;
+
+public:
+							idFile_InZipMapped( const char *name, const char *fullPath, const byte *data, int compressedSize, int fileSize, bool deflated );
+	virtual					~idFile_InZipMapped( void );
+
+	virtual const char *	GetName( void ) { return name.c_str(); }
+	virtual const char *	GetFullPath( void ) { return fullPath.c_str(); }
+	virtual int				Read( void *buffer, int len );
+	virtual int				Write( const void *buffer, int len );
+	virtual int				Length( void );
+	virtual ID_TIME_T			Timestamp( void );
+	virtual int				Tell( void );
+	virtual void			ForceFlush( void );
+	virtual void			Flush( void );
+	virtual int				Seek( long offset, fsOrigin_t origin );
+
+							// returns the file contents in the mapping, NULL if the entry is compressed
+	const byte *			GetDataPtr( void ) const { return deflated ? NULL : data; }
+
+private:
+	idStr					name;			// name of the file in the pak
+	idStr					fullPath;		// full file path including pak file name
+	const byte *			data;			// entry data in the mapped pak
+	int						compressedSize;	// size of the data in the pak
+	int						fileSize;		// size of the file
+	int						filePos;		// current read position
+	bool					deflated;
+	z_stream				stream;			// inflate state for deflated entries
+
+	void					ResetStream( void );
+};
+
 #endif /* !__FILE_H__ */
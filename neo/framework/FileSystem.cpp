@@ -40,6 +40,7 @@ If you have questions concerning this license or the applicable additional terms
 	#include <curl/curl.h>
 #endif
 
+#include "idlib/hashing/CRC32.h"
 #include "idlib/hashing/MD4.h"
 #include "framework/Licensee.h"
 #include "framework/Unzip.h"
@@ -277,6 +278,8 @@ typedef struct {
 typedef struct {
 	idStr				pakFilename;				// c:\doom\base\pak0.pk4
 	unzFile				handle;
+	const byte *		mapped;						// whole pak mapped into memory, NULL if reads go through handle
+	int					mappedLength;
 	int					checksum;
 	int					numfiles;
 	int					length;
@@ -295,6 +298,51 @@ typedef struct {
 	idStr				gamedir;					// base
 } directory_t;
 
+typedef struct {
+	pack_t *			pack;						// first pak on the search path with the file
+	fileInPack_t *		file;
+} fileIndexEntry_t;
+
+// directory and checksum of a pak as they were the last time it was loaded
+typedef struct {
+	idStr				pakFilename;
+	int					length;
+	ID_TIME_T			timestamp;
+	int					checksum;
+	pureStatus_t		pureStatus;
+	idStrList			names;						// already lower case with forward slashes
+	idList<ZPOS64_T>	positions;
+	bool				used;						// matched by a LoadZipFile since the cache was loaded
+} pakCacheEntry_t;
+
+// each I/O thread sleeps on its own trigger event, TRIGGER_EVENT_FS_ASYNC0 and up
+static const int		MAX_ASYNC_READ_THREADS		= 2;
+static const int		ASYNC_READ_CHUNK_SIZE		= 16384;
+
+typedef enum {
+	ASYNCREAD_QUEUED,
+	ASYNCREAD_READING,
+	ASYNCREAD_DONE,
+	ASYNCREAD_FAILED
+} asyncReadState_t;
+
+// the location is resolved on the main thread, the I/O threads only need libc and zlib to serve it
+typedef struct {
+	int					handle;
+	asyncReadPriority_t	priority;
+	volatile asyncReadState_t state;
+	idStr				osPath;						// file holding the data, unless it is in a mapped pak
+	const byte *		mapped;						// entry data in a mapped pak
+	int					offset;
+	int					compressedLength;
+	int					length;
+	bool				deflated;
+	ID_TIME_T			timestamp;
+	byte *				buffer;						// length + 1 bytes, allocated on the main thread
+	asyncReadCallback_t	callback;
+	void *				data;
+} asyncRead_t;
+
 typedef struct searchpath_s {
 	pack_t *			pack;						// only one of pack / dir will be non NULL
 	directory_t *		dir;
@@ -349,6 +397,7 @@ public:
 	virtual const char *	BuildOSPath( const char *base, const char *game, const char *relativePath );
 	virtual void			CreateOSPath( const char *OSPath );
 	virtual bool			FileIsInPAK( const char *relativePath );
+	virtual bool			GetFileLocation( const char *relativePath, idStr &osPath, int &offset, int &length );
 	virtual void			UpdatePureServerChecksums( void );
 	virtual fsPureReply_t	SetPureServerChecksums( const int pureChecksums[ MAX_PURE_PAKS ], int missingChecksums[ MAX_PURE_PAKS ] );
 	virtual void			GetPureServerChecksums( int checksums[ MAX_PURE_PAKS ] );
@@ -356,6 +405,8 @@ public:
 	virtual	void			ClearPureChecksums( void );
 	virtual int				ReadFile( const char *relativePath, void **buffer, ID_TIME_T *timestamp );
 	virtual void			FreeFile( void *buffer );
+	virtual int				ReadFileMapped( const char *relativePath, const void **buffer, ID_TIME_T *timestamp = NULL );
+	virtual void			FreeFileMapped( const void *buffer );
 	virtual int				WriteFile( const char *relativePath, const void *buffer, int size, const char *basePath = "fs_savepath" );
 	virtual void			RemoveFile( const char *relativePath );
 	virtual idFile *		OpenFileReadFlags( const char *relativePath, int searchFlags, pack_t **foundInPak = NULL, bool allowCopyFiles = true, const char* gamedir = NULL );
@@ -367,6 +418,11 @@ public:
 	virtual idFile *		OpenExplicitFileWrite( const char *OSPath );
 	virtual void			CloseFile( idFile *f );
 	virtual void			BackgroundDownload( backgroundDownload_t *bgl );
+	virtual int				ReadFileAsync( const char *relativePath, asyncReadPriority_t priority = ASYNCREAD_NORMAL, asyncReadCallback_t callback = NULL, void *data = NULL );
+	virtual bool			CheckAsyncRead( int handle, void **buffer, int *length, ID_TIME_T *timestamp = NULL );
+	virtual int				WaitAsyncRead( int handle, void **buffer, ID_TIME_T *timestamp = NULL );
+	virtual void			CancelAsyncRead( int handle );
+	virtual void			ServiceAsyncReads( void );
 	virtual void			ResetReadCount( void ) { readCount = 0; }
 	virtual void			AddToReadCount( int c ) { readCount += c; }
 	virtual int				GetReadCount( void ) { return readCount; }
@@ -392,6 +448,7 @@ public:
 
 private:
 	friend int				BackgroundDownloadThread( void *pexit );
+	friend int				AsyncReadThread( void *parm );
 
 	searchpath_t *			searchPaths;
 	int						readCount;			// total bytes read
@@ -403,6 +460,16 @@ private:
 
 	idDict					mapDict;			// for GetMapDecl
 
+	idList<fileIndexEntry_t> fileIndex;			// every file in the searched paks, only the one that takes precedence
+	idHashIndex				fileIndexHash;
+	int						fileIndexHits;
+	int						fileIndexMisses;
+
+	idList<pakCacheEntry_t *> pakCache;
+	bool					pakCacheModified;
+
+	size_t					mappedPakBytes;		// total length of the mapped paks
+
 	static idCVar			fs_debug;
 	static idCVar			fs_restrict;
 	static idCVar			fs_copyfiles;
@@ -415,12 +482,22 @@ private:
 	static idCVar			fs_game_base;
 	static idCVar			fs_caseSensitiveOS;
 	static idCVar			fs_searchAddons;
+	static idCVar			fs_mapPaks;
+	static idCVar			fs_mapPaksLimit;
+	static idCVar			fs_pakCache;
+	static idCVar			fs_asyncReadThreads;
 
 	backgroundDownload_t *	backgroundDownloads;
 	backgroundDownload_t	defaultBackgroundDownload;
 	xthreadInfo				backgroundThread;
 	bool					backgroundThread_exit;
 
+	idList<asyncRead_t *>	asyncReads;			// queued, in flight and finished reads, guarded by CRITICAL_SECTION_FS_ASYNC
+	int						asyncReadHandle;
+	xthreadInfo				asyncReadThreads[ MAX_ASYNC_READ_THREADS ];
+	int						numAsyncReadThreads;
+	volatile bool			asyncReadThreads_exit;
+
 	idList<pack_t *>		serverPaks;
 	bool					loadedFileFromDir;		// set to true once a file was loaded from a directory - can't switch to pure anymore
 	idList<int>				restartChecksums;		// used during a restart to set things in right order
@@ -435,6 +512,14 @@ private:
 private:
 	void					ReplaceSeparators( idStr &path, char sep = PATHSEPERATOR_CHAR );
 	int						HashFileName( const char *fname ) const;
+	int						FileIndexKey( const char *fname ) const;
+	void					BuildFileIndex( void );
+	const char *			PakCachePath( void );
+	void					LoadPakCache( void );
+	void					SavePakCache( bool prune );
+	void					ClearPakCache( void );
+	pakCacheEntry_t *		FindPakCache( const char *pakFilename ) const;
+	const fileIndexEntry_t *FindInFileIndex( const char *relativePath ) const;
 	int						ListOSFiles( const char *directory, const char *extension, idStrList &list );
 	FILE *					OpenOSFile( const char *name, const char *mode, idStr *caseSensitiveName = NULL );
 	FILE *					OpenOSFileCorrectName( idStr &path, const char *mode );
@@ -446,6 +531,11 @@ private:
 
 	int						GetFileListTree( const char *relativePath, const idStrList &extensions, idStrList &list, idHashIndex &hashIndex, const char* gamedir = NULL );
 	pack_t *				LoadZipFile( const char *zipfile );
+	void					StartAsyncReadThreads( void );
+	void					StopAsyncReadThreads( void );
+	asyncRead_t *			NextAsyncRead( void );
+	int						FindAsyncRead( int handle ) const;
+	int						FinishAsyncRead( int index, void **buffer, ID_TIME_T *timestamp );
 	void					AddGameDirectory( const char *path, const char *dir );
 	void					SetupGameDirectories( const char *gameName );
 	void					Startup( void );
@@ -455,7 +545,8 @@ private:
 	pack_t *				GetPackForChecksum( int checksum, bool searchAddons = false );
 							// searches all the paks, no pure check
 	pack_t *				FindPakForFileChecksum( const char *relativePath, int fileChecksum, bool bReference );
-	idFile_InZip *			ReadFileFromZip( pack_t *pak, fileInPack_t *pakFile, const char *relativePath );
+	idFile *				ReadFileFromZip( pack_t *pak, fileInPack_t *pakFile, const char *relativePath );
+	idFile *				ReadFileFromMappedZip( pack_t *pak, fileInPack_t *pakFile, const char *relativePath );
 	int						GetFileChecksum( idFile *file );
 	pureStatus_t			GetPackStatus( pack_t *pak );
 	addonInfo_t *			ParseAddonDef( const char *buf, const int len );
@@ -482,6 +573,10 @@ idCVar	idFileSystemLocal::fs_caseSensitiveOS( "fs_caseSensitiveOS", "0", CVAR_SY
 idCVar	idFileSystemLocal::fs_caseSensitiveOS( "fs_caseSensitiveOS", "1", CVAR_SYSTEM | CVAR_BOOL, "" );
 #endif
 idCVar	idFileSystemLocal::fs_searchAddons( "fs_searchAddons", "0", CVAR_SYSTEM | CVAR_BOOL, "search all addon pk4s ( disables addon functionality )" );
+idCVar	idFileSystemLocal::fs_asyncReadThreads( "fs_asyncReadThreads", "2", CVAR_SYSTEM | CVAR_INIT | CVAR_INTEGER, "number of threads serving asynchronous file reads, 0 reads them on the main thread when requested", 0, MAX_ASYNC_READ_THREADS );
+idCVar	idFileSystemLocal::fs_pakCache( "fs_pakCache", "1", CVAR_SYSTEM | CVAR_BOOL, "keep the directories and checksums of the pk4 files in pakcache.dat in the save path" );
+idCVar	idFileSystemLocal::fs_mapPaks( "fs_mapPaks", "1", CVAR_SYSTEM | CVAR_INIT | CVAR_BOOL, "map pk4 files into memory and read stored and deflated entries straight from the mapping" );
+idCVar	idFileSystemLocal::fs_mapPaksLimit( "fs_mapPaksLimit", "512", CVAR_SYSTEM | CVAR_INIT | CVAR_INTEGER, "megabytes of pk4 files mapped into memory by 32 bit builds, the paks beyond it are read through minizip. 64 bit builds map all of them", 0, 2047 );
 
 idFileSystemLocal	fileSystemLocal;
 idFileSystem *		fileSystem = &fileSystemLocal;
@@ -503,6 +598,14 @@ idFileSystemLocal::idFileSystemLocal( void ) {
 	memset( &backgroundThread, 0, sizeof( backgroundThread ) );
 	backgroundThread_exit = false;
 	addonPaks = NULL;
+	fileIndexHits = 0;
+	fileIndexMisses = 0;
+	pakCacheModified = false;
+	asyncReadHandle = 0;
+	memset( asyncReadThreads, 0, sizeof( asyncReadThreads ) );
+	numAsyncReadThreads = 0;
+	asyncReadThreads_exit = false;
+	mappedPakBytes = 0;
 }
 
 /*
@@ -534,6 +637,92 @@ int idFileSystemLocal::HashFileName( const char *fname ) const {
 	return hash;
 }
 
+/*
+===========
+idFileSystemLocal::FileIndexKey
+
+like HashFileName, but includes the extension so the .tga / .jpg / .dds variants of a name don't share a chain
+===========
+*/
+int idFileSystemLocal::FileIndexKey( const char *fname ) const {
+	int		hash;
+	char	letter;
+
+	hash = 0;
+	for ( int i = 0; fname[i] != '\0'; i++ ) {
+		letter = idStr::ToLower( fname[i] );
+		if ( letter == '\\' ) {
+			letter = '/';
+		}
+		hash = hash * 31 + letter;
+	}
+	return hash & 0x7fffffff;
+}
+
+/*
+===========
+idFileSystemLocal::BuildFileIndex
+
+Resolves the precedence of every file in the paks on the search path once,
+a lookup then only has to compare against a single pak file.  The loose
+directories are not indexed, files get written to them while running.
+===========
+*/
+void idFileSystemLocal::BuildFileIndex( void ) {
+	searchpath_t *	search;
+	int				numFiles = 0;
+
+	for ( search = searchPaths; search; search = search->next ) {
+		if ( search->pack ) {
+			numFiles += search->pack->numfiles;
+		}
+	}
+
+	fileIndex.Clear();
+	fileIndex.SetGranularity( 1024 );
+	fileIndex.Resize( numFiles );
+	fileIndexHash.Clear( idMath::CeilPowerOfTwo( Max( numFiles, 1024 ) ), numFiles );
+	fileIndexHits = 0;
+	fileIndexMisses = 0;
+
+	for ( search = searchPaths; search; search = search->next ) {
+		if ( !search->pack ) {
+			continue;
+		}
+		pack_t *pak = search->pack;
+		// walk backwards, the pak hash chains return the last of duplicate names
+		for ( int i = pak->numfiles - 1; i >= 0; i-- ) {
+			fileInPack_t *pakFile = &pak->buildBuffer[i];
+			if ( FindInFileIndex( pakFile->name ) ) {
+				continue;	// hidden by a pak earlier on the search path
+			}
+			fileIndexEntry_t &entry = fileIndex.Alloc();
+			entry.pack = pak;
+			entry.file = pakFile;
+			fileIndexHash.Add( FileIndexKey( pakFile->name ), fileIndex.Num() - 1 );
+		}
+	}
+
+	if ( fs_debug.GetInteger() ) {
+		common->Printf( "file index: %d of %d pak files visible\n", fileIndex.Num(), numFiles );
+	}
+}
+
+/*
+===========
+idFileSystemLocal::FindInFileIndex
+===========
+*/
+const fileIndexEntry_t *idFileSystemLocal::FindInFileIndex( const char *relativePath ) const {
+	int key = FileIndexKey( relativePath );
+	for ( int i = fileIndexHash.First( key ); i != -1; i = fileIndexHash.Next( i ) ) {
+		if ( !FilenameCompare( fileIndex[i].file->name, relativePath ) ) {
+			return &fileIndex[i];
+		}
+	}
+	return NULL;
+}
+
 /*
 ===========
 idFileSystemLocal::FilenameCompare
@@ -1013,6 +1202,49 @@ bool idFileSystemLocal::FileIsInPAK( const char *relativePath ) {
 	return false;
 }
 
+/*
+================
+idFileSystemLocal::GetFileLocation
+
+Used to prefetch file data through the OS without going through the file system.
+For files in a pak the range covers the compressed data of the entry.
+================
+*/
+bool idFileSystemLocal::GetFileLocation( const char *relativePath, idStr &osPath, int &offset, int &length ) {
+	pack_t *pak = NULL;
+
+	idFile *f = OpenFileReadFlags( relativePath, FSFLAG_SEARCH_DIRS | FSFLAG_SEARCH_PAKS | FSFLAG_PURE_NOREF, &pak, false );
+	if ( !f ) {
+		return false;
+	}
+
+	idFile_InZipMapped *mf = dynamic_cast<idFile_InZipMapped *>( f );
+	idFile_InZip *zf = dynamic_cast<idFile_InZip *>( f );
+
+	if ( pak && mf ) {
+		osPath = pak->pakFilename;
+		offset = (int)( mf->data - pak->mapped );
+		length = mf->compressedSize;
+	} else if ( pak && zf ) {
+		unz_file_info64 info;
+
+		if ( unzGetCurrentFileInfo64( zf->z, &info, NULL, 0, NULL, 0, NULL, 0 ) != UNZ_OK ) {
+			CloseFile( f );
+			return false;
+		}
+		osPath = pak->pakFilename;
+		offset = (int)unzGetCurrentFileZStreamPos64( zf->z );
+		length = (int)info.compressed_size;
+	} else {
+		osPath = f->GetFullPath();
+		offset = 0;
+		length = f->Length();
+	}
+
+	CloseFile( f );
+	return true;
+}
+
 /*
 ============
 idFileSystemLocal::ReadFile
@@ -1138,6 +1370,79 @@ void idFileSystemLocal::FreeFile( void *buffer ) {
 	Mem_Free( buffer );
 }
 
+/*
+============
+idFileSystemLocal::ReadFileMapped
+
+Only stored entries of mapped paks can be handed out in place, everything
+else is read into a buffer as ReadFile does.
+============
+*/
+int idFileSystemLocal::ReadFileMapped( const char *relativePath, const void **buffer, ID_TIME_T *timestamp ) {
+	if ( !searchPaths ) {
+		common->FatalError( "Filesystem call made without initialization\n" );
+	}
+
+	if ( !relativePath || !relativePath[0] ) {
+		common->FatalError( "idFileSystemLocal::ReadFileMapped with empty name\n" );
+	}
+
+	*buffer = NULL;
+	if ( timestamp ) {
+		*timestamp = FILE_NOT_FOUND_TIMESTAMP;
+	}
+
+	idFile *f = OpenFileRead( relativePath );
+	if ( f == NULL ) {
+		return -1;
+	}
+	int len = f->Length();
+
+	if ( timestamp ) {
+		*timestamp = f->Timestamp();
+	}
+
+	loadCount++;
+	loadStack++;
+
+	idFile_InZipMapped *mf = dynamic_cast<idFile_InZipMapped *>( f );
+	if ( mf && mf->GetDataPtr() ) {
+		*buffer = mf->GetDataPtr();
+	} else {
+		// one byte more as in ReadFile, so even an empty file has a buffer
+		byte *buf = (byte *)Mem_ClearedAlloc( len + 1 );
+		f->Read( buf, len );
+		*buffer = buf;
+	}
+	CloseFile( f );
+
+	return len;
+}
+
+/*
+=============
+idFileSystemLocal::FreeFileMapped
+=============
+*/
+void idFileSystemLocal::FreeFileMapped( const void *buffer ) {
+	if ( !searchPaths ) {
+		common->FatalError( "Filesystem call made without initialization\n" );
+	}
+	if ( !buffer ) {
+		common->FatalError( "idFileSystemLocal::FreeFileMapped( NULL )" );
+	}
+
+	for ( searchpath_t *search = searchPaths; search; search = search->next ) {
+		const pack_t *pak = search->pack;
+		if ( pak && pak->mapped && (const byte *)buffer >= pak->mapped && (const byte *)buffer < pak->mapped + pak->mappedLength ) {
+			loadStack--;
+			return;
+		}
+	}
+
+	FreeFile( const_cast<void *>( buffer ) );
+}
+
 /*
 ============
 idFileSystemLocal::WriteFile
@@ -1266,6 +1571,224 @@ addonInfo_t *idFileSystemLocal::ParseAddonDef( const char *buf, const int len )
 	return NULL;
 }
 
+/*
+===============================================================================
+
+	Pak cache
+
+	Listing the central directory of every pk4 through minizip and
+	checksumming it is slow on some storage, so the result is kept in
+	pakcache.dat and reused for paks with the same length and timestamp.
+
+===============================================================================
+*/
+
+static const int PAKCACHE_ID		= ( ('1'<<24)+('C'<<16)+('K'<<8)+'P' );
+static const int PAKCACHE_VERSION	= 2;
+
+/*
+=================
+ReadPakCacheString
+
+A string can't be longer than what is left of the file.
+=================
+*/
+static bool ReadPakCacheString( idFile_Memory &f, idStr &string ) {
+	int len = -1;
+
+	f.ReadInt( len );
+	if ( len < 0 || len > f.Length() - f.Tell() ) {
+		return false;
+	}
+	string.Fill( ' ', len );
+	f.Read( &string[0], len );
+	return true;
+}
+
+/*
+=================
+idFileSystemLocal::PakCachePath
+=================
+*/
+const char *idFileSystemLocal::PakCachePath( void ) {
+	return BuildOSPath( fs_savepath.GetString(), BASE_GAMEDIR, "pakcache.dat" );
+}
+
+/*
+=================
+idFileSystemLocal::ClearPakCache
+=================
+*/
+void idFileSystemLocal::ClearPakCache( void ) {
+	pakCache.DeleteContents( true );
+	pakCacheModified = false;
+}
+
+/*
+=================
+idFileSystemLocal::FindPakCache
+=================
+*/
+pakCacheEntry_t *idFileSystemLocal::FindPakCache( const char *pakFilename ) const {
+	for ( int i = 0; i < pakCache.Num(); i++ ) {
+		if ( pakCache[i]->pakFilename.Cmp( pakFilename ) == 0 ) {
+			return pakCache[i];
+		}
+	}
+	return NULL;
+}
+
+/*
+=================
+idFileSystemLocal::LoadPakCache
+
+Uses stdio, the search paths don't exist yet
+=================
+*/
+void idFileSystemLocal::LoadPakCache( void ) {
+	ClearPakCache();
+
+	if ( !fs_pakCache.GetBool() ) {
+		return;
+	}
+
+	FILE *fp = OpenOSFile( PakCachePath(), "rb" );
+	if ( !fp ) {
+		return;
+	}
+	int length = DirectFileLength( fp );
+	if ( length <= 0 ) {
+		fclose( fp );
+		return;
+	}
+	char *buffer = (char *)Mem_Alloc( length );
+	int read = fread( buffer, 1, length, fp );
+	fclose( fp );
+
+	idFile_Memory f( "pakcache.dat", buffer, read );
+	int id = 0, version = 0, numPaks = 0, payloadLength = 0, payloadCRC = 0;
+
+	f.ReadInt( id );
+	f.ReadInt( version );
+	f.ReadInt( numPaks );
+	f.ReadInt( payloadLength );
+	f.ReadInt( payloadCRC );
+	if ( id != PAKCACHE_ID || version != PAKCACHE_VERSION || numPaks < 0 || read != length ) {
+		common->Printf( "ignoring out of date pak cache\n" );
+		Mem_Free( buffer );
+		return;
+	}
+	if ( payloadLength != f.Length() - f.Tell() || payloadCRC != (int)CRC32_BlockChecksum( buffer + f.Tell(), payloadLength ) ) {
+		common->Warning( "pak cache is corrupt" );
+		Mem_Free( buffer );
+		return;
+	}
+
+	for ( int i = 0; i < numPaks; i++ ) {
+		pakCacheEntry_t *entry = new pakCacheEntry_t;
+		int timestamp = 0, pureStatus = 0, numFiles = 0;
+
+		entry->used = false;
+		bool corrupt = !ReadPakCacheString( f, entry->pakFilename );
+		f.ReadInt( entry->length );
+		f.ReadInt( timestamp );
+		f.ReadInt( entry->checksum );
+		f.ReadInt( pureStatus );
+		f.ReadInt( numFiles );
+		entry->timestamp = timestamp;
+		entry->pureStatus = (pureStatus_t)pureStatus;
+
+		// a truncated file shows up as a short read, every file takes at least 12 bytes
+		if ( numFiles < 0 || numFiles > ( f.Length() - f.Tell() ) / 12 ) {
+			corrupt = true;
+		}
+
+		entry->names.SetNum( corrupt ? 0 : numFiles );
+		entry->positions.SetNum( entry->names.Num() );
+		for ( int j = 0; j < entry->names.Num() && !corrupt; j++ ) {
+			int low = 0, high = 0;
+			corrupt = !ReadPakCacheString( f, entry->names[j] );
+			f.ReadInt( low );
+			f.ReadInt( high );
+			entry->positions[j] = ( (ZPOS64_T)(unsigned int)high << 32 ) | (unsigned int)low;
+		}
+
+		if ( corrupt ) {
+			common->Warning( "pak cache is corrupt" );
+			delete entry;
+			ClearPakCache();
+			break;
+		}
+		pakCache.Append( entry );
+	}
+
+	Mem_Free( buffer );
+}
+
+/*
+=================
+idFileSystemLocal::SavePakCache
+
+When all search paths were set up, prune drops the paks that weren't loaded,
+they were removed or are in directories that aren't searched anymore.
+=================
+*/
+void idFileSystemLocal::SavePakCache( bool prune ) {
+	if ( !fs_pakCache.GetBool() ) {
+		return;
+	}
+	if ( prune ) {
+		for ( int i = pakCache.Num() - 1; i >= 0; i-- ) {
+			if ( !pakCache[i]->used ) {
+				delete pakCache[i];
+				pakCache.RemoveIndex( i );
+				pakCacheModified = true;
+			}
+		}
+	}
+	if ( !pakCacheModified ) {
+		return;
+	}
+	pakCacheModified = false;
+
+	idFile_Memory payload( "pakcache.dat" );
+
+	for ( int i = 0; i < pakCache.Num(); i++ ) {
+		const pakCacheEntry_t *entry = pakCache[i];
+
+		payload.WriteString( entry->pakFilename );
+		payload.WriteInt( entry->length );
+		payload.WriteInt( (int)entry->timestamp );
+		payload.WriteInt( entry->checksum );
+		payload.WriteInt( (int)entry->pureStatus );
+		payload.WriteInt( entry->names.Num() );
+		for ( int j = 0; j < entry->names.Num(); j++ ) {
+			payload.WriteString( entry->names[j] );
+			payload.WriteInt( (int)( entry->positions[j] & 0xffffffff ) );
+			payload.WriteInt( (int)( entry->positions[j] >> 32 ) );
+		}
+	}
+
+	idFile_Memory f( "pakcache.dat" );
+
+	f.WriteInt( PAKCACHE_ID );
+	f.WriteInt( PAKCACHE_VERSION );
+	f.WriteInt( pakCache.Num() );
+	f.WriteInt( payload.Length() );
+	f.WriteInt( (int)CRC32_BlockChecksum( payload.GetDataPtr(), payload.Length() ) );
+	f.Write( payload.GetDataPtr(), payload.Length() );
+
+	idStr path = PakCachePath();
+	CreateOSPath( path );
+	FILE *fp = OpenOSFile( path, "wb" );
+	if ( !fp ) {
+		common->Warning( "couldn't write %s", path.c_str() );
+		return;
+	}
+	fwrite( f.GetDataPtr(), 1, f.Length(), fp );
+	fclose( fp );
+}
+
 /*
 =================
 idFileSystemLocal::LoadZipFile
@@ -1294,6 +1817,7 @@ pack_t *idFileSystemLocal::LoadZipFile( const char *zipfile ) {
 	}
 	fseek( f, 0, SEEK_END );
 	len = ftell( f );
+	ID_TIME_T timestamp = Sys_FileTimeStamp( f );
 	fclose( f );
 
 	fs_numHeaderLongs = 0;
@@ -1313,6 +1837,8 @@ pack_t *idFileSystemLocal::LoadZipFile( const char *zipfile ) {
 
 	pack->pakFilename = zipfile;
 	pack->handle = uf;
+	pack->mapped = NULL;
+	pack->mappedLength = 0;
 	pack->numfiles = gi.number_entry;
 	pack->buildBuffer = buildBuffer;
 	pack->referenced = false;
@@ -1324,27 +1850,71 @@ pack_t *idFileSystemLocal::LoadZipFile( const char *zipfile ) {
 
 	pack->length = len;
 
-	unzGoToFirstFile(uf);
-	fs_headerLongs = (int *)Mem_ClearedAlloc( gi.number_entry * sizeof(int) );
-	for ( i = 0; i < (int)gi.number_entry; i++ ) {
-		err = unzGetCurrentFileInfo64( uf, &file_info, filename_inzip, sizeof(filename_inzip), NULL, 0, NULL, 0 );
-		if ( err != UNZ_OK ) {
-			break;
+	pakCacheEntry_t *cached = FindPakCache( zipfile );
+	if ( cached && ( cached->length != len || cached->timestamp != timestamp || cached->names.Num() != (int)gi.number_entry ) ) {
+		pakCache.Remove( cached );
+		delete cached;
+		cached = NULL;
+	}
+
+	if ( cached ) {
+		cached->used = true;
+		for ( i = 0; i < cached->names.Num(); i++ ) {
+			hash = HashFileName( cached->names[i] );
+			buildBuffer[i].name = cached->names[i];
+			buildBuffer[i].pos = cached->positions[i];
+			buildBuffer[i].next = pack->hashTable[hash];
+			pack->hashTable[hash] = &buildBuffer[i];
+		}
+		pack->checksum = cached->checksum;
+		pack->pureStatus = cached->pureStatus;
+	} else {
+		unzGoToFirstFile(uf);
+		fs_headerLongs = (int *)Mem_ClearedAlloc( gi.number_entry * sizeof(int) );
+		for ( i = 0; i < (int)gi.number_entry; i++ ) {
+			err = unzGetCurrentFileInfo64( uf, &file_info, filename_inzip, sizeof(filename_inzip), NULL, 0, NULL, 0 );
+			if ( err != UNZ_OK ) {
+				break;
+			}
+			if ( file_info.uncompressed_size > 0 ) {
+				fs_headerLongs[fs_numHeaderLongs++] = LittleInt( file_info.crc );
+			}
+			hash = HashFileName( filename_inzip );
+			buildBuffer[i].name = filename_inzip;
+			buildBuffer[i].name.ToLower();
+			buildBuffer[i].name.BackSlashesToSlashes();
+			// store the file position in the zip
+			buildBuffer[i].pos = unzGetOffset64( uf );
+			// add the file to the hash
+			buildBuffer[i].next = pack->hashTable[hash];
+			pack->hashTable[hash] = &buildBuffer[i];
+			// go to the next file in the zip
+			unzGoToNextFile(uf);
 		}
-		if ( file_info.uncompressed_size > 0 ) {
-			fs_headerLongs[fs_numHeaderLongs++] = LittleInt( file_info.crc );
+
+		pack->checksum = MD4_BlockChecksum( fs_headerLongs, 4 * fs_numHeaderLongs );
+		pack->checksum = LittleInt( pack->checksum );
+
+		Mem_Free( fs_headerLongs );
+
+		// remember the directory unless it couldn't be read completely
+		if ( fs_pakCache.GetBool() && i == (int)gi.number_entry ) {
+			cached = new pakCacheEntry_t;
+			cached->pakFilename = zipfile;
+			cached->length = len;
+			cached->timestamp = timestamp;
+			cached->checksum = pack->checksum;
+			cached->pureStatus = GetPackStatus( pack );
+			cached->used = true;
+			cached->names.SetNum( gi.number_entry );
+			cached->positions.SetNum( gi.number_entry );
+			for ( i = 0; i < (int)gi.number_entry; i++ ) {
+				cached->names[i] = buildBuffer[i].name;
+				cached->positions[i] = buildBuffer[i].pos;
+			}
+			pakCache.Append( cached );
+			pakCacheModified = true;
 		}
-		hash = HashFileName( filename_inzip );
-		buildBuffer[i].name = filename_inzip;
-		buildBuffer[i].name.ToLower();
-		buildBuffer[i].name.BackSlashesToSlashes();
-		// store the file position in the zip
-		buildBuffer[i].pos = unzGetOffset64( uf );
-		// add the file to the hash
-		buildBuffer[i].next = pack->hashTable[hash];
-		pack->hashTable[hash] = &buildBuffer[i];
-		// go to the next file in the zip
-		unzGoToNextFile(uf);
 	}
 
 	// ignore all binary paks
@@ -1354,18 +1924,31 @@ pack_t *idFileSystemLocal::LoadZipFile( const char *zipfile ) {
 			unzClose(uf);
 			delete[] buildBuffer;
 			delete pack;
-			Mem_Free( fs_headerLongs );
 			return NULL;
 		}
 	}
 
+	if ( fs_mapPaks.GetBool() ) {
+		// on 32 bit the mappings would take most of the address space, leave room for the heap and textures
+		if ( sizeof( void * ) < 8 && mappedPakBytes + (size_t)pack->length > (size_t)fs_mapPaksLimit.GetInteger() << 20 ) {
+			common->DPrintf( "not mapping %s, fs_mapPaksLimit reached, reading through minizip\n", zipfile );
+		} else {
+			pack->mapped = (const byte *)Sys_MapFile( zipfile, &pack->mappedLength );
+			if ( !pack->mapped ) {
+				common->DPrintf( "couldn't map %s, reading through minizip\n", zipfile );
+			} else {
+				mappedPakBytes += pack->mappedLength;
+			}
+		}
+	}
+
 	// check if this is an addon pak
 	pack->addon = false;
 	confHash = HashFileName( ADDON_CONFIG );
 	for ( pakFile = pack->hashTable[confHash]; pakFile; pakFile = pakFile->next ) {
 		if ( !FilenameCompare( pakFile->name, ADDON_CONFIG ) ) {
 			pack->addon = true;
-			idFile_InZip *file = ReadFileFromZip( pack, pakFile, ADDON_CONFIG );
+			idFile *file = ReadFileFromZip( pack, pakFile, ADDON_CONFIG );
 			// may be just an empty file if you don't bother about the mapDef
 			if ( file && file->Length() ) {
 				char *buf;
@@ -1382,11 +1965,6 @@ pack_t *idFileSystemLocal::LoadZipFile( const char *zipfile ) {
 		}
 	}
 
-	pack->checksum = MD4_BlockChecksum( fs_headerLongs, 4 * fs_numHeaderLongs );
-	pack->checksum = LittleInt( pack->checksum );
-
-	Mem_Free( fs_headerLongs );
-
 	return pack;
 }
 
@@ -1403,7 +1981,10 @@ int idFileSystemLocal::AddZipFile( const char *path ) {
 	searchpath_t	*search, *last;
 
 	fullpath.AppendPath( path );
+	LoadPakCache();
 	pak = LoadZipFile( fullpath );
+	SavePakCache( false );
+	ClearPakCache();
 	if ( !pak ) {
 		common->Warning( "AddZipFile %s failed\n", path );
 		return 0;
@@ -1419,6 +2000,7 @@ int idFileSystemLocal::AddZipFile( const char *path ) {
 		last = last->next;
 	}
 	last->next = search;
+	BuildFileIndex();
 	common->Printf( "Appended pk4 %s with checksum 0x%x\n", pak->pakFilename.c_str(), pak->checksum );
 	return pak->checksum;
 }
@@ -2011,6 +2593,11 @@ void idFileSystemLocal::Path_f( const idCmdArgs &args ) {
 			common->Printf( "%s (%i files)\n", sp->pack->pakFilename.c_str(), sp->pack->numfiles );
 		}
 	}
+
+	if ( fs_debug.GetInteger() ) {
+		common->Printf( "File index: %d files, %d hits, %d misses since the last restart\n", fileSystemLocal.fileIndex.Num(),
+						fileSystemLocal.fileIndexHits, fileSystemLocal.fileIndexMisses );
+	}
 }
 
 /*
@@ -2222,6 +2809,8 @@ void idFileSystemLocal::Startup( void ) {
 		common->Printf( "restarting filesystem with %d addon pak file(s) to include\n", addonChecksums.Num() );
 	}
 
+	LoadPakCache();
+
 	SetupGameDirectories( BASE_GAMEDIR );
 
 	// fs_game_base override
@@ -2237,6 +2826,10 @@ void idFileSystemLocal::Startup( void ) {
 		SetupGameDirectories( fs_game.GetString() );
 	}
 
+	// only paks that were new, changed or removed have to be written
+	SavePakCache( true );
+	ClearPakCache();
+
 	// currently all addons are in the search list - deal with filtering out and dependencies now
 	// scan through and deal with dependencies
 	search = &searchPaths;
@@ -2371,6 +2964,8 @@ void idFileSystemLocal::Startup( void ) {
 	cmdSystem->AddCommand( "touchFile", TouchFile_f, CMD_FL_SYSTEM, "touches a file" );
 	cmdSystem->AddCommand( "touchFileList", TouchFileList_f, CMD_FL_SYSTEM, "touches a list of files" );
 
+	BuildFileIndex();
+
 	// print the current search paths
 	Path_f( idCmdArgs() );
 }
@@ -2690,6 +3285,9 @@ void idFileSystemLocal::Init( void ) {
 	// spawn a thread to handle background file reads
 	StartBackgroundDownloadThread();
 
+	// and the threads serving ReadFileAsync
+	StartAsyncReadThreads();
+
 	if ( ReadFile( "default.cfg", NULL, NULL ) <= 0 ) {
 		// DG: the demo gamedata is in demo/ instead of base/. to make it "just work", add a fallback for that
 		if(fs_game.GetString()[0] == '\0' || idStr::Icmp(fs_game.GetString(), BASE_GAMEDIR) == 0) {
@@ -2721,6 +3319,9 @@ void idFileSystemLocal::Restart( void ) {
 	// spawn a thread to handle background file reads
 	StartBackgroundDownloadThread();
 
+	// and the threads serving ReadFileAsync
+	StartAsyncReadThreads();
+
 	// if we can't find default.cfg, assume that the paths are
 	// busted and error out now, rather than getting an unreadable
 	// graphics screen when the font fails to load
@@ -2744,6 +3345,9 @@ void idFileSystemLocal::Shutdown( bool reloading ) {
 	Sys_DestroyThread(backgroundThread);
 	backgroundThread_exit = false;
 
+	// the requests can point into mapped paks
+	StopAsyncReadThreads();
+
 	gameFolder.Clear();
 
 	serverPaks.Clear();
@@ -2762,6 +3366,10 @@ void idFileSystemLocal::Shutdown( bool reloading ) {
 
 			if ( sp->pack ) {
 				unzClose( sp->pack->handle );
+				if ( sp->pack->mapped ) {
+					Sys_UnmapFile( sp->pack->mapped, sp->pack->mappedLength );
+					mappedPakBytes -= sp->pack->mappedLength;
+				}
 				delete [] sp->pack->buildBuffer;
 				if ( sp->pack->addon_info ) {
 					sp->pack->addon_info->mapDecls.DeleteContents( true );
@@ -2780,6 +3388,9 @@ void idFileSystemLocal::Shutdown( bool reloading ) {
 	searchPaths = NULL;
 	addonPaks = NULL;
 
+	fileIndex.Clear();
+	fileIndexHash.Free();
+
 	cmdSystem->RemoveCommand( "path" );
 	cmdSystem->RemoveCommand( "dir" );
 	cmdSystem->RemoveCommand( "dirtree" );
@@ -2909,15 +3520,95 @@ pureStatus_t idFileSystemLocal::GetPackStatus( pack_t *pak ) {
 	return PURE_NEUTRAL;
 }
 
+/*
+===========
+Zip_Short / Zip_Long
+
+zip headers are little endian and not aligned
+===========
+*/
+static ID_INLINE int Zip_Short( const byte *p ) {
+	return p[0] | ( p[1] << 8 );
+}
+
+static ID_INLINE unsigned int Zip_Long( const byte *p ) {
+	return p[0] | ( p[1] << 8 ) | ( p[2] << 16 ) | ( (unsigned int)p[3] << 24 );
+}
+
+#define ZIP_CENTRAL_HEADER_SIG		0x02014b50
+#define ZIP_CENTRAL_HEADER_SIZE		46
+#define ZIP_LOCAL_HEADER_SIG		0x04034b50
+#define ZIP_LOCAL_HEADER_SIZE		30
+
+/*
+===========
+idFileSystemLocal::ReadFileFromMappedZip
+
+Finds the entry data in the mapped pak through its central directory and
+local headers.  Returns NULL for anything that has to go through minizip:
+zip64 sizes, other compression methods, encryption or a damaged header.
+===========
+*/
+idFile * idFileSystemLocal::ReadFileFromMappedZip( pack_t *pak, fileInPack_t *pakFile, const char *relativePath ) {
+	const byte *	central;
+	const byte *	local;
+
+	if ( pakFile->pos + ZIP_CENTRAL_HEADER_SIZE > (ZPOS64_T)pak->mappedLength ) {
+		return NULL;
+	}
+	central = pak->mapped + pakFile->pos;
+	if ( Zip_Long( central ) != ZIP_CENTRAL_HEADER_SIG ) {
+		return NULL;
+	}
+
+	int flags = Zip_Short( central + 8 );
+	int method = Zip_Short( central + 10 );
+	unsigned int compressedSize = Zip_Long( central + 20 );
+	unsigned int uncompressedSize = Zip_Long( central + 24 );
+	unsigned int localOffset = Zip_Long( central + 42 );
+
+	if ( ( flags & 1 ) || ( method != 0 && method != Z_DEFLATED ) ) {
+		return NULL;
+	}
+	// the central header fit, so mappedLength can't be below the local header size.
+	// compare against what is left of the mapping, the sums could wrap
+	if ( compressedSize >= 0x7fffffff || uncompressedSize >= 0x7fffffff || localOffset > (unsigned int)pak->mappedLength - ZIP_LOCAL_HEADER_SIZE ) {
+		return NULL;
+	}
+
+	local = pak->mapped + localOffset;
+	if ( Zip_Long( local ) != ZIP_LOCAL_HEADER_SIG ) {
+		return NULL;
+	}
+	// the sizes are taken from the central directory, the local ones may be in a data descriptor
+	unsigned int dataOffset = localOffset + ZIP_LOCAL_HEADER_SIZE + Zip_Short( local + 26 ) + Zip_Short( local + 28 );
+	if ( dataOffset > (unsigned int)pak->mappedLength || compressedSize > (unsigned int)pak->mappedLength - dataOffset ) {
+		return NULL;
+	}
+	if ( method == 0 && compressedSize != uncompressedSize ) {
+		return NULL;
+	}
+
+	return new idFile_InZipMapped( relativePath, pak->pakFilename + "/" + relativePath, pak->mapped + dataOffset,
+									(int)compressedSize, (int)uncompressedSize, ( method == Z_DEFLATED ) );
+}
+
 /*
 ===========
 idFileSystemLocal::ReadFileFromZip
 ===========
 */
-idFile_InZip * idFileSystemLocal::ReadFileFromZip( pack_t *pak, fileInPack_t *pakFile, const char *relativePath ) {
+idFile * idFileSystemLocal::ReadFileFromZip( pack_t *pak, fileInPack_t *pakFile, const char *relativePath ) {
 	// relativePath == pakFile->name according to FilenameCompare()
 	// pakFile->Pos is position of that file within the zip
 
+	if ( pak->mapped ) {
+		idFile *file = ReadFileFromMappedZip( pak, pakFile, relativePath );
+		if ( file ) {
+			return file;
+		}
+	}
+
 	// set position in pk4 file to the file (in the zip/pk4) we want a handle on
 	unzSetOffset64( pak->handle, pakFile->pos );
 
@@ -3006,6 +3697,22 @@ idFile *idFileSystemLocal::OpenFileReadFlags( const char *relativePath, int sear
 
 	hash = HashFileName( relativePath );
 
+	// the index has the pak that wins for every name, it can't be used while
+	// the pure list restricts which paks are searched
+	const fileIndexEntry_t *indexed = NULL;
+	bool useIndex = ( ( searchFlags & FSFLAG_SEARCH_PAKS ) && !serverPaks.Num() );
+	if ( useIndex ) {
+		indexed = FindInFileIndex( relativePath );
+		if ( indexed ) {
+			fileIndexHits++;
+		} else {
+			fileIndexMisses++;
+			if ( fs_debug.GetInteger() > 1 ) {
+				common->Printf( "idFileSystem::OpenFileRead: %s not in any pak\n", relativePath );
+			}
+		}
+	}
+
 	for ( search = searchPaths; search; search = search->next ) {
 		if ( search->dir && ( searchFlags & FSFLAG_SEARCH_DIRS ) ) {
 			// check a file in the directory tree
@@ -3110,6 +3817,18 @@ idFile *idFileSystemLocal::OpenFileReadFlags( const char *relativePath, int sear
 			return file;
 		} else if ( search->pack && ( searchFlags & FSFLAG_SEARCH_PAKS ) ) {
 
+			if ( useIndex ) {
+				if ( !indexed ) {
+					if ( !( searchFlags & FSFLAG_SEARCH_DIRS ) ) {
+						break;		// nothing left to search
+					}
+					continue;
+				}
+				if ( indexed->pack != search->pack ) {
+					continue;
+				}
+			}
+
 			if ( !search->pack->hashTable[hash] ) {
 				continue;
 			}
@@ -3124,10 +3843,10 @@ idFile *idFileSystemLocal::OpenFileReadFlags( const char *relativePath, int sear
 
 			// look through all the pak file elements
 			pak = search->pack;
-			for ( pakFile = pak->hashTable[hash]; pakFile; pakFile = pakFile->next ) {
+			for ( pakFile = ( useIndex ? indexed->file : pak->hashTable[hash] ); pakFile; pakFile = pakFile->next ) {
 				// case and separator insensitive comparisons
 				if ( !FilenameCompare( pakFile->name, relativePath ) ) {
-					idFile_InZip *file = ReadFileFromZip( pak, pakFile, relativePath );
+					idFile *file = ReadFileFromZip( pak, pakFile, relativePath );
 
 					if ( foundInPak ) {
 						*foundInPak = pak;
@@ -3157,7 +3876,7 @@ idFile *idFileSystemLocal::OpenFileReadFlags( const char *relativePath, int sear
 			pak = search->pack;
 			for ( pakFile = pak->hashTable[hash]; pakFile; pakFile = pakFile->next ) {
 				if ( !FilenameCompare( pakFile->name, relativePath ) ) {
-					idFile_InZip *file = ReadFileFromZip( pak, pakFile, relativePath );
+					idFile *file = ReadFileFromZip( pak, pakFile, relativePath );
 					if ( foundInPak ) {
 						*foundInPak = pak;
 					}
@@ -3581,6 +4300,453 @@ void idFileSystemLocal::BackgroundDownload( backgroundDownload_t *bgl ) {
 	}
 }
 
+/*
+=================
+PerformAsyncRead
+
+Fills the buffer of a request from the pak mapping or the OS file, inflating
+deflated pak entries.  Runs on the I/O threads, so only libc and zlib here.
+=================
+*/
+static bool PerformAsyncRead( asyncRead_t *read ) {
+	byte		chunk[ ASYNC_READ_CHUNK_SIZE ];
+	z_stream	stream;
+	FILE *		fp;
+	int			remaining;
+	int			err;
+	bool		ok;
+
+	if ( read->mapped && !read->deflated ) {
+		memcpy( read->buffer, read->mapped, read->length );
+		return true;
+	}
+
+	fp = NULL;
+	if ( !read->mapped ) {
+		fp = fopen( read->osPath.c_str(), "rb" );
+		if ( !fp ) {
+			return false;
+		}
+		if ( fseek( fp, read->offset, SEEK_SET ) != 0 ) {
+			fclose( fp );
+			return false;
+		}
+		if ( !read->deflated ) {
+			ok = ( (int)fread( read->buffer, 1, read->length, fp ) == read->length );
+			fclose( fp );
+			return ok;
+		}
+	}
+
+	memset( &stream, 0, sizeof( stream ) );
+	if ( inflateInit2( &stream, -MAX_WBITS ) != Z_OK ) {
+		if ( fp ) {
+			fclose( fp );
+		}
+		return false;
+	}
+	stream.next_out = read->buffer;
+	stream.avail_out = read->length;
+	if ( read->mapped ) {
+		stream.next_in = const_cast<Bytef *>( read->mapped );
+		stream.avail_in = read->compressedLength;
+	}
+
+	remaining = read->compressedLength;
+	err = Z_OK;
+	while ( err == Z_OK && stream.avail_out > 0 ) {
+		if ( fp && stream.avail_in == 0 ) {
+			int n = Min( remaining, ASYNC_READ_CHUNK_SIZE );
+			if ( n <= 0 || (int)fread( chunk, 1, n, fp ) != n ) {
+				break;
+			}
+			remaining -= n;
+			stream.next_in = chunk;
+			stream.avail_in = n;
+		}
+		err = inflate( &stream, Z_NO_FLUSH );
+	}
+	ok = ( stream.avail_out == 0 && ( err == Z_OK || err == Z_STREAM_END ) );
+
+	inflateEnd( &stream );
+	if ( fp ) {
+		fclose( fp );
+	}
+	return ok;
+}
+
+/*
+=================
+AsyncReadThread
+
+Serves the queued reads by priority, sleeping on its own event when there is nothing to do.
+=================
+*/
+int AsyncReadThread( void *parm ) {
+	int event = TRIGGER_EVENT_FS_ASYNC0 + (int)(intptr_t)parm;
+
+	while ( !fileSystemLocal.asyncReadThreads_exit ) {
+		Sys_EnterCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+		asyncRead_t *read = fileSystemLocal.NextAsyncRead();
+		Sys_LeaveCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+
+		if ( !read ) {
+			Sys_WaitForEvent( event );
+			continue;
+		}
+
+		bool ok = PerformAsyncRead( read );
+
+		Sys_EnterCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+		read->state = ok ? ASYNCREAD_DONE : ASYNCREAD_FAILED;
+		Sys_LeaveCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+	}
+	return 0;
+}
+
+/*
+=================
+idFileSystemLocal::StartAsyncReadThreads
+=================
+*/
+void idFileSystemLocal::StartAsyncReadThreads( void ) {
+	static const char *asyncReadThreadNames[MAX_ASYNC_READ_THREADS] = { "asyncRead0", "asyncRead1" };
+
+
+	if ( numAsyncReadThreads ) {
+		return;
+	}
+	asyncReadThreads_exit = false;
+	numAsyncReadThreads = idMath::ClampInt( 0, MAX_ASYNC_READ_THREADS, fs_asyncReadThreads.GetInteger() );
+	for ( int i = 0; i < numAsyncReadThreads; i++ ) {
+		Sys_CreateThread( AsyncReadThread, (void *)(intptr_t)i, asyncReadThreads[i], asyncReadThreadNames[i] );
+	}
+}
+
+/*
+=================
+idFileSystemLocal::StopAsyncReadThreads
+
+Outstanding requests are dropped, their handles read as failed from now on.
+=================
+*/
+void idFileSystemLocal::StopAsyncReadThreads( void ) {
+	asyncReadThreads_exit = true;
+	for ( int i = 0; i < numAsyncReadThreads; i++ ) {
+		Sys_TriggerEvent( TRIGGER_EVENT_FS_ASYNC0 + i );
+	}
+	for ( int i = 0; i < numAsyncReadThreads; i++ ) {
+		Sys_DestroyThread( asyncReadThreads[i] );
+	}
+	memset( asyncReadThreads, 0, sizeof( asyncReadThreads ) );
+	numAsyncReadThreads = 0;
+	asyncReadThreads_exit = false;
+
+	for ( int i = 0; i < asyncReads.Num(); i++ ) {
+		Mem_Free( asyncReads[i]->buffer );
+		loadStack--;
+	}
+	asyncReads.DeleteContents( true );
+}
+
+/*
+=================
+idFileSystemLocal::NextAsyncRead
+
+Takes the first queued request of the highest priority, CRITICAL_SECTION_FS_ASYNC has to be held.
+=================
+*/
+asyncRead_t *idFileSystemLocal::NextAsyncRead( void ) {
+	asyncRead_t *best = NULL;
+
+	for ( int i = 0; i < asyncReads.Num(); i++ ) {
+		asyncRead_t *read = asyncReads[i];
+		if ( read->state == ASYNCREAD_QUEUED && ( !best || read->priority > best->priority ) ) {
+			best = read;
+		}
+	}
+	if ( best ) {
+		best->state = ASYNCREAD_READING;
+	}
+	return best;
+}
+
+/*
+=================
+idFileSystemLocal::FindAsyncRead
+=================
+*/
+int idFileSystemLocal::FindAsyncRead( int handle ) const {
+	for ( int i = 0; i < asyncReads.Num(); i++ ) {
+		if ( asyncReads[i]->handle == handle ) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/*
+=================
+idFileSystemLocal::FinishAsyncRead
+
+Hands the result of a finished request to the caller and releases it.
+=================
+*/
+int idFileSystemLocal::FinishAsyncRead( int index, void **buffer, ID_TIME_T *timestamp ) {
+	asyncRead_t *read = asyncReads[index];
+	int length = read->length;
+
+	asyncReads.RemoveIndex( index );
+
+	if ( timestamp ) {
+		*timestamp = read->timestamp;
+	}
+	if ( read->state == ASYNCREAD_FAILED ) {
+		common->Warning( "async read of '%s' failed", read->osPath.c_str() );
+		FreeFile( read->buffer );
+		read->buffer = NULL;
+		length = -1;
+	}
+	*buffer = read->buffer;
+
+	delete read;
+	return length;
+}
+
+/*
+=================
+idFileSystemLocal::ReadFileAsync
+
+The file is opened here to find where its bytes are, the I/O threads then
+only have to copy or inflate them.
+=================
+*/
+int idFileSystemLocal::ReadFileAsync( const char *relativePath, asyncReadPriority_t priority, asyncReadCallback_t callback, void *data ) {
+	pack_t *	pak = NULL;
+	idFile *	f;
+
+	if ( !searchPaths ) {
+		common->FatalError( "Filesystem call made without initialization\n" );
+	}
+
+	if ( !relativePath || !relativePath[0] ) {
+		common->FatalError( "idFileSystemLocal::ReadFileAsync with empty name\n" );
+	}
+
+	f = OpenFileReadFlags( relativePath, FSFLAG_SEARCH_DIRS | FSFLAG_SEARCH_PAKS, &pak );
+	if ( !f ) {
+		return -1;
+	}
+
+	asyncRead_t *read = new asyncRead_t;
+	read->handle = asyncReadHandle++;
+	read->priority = priority;
+	read->state = ASYNCREAD_QUEUED;
+	read->osPath = f->GetFullPath();
+	read->mapped = NULL;
+	read->offset = 0;
+	read->length = f->Length();
+	read->compressedLength = read->length;
+	read->deflated = false;
+	read->timestamp = f->Timestamp();
+	read->callback = callback;
+	read->data = data;
+
+	idFile_InZipMapped *mf = dynamic_cast<idFile_InZipMapped *>( f );
+	idFile_InZip *zf = dynamic_cast<idFile_InZip *>( f );
+	bool direct = true;
+
+	if ( pak && mf ) {
+		read->mapped = mf->data;
+		read->compressedLength = mf->compressedSize;
+		read->deflated = mf->deflated;
+	} else if ( pak && zf ) {
+		unz_file_info64 info;
+
+		if ( unzGetCurrentFileInfo64( zf->z, &info, NULL, 0, NULL, 0, NULL, 0 ) != UNZ_OK
+				|| ( info.flag & 1 ) || ( info.compression_method != 0 && info.compression_method != Z_DEFLATED ) ) {
+			direct = false;
+		} else {
+			read->osPath = pak->pakFilename;
+			read->offset = (int)unzGetCurrentFileZStreamPos64( zf->z );
+			read->compressedLength = (int)info.compressed_size;
+			read->deflated = ( info.compression_method == Z_DEFLATED );
+		}
+	} else if ( pak ) {
+		direct = false;
+	}
+
+	loadCount++;
+	loadStack++;
+
+	read->buffer = (byte *)Mem_Alloc( read->length + 1 );
+	// guarantee that it will have a trailing 0 for string operations
+	read->buffer[read->length] = 0;
+
+	if ( !direct ) {
+		// encrypted or oddly compressed, let minizip deal with it now
+		f->Read( read->buffer, read->length );
+		read->state = ASYNCREAD_DONE;
+	} else if ( !numAsyncReadThreads ) {
+		read->state = PerformAsyncRead( read ) ? ASYNCREAD_DONE : ASYNCREAD_FAILED;
+	}
+	CloseFile( f );
+
+	Sys_EnterCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+	asyncReads.Append( read );
+	Sys_LeaveCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+
+	if ( read->state == ASYNCREAD_QUEUED ) {
+		for ( int i = 0; i < numAsyncReadThreads; i++ ) {
+			Sys_TriggerEvent( TRIGGER_EVENT_FS_ASYNC0 + i );
+		}
+	}
+
+	if ( fs_debug.GetInteger() > 1 ) {
+		common->Printf( "async read %d: %s, priority %d\n", read->handle, relativePath, (int)priority );
+	}
+
+	return read->handle;
+}
+
+/*
+=================
+idFileSystemLocal::CheckAsyncRead
+=================
+*/
+bool idFileSystemLocal::CheckAsyncRead( int handle, void **buffer, int *length, ID_TIME_T *timestamp ) {
+	Sys_EnterCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+
+	int index = FindAsyncRead( handle );
+	if ( index < 0 ) {
+		Sys_LeaveCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+		*buffer = NULL;
+		*length = -1;
+		return true;
+	}
+	if ( asyncReads[index]->state < ASYNCREAD_DONE ) {
+		Sys_LeaveCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+		return false;
+	}
+
+	*length = FinishAsyncRead( index, buffer, timestamp );
+
+	Sys_LeaveCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+	return true;
+}
+
+/*
+=================
+idFileSystemLocal::WaitAsyncRead
+
+A request nobody has picked up yet is read right here rather than waiting
+behind everything queued before it.
+=================
+*/
+int idFileSystemLocal::WaitAsyncRead( int handle, void **buffer, ID_TIME_T *timestamp ) {
+	void *	buf;
+	int		length;
+
+	while( 1 ) {
+		Sys_EnterCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+		int index = FindAsyncRead( handle );
+		asyncRead_t *read = ( index >= 0 && asyncReads[index]->state == ASYNCREAD_QUEUED ) ? asyncReads[index] : NULL;
+		if ( read ) {
+			read->state = ASYNCREAD_READING;
+		}
+		Sys_LeaveCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+
+		if ( read ) {
+			bool ok = PerformAsyncRead( read );
+			Sys_EnterCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+			read->state = ok ? ASYNCREAD_DONE : ASYNCREAD_FAILED;
+			Sys_LeaveCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+		}
+
+		if ( CheckAsyncRead( handle, &buf, &length, timestamp ) ) {
+			break;
+		}
+		Sys_Sleep( 0 );
+	}
+
+	if ( buffer ) {
+		*buffer = buf;
+	} else if ( buf ) {
+		FreeFile( buf );
+	}
+	return length;
+}
+
+/*
+=================
+idFileSystemLocal::CancelAsyncRead
+=================
+*/
+void idFileSystemLocal::CancelAsyncRead( int handle ) {
+	void *	buf;
+
+	while( 1 ) {
+		Sys_EnterCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+		int index = FindAsyncRead( handle );
+		if ( index < 0 ) {
+			Sys_LeaveCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+			return;
+		}
+		if ( asyncReads[index]->state != ASYNCREAD_READING ) {
+			// not in the hands of an I/O thread, drop it as it is
+			asyncReads[index]->state = ASYNCREAD_DONE;
+			FinishAsyncRead( index, &buf, NULL );
+			Sys_LeaveCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+			FreeFile( buf );
+			return;
+		}
+		Sys_LeaveCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+		Sys_Sleep( 0 );
+	}
+}
+
+/*
+=================
+idFileSystemLocal::ServiceAsyncReads
+=================
+*/
+void idFileSystemLocal::ServiceAsyncReads( void ) {
+	idList<int>	finished;
+	void *		buf;
+	int			length;
+
+	if ( !asyncReads.Num() ) {
+		return;
+	}
+
+	Sys_EnterCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+	for ( int i = 0; i < asyncReads.Num(); i++ ) {
+		if ( asyncReads[i]->callback && asyncReads[i]->state >= ASYNCREAD_DONE ) {
+			finished.Append( asyncReads[i]->handle );
+		}
+	}
+	Sys_LeaveCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+
+	// the callbacks may issue or cancel reads, so they run without the lock
+	for ( int i = 0; i < finished.Num(); i++ ) {
+		Sys_EnterCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+		int index = FindAsyncRead( finished[i] );
+		if ( index < 0 ) {
+			Sys_LeaveCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+			continue;
+		}
+		asyncReadCallback_t callback = asyncReads[index]->callback;
+		void *data = asyncReads[index]->data;
+		length = FinishAsyncRead( index, &buf, NULL );
+		Sys_LeaveCriticalSection( CRITICAL_SECTION_FS_ASYNC );
+
+		callback( finished[i], buf, length, data );
+		if ( buf ) {
+			FreeFile( buf );
+		}
+	}
+}
+
 /*
 =================
 idFileSystemLocal::PerformingCopyFiles
@@ -3607,7 +4773,7 @@ pack_t *idFileSystemLocal::FindPakForFileChecksum( const char *relativePath, int
 			pak = search->pack;
 			for ( pakFile = pak->hashTable[ hash ]; pakFile; pakFile = pakFile->next ) {
 				if ( !FilenameCompare( pakFile->name, relativePath ) ) {
-					idFile_InZip *file = ReadFileFromZip( pak, pakFile, relativePath );
+					idFile *file = ReadFileFromZip( pak, pakFile, relativePath );
 					if ( findChecksum == GetFileChecksum( file ) ) {
 						if ( fs_debug.GetBool() ) {
 							common->Printf( "found '%s' with checksum 0x%x in pak '%s'\n", relativePath, findChecksum, pak->pakFilename.c_str() );
@@ -127,6 +127,17 @@ struct backgroundDownload_t {
 	volatile bool		completed;
 };
 
+// priorities of asynchronous reads, higher ones are served first
+typedef enum {
+	ASYNCREAD_LOW,
+	ASYNCREAD_NORMAL,
+	ASYNCREAD_HIGH
+} asyncReadPriority_t;
+
+// called from idFileSystem::ServiceAsyncReads on the main thread, buffer is NULL and length -1 if the read failed
+// the buffer is freed when the callback returns
+typedef void (*asyncReadCallback_t)( int handle, void *buffer, int length, void *data );
+
 // file list for directory listings
 class idFileList {
 	friend class idFileSystemLocal;
@@ -196,6 +207,9 @@ public:
 	virtual void			CreateOSPath( const char *OSPath ) = 0;
 							// Returns true if a file is in a pak file.
 	virtual bool			FileIsInPAK( const char *relativePath ) = 0;
+							// Finds where the bytes of a file live on disk: the OS file holding it, and the offset
+							// and length of its (possibly compressed) data in there. Returns false if not found.
+	virtual bool			GetFileLocation( const char *relativePath, idStr &osPath, int &offset, int &length ) = 0;
 							// Returns a space separated string containing the checksums of all referenced pak files.
 							// will call SetPureServerChecksums internally to restrict itself
 	virtual void			UpdatePureServerChecksums( void ) = 0;
@@ -225,6 +239,12 @@ public:
 	virtual int				ReadFile( const char *relativePath, void **buffer, ID_TIME_T *timestamp = NULL ) = 0;
 							// Frees the memory allocated by ReadFile.
 	virtual void			FreeFile( void *buffer ) = 0;
+							// Reads a complete file like ReadFile, but a stored file in a memory mapped pak
+							// is returned in place without a copy. No 0 byte is appended.
+							// The buffer is valid until FreeFileMapped or a file system restart.
+	virtual int				ReadFileMapped( const char *relativePath, const void **buffer, ID_TIME_T *timestamp = NULL ) = 0;
+							// Releases a buffer returned by ReadFileMapped.
+	virtual void			FreeFileMapped( const void *buffer ) = 0;
 							// Writes a complete file, will create any needed subdirectories.
 							// Returns the length of the file, or -1 on failure.
 	virtual int				WriteFile( const char *relativePath, const void *buffer, int size, const char *basePath = "fs_savepath" ) = 0;
@@ -246,6 +266,19 @@ public:
 	virtual void			CloseFile( idFile *f ) = 0;
 							// Returns immediately, performing the read from a background thread.
 	virtual void			BackgroundDownload( backgroundDownload_t *bgl ) = 0;
+							// Queues a complete file read for the asynchronous I/O threads, which also inflate pak entries.
+							// Returns a handle, or -1 if the file does not exist. Requests of equal priority are served in order.
+							// With a callback the result is delivered by ServiceAsyncReads, otherwise poll or wait on the handle.
+	virtual int				ReadFileAsync( const char *relativePath, asyncReadPriority_t priority = ASYNCREAD_NORMAL, asyncReadCallback_t callback = NULL, void *data = NULL ) = 0;
+							// Returns true once the read has finished and releases the handle. The buffer and timestamp
+							// work as with ReadFile, the buffer has to be freed with FreeFile.
+	virtual bool			CheckAsyncRead( int handle, void **buffer, int *length, ID_TIME_T *timestamp = NULL ) = 0;
+							// Blocks until the read has finished and releases the handle. Returns the length or -1.
+	virtual int				WaitAsyncRead( int handle, void **buffer, ID_TIME_T *timestamp = NULL ) = 0;
+							// Drops a request, waiting for it if an I/O thread is already reading it.
+	virtual void			CancelAsyncRead( int handle ) = 0;
+							// Runs the callbacks of finished requests, called from the main thread.
+	virtual void			ServiceAsyncReads( void ) = 0;
 							// resets the bytes read counter
 	virtual void			ResetReadCount( void ) = 0;
 							// retrieves the current read count
@@ -0,0 +1,485 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "sys/platform.h"
+#include "idlib/Lexer.h"
+#include "framework/Common.h"
+#include "framework/CVarSystem.h"
+#include "framework/DeclManager.h"
+#include "framework/FileSystem.h"
+#include "framework/Session.h"
+#include "renderer/Image.h"
+#include "renderer/ModelManager.h"
+
+#include "framework/ResourceManifest.h"
+
+idCVar idResourceManifest::com_recordManifest( "com_recordManifest", "1", CVAR_SYSTEM | CVAR_BOOL, "record the resources referenced by a map to maps/<name>.manifest" );
+idCVar idResourceManifest::com_useManifest( "com_useManifest", "1", CVAR_SYSTEM | CVAR_BOOL | CVAR_ARCHIVE, "prefetch and precache the resources listed in the map manifest at load" );
+idCVar idResourceManifest::com_manifestPrefetchMB( "com_manifestPrefetchMB", "256", CVAR_SYSTEM | CVAR_INTEGER | CVAR_ARCHIVE, "maximum number of megabytes prefetched from the map manifest, 0 disables the prefetch", 0, 4096 );
+
+static const char *manifestKindNames[MANIFEST_NUM_KINDS] = { "decl", "image", "model", "sample" };
+
+static const int MANIFEST_VERSION = 1;
+
+idResourceManifest	resourceManifest;
+
+/*
+================
+idResourceManifest::idResourceManifest
+================
+*/
+idResourceManifest::idResourceManifest( void ) {
+	recording = false;
+	modified = false;
+	memset( prefetchBytes, 0, sizeof( prefetchBytes ) );
+}
+
+/*
+================
+idResourceManifest::Clear
+================
+*/
+void idResourceManifest::Clear( void ) {
+	recording = false;
+	modified = false;
+	fileName.Clear();
+	entries.Clear();
+	entryHash.Clear();
+	prefetchFiles.Clear();
+	prefetchFileHash.Clear();
+	prefetchRanges.Clear();
+	memset( prefetchBytes, 0, sizeof( prefetchBytes ) );
+}
+
+/*
+================
+idResourceManifest::BeginMap
+================
+*/
+void idResourceManifest::BeginMap( const char *fullMapName ) {
+	Clear();
+
+	fileName = fullMapName;
+	fileName.SetFileExtension( ".manifest" );
+
+	if ( com_useManifest.GetBool() ) {
+		Read();
+	}
+	recording = com_recordManifest.GetBool();
+}
+
+/*
+================
+idResourceManifest::EndMap
+================
+*/
+void idResourceManifest::EndMap( void ) {
+	if ( recording && modified ) {
+		Write();
+	}
+	Clear();
+}
+
+/*
+================
+idResourceManifest::Read
+================
+*/
+void idResourceManifest::Read( void ) {
+	idLexer		src( LEXFL_NOSTRINGCONCAT | LEXFL_NOSTRINGESCAPECHARS | LEXFL_ALLOWPATHNAMES | LEXFL_NOERRORS );
+	idToken		token, type, name;
+
+	if ( !src.LoadFile( fileName ) ) {
+		return;
+	}
+
+	if ( !src.ExpectTokenString( "manifestVersion" ) || src.ParseInt() != MANIFEST_VERSION ) {
+		common->Warning( "%s has the wrong version, ignored", fileName.c_str() );
+		return;
+	}
+
+	while ( src.ReadToken( &token ) ) {
+		int kind;
+		for ( kind = 0; kind < MANIFEST_NUM_KINDS; kind++ ) {
+			if ( token == manifestKindNames[kind] ) {
+				break;
+			}
+		}
+		if ( kind == MANIFEST_NUM_KINDS ) {
+			common->Warning( "%s: unknown resource kind '%s' on line %d", fileName.c_str(), token.c_str(), src.GetLineNum() );
+			break;
+		}
+
+		type.Clear();
+		if ( kind == MANIFEST_DECL && !src.ReadTokenOnLine( &type ) ) {
+			break;
+		}
+		if ( !src.ReadTokenOnLine( &name ) ) {
+			break;
+		}
+
+		manifestEntry_t *entry = AddEntry( (manifestKind_t)kind, type, name );
+		if ( kind == MANIFEST_IMAGE && entry ) {
+			for ( int i = 0; i < 5; i++ ) {
+				entry->parms[i] = src.ParseInt();
+			}
+		}
+	}
+
+	// only write the file again when the map references something new
+	modified = false;
+}
+
+/*
+================
+idResourceManifest::Write
+================
+*/
+void idResourceManifest::Write( void ) {
+	idFile *f = fileSystem->OpenFileWrite( fileName );
+	if ( !f ) {
+		common->Warning( "couldn't write %s", fileName.c_str() );
+		return;
+	}
+
+	f->WriteFloatString( "// resources referenced by %s, written at map unload\n", fileName.c_str() );
+	f->WriteFloatString( "manifestVersion %d\n\n", MANIFEST_VERSION );
+
+	for ( int i = 0; i < entries.Num(); i++ ) {
+		const manifestEntry_t &entry = entries[i];
+
+		switch( entry.kind ) {
+			case MANIFEST_DECL:
+				f->WriteFloatString( "decl \"%s\" \"%s\"\n", entry.type.c_str(), entry.name.c_str() );
+				break;
+			case MANIFEST_IMAGE:
+				f->WriteFloatString( "image \"%s\" %d %d %d %d %d\n", entry.name.c_str(),
+									entry.parms[0], entry.parms[1], entry.parms[2], entry.parms[3], entry.parms[4] );
+				break;
+			default:
+				f->WriteFloatString( "%s \"%s\"\n", manifestKindNames[entry.kind], entry.name.c_str() );
+				break;
+		}
+	}
+
+	fileSystem->CloseFile( f );
+
+	common->Printf( "wrote %s with %d resources\n", fileName.c_str(), entries.Num() );
+}
+
+/*
+================
+idResourceManifest::FindEntry
+================
+*/
+int idResourceManifest::FindEntry( manifestKind_t kind, const char *type, const char *name ) const {
+	int key = entryHash.GenerateKey( name, false );
+
+	for ( int i = entryHash.First( key ); i != -1; i = entryHash.Next( i ) ) {
+		const manifestEntry_t &entry = entries[i];
+		if ( entry.kind == kind && entry.name.Icmp( name ) == 0 && entry.type.Icmp( type ) == 0 ) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/*
+================
+idResourceManifest::AddEntry
+
+Returns NULL if the resource is already listed.
+================
+*/
+idResourceManifest::manifestEntry_t *idResourceManifest::AddEntry( manifestKind_t kind, const char *type, const char *name ) {
+	if ( !name[0] || FindEntry( kind, type, name ) != -1 ) {
+		return NULL;
+	}
+
+	manifestEntry_t &entry = entries.Alloc();
+	entry.kind = kind;
+	entry.type = type;
+	entry.name = name;
+	memset( entry.parms, 0, sizeof( entry.parms ) );
+
+	entryHash.Add( entryHash.GenerateKey( name, false ), entries.Num() - 1 );
+	modified = true;
+
+	return &entry;
+}
+
+/*
+================
+idResourceManifest::AddDecl
+================
+*/
+void idResourceManifest::AddDecl( const char *typeName, const char *name ) {
+	AddEntry( MANIFEST_DECL, typeName, name );
+}
+
+/*
+================
+idResourceManifest::AddImage
+================
+*/
+void idResourceManifest::AddImage( const char *name, int filter, bool allowDownSize, int repeat, int depth, int cubeMap ) {
+	manifestEntry_t *entry = AddEntry( MANIFEST_IMAGE, "", name );
+	if ( entry ) {
+		entry->parms[0] = filter;
+		entry->parms[1] = allowDownSize;
+		entry->parms[2] = repeat;
+		entry->parms[3] = depth;
+		entry->parms[4] = cubeMap;
+	}
+}
+
+/*
+================
+idResourceManifest::AddModel
+================
+*/
+void idResourceManifest::AddModel( const char *name ) {
+	// procedural models like the world areas are created by their owners
+	if ( name[0] == '_' ) {
+		return;
+	}
+	AddEntry( MANIFEST_MODEL, "", name );
+}
+
+/*
+================
+idResourceManifest::AddSample
+================
+*/
+void idResourceManifest::AddSample( const char *name ) {
+	AddEntry( MANIFEST_SAMPLE, "", name );
+}
+
+/*
+================
+idResourceManifest::AddPrefetchFile
+================
+*/
+void idResourceManifest::AddPrefetchFile( const char *relativePath, int &totalBytes, int maxBytes ) {
+	idStr			osPath;
+	prefetchRange_t	range;
+
+	if ( totalBytes >= maxBytes ) {
+		return;
+	}
+	if ( !fileSystem->GetFileLocation( relativePath, osPath, range.offset, range.length ) || range.length <= 0 ) {
+		return;
+	}
+
+	// all entries of a pak share the OS file so they end up with the same reader
+	int key = prefetchFileHash.GenerateKey( osPath, true );
+	for ( range.file = prefetchFileHash.First( key ); range.file != -1; range.file = prefetchFileHash.Next( range.file ) ) {
+		if ( prefetchFiles[range.file] == osPath ) {
+			break;
+		}
+	}
+	if ( range.file == -1 ) {
+		range.file = prefetchFiles.Append( osPath );
+		prefetchFileHash.Add( key, range.file );
+	}
+	prefetchRanges.Append( range );
+	totalBytes += range.length;
+}
+
+/*
+================
+idResourceManifest::SortRanges
+================
+*/
+int idResourceManifest::SortRanges( const prefetchRange_t *a, const prefetchRange_t *b ) {
+	if ( a->file != b->file ) {
+		return a->file - b->file;
+	}
+	return a->offset - b->offset;
+}
+
+/*
+================
+idResourceManifest::FindPrefetchRanges
+
+Image names can be image programs, every token that looks like a path is
+tried as a file.  Decls are not listed, they come from the few decl files that
+are parsed at startup.
+================
+*/
+void idResourceManifest::FindPrefetchRanges( void ) {
+	idStr	path;
+	int		totalBytes = 0;
+	int		maxBytes = com_manifestPrefetchMB.GetInteger() * 1024 * 1024;
+
+	prefetchFiles.Clear();
+	prefetchFileHash.Clear();
+	prefetchRanges.Clear();
+	memset( prefetchBytes, 0, sizeof( prefetchBytes ) );
+
+	if ( maxBytes <= 0 ) {
+		return;
+	}
+
+	for ( int i = 0; i < entries.Num(); i++ ) {
+		const manifestEntry_t &entry = entries[i];
+
+		switch( entry.kind ) {
+			case MANIFEST_IMAGE: {
+				idLexer	src( entry.name, entry.name.Length(), "FindPrefetchRanges", LEXFL_NOERRORS | LEXFL_NOWARNINGS | LEXFL_ALLOWPATHNAMES );
+				idToken	token;
+
+				while ( src.ReadToken( &token ) ) {
+					if ( token.Find( '/' ) == -1 ) {
+						continue;
+					}
+					path = token;
+					path.DefaultFileExtension( ".tga" );
+					AddPrefetchFile( path, totalBytes, maxBytes );
+					path = "dds/" + token;
+					path.SetFileExtension( ".dds" );
+					AddPrefetchFile( path, totalBytes, maxBytes );
+				}
+				break;
+			}
+			case MANIFEST_MODEL: {
+				AddPrefetchFile( entry.name, totalBytes, maxBytes );
+
+				// the processed surfaces the model manager caches next to the source
+				idStr extension;
+				entry.name.ExtractFileExtension( extension );
+				path = entry.name;
+				path.SetFileExtension( ".b" + extension );
+				AddPrefetchFile( path, totalBytes, maxBytes );
+				break;
+			}
+			case MANIFEST_SAMPLE:
+				AddPrefetchFile( entry.name, totalBytes, maxBytes );
+				break;
+			default:
+				break;
+		}
+	}
+
+	prefetchRanges.Sort( SortRanges );
+}
+
+/*
+================
+idResourceManifest::Prefetch
+
+Prefetch stage, only uses libc.  Ranges are sorted by file and offset, so every
+file is opened once and pk4 files are read front to back.
+================
+*/
+void idResourceManifest::Prefetch( int part, int numParts ) {
+	byte	buffer[16384];
+	FILE *	f = NULL;
+	int		openFile = -1;
+	int		bytes = 0;
+
+	for ( int i = 0; i < prefetchRanges.Num(); i++ ) {
+		const prefetchRange_t &range = prefetchRanges[i];
+
+		if ( range.file % numParts != part ) {
+			continue;
+		}
+		if ( range.file != openFile ) {
+			if ( f ) {
+				fclose( f );
+			}
+			f = fopen( prefetchFiles[range.file].c_str(), "rb" );
+			openFile = range.file;
+		}
+		if ( !f || fseek( f, range.offset, SEEK_SET ) != 0 ) {
+			continue;
+		}
+		for ( int left = range.length; left > 0; ) {
+			size_t read = fread( buffer, 1, Min( left, (int)sizeof( buffer ) ), f );
+			if ( read == 0 ) {
+				break;
+			}
+			left -= (int)read;
+			bytes += (int)read;
+		}
+	}
+
+	if ( f ) {
+		fclose( f );
+	}
+	prefetchBytes[part] = bytes;
+}
+
+/*
+================
+idResourceManifest::PrefetchedBytes
+================
+*/
+int idResourceManifest::PrefetchedBytes( void ) const {
+	int total = 0;
+	for ( int i = 0; i < MANIFEST_PREFETCH_THREADS; i++ ) {
+		total += prefetchBytes[i];
+	}
+	return total;
+}
+
+/*
+================
+idResourceManifest::Precache
+
+Samples are not loaded here, the sound shaders that reference them are.
+================
+*/
+void idResourceManifest::Precache( void ) {
+	for ( int i = 0; i < entries.Num(); i++ ) {
+		const manifestEntry_t &entry = entries[i];
+
+		switch( entry.kind ) {
+			case MANIFEST_DECL: {
+				declType_t type = declManager->GetDeclTypeFromName( entry.type );
+				if ( type != DECL_MAX_TYPES ) {
+					declManager->FindType( type, entry.name, false );
+				}
+				break;
+			}
+			case MANIFEST_IMAGE:
+				globalImages->ImageFromFile( entry.name, (textureFilter_t)entry.parms[0], entry.parms[1] != 0,
+							(textureRepeat_t)entry.parms[2], (textureDepth_t)entry.parms[3], (cubeFiles_t)entry.parms[4] );
+				break;
+			case MANIFEST_MODEL:
+				renderModelManager->CheckModel( entry.name );
+				break;
+			default:
+				break;
+		}
+
+		if ( ( i & 63 ) == 0 ) {
+			session->PacifierUpdate();
+		}
+	}
+}
@@ -0,0 +1,129 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __RESOURCEMANIFEST_H__
+#define __RESOURCEMANIFEST_H__
+
+#include "idlib/containers/HashIndex.h"
+#include "idlib/containers/StrList.h"
+
+/*
+===============================================================================
+
+	Resource manifest
+
+	Records the decls, images, models and sound samples a map references while
+	it is loaded and played, and writes them to maps/<name>.manifest when the
+	map is unloaded.  The next load of the map reads the file back, prefetches
+	the bytes of every listed file through the OS on prefetch threads and then
+	precaches the resources on the main thread before the game spawns.
+
+	The recorded set only grows, resources that are no longer used by the map
+	are simply not found again on replay.
+
+===============================================================================
+*/
+
+typedef enum {
+	MANIFEST_DECL,
+	MANIFEST_IMAGE,
+	MANIFEST_MODEL,
+	MANIFEST_SAMPLE,
+	MANIFEST_NUM_KINDS
+} manifestKind_t;
+
+const int MANIFEST_PREFETCH_THREADS =	2;
+
+class idResourceManifest {
+public:
+							idResourceManifest( void );
+
+							// Reads the manifest of the map, if any, and starts recording.
+	void					BeginMap( const char *fullMapName );
+							// Stops recording and writes the manifest if anything new was referenced.
+	void					EndMap( void );
+	void					Clear( void );
+
+	bool					IsRecording( void ) const { return recording; }
+	int						Num( void ) const { return entries.Num(); }
+
+	void					AddDecl( const char *typeName, const char *name );
+	void					AddImage( const char *name, int filter, bool allowDownSize, int repeat, int depth, int cubeMap );
+	void					AddModel( const char *name );
+	void					AddSample( const char *name );
+
+							// Looks up where the data of every listed file lives, main thread only.
+	void					FindPrefetchRanges( void );
+							// Reads every numParts'th file, only uses libc so it can run on a prefetch thread.
+	void					Prefetch( int part, int numParts );
+							// Loads the listed resources in the order they were first referenced.
+	void					Precache( void );
+
+	int						NumPrefetchFiles( void ) const { return prefetchFiles.Num(); }
+	int						PrefetchedBytes( void ) const;
+
+private:
+	typedef struct {
+		manifestKind_t		kind;
+		idStr				type;			// decl type name
+		idStr				name;
+		int					parms[5];		// image filter, allowDownSize, repeat, depth and cubeMap
+	} manifestEntry_t;
+
+	typedef struct {
+		int					file;			// index into prefetchFiles
+		int					offset;
+		int					length;
+	} prefetchRange_t;
+
+	bool					recording;
+	bool					modified;
+	idStr					fileName;
+	idList<manifestEntry_t>	entries;
+	idHashIndex				entryHash;
+
+	idStrList				prefetchFiles;	// OS paths, each read by a single part
+	idHashIndex				prefetchFileHash;
+	idList<prefetchRange_t>	prefetchRanges;
+	int						prefetchBytes[MANIFEST_PREFETCH_THREADS];
+
+	static idCVar			com_recordManifest;
+	static idCVar			com_useManifest;
+	static idCVar			com_manifestPrefetchMB;
+
+	void					Read( void );
+	void					Write( void );
+	int						FindEntry( manifestKind_t kind, const char *type, const char *name ) const;
+	manifestEntry_t *		AddEntry( manifestKind_t kind, const char *type, const char *name );
+	void					AddPrefetchFile( const char *relativePath, int &totalBytes, int maxBytes );
+	static int				SortRanges( const prefetchRange_t *a, const prefetchRange_t *b );
+};
+
+extern idResourceManifest	resourceManifest;
+
+#endif /* !__RESOURCEMANIFEST_H__ */
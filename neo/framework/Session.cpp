@@ -33,6 +33,9 @@ If you have questions concerning this license or the applicable additional terms
 #include "framework/Console.h"
 #include "framework/Game.h"
 #include "framework/EventLoop.h"
+#include "framework/DeclEntityDef.h"
+#include "framework/StagedLoader.h"
+#include "framework/ResourceManifest.h"
 #include "renderer/ModelManager.h"
 
 #include "framework/Session_local.h"
@@ -1437,6 +1440,9 @@ void idSessionLocal::UnloadMap() {
 		game->MapShutdown();
 	}
 
+	// everything the map referenced while it was played has been seen now
+	resourceManifest.EndMap();
+
 	if ( cmdDemoFile ) {
 		fileSystem->CloseFile( cmdDemoFile );
 		cmdDemoFile = NULL;
@@ -1521,6 +1527,232 @@ void idSessionLocal::SetBytesNeededForMapLoad( const char *mapName, int bytesNee
 	}
 }
 
+/*
+===============================================================================
+
+	Map load stages
+
+===============================================================================
+*/
+
+const int MAX_PREFETCH_FILES = 16;
+
+typedef struct {
+	idStr		mapString;
+	idStr		fullMapName;
+	bool		reloadingSameMap;
+
+	// filled in on the main thread before the prefetch stage starts
+	int			numPrefetchFiles;
+	char		prefetchFiles[MAX_PREFETCH_FILES][MAX_OSPATH];
+	int			prefetchBytes;
+} mapLoad_t;
+
+static mapLoad_t	mapLoad;
+
+/*
+===============
+MapLoad_FindPrefetchFiles
+
+Notes the OS paths of the loose files that make up the map, including the
+binary versions written after a previous load.  Files in pak files are left
+to the normal reads.
+===============
+*/
+static void MapLoad_FindPrefetchFiles( void ) {
+	idStrList	extensions;
+
+	extensions.Append( ".map" );
+	extensions.Append( ".proc" );
+	extensions.Append( ".bproc" );
+	extensions.Append( ".cm" );
+	extensions.Append( ".bcm" );
+
+	const idDeclEntityDef *aasTypes = static_cast<const idDeclEntityDef *>( declManager->FindType( DECL_ENTITYDEF, "aas_types", false ) );
+	if ( aasTypes ) {
+		for ( const idKeyValue *kv = aasTypes->dict.MatchPrefix( "type" ); kv; kv = aasTypes->dict.MatchPrefix( "type", kv ) ) {
+			extensions.Append( va( ".%s", kv->GetValue().c_str() ) );
+			extensions.Append( va( ".b%s", kv->GetValue().c_str() ) );
+		}
+	}
+
+	mapLoad.numPrefetchFiles = 0;
+	mapLoad.prefetchBytes = 0;
+	for ( int i = 0; i < extensions.Num() && mapLoad.numPrefetchFiles < MAX_PREFETCH_FILES; i++ ) {
+		idFile *f = fileSystem->OpenFileRead( mapLoad.fullMapName + extensions[i] );
+		if ( !f ) {
+			continue;
+		}
+		idStr::Copynz( mapLoad.prefetchFiles[mapLoad.numPrefetchFiles++], f->GetFullPath(), MAX_OSPATH );
+		fileSystem->CloseFile( f );
+	}
+}
+
+/*
+===============
+MapLoad_Prefetch
+
+Prefetch stage that reads the map files ahead of the stages that parse them, so
+they come from the OS file cache.  Only uses libc.
+===============
+*/
+static void MapLoad_Prefetch( void *data ) {
+	byte	buffer[16384];
+	size_t	read;
+
+	for ( int i = 0; i < mapLoad.numPrefetchFiles; i++ ) {
+		// paths inside pak files can't be opened, they are read normally
+		FILE *f = fopen( mapLoad.prefetchFiles[i], "rb" );
+		if ( !f ) {
+			continue;
+		}
+		while ( ( read = fread( buffer, 1, sizeof( buffer ), f ) ) > 0 ) {
+			mapLoad.prefetchBytes += read;
+		}
+		fclose( f );
+	}
+}
+
+/*
+===============
+MapLoad_ManifestPrefetch
+
+Prefetch stage that reads the files listed in the map manifest, data is the part
+of the files to read.
+===============
+*/
+static void MapLoad_ManifestPrefetch( void *data ) {
+	resourceManifest.Prefetch( (int)(intptr_t)data, MANIFEST_PREFETCH_THREADS );
+}
+
+/*
+===============
+MapLoad_Precache
+
+Loads everything the manifest lists before the game spawns, the files have
+been read into the OS cache by the prefetch stages.
+===============
+*/
+static void MapLoad_Precache( void *data ) {
+	resourceManifest.Precache();
+}
+
+/*
+===============
+MapLoad_RenderWorld
+===============
+*/
+static void MapLoad_RenderWorld( void *data ) {
+	// let the renderSystem load all the geometry
+	if ( !sessLocal.rw->InitFromMap( mapLoad.fullMapName ) ) {
+		common->Error( "couldn't load %s", mapLoad.fullMapName.c_str() );
+	}
+}
+
+/*
+===============
+MapLoad_Game
+
+Loads the collision models, the AAS and spawns all entities
+===============
+*/
+static void MapLoad_Game( void *data ) {
+	int i;
+
+	// for the synchronous networking we needed to roll the angles over from
+	// level to level, but now we can just clear everything
+	usercmdGen->InitForNewMap();
+	memset( &sessLocal.mapSpawnData.mapSpawnUsercmd, 0, sizeof( sessLocal.mapSpawnData.mapSpawnUsercmd ) );
+
+	// set the user info
+	for ( i = 0; i < sessLocal.numClients; i++ ) {
+		game->SetUserInfo( i, sessLocal.mapSpawnData.userInfo[i], idAsyncNetwork::client.IsActive(), false );
+		game->SetPersistentPlayerInfo( i, sessLocal.mapSpawnData.persistentPlayerInfo[i] );
+	}
+
+	// load and spawn all other entities ( from a savegame possibly )
+	if ( sessLocal.loadingSaveGame && sessLocal.savegameFile ) {
+		if ( game->InitFromSaveGame( mapLoad.fullMapName + ".map", sessLocal.rw, sessLocal.sw, sessLocal.savegameFile ) == false ) {
+			// If the loadgame failed, restart the map with the player persistent data
+			sessLocal.loadingSaveGame = false;
+			fileSystem->CloseFile( sessLocal.savegameFile );
+			sessLocal.savegameFile = NULL;
+
+			common->Warning( "WARNING: Loading savegame failed, will restart the map with the player persistent data!" );
+
+			game->SetServerInfo( sessLocal.mapSpawnData.serverInfo );
+			game->InitFromNewMap( mapLoad.fullMapName + ".map", sessLocal.rw, sessLocal.sw, idAsyncNetwork::server.IsActive(), idAsyncNetwork::client.IsActive(), Sys_Milliseconds() );
+		}
+	} else {
+		game->SetServerInfo( sessLocal.mapSpawnData.serverInfo );
+		game->InitFromNewMap( mapLoad.fullMapName + ".map", sessLocal.rw, sessLocal.sw, idAsyncNetwork::server.IsActive(), idAsyncNetwork::client.IsActive(), Sys_Milliseconds() );
+	}
+
+	if ( !idAsyncNetwork::IsActive() && !sessLocal.loadingSaveGame ) {
+		// spawn players
+		for ( i = 0; i < sessLocal.numClients; i++ ) {
+			game->SpawnPlayer( i );
+		}
+	}
+}
+
+/*
+===============
+MapLoad_Images
+===============
+*/
+static void MapLoad_Images( void *data ) {
+	if ( !mapLoad.reloadingSameMap ) {
+		renderSystem->EndLevelLoad();
+	}
+}
+
+/*
+===============
+MapLoad_Sounds
+===============
+*/
+static void MapLoad_Sounds( void *data ) {
+	if ( !mapLoad.reloadingSameMap ) {
+		soundSystem->EndLevelLoad( mapLoad.mapString.c_str() );
+	}
+}
+
+/*
+===============
+MapLoad_Decls
+===============
+*/
+static void MapLoad_Decls( void *data ) {
+	if ( !mapLoad.reloadingSameMap ) {
+		declManager->EndLevelLoad();
+		sessLocal.SetBytesNeededForMapLoad( mapLoad.mapString.c_str(), fileSystem->GetReadCount() );
+	}
+}
+
+/*
+===============
+MapLoad_Guis
+===============
+*/
+static void MapLoad_Guis( void *data ) {
+	uiManager->EndLevelLoad();
+}
+
+/*
+===============
+MapLoad_Settle
+===============
+*/
+static void MapLoad_Settle( void *data ) {
+	if ( !idAsyncNetwork::IsActive() && !sessLocal.loadingSaveGame ) {
+		// run a few frames to allow everything to settle
+		for ( int i = 0; i < 10; i++ ) {
+			game->RunFrame( sessLocal.mapSpawnData.mapSpawnUsercmd );
+		}
+	}
+}
+
 /*
 ===============
 idSessionLocal::ExecuteMapChange
@@ -1532,7 +1764,6 @@ Exits with mapSpawned = true
 ===============
 */
 void idSessionLocal::ExecuteMapChange( bool noFadeWipe ) {
-	int		i;
 	bool	reloadingSameMap;
 
 	// close console and remove any prints from the notify lines
@@ -1631,68 +1862,63 @@ void idSessionLocal::ExecuteMapChange( bool noFadeWipe ) {
 	common->Printf( "----- Map Initialization -----\n" );
 	common->Printf( "Map: %s\n", mapString.c_str() );
 
-	// let the renderSystem load all the geometry
-	if ( !rw->InitFromMap( fullMapName ) ) {
-		common->Error( "couldn't load %s", fullMapName.c_str() );
-	}
-
-	// for the synchronous networking we needed to roll the angles over from
-	// level to level, but now we can just clear everything
-	usercmdGen->InitForNewMap();
-	memset( &mapSpawnData.mapSpawnUsercmd, 0, sizeof( mapSpawnData.mapSpawnUsercmd ) );
-
-	// set the user info
-	for ( i = 0; i < numClients; i++ ) {
-		game->SetUserInfo( i, mapSpawnData.userInfo[i], idAsyncNetwork::client.IsActive(), false );
-		game->SetPersistentPlayerInfo( i, mapSpawnData.persistentPlayerInfo[i] );
-	}
-
-	// load and spawn all other entities ( from a savegame possibly )
-	if ( loadingSaveGame && savegameFile ) {
-		if ( game->InitFromSaveGame( fullMapName + ".map", rw, sw, savegameFile ) == false ) {
-			// If the loadgame failed, restart the map with the player persistent data
-			loadingSaveGame = false;
-			fileSystem->CloseFile( savegameFile );
-			savegameFile = NULL;
-
-			common->Warning( "WARNING: Loading savegame failed, will restart the map with the player persistent data!" );
-
-			game->SetServerInfo( mapSpawnData.serverInfo );
-			game->InitFromNewMap( fullMapName + ".map", rw, sw, idAsyncNetwork::server.IsActive(), idAsyncNetwork::client.IsActive(), Sys_Milliseconds() );
-		}
-	} else {
-		game->SetServerInfo( mapSpawnData.serverInfo );
-		game->InitFromNewMap( fullMapName + ".map", rw, sw, idAsyncNetwork::server.IsActive(), idAsyncNetwork::client.IsActive(), Sys_Milliseconds() );
-	}
-
-	if ( !idAsyncNetwork::IsActive() && !loadingSaveGame ) {
-		// spawn players
-		for ( i = 0; i < numClients; i++ ) {
-			game->SpawnPlayer( i );
-		}
-	}
-
-	// actually purge/load the media
-	if ( !reloadingSameMap ) {
-		renderSystem->EndLevelLoad();
-		soundSystem->EndLevelLoad( mapString.c_str() );
-		declManager->EndLevelLoad();
-		SetBytesNeededForMapLoad( mapString.c_str(), fileSystem->GetReadCount() );
+	mapLoad.mapString = mapString;
+	mapLoad.fullMapName = fullMapName;
+	mapLoad.reloadingSameMap = reloadingSameMap;
+	MapLoad_FindPrefetchFiles();
+
+	resourceManifest.BeginMap( fullMapName );
+	resourceManifest.FindPrefetchRanges();
+
+	// the media purge/load has to wait for everything that references media,
+	// the rest only has to follow the order the game expects.
+	// NOTE: the engine heap, decl manager and file system aren't thread safe, so every
+	// stage that parses or creates something runs on the main thread, the prefetch
+	// stages only read files ahead into the OS file cache.
+	idStagedLoader loader;
+	int prefetch = loader.AddStage( "prefetch", MapLoad_Prefetch, NULL, LOADSTAGE_PREFETCH );
+	int world = loader.AddStage( "render world", MapLoad_RenderWorld, NULL );
+	int precache = loader.AddStage( "manifest precache", MapLoad_Precache, NULL );
+	int spawn = loader.AddStage( "game", MapLoad_Game, NULL );
+	int images = loader.AddStage( "images and models", MapLoad_Images, NULL );
+	int sounds = loader.AddStage( "sounds", MapLoad_Sounds, NULL );
+	int decls = loader.AddStage( "decls", MapLoad_Decls, NULL );
+	int guis = loader.AddStage( "guis", MapLoad_Guis, NULL );
+	int settle = loader.AddStage( "settle", MapLoad_Settle, NULL );
+
+	for ( int i = 0; i < MANIFEST_PREFETCH_THREADS; i++ ) {
+		int part = loader.AddStage( "manifest prefetch", MapLoad_ManifestPrefetch, (void *)(intptr_t)i, LOADSTAGE_PREFETCH );
+		loader.AddDependency( precache, part );
+	}
+
+	loader.AddDependency( precache, world );
+	loader.AddDependency( spawn, precache );
+	loader.AddDependency( images, spawn );
+	loader.AddDependency( sounds, spawn );
+	loader.AddDependency( guis, spawn );
+	loader.AddDependency( decls, images );
+	loader.AddDependency( decls, sounds );
+	loader.AddDependency( settle, decls );
+	loader.AddDependency( settle, guis );
+	loader.AddDependency( settle, prefetch );
+
+	loader.Run();
+
+	// same span as before the stages, interactions are timed on their own
+	int	msec = Sys_Milliseconds() - start;
+	loader.PrintTimings( "Map Load Stages" );
+	if ( mapLoad.prefetchBytes ) {
+		common->Printf( "%d kB prefetched from %d files\n", mapLoad.prefetchBytes / 1024, mapLoad.numPrefetchFiles );
 	}
-	uiManager->EndLevelLoad();
-
-	if ( !idAsyncNetwork::IsActive() && !loadingSaveGame ) {
-		// run a few frames to allow everything to settle
-		for ( i = 0; i < 10; i++ ) {
-			game->RunFrame( mapSpawnData.mapSpawnUsercmd );
-		}
+	if ( resourceManifest.NumPrefetchFiles() ) {
+		common->Printf( "%d kB prefetched from %d files listed in the manifest\n", resourceManifest.PrefetchedBytes() / 1024, resourceManifest.NumPrefetchFiles() );
 	}
-
-	int	msec = Sys_Milliseconds() - start;
 	common->Printf( "%6d msec to load %s\n", msec, mapString.c_str() );
 
 	// let the renderSystem generate interactions now that everything is spawned
+	start = Sys_Milliseconds();
 	rw->GenerateAllInteractions();
+	common->Printf( "%6d msec to generate interactions\n", Sys_Milliseconds() - start );
 
 	common->PrintWarnings();
 
@@ -0,0 +1,270 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "sys/platform.h"
+#include "framework/Common.h"
+#include "framework/CVarSystem.h"
+#include "framework/Session.h"
+
+#include "framework/StagedLoader.h"
+
+idCVar idStagedLoader::com_loadPrefetchThreads( "com_loadPrefetchThreads", "2", CVAR_SYSTEM | CVAR_INTEGER | CVAR_ARCHIVE, "number of threads reading files ahead while loading a level, 0 runs the prefetch stages on the main thread", 0, 8, idCmdSystem::ArgCompletion_Integer<0,8> );
+
+/*
+================
+idStagedLoader::idStagedLoader
+================
+*/
+idStagedLoader::idStagedLoader( void ) {
+	Clear();
+}
+
+/*
+================
+idStagedLoader::~idStagedLoader
+================
+*/
+idStagedLoader::~idStagedLoader( void ) {
+	// an error in a main thread stage can leave prefetch threads running
+	for ( int i = 0; i < numStages; i++ ) {
+		if ( stages[i].state == STAGE_RUNNING && stages[i].threadInfo.threadHandle ) {
+			Sys_DestroyThread( stages[i].threadInfo );
+		}
+	}
+}
+
+/*
+================
+idStagedLoader::Clear
+================
+*/
+void idStagedLoader::Clear( void ) {
+	memset( stages, 0, sizeof( stages ) );
+	numStages = 0;
+	runStartTime = 0;
+	runEndTime = 0;
+}
+
+/*
+================
+idStagedLoader::AddStage
+================
+*/
+int idStagedLoader::AddStage( const char *name, loadStageFunc_t function, void *data, loadStageThread_t thread ) {
+	if ( numStages >= MAX_LOAD_STAGES ) {
+		common->Error( "idStagedLoader::AddStage: MAX_LOAD_STAGES hit" );
+	}
+
+	loadStage_t &stage = stages[numStages];
+	memset( &stage, 0, sizeof( stage ) );
+	stage.name = name;
+	stage.function = function;
+	stage.data = data;
+	stage.thread = thread;
+	stage.state = STAGE_WAITING;
+
+	return numStages++;
+}
+
+/*
+================
+idStagedLoader::AddDependency
+================
+*/
+void idStagedLoader::AddDependency( int stage, int dependsOn ) {
+	if ( stage < 0 || stage >= numStages || dependsOn < 0 || dependsOn >= numStages || stage == dependsOn ) {
+		common->Error( "idStagedLoader::AddDependency: bad stage %d -> %d", stage, dependsOn );
+	}
+	stages[stage].dependencies |= 1u << dependsOn;
+}
+
+/*
+================
+idStagedLoader::IsReady
+================
+*/
+bool idStagedLoader::IsReady( const loadStage_t &stage ) const {
+	if ( stage.state != STAGE_WAITING ) {
+		return false;
+	}
+	for ( int i = 0; i < numStages; i++ ) {
+		if ( ( stage.dependencies & ( 1u << i ) ) && stages[i].state != STAGE_DONE ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+================
+idStagedLoader::PrefetchThread
+================
+*/
+int idStagedLoader::PrefetchThread( void *parms ) {
+	loadStage_t *stage = (loadStage_t *)parms;
+
+	stage->function( stage->data );
+
+	Sys_EnterCriticalSection( CRITICAL_SECTION_LOAD_PREFETCH );
+	stage->endTime = Sys_Milliseconds();
+	stage->finished = true;
+	Sys_LeaveCriticalSection( CRITICAL_SECTION_LOAD_PREFETCH );
+
+	return 0;
+}
+
+/*
+================
+idStagedLoader::IsPrefetchFinished
+================
+*/
+bool idStagedLoader::IsPrefetchFinished( const loadStage_t &stage ) const {
+	Sys_EnterCriticalSection( CRITICAL_SECTION_LOAD_PREFETCH );
+	bool finished = stage.finished;
+	Sys_LeaveCriticalSection( CRITICAL_SECTION_LOAD_PREFETCH );
+	return finished;
+}
+
+/*
+================
+idStagedLoader::RunStage
+
+Runs a stage on the main thread
+================
+*/
+void idStagedLoader::RunStage( loadStage_t &stage ) {
+	stage.state = STAGE_RUNNING;
+	stage.startTime = Sys_Milliseconds();
+
+	stage.function( stage.data );
+
+	stage.endTime = Sys_Milliseconds();
+	stage.state = STAGE_DONE;
+
+	// let the loading gui animate before the next stage
+	session->PacifierUpdate();
+}
+
+/*
+================
+idStagedLoader::Run
+
+Prefetch stages are started as soon as they are ready, so they overlap with as
+much main thread work as possible.  When the main thread has nothing to do but
+wait for them, it keeps the loading gui updated.
+================
+*/
+void idStagedLoader::Run( void ) {
+	int		i, numDone, numPrefetching;
+
+	runStartTime = Sys_Milliseconds();
+
+	numDone = 0;
+	numPrefetching = 0;
+	while ( numDone < numStages ) {
+		bool progress = false;
+
+		// start the prefetch threads
+		for ( i = 0; i < numStages; i++ ) {
+			loadStage_t &stage = stages[i];
+			if ( stage.thread != LOADSTAGE_PREFETCH || !IsReady( stage ) ) {
+				continue;
+			}
+			if ( com_loadPrefetchThreads.GetInteger() <= 0 ) {
+				RunStage( stage );
+				numDone++;
+				progress = true;
+				continue;
+			}
+			if ( numPrefetching >= com_loadPrefetchThreads.GetInteger() ) {
+				break;
+			}
+			stage.state = STAGE_RUNNING;
+			stage.finished = false;
+			stage.startTime = Sys_Milliseconds();
+			Sys_CreateThread( PrefetchThread, &stage, stage.threadInfo, stage.name );
+			numPrefetching++;
+			progress = true;
+		}
+
+		// collect the finished prefetch threads
+		for ( i = 0; i < numStages; i++ ) {
+			loadStage_t &stage = stages[i];
+			if ( stage.state == STAGE_RUNNING && stage.thread == LOADSTAGE_PREFETCH && IsPrefetchFinished( stage ) ) {
+				Sys_DestroyThread( stage.threadInfo );
+				stage.state = STAGE_DONE;
+				numPrefetching--;
+				numDone++;
+				progress = true;
+			}
+		}
+
+		// run one main thread stage, then check the prefetch threads again
+		for ( i = 0; i < numStages; i++ ) {
+			loadStage_t &stage = stages[i];
+			if ( stage.thread == LOADSTAGE_MAIN_THREAD && IsReady( stage ) ) {
+				RunStage( stage );
+				numDone++;
+				progress = true;
+				break;
+			}
+		}
+
+		if ( !progress ) {
+			if ( !numPrefetching ) {
+				common->Error( "idStagedLoader::Run: circular stage dependencies" );
+			}
+			session->PacifierUpdate();
+			Sys_Sleep( 5 );
+		}
+	}
+
+	runEndTime = Sys_Milliseconds();
+}
+
+/*
+================
+idStagedLoader::PrintTimings
+================
+*/
+void idStagedLoader::PrintTimings( const char *title ) const {
+	int total = 0;
+
+	common->Printf( "----- %s -----\n", title );
+	common->Printf( "start  msec thread   stage\n" );
+	for ( int i = 0; i < numStages; i++ ) {
+		const loadStage_t &stage = stages[i];
+		if ( stage.state != STAGE_DONE ) {
+			continue;
+		}
+		int msec = stage.endTime - stage.startTime;
+		common->Printf( "%5d %5d %-8s %s\n", stage.startTime - runStartTime, msec, ( stage.thread == LOADSTAGE_PREFETCH ) ? "prefetch" : "main", stage.name );
+		total += msec;
+	}
+	common->Printf( "%5d msec total, %d msec of stage time\n", runEndTime - runStartTime, total );
+}
@@ -0,0 +1,112 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __STAGEDLOADER_H__
+#define __STAGEDLOADER_H__
+
+#include "sys/sys_public.h"
+
+/*
+===============================================================================
+
+	Staged level loader
+
+	Runs the stages of a level load on the main thread in dependency order,
+	keeps the loading gui updated between them and times each of them.
+
+	Prefetch stages run on threads of their own while the main thread loads.
+	The engine heap, the decl manager, the file system and the render and sound
+	systems are not thread safe, so a prefetch stage may only use the OS and
+	libc, which leaves reading files ahead into the OS file cache.
+
+===============================================================================
+*/
+
+typedef void (*loadStageFunc_t)( void *data );
+
+typedef enum {
+	LOADSTAGE_MAIN_THREAD,				// may use any engine system
+	LOADSTAGE_PREFETCH					// runs on its own thread, may only use the OS and libc
+} loadStageThread_t;
+
+const int MAX_LOAD_STAGES =		32;
+
+class idStagedLoader {
+public:
+					idStagedLoader( void );
+					~idStagedLoader( void );
+
+					// Returns the stage number to use for dependencies.
+	int				AddStage( const char *name, loadStageFunc_t function, void *data, loadStageThread_t thread = LOADSTAGE_MAIN_THREAD );
+
+					// The stage will not start before dependsOn has finished.
+	void			AddDependency( int stage, int dependsOn );
+
+					// Runs all stages and returns when the last one has finished.
+	void			Run( void );
+
+					// Prints the start time and duration of every stage of the last run.
+	void			PrintTimings( const char *title ) const;
+
+					// Removes all stages.
+	void			Clear( void );
+
+private:
+	typedef enum {
+		STAGE_WAITING,
+		STAGE_RUNNING,
+		STAGE_DONE
+	} stageState_t;
+
+	typedef struct loadStage_s {
+		const char *		name;
+		loadStageFunc_t		function;
+		void *				data;
+		loadStageThread_t	thread;
+		unsigned int		dependencies;		// bit mask of stage numbers
+		stageState_t		state;
+		unsigned int		startTime;
+		unsigned int		endTime;			// set by a prefetch thread under CRITICAL_SECTION_LOAD_PREFETCH
+		bool				finished;			// set by a prefetch thread under CRITICAL_SECTION_LOAD_PREFETCH
+		xthreadInfo			threadInfo;
+	} loadStage_t;
+
+	loadStage_t		stages[MAX_LOAD_STAGES];
+	int				numStages;
+	unsigned int	runStartTime;
+	unsigned int	runEndTime;
+
+	static idCVar	com_loadPrefetchThreads;
+
+	bool			IsReady( const loadStage_t &stage ) const;
+	void			RunStage( loadStage_t &stage );
+	bool			IsPrefetchFinished( const loadStage_t &stage ) const;
+	static int		PrefetchThread( void *parms );
+};
+
+#endif /* !__STAGEDLOADER_H__ */
@@ -28,6 +28,9 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "sys/platform.h"
 #include "idlib/Timer.h"
+#include "idlib/hashing/CRC32.h"
+#include "framework/FileSystem.h"
+#include "gamesys/SysCvar.h"
 
 #include "Game_local.h"
 
@@ -35,6 +38,11 @@ If you have questions concerning this license or the applicable additional terms
 
 #define MAX_BOUNDS_AREAS	16
 
+// the area PVS is stored in maps/<name>.pvs, the header has the length and
+// timestamp of the .proc and a checksum of the portals it was calculated from
+static const int PVS_CACHE_ID		= ( ('1'<<24)+('S'<<16)+('V'<<8)+'P' );
+static const int PVS_CACHE_VERSION	= 1;
+
 typedef struct pvsPassage_s {
 	byte *				canSee;		// bit set for all portals that can be seen through this passage
 } pvsPassage_t;
@@ -789,6 +797,107 @@ int idPVS::AreaPVSFromPortalPVS( void ) const {
 	return totalVisibleAreas;
 }
 
+/*
+================
+idPVS::PortalChecksum
+
+The PVS only depends on the areas and the portal windings.
+================
+*/
+unsigned int idPVS::PortalChecksum( void ) const {
+	unsigned int crc;
+
+	CRC32_InitChecksum( crc );
+	CRC32_UpdateChecksum( crc, &numAreas, sizeof( numAreas ) );
+	CRC32_UpdateChecksum( crc, &numPortals, sizeof( numPortals ) );
+
+	for ( int i = 0; i < numAreas; i++ ) {
+		int n = gameRenderWorld->NumPortalsInArea( i );
+		for ( int j = 0; j < n; j++ ) {
+			exitPortal_t portal = gameRenderWorld->GetPortal( i, j );
+			int numPoints = portal.w->GetNumPoints();
+
+			CRC32_UpdateChecksum( crc, portal.areas, sizeof( portal.areas ) );
+			CRC32_UpdateChecksum( crc, &numPoints, sizeof( numPoints ) );
+			for ( int k = 0; k < numPoints; k++ ) {
+				CRC32_UpdateChecksum( crc, (*portal.w)[k].ToFloatPtr(), 3 * sizeof( float ) );
+			}
+		}
+	}
+
+	CRC32_FinishChecksum( crc );
+	return crc;
+}
+
+/*
+================
+idPVS::ReadPVSCache
+================
+*/
+bool idPVS::ReadPVSCache( const char *fileName, int procLength, ID_TIME_T procTimeStamp, unsigned int portalCRC ) {
+	int header[8];
+
+	idFile *f = fileSystem->OpenFileRead( fileName );
+	if ( !f ) {
+		return false;
+	}
+
+	int pvsBytes = numAreas * areaVisBytes;
+	if ( f->Length() != (int)sizeof( header ) + pvsBytes ) {
+		fileSystem->CloseFile( f );
+		return false;
+	}
+
+	for ( int i = 0; i < 8; i++ ) {
+		f->ReadInt( header[i] );
+	}
+
+	if ( header[0] != PVS_CACHE_ID || header[1] != PVS_CACHE_VERSION || header[2] != procLength || header[3] != (int)procTimeStamp
+			|| header[4] != (int)portalCRC || header[5] != numAreas || header[6] != numPortals ) {
+		gameLocal.DPrintf( "%s is out of date\n", fileName );
+		fileSystem->CloseFile( f );
+		return false;
+	}
+
+	f->Read( areaPVS, pvsBytes );
+	fileSystem->CloseFile( f );
+
+	if ( header[7] != (int)CRC32_BlockChecksum( areaPVS, pvsBytes ) ) {
+		gameLocal.Warning( "%s is corrupt", fileName );
+		memset( areaPVS, 0xFF, pvsBytes );
+		return false;
+	}
+
+	return true;
+}
+
+/*
+================
+idPVS::WritePVSCache
+================
+*/
+void idPVS::WritePVSCache( const char *fileName, int procLength, ID_TIME_T procTimeStamp, unsigned int portalCRC ) const {
+	int pvsBytes = numAreas * areaVisBytes;
+
+	idFile *f = fileSystem->OpenFileWrite( fileName );
+	if ( !f ) {
+		gameLocal.Warning( "couldn't write %s", fileName );
+		return;
+	}
+
+	f->WriteInt( PVS_CACHE_ID );
+	f->WriteInt( PVS_CACHE_VERSION );
+	f->WriteInt( procLength );
+	f->WriteInt( (int)procTimeStamp );
+	f->WriteInt( (int)portalCRC );
+	f->WriteInt( numAreas );
+	f->WriteInt( numPortals );
+	f->WriteInt( (int)CRC32_BlockChecksum( areaPVS, pvsBytes ) );
+	f->Write( areaPVS, pvsBytes );
+
+	fileSystem->CloseFile( f );
+}
+
 /*
 ================
 idPVS::Init
@@ -796,6 +905,10 @@ idPVS::Init
 */
 void idPVS::Init( void ) {
 	int totalVisibleAreas;
+	int procLength = 0;
+	ID_TIME_T procTimeStamp = 0;
+	unsigned int portalCRC = 0;
+	idStr cacheName;
 
 	Shutdown();
 
@@ -828,21 +941,46 @@ void idPVS::Init( void ) {
 	idTimer timer;
 	timer.Start();
 
-	CreatePVSData();
+	bool cached = false;
+	if ( g_cachePVS.GetBool() && numPortals ) {
+		cacheName = gameLocal.GetMapName();
+		procLength = fileSystem->ReadFile( cacheName.SetFileExtension( "proc" ), NULL, &procTimeStamp );
+		portalCRC = PortalChecksum();
+		cacheName.SetFileExtension( "pvs" );
+		cached = ( procLength > 0 && ReadPVSCache( cacheName, procLength, procTimeStamp, portalCRC ) );
+	}
 
-	FrontPortalPVS();
+	if ( cached ) {
+		totalVisibleAreas = 0;
+		for ( int i = 0; i < numAreas; i++ ) {
+			const byte *pvs = areaPVS + i * areaVisBytes;
+			for ( int j = 0; j < numAreas; j++ ) {
+				if ( pvs[j>>3] & (1 << (j&7)) ) {
+					totalVisibleAreas++;
+				}
+			}
+		}
+	} else {
+		CreatePVSData();
+
+		FrontPortalPVS();
 
-	CopyPortalPVSToMightSee();
+		CopyPortalPVSToMightSee();
 
-	PassagePVS();
+		PassagePVS();
 
-	totalVisibleAreas = AreaPVSFromPortalPVS();
+		totalVisibleAreas = AreaPVSFromPortalPVS();
 
-	DestroyPVSData();
+		DestroyPVSData();
+
+		if ( g_cachePVS.GetBool() && numPortals && procLength > 0 ) {
+			WritePVSCache( cacheName, procLength, procTimeStamp, portalCRC );
+		}
+	}
 
 	timer.Stop();
 
-	gameLocal.Printf( "%5u msec to calculate PVS\n", timer.Milliseconds() );
+	gameLocal.Printf( "%5u msec to %s PVS\n", timer.Milliseconds(), cached ? "load cached" : "calculate" );
 	gameLocal.Printf( "%5d areas\n", numAreas );
 	gameLocal.Printf( "%5d portals\n", numPortals );
 	gameLocal.Printf( "%5d areas visible on average\n", totalVisibleAreas / numAreas );
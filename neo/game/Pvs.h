@@ -126,6 +126,9 @@ private:
 	void				CreatePassages( void ) const;
 	void				DestroyPassages( void ) const;
 	int					AreaPVSFromPortalPVS( void ) const;
+	unsigned int		PortalChecksum( void ) const;
+	bool				ReadPVSCache( const char *fileName, int procLength, ID_TIME_T procTimeStamp, unsigned int portalCRC );
+	void				WritePVSCache( const char *fileName, int procLength, ID_TIME_T procTimeStamp, unsigned int portalCRC ) const;
 	void				GetConnectedAreas( int srcArea, bool *connectedAreas ) const;
 	pvsHandle_t			AllocCurrentPVS( unsigned int h ) const;
 };
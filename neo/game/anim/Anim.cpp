@@ -29,7 +29,10 @@ If you have questions concerning this license or the applicable additional terms
 #include "sys/platform.h"
 #include "idlib/geometry/JointTransform.h"
 #include "idlib/math/Quat.h"
+#include "idlib/hashing/CRC32.h"
+#include "framework/FileSystem.h"
 
+#include "gamesys/SysCvar.h"
 #include "Game_local.h"
 
 #include "anim/Anim.h"
@@ -82,6 +85,9 @@ void idMD5Anim::Free( void ) {
 	jointInfo.Clear();
 	bounds.Clear();
 	componentFrames.Clear();
+	quantizedFrames.Clear();
+	componentScale.Clear();
+	componentBias.Clear();
 }
 
 /*
@@ -150,6 +156,7 @@ idMD5Anim::Allocated
 */
 size_t idMD5Anim::Allocated( void ) const {
 	size_t	size = bounds.Allocated() + jointInfo.Allocated() + componentFrames.Allocated() + name.Allocated();
+	size += quantizedFrames.Allocated() + componentScale.Allocated() + componentBias.Allocated();
 	return size;
 }
 
@@ -164,6 +171,13 @@ bool idMD5Anim::LoadAnim( const char *filename ) {
 	idToken	token;
 	int		i, j;
 	int		num;
+	int		sourceLength;
+	ID_TIME_T	sourceTimeStamp;
+
+	sourceLength = fileSystem->ReadFile( filename, NULL, &sourceTimeStamp );
+	if ( sourceLength > 0 && LoadBinaryAnim( filename, sourceLength, sourceTimeStamp ) ) {
+		return true;
+	}
 
 	if ( !parser.LoadFile( filename ) ) {
 		return false;
@@ -326,10 +340,317 @@ bool idMD5Anim::LoadAnim( const char *filename ) {
 	// we don't count last frame because it would cause a 1 frame pause at the end
 	animLength = ( ( numFrames - 1 ) * 1000 + frameRate - 1 ) / frameRate;
 
+	Quantize();
+
+	WriteBinaryAnim( sourceLength, sourceTimeStamp );
+
 	// done
 	return true;
 }
 
+/*
+====================
+idMD5Anim::GetFrameComponents
+
+Returns the components of a frame starting at firstComponent, quantized
+anims decode up to num components into the buffer.
+====================
+*/
+const float *idMD5Anim::GetFrameComponents( int framenum, int firstComponent, int num, float *buffer ) const {
+	if ( !quantizedFrames.Num() ) {
+		return &componentFrames[ framenum * numAnimatedComponents + firstComponent ];
+	}
+
+	num = Min( num, numAnimatedComponents - firstComponent );
+	SIMDProcessor->DequantizeShorts( buffer, &quantizedFrames[ framenum * numAnimatedComponents + firstComponent ],
+										&componentScale[ firstComponent ], &componentBias[ firstComponent ], num );
+	return buffer;
+}
+
+/*
+====================
+idMD5Anim::Quantize
+
+Replaces the float components with 16 bit values scaled to the range of
+each component over all frames.  The anim stays in floats if any decoded
+value is further from the original than g_quantizeAnimsError allows.
+====================
+*/
+bool idMD5Anim::Quantize( void ) {
+	int			i, j, c;
+	float		maxError[2];
+	float		*tolerance;
+
+	if ( !g_quantizeAnims.GetBool() || !numAnimatedComponents ) {
+		return false;
+	}
+
+	maxError[0] = maxError[1] = 0.0f;
+	sscanf( g_quantizeAnimsError.GetString(), "%f %f", &maxError[0], &maxError[1] );
+
+	// translation and rotation components have their own error bound
+	tolerance = (float *)_alloca16( numAnimatedComponents * sizeof( tolerance[0] ) );
+	for ( i = 0; i < numAnimatedComponents; i++ ) {
+		tolerance[i] = maxError[1];
+	}
+	for ( i = 0; i < numJoints; i++ ) {
+		c = jointInfo[i].firstComponent;
+		for ( j = 0; j < 6; j++ ) {
+			if ( jointInfo[i].animBits & ( 1 << j ) ) {
+				tolerance[c++] = ( j < 3 ) ? maxError[0] : maxError[1];
+			}
+		}
+	}
+
+	componentScale.SetGranularity( 1 );
+	componentScale.SetNum( numAnimatedComponents );
+	componentBias.SetGranularity( 1 );
+	componentBias.SetNum( numAnimatedComponents );
+	quantizedFrames.SetGranularity( 1 );
+	quantizedFrames.SetNum( numAnimatedComponents * numFrames );
+
+	for ( c = 0; c < numAnimatedComponents; c++ ) {
+		float minValue = idMath::INFINITY;
+		float maxValue = -idMath::INFINITY;
+		for ( i = 0; i < numFrames; i++ ) {
+			float v = componentFrames[ i * numAnimatedComponents + c ];
+			minValue = Min( minValue, v );
+			maxValue = Max( maxValue, v );
+		}
+
+		componentBias[c] = minValue;
+		componentScale[c] = ( maxValue - minValue ) / 65535.0f;
+
+		for ( i = 0; i < numFrames; i++ ) {
+			float v = componentFrames[ i * numAnimatedComponents + c ];
+			int q = ( componentScale[c] > 0.0f ) ? idMath::Ftoi( ( v - minValue ) / componentScale[c] + 0.5f ) : 0;
+			q = idMath::ClampInt( 0, 65535, q );
+			quantizedFrames[ i * numAnimatedComponents + c ] = q;
+
+			// check the round trip through the same decode as GetFrameComponents
+			if ( idMath::Fabs( componentBias[c] + componentScale[c] * q - v ) > tolerance[c] ) {
+				quantizedFrames.Clear();
+				componentScale.Clear();
+				componentBias.Clear();
+				return false;
+			}
+		}
+	}
+
+	componentFrames.Clear();
+
+	return true;
+}
+
+/*
+====================
+Binary anims
+
+The processed anim is written to <name>.bmd5anim after the first load of
+the text file.  The header records the length and timestamp of the source
+file and the quantization settings.
+====================
+*/
+
+#define BINARY_ANIM_ID			( ( 'M' << 24 ) | ( 'N' << 16 ) | ( 'A' << 8 ) | 'B' )
+#define BINARY_ANIM_VERSION		1
+
+typedef struct {
+	int						ident;
+	int						version;
+	int						sourceLength;
+	int						sourceTimeStamp;
+	int						structSizes[2];
+	int						quantize;
+	char					quantizeError[32];
+	int						payloadLength;
+	unsigned int			payloadCRC;
+} binaryAnimHeader_t;
+
+/*
+====================
+AnimBinaryName
+====================
+*/
+static idStr AnimBinaryName( const char *filename ) {
+	idStr binaryName = filename;
+	binaryName.SetFileExtension( "b" MD5_ANIM_EXT );
+	return binaryName;
+}
+
+/*
+====================
+AnimSetBinaryHeader
+====================
+*/
+static void AnimSetBinaryHeader( binaryAnimHeader_t &header, int sourceLength, ID_TIME_T sourceTimeStamp ) {
+	memset( &header, 0, sizeof( header ) );
+	header.ident = BINARY_ANIM_ID;
+	header.version = BINARY_ANIM_VERSION;
+	header.sourceLength = sourceLength;
+	header.sourceTimeStamp = (int)sourceTimeStamp;
+	header.structSizes[0] = sizeof( idBounds );
+	header.structSizes[1] = sizeof( idJointQuat );
+	header.quantize = g_quantizeAnims.GetBool();
+	idStr::Copynz( header.quantizeError, g_quantizeAnimsError.GetString(), sizeof( header.quantizeError ) );
+}
+
+/*
+====================
+AnimReadBinaryList
+====================
+*/
+template< class type >
+static bool AnimReadBinaryList( idFile *f, idList<type> &list, int num ) {
+	if ( num < 0 || num > ( f->Length() - f->Tell() ) / (int)sizeof( type ) ) {
+		return false;
+	}
+	list.SetGranularity( 1 );
+	list.SetNum( num );
+	f->Read( list.Ptr(), num * sizeof( type ) );
+	return true;
+}
+
+/*
+====================
+idMD5Anim::LoadBinaryAnim
+====================
+*/
+bool idMD5Anim::LoadBinaryAnim( const char *filename, int sourceLength, ID_TIME_T sourceTimeStamp ) {
+	binaryAnimHeader_t	header, expected;
+	void *				buffer;
+	int					i, length, quantized;
+	idStr				jointName;
+	bool				ok;
+
+	if ( !g_binaryAnims.GetBool() ) {
+		return false;
+	}
+
+	length = fileSystem->ReadFile( AnimBinaryName( filename ), &buffer );
+	if ( !buffer ) {
+		return false;
+	}
+	if ( length < (int)sizeof( header ) ) {
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
+	memcpy( &header, buffer, sizeof( header ) );
+	AnimSetBinaryHeader( expected, sourceLength, sourceTimeStamp );
+	expected.payloadLength = length - sizeof( header );
+	expected.payloadCRC = header.payloadCRC;
+
+	const char *payload = (const char *)buffer + sizeof( header );
+	if ( memcmp( &header, &expected, sizeof( header ) ) != 0 || CRC32_BlockChecksum( payload, expected.payloadLength ) != header.payloadCRC ) {
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
+	Free();
+
+	name = filename;
+
+	idFile_Memory f( name, payload, expected.payloadLength );
+
+	f.ReadInt( numFrames );
+	f.ReadInt( frameRate );
+	f.ReadInt( numJoints );
+	f.ReadInt( numAnimatedComponents );
+	f.ReadInt( animLength );
+	f.ReadVec3( totaldelta );
+
+	ok = ( numFrames > 0 && numJoints > 0 && numJoints <= f.Length() && numAnimatedComponents >= 0 && numAnimatedComponents <= numJoints * 6 );
+	if ( ok ) {
+		jointInfo.SetGranularity( 1 );
+		jointInfo.SetNum( numJoints );
+		for ( i = 0; i < numJoints; i++ ) {
+			f.ReadString( jointName );
+			jointInfo[ i ].nameIndex = animationLib.JointIndex( jointName );
+			f.ReadInt( jointInfo[ i ].parentNum );
+			f.ReadInt( jointInfo[ i ].animBits );
+			f.ReadInt( jointInfo[ i ].firstComponent );
+		}
+		ok = AnimReadBinaryList( &f, bounds, numFrames ) && AnimReadBinaryList( &f, baseFrame, numJoints );
+	}
+	if ( ok ) {
+		f.ReadInt( quantized );
+		if ( quantized ) {
+			ok = AnimReadBinaryList( &f, componentScale, numAnimatedComponents )
+					&& AnimReadBinaryList( &f, componentBias, numAnimatedComponents )
+						&& AnimReadBinaryList( &f, quantizedFrames, numAnimatedComponents * numFrames );
+		} else {
+			ok = AnimReadBinaryList( &f, componentFrames, numAnimatedComponents * numFrames );
+		}
+	}
+
+	fileSystem->FreeFile( buffer );
+
+	if ( !ok ) {
+		Free();
+		return false;
+	}
+
+	return true;
+}
+
+/*
+====================
+idMD5Anim::WriteBinaryAnim
+====================
+*/
+void idMD5Anim::WriteBinaryAnim( int sourceLength, ID_TIME_T sourceTimeStamp ) const {
+	binaryAnimHeader_t	header;
+	int					i;
+
+	if ( !g_binaryAnims.GetBool() || sourceLength <= 0 ) {
+		return;
+	}
+
+	idFile_Memory payload( name );
+
+	payload.WriteInt( numFrames );
+	payload.WriteInt( frameRate );
+	payload.WriteInt( numJoints );
+	payload.WriteInt( numAnimatedComponents );
+	payload.WriteInt( animLength );
+	payload.WriteVec3( totaldelta );
+
+	for ( i = 0; i < numJoints; i++ ) {
+		payload.WriteString( animationLib.JointName( jointInfo[ i ].nameIndex ) );
+		payload.WriteInt( jointInfo[ i ].parentNum );
+		payload.WriteInt( jointInfo[ i ].animBits );
+		payload.WriteInt( jointInfo[ i ].firstComponent );
+	}
+	payload.Write( bounds.Ptr(), bounds.Num() * sizeof( bounds[0] ) );
+	payload.Write( baseFrame.Ptr(), baseFrame.Num() * sizeof( baseFrame[0] ) );
+
+	payload.WriteInt( quantizedFrames.Num() != 0 );
+	if ( quantizedFrames.Num() ) {
+		payload.Write( componentScale.Ptr(), componentScale.Num() * sizeof( componentScale[0] ) );
+		payload.Write( componentBias.Ptr(), componentBias.Num() * sizeof( componentBias[0] ) );
+		payload.Write( quantizedFrames.Ptr(), quantizedFrames.Num() * sizeof( quantizedFrames[0] ) );
+	} else {
+		payload.Write( componentFrames.Ptr(), componentFrames.Num() * sizeof( componentFrames[0] ) );
+	}
+
+	idStr binaryName = AnimBinaryName( name );
+	idFile *f = fileSystem->OpenFileWrite( binaryName );
+	if ( !f ) {
+		gameLocal.Warning( "couldn't write %s", binaryName.c_str() );
+		return;
+	}
+
+	AnimSetBinaryHeader( header, sourceLength, sourceTimeStamp );
+	header.payloadLength = payload.Length();
+	header.payloadCRC = CRC32_BlockChecksum( payload.GetDataPtr(), payload.Length() );
+
+	f->Write( &header, sizeof( header ) );
+	f->Write( payload.GetDataPtr(), payload.Length() );
+
+	fileSystem->CloseFile( f );
+}
+
 /*
 ====================
 idMD5Anim::IncreaseRefs
@@ -445,8 +766,9 @@ void idMD5Anim::GetOrigin( idVec3 &offset, int time, int cyclecount ) const {
 
 	ConvertTimeToFrame( time, cyclecount, frame );
 
-	const float *componentPtr1 = &componentFrames[ numAnimatedComponents * frame.frame1 + jointInfo[ 0 ].firstComponent ];
-	const float *componentPtr2 = &componentFrames[ numAnimatedComponents * frame.frame2 + jointInfo[ 0 ].firstComponent ];
+	float buffer1[3], buffer2[3];
+	const float *componentPtr1 = GetFrameComponents( frame.frame1, jointInfo[ 0 ].firstComponent, 3, buffer1 );
+	const float *componentPtr2 = GetFrameComponents( frame.frame2, jointInfo[ 0 ].firstComponent, 3, buffer2 );
 
 	if ( jointInfo[ 0 ].animBits & ANIM_TX ) {
 		offset.x = *componentPtr1 * frame.frontlerp + *componentPtr2 * frame.backlerp;
@@ -487,8 +809,9 @@ void idMD5Anim::GetOriginRotation( idQuat &rotation, int time, int cyclecount )
 
 	ConvertTimeToFrame( time, cyclecount, frame );
 
-	const float	*jointframe1 = &componentFrames[ numAnimatedComponents * frame.frame1 + jointInfo[ 0 ].firstComponent ];
-	const float	*jointframe2 = &componentFrames[ numAnimatedComponents * frame.frame2 + jointInfo[ 0 ].firstComponent ];
+	float		buffer1[6], buffer2[6];
+	const float	*jointframe1 = GetFrameComponents( frame.frame1, jointInfo[ 0 ].firstComponent, 6, buffer1 );
+	const float	*jointframe2 = GetFrameComponents( frame.frame2, jointInfo[ 0 ].firstComponent, 6, buffer2 );
 
 	if ( animBits & ANIM_TX ) {
 		jointframe1++;
@@ -601,8 +924,9 @@ void idMD5Anim::GetBounds( idBounds &bnds, int time, int cyclecount ) const {
 	// origin position
 	offset = baseFrame[ 0 ].t;
 	if ( jointInfo[ 0 ].animBits & ( ANIM_TX | ANIM_TY | ANIM_TZ ) ) {
-		const float *componentPtr1 = &componentFrames[ numAnimatedComponents * frame.frame1 + jointInfo[ 0 ].firstComponent ];
-		const float *componentPtr2 = &componentFrames[ numAnimatedComponents * frame.frame2 + jointInfo[ 0 ].firstComponent ];
+		float buffer1[3], buffer2[3];
+		const float *componentPtr1 = GetFrameComponents( frame.frame1, jointInfo[ 0 ].firstComponent, 3, buffer1 );
+		const float *componentPtr2 = GetFrameComponents( frame.frame2, jointInfo[ 0 ].firstComponent, 3, buffer2 );
 
 		if ( jointInfo[ 0 ].animBits & ANIM_TX ) {
 			offset.x = *componentPtr1 * frame.frontlerp + *componentPtr2 * frame.backlerp;
@@ -655,8 +979,9 @@ void idMD5Anim::GetInterpolatedFrame( frameBlend_t &frame, idJointQuat *joints,
 	lerpIndex = (int *)_alloca16( baseFrame.Num() * sizeof( lerpIndex[ 0 ] ) );
 	numLerpJoints = 0;
 
-	frame1 = &componentFrames[ frame.frame1 * numAnimatedComponents ];
-	frame2 = &componentFrames[ frame.frame2 * numAnimatedComponents ];
+	// quantized anims decode both frames with SIMD
+	frame1 = GetFrameComponents( frame.frame1, 0, numAnimatedComponents, (float *)_alloca16( numAnimatedComponents * sizeof( float ) ) );
+	frame2 = GetFrameComponents( frame.frame2, 0, numAnimatedComponents, (float *)_alloca16( numAnimatedComponents * sizeof( float ) ) );
 
 	for ( i = 0; i < numIndexes; i++ ) {
 		int j = index[i];
@@ -836,7 +1161,7 @@ void idMD5Anim::GetSingleFrame( int framenum, idJointQuat *joints, const int *in
 		return;
 	}
 
-	frame = &componentFrames[ framenum * numAnimatedComponents ];
+	frame = GetFrameComponents( framenum, 0, numAnimatedComponents, (float *)_alloca16( numAnimatedComponents * sizeof( float ) ) );
 
 	for ( i = 0; i < numIndexes; i++ ) {
 		int j = index[i];
@@ -88,8 +88,11 @@ public:
 
 class idSaveGame;
 class idRestoreGame;
+class idEventHeap;
 
 class idEvent {
+	friend class idEventHeap;
+
 private:
 	const idEventDef			*eventdef;
 	byte						*data;
@@ -97,7 +100,11 @@ private:
 	idClass						*object;
 	const idTypeInfo			*typeinfo;
 
-	idLinkList<idEvent>			eventNode;
+	idLinkList<idEvent>			eventNode;			// free list
+	idLinkList<idEvent>			objectNode;			// pending events hashed by object, for CancelEvents
+	idEventHeap				*queue;				// queue the event is pending in, or NULL
+	int							queueIndex;			// position in the queue's heap
+	unsigned int				sequence;			// orders events posted for the same time
 
 	static idDynamicBlockAlloc<byte, 16 * 1024, 256> eventDataAllocator;
 
@@ -113,7 +113,11 @@ idCVar g_skipFX(					"g_skipFX",					"0",			CVAR_GAME | CVAR_BOOL, "" );
 idCVar g_skipParticles(				"g_skipParticles",			"0",			CVAR_GAME | CVAR_BOOL, "" );
 
 idCVar g_disasm(					"g_disasm",					"0",			CVAR_GAME | CVAR_BOOL, "disassemble script into base/script/disasm.txt on the local drive when script is compiled" );
+idCVar g_scriptCache(				"g_scriptCache",			"1",			CVAR_GAME | CVAR_BOOL, "load the compiled default script from a binary file written after the first compile, as long as none of its source files changed" );
 idCVar g_debugBounds(				"g_debugBounds",			"0",			CVAR_GAME | CVAR_BOOL, "checks for models with bounds > 2048" );
+idCVar g_binaryAnims(				"g_binaryAnims",			"1",			CVAR_GAME | CVAR_BOOL, "load animations from binary files written after the first load of the md5anim" );
+idCVar g_quantizeAnims(				"g_quantizeAnims",			"1",			CVAR_GAME | CVAR_BOOL, "store animation components as 16 bit values when the round-trip error stays within g_quantizeAnimsError" );
+idCVar g_quantizeAnimsError(		"g_quantizeAnimsError",		"0.01 0.0005",	CVAR_GAME, "maximum round-trip error of quantized translation and rotation components" );
 idCVar g_debugAnim(					"g_debugAnim",				"-1",			CVAR_GAME | CVAR_INTEGER, "displays information on which animations are playing on the specified entity number.  set to -1 to disable." );
 idCVar g_debugMove(					"g_debugMove",				"0",			CVAR_GAME | CVAR_BOOL, "" );
 idCVar g_debugDamage(				"g_debugDamage",			"0",			CVAR_GAME | CVAR_BOOL, "" );
@@ -310,6 +314,8 @@ idCVar aas_randomPullPlayer(		"aas_randomPullPlayer",		"0",			CVAR_GAME | CVAR_B
 idCVar aas_goalArea(				"aas_goalArea",				"0",			CVAR_GAME | CVAR_INTEGER, "" );
 idCVar aas_showPushIntoArea(		"aas_showPushIntoArea",		"0",			CVAR_GAME | CVAR_BOOL, "" );
 
+idCVar g_cachePVS(					"g_cachePVS",				"1",			CVAR_GAME | CVAR_BOOL, "keep the PVS of a map in maps/<name>.pvs and reuse it while the .proc file is unchanged" );
+
 idCVar g_password(					"g_password",				"",				CVAR_GAME | CVAR_ARCHIVE, "game password" );
 idCVar password(					"password",					"",				CVAR_GAME | CVAR_NOCHEAT, "client password used when connecting" );
 
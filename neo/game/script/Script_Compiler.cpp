@@ -2612,10 +2612,11 @@ void idCompiler::ParseNamespace( idVarDef *newScope ) {
 ============
 idCompiler::CompileFile
 
-compiles the 0 terminated text, adding definitions to the program structure
+compiles the 0 terminated text, adding definitions to the program structure.
+The names of all files pulled in through #include are added to includes.
 ============
 */
-void idCompiler::CompileFile( const char *text, const char *filename, bool toConsole ) {
+void idCompiler::CompileFile( const char *text, const char *filename, bool toConsole, idStrList *includes ) {
 	idTimer compile_time;
 	bool error;
 
@@ -2636,6 +2637,7 @@ void idCompiler::CompileFile( const char *text, const char *filename, bool toCon
 	memset( &immediate, 0, sizeof( immediate ) );
 
 	parser.SetFlags( LEXFL_ALLOWMULTICHARLITERALS );
+	parser.SetIncludeList( includes );
 	parser.LoadMemory( text, strlen( text ), filename );
 	parserPtr = &parser;
 
@@ -2682,11 +2684,13 @@ void idCompiler::CompileFile( const char *text, const char *filename, bool toCon
 		}
 
 		parser.FreeSource();
+		parser.SetIncludeList( NULL );
 
 		throw idCompileError( error );
 	}
 
 	parser.FreeSource();
+	parser.SetIncludeList( NULL );
 
 	compile_time.Stop();
 	if ( !toConsole ) {
@@ -198,6 +198,50 @@ enum {
 	NUM_OPCODES
 };
 
+// superinstructions.  the program only puts these in the decoded statements the
+// interpreter runs, each one does its statement and the one after it.
+enum {
+	// compare and the if or ifnot on its result.  the ifnot form follows the if form.
+	OP_EQ_F_IF = NUM_OPCODES,
+	OP_EQ_F_IFNOT,
+	OP_NE_F_IF,
+	OP_NE_F_IFNOT,
+	OP_LT_IF,
+	OP_LT_IFNOT,
+	OP_LE_IF,
+	OP_LE_IFNOT,
+	OP_GT_IF,
+	OP_GT_IFNOT,
+	OP_GE_IF,
+	OP_GE_IFNOT,
+	OP_EQ_E_IF,
+	OP_EQ_E_IFNOT,
+	OP_NE_E_IF,
+	OP_NE_E_IFNOT,
+	OP_AND_IF,
+	OP_AND_IFNOT,
+	OP_OR_IF,
+	OP_OR_IFNOT,
+	OP_NOT_F_IF,
+	OP_NOT_F_IFNOT,
+	OP_NOT_BOOL_IF,
+	OP_NOT_BOOL_IFNOT,
+	OP_NOT_ENT_IF,
+	OP_NOT_ENT_IFNOT,
+
+	// math into a temporary and the store of it
+	OP_ADD_F_STORE,
+	OP_SUB_F_STORE,
+	OP_MUL_F_STORE,
+	OP_ADD_V_STORE,
+	OP_SUB_V_STORE,
+
+	// two pushes of a float, entity or object
+	OP_PUSH_PAIR,
+
+	NUM_SCRIPT_OPS
+};
+
 class idCompiler {
 private:
 	static bool		punctuationValid[ 256 ];
@@ -276,7 +320,7 @@ public :
 	static const opcode_t	opcodes[];
 
 					idCompiler();
-	void			CompileFile( const char *text, const char *filename, bool console );
+	void			CompileFile( const char *text, const char *filename, bool console, idStrList *includes = NULL );
 };
 
 #endif /* !__SCRIPT_COMPILER_H__ */
@@ -37,6 +37,7 @@ If you have questions concerning this license or the applicable additional terms
 
 // HvG: Debugger support
 extern bool updateGameDebugger( idInterpreter *interpreter, idProgram *program, int instructionPointer );
+extern bool gameDebuggerActive( void );
 
 /*
 ================
@@ -540,6 +541,176 @@ void idInterpreter::DisplayInfo( void ) const {
 	}
 }
 
+/*
+====================
+Script profiling
+
+Self time is charged to the running function or event whenever the
+interpreter switches between them.  The clock only counts milliseconds,
+so the times are only meaningful over many frames.
+====================
+*/
+
+typedef struct {
+	int					calls;
+	unsigned int		msec;
+} scriptProfile_t;
+
+static bool				scriptProfiling = false;
+static scriptProfile_t	scriptProfileFunctions[ MAX_FUNCS ];
+static scriptProfile_t	scriptProfileEvents[ MAX_EVENTS ];
+static scriptProfile_t *scriptProfileCurrent = NULL;
+static unsigned int		scriptProfileTime = 0;
+
+/*
+====================
+ScriptProfileSwitch
+
+Charges the time since the last switch and returns what it was charged to.
+====================
+*/
+static scriptProfile_t *ScriptProfileSwitch( scriptProfile_t *profile ) {
+	scriptProfile_t *previous = scriptProfileCurrent;
+	unsigned int time = sys->GetMilliseconds();
+
+	if ( previous ) {
+		previous->msec += time - scriptProfileTime;
+	}
+	scriptProfileTime = time;
+	scriptProfileCurrent = profile;
+
+	return previous;
+}
+
+/*
+====================
+ScriptProfileFunction
+====================
+*/
+static scriptProfile_t *ScriptProfileFunction( const function_t *func ) {
+	if ( !func ) {
+		return NULL;
+	}
+	return &scriptProfileFunctions[ gameLocal.program.GetFunctionIndex( func ) ];
+}
+
+/*
+====================
+ScriptProfileEvent
+====================
+*/
+static scriptProfile_t *ScriptProfileEvent( const function_t *func ) {
+	if ( !func || !func->eventdef ) {
+		return NULL;
+	}
+	scriptProfile_t *profile = &scriptProfileEvents[ func->eventdef->GetEventNum() ];
+	profile->calls++;
+	return profile;
+}
+
+typedef struct {
+	const char *		name;
+	scriptProfile_t		profile;
+} scriptProfileEntry_t;
+
+/*
+====================
+ScriptProfileSort
+====================
+*/
+static int ScriptProfileSort( const scriptProfileEntry_t *a, const scriptProfileEntry_t *b ) {
+	if ( a->profile.msec != b->profile.msec ) {
+		return ( a->profile.msec > b->profile.msec ) ? -1 : 1;
+	}
+	return b->profile.calls - a->profile.calls;
+}
+
+/*
+====================
+ScriptProfilePrint
+====================
+*/
+static void ScriptProfilePrint( const char *title, idList<scriptProfileEntry_t> &entries, int count ) {
+	int i, calls;
+	unsigned int msec;
+
+	entries.Sort( ScriptProfileSort );
+
+	calls = 0;
+	msec = 0;
+	for ( i = 0; i < entries.Num(); i++ ) {
+		calls += entries[ i ].profile.calls;
+		msec += entries[ i ].profile.msec;
+	}
+
+	gameLocal.Printf( "%8s %8s  %s\n", "calls", "msec", title );
+	for ( i = 0; i < entries.Num() && i < count; i++ ) {
+		gameLocal.Printf( "%8d %8u  %s\n", entries[ i ].profile.calls, entries[ i ].profile.msec, entries[ i ].name );
+	}
+	gameLocal.Printf( "%8d %8u  total of %d\n\n", calls, msec, entries.Num() );
+}
+
+/*
+====================
+idInterpreter::Profile_f
+====================
+*/
+void idInterpreter::Profile_f( const idCmdArgs &args ) {
+	idList<scriptProfileEntry_t> entries;
+	scriptProfileEntry_t entry;
+	int i, count;
+
+	if ( args.Argc() > 1 && !idStr::Icmp( args.Argv( 1 ), "start" ) ) {
+		ScriptProfileSwitch( NULL );
+		memset( scriptProfileFunctions, 0, sizeof( scriptProfileFunctions ) );
+		memset( scriptProfileEvents, 0, sizeof( scriptProfileEvents ) );
+		scriptProfiling = true;
+		gameLocal.Printf( "script profiling started\n" );
+		return;
+	}
+
+	if ( args.Argc() > 1 && !idStr::Icmp( args.Argv( 1 ), "stop" ) ) {
+		ScriptProfileSwitch( NULL );
+		scriptProfiling = false;
+		gameLocal.Printf( "script profiling stopped\n" );
+		return;
+	}
+
+	count = ( args.Argc() > 1 ) ? atoi( args.Argv( 1 ) ) : 20;
+	if ( count <= 0 ) {
+		gameLocal.Printf( "usage: scriptProfile [start|stop|<number of lines>]\n" );
+		return;
+	}
+
+	if ( scriptProfiling ) {
+		// bring the running totals up to date
+		ScriptProfileSwitch( scriptProfileCurrent );
+	}
+
+	// functions are only in the table while their map is loaded
+	for ( i = 0; i < gameLocal.program.NumFunctions(); i++ ) {
+		const function_t *func = gameLocal.program.GetFunction( i );
+		if ( func->eventdef || ( !scriptProfileFunctions[ i ].calls && !scriptProfileFunctions[ i ].msec ) ) {
+			continue;
+		}
+		entry.name = func->Name();
+		entry.profile = scriptProfileFunctions[ i ];
+		entries.Append( entry );
+	}
+	ScriptProfilePrint( "function", entries, count );
+
+	entries.Clear();
+	for ( i = 0; i < idEventDef::NumEventCommands(); i++ ) {
+		if ( !scriptProfileEvents[ i ].calls ) {
+			continue;
+		}
+		entry.name = idEventDef::GetEventCommand( i )->GetName();
+		entry.profile = scriptProfileEvents[ i ];
+		entries.Append( entry );
+	}
+	ScriptProfilePrint( "event", entries, count );
+}
+
 /*
 ====================
 idInterpreter::ThreadCall
@@ -622,6 +793,10 @@ void idInterpreter::EnterFunction( const function_t *func, bool clearStack ) {
 		Error( "NULL function" );
 	}
 
+	if ( scriptProfiling ) {
+		ScriptProfileFunction( func )->calls++;
+	}
+
 	if ( debug ) {
 		if ( currentFunction ) {
 			gameLocal.Printf( "%d: call '%s' from '%s'(line %d)%s\n", gameLocal.time, func->Name(), currentFunction->Name(),
@@ -968,6 +1143,67 @@ void idInterpreter::CallSysEvent( const function_t *func, int argsize ) {
 	popParms = 0;
 }
 
+/*
+====================
+idInterpreter::DebugStatement
+
+Hands the statement about to run to the debugger.
+====================
+*/
+void idInterpreter::DebugStatement( void ) {
+	if ( !updateGameDebugger( this, &gameLocal.program, instructionPointer ) && g_debugScript.GetBool( ) ) {
+		static int lastLineNumber = -1;
+		if ( lastLineNumber != gameLocal.program.GetStatement ( instructionPointer ).linenumber ) {				
+			gameLocal.Printf ( "%s (%d)\n", 
+				gameLocal.program.GetFilename ( gameLocal.program.GetStatement ( instructionPointer ).file ),
+				gameLocal.program.GetStatement ( instructionPointer ).linenumber
+				);
+			lastLineNumber = gameLocal.program.GetStatement ( instructionPointer ).linenumber;
+		}
+	}
+}
+
+/*
+====================
+Statement dispatch
+
+Execute runs the statements the program decoded for it.  With gcc and clang
+every handler ends in an indirect jump of its own through a table of label
+addresses, so each opcode gets its own branch history.  Other compilers use
+the switch.  While the script is debugged, statements run one at a time
+through their plain opcode so superinstructions never skip one.
+====================
+*/
+
+#ifdef __GNUC__
+#define SCRIPT_COMPUTED_GOTO
+#endif
+
+#ifdef SCRIPT_COMPUTED_GOTO
+
+#define SCRIPT_OP( opnum )		label_##opnum:
+#define SCRIPT_BAD_OP			label_default:
+#define SCRIPT_LABEL( opnum )	opLabels[ opnum ] = &&label_##opnum
+
+// fetch the next statement and jump straight to its handler
+#define SCRIPT_NEXT()								\
+	if ( doneProcessing || threadDying ) {			\
+		goto finished;								\
+	}												\
+	if ( !--runaway ) {								\
+		Error( "runaway loop error" );				\
+	}												\
+	op = &code[ ++instructionPointer ];				\
+	goto *dispatch[ op->op ]
+
+#else
+
+#define SCRIPT_OP( opnum )		case opnum:
+#define SCRIPT_BAD_OP			default:
+#define SCRIPT_NEXT()			break
+
+#endif
+
 /*
 ====================
 idInterpreter::Execute
@@ -978,17 +1214,194 @@ bool idInterpreter::Execute( void ) {
 	varEval_t	var_b;
 	varEval_t	var_c;
 	varEval_t	var;
-	statement_t	*st;
+	const scriptOp_t *code;
+	const scriptOp_t *op;
 	int			runaway;
 	idThread	*newThread;
 	float		floatVal;
+	bool		result;
 	idScriptObject *obj;
 	const function_t *func;
+	bool		debugging;
+	bool		profiled;
+	scriptProfile_t *profileCaller = NULL;
+#ifdef SCRIPT_COMPUTED_GOTO
+	static void	*opLabels[ NUM_SCRIPT_OPS ];
+	static void	*debugLabels[ NUM_SCRIPT_OPS ];
+	void		**dispatch;
+	int			i;
+#else
+	int			opnum;
+#endif
 
 	if ( threadDying || !currentFunction ) {
 		return true;
 	}
 
+#ifdef SCRIPT_COMPUTED_GOTO
+	if ( !opLabels[ OP_RETURN ] ) {
+		for( i = 0; i < NUM_SCRIPT_OPS; i++ ) {
+			opLabels[ i ] = &&label_default;
+			debugLabels[ i ] = &&label_debug;
+		}
+		SCRIPT_LABEL( OP_RETURN );
+		SCRIPT_LABEL( OP_THREAD );
+		SCRIPT_LABEL( OP_OBJTHREAD );
+		SCRIPT_LABEL( OP_CALL );
+		SCRIPT_LABEL( OP_EVENTCALL );
+		SCRIPT_LABEL( OP_OBJECTCALL );
+		SCRIPT_LABEL( OP_SYSCALL );
+		SCRIPT_LABEL( OP_IFNOT );
+		SCRIPT_LABEL( OP_IF );
+		SCRIPT_LABEL( OP_GOTO );
+		SCRIPT_LABEL( OP_ADD_F );
+		SCRIPT_LABEL( OP_ADD_V );
+		SCRIPT_LABEL( OP_ADD_S );
+		SCRIPT_LABEL( OP_ADD_FS );
+		SCRIPT_LABEL( OP_ADD_SF );
+		SCRIPT_LABEL( OP_ADD_VS );
+		SCRIPT_LABEL( OP_ADD_SV );
+		SCRIPT_LABEL( OP_SUB_F );
+		SCRIPT_LABEL( OP_SUB_V );
+		SCRIPT_LABEL( OP_MUL_F );
+		SCRIPT_LABEL( OP_MUL_V );
+		SCRIPT_LABEL( OP_MUL_FV );
+		SCRIPT_LABEL( OP_MUL_VF );
+		SCRIPT_LABEL( OP_DIV_F );
+		SCRIPT_LABEL( OP_MOD_F );
+		SCRIPT_LABEL( OP_BITAND );
+		SCRIPT_LABEL( OP_BITOR );
+		SCRIPT_LABEL( OP_GE );
+		SCRIPT_LABEL( OP_LE );
+		SCRIPT_LABEL( OP_GT );
+		SCRIPT_LABEL( OP_LT );
+		SCRIPT_LABEL( OP_AND );
+		SCRIPT_LABEL( OP_AND_BOOLF );
+		SCRIPT_LABEL( OP_AND_FBOOL );
+		SCRIPT_LABEL( OP_AND_BOOLBOOL );
+		SCRIPT_LABEL( OP_OR );
+		SCRIPT_LABEL( OP_OR_BOOLF );
+		SCRIPT_LABEL( OP_OR_FBOOL );
+		SCRIPT_LABEL( OP_OR_BOOLBOOL );
+		SCRIPT_LABEL( OP_NOT_BOOL );
+		SCRIPT_LABEL( OP_NOT_F );
+		SCRIPT_LABEL( OP_NOT_V );
+		SCRIPT_LABEL( OP_NOT_S );
+		SCRIPT_LABEL( OP_NOT_ENT );
+		SCRIPT_LABEL( OP_NEG_F );
+		SCRIPT_LABEL( OP_NEG_V );
+		SCRIPT_LABEL( OP_INT_F );
+		SCRIPT_LABEL( OP_EQ_F );
+		SCRIPT_LABEL( OP_EQ_V );
+		SCRIPT_LABEL( OP_EQ_S );
+		SCRIPT_LABEL( OP_EQ_E );
+		SCRIPT_LABEL( OP_EQ_EO );
+		SCRIPT_LABEL( OP_EQ_OE );
+		SCRIPT_LABEL( OP_EQ_OO );
+		SCRIPT_LABEL( OP_NE_F );
+		SCRIPT_LABEL( OP_NE_V );
+		SCRIPT_LABEL( OP_NE_S );
+		SCRIPT_LABEL( OP_NE_E );
+		SCRIPT_LABEL( OP_NE_EO );
+		SCRIPT_LABEL( OP_NE_OE );
+		SCRIPT_LABEL( OP_NE_OO );
+		SCRIPT_LABEL( OP_UADD_F );
+		SCRIPT_LABEL( OP_UADD_V );
+		SCRIPT_LABEL( OP_USUB_F );
+		SCRIPT_LABEL( OP_USUB_V );
+		SCRIPT_LABEL( OP_UMUL_F );
+		SCRIPT_LABEL( OP_UMUL_V );
+		SCRIPT_LABEL( OP_UDIV_F );
+		SCRIPT_LABEL( OP_UDIV_V );
+		SCRIPT_LABEL( OP_UMOD_F );
+		SCRIPT_LABEL( OP_UOR_F );
+		SCRIPT_LABEL( OP_UAND_F );
+		SCRIPT_LABEL( OP_UINC_F );
+		SCRIPT_LABEL( OP_UINCP_F );
+		SCRIPT_LABEL( OP_UDEC_F );
+		SCRIPT_LABEL( OP_UDECP_F );
+		SCRIPT_LABEL( OP_COMP_F );
+		SCRIPT_LABEL( OP_STORE_F );
+		SCRIPT_LABEL( OP_STORE_ENT );
+		SCRIPT_LABEL( OP_STORE_BOOL );
+		SCRIPT_LABEL( OP_STORE_OBJENT );
+		SCRIPT_LABEL( OP_STORE_OBJ );
+		SCRIPT_LABEL( OP_STORE_ENTOBJ );
+		SCRIPT_LABEL( OP_STORE_S );
+		SCRIPT_LABEL( OP_STORE_V );
+		SCRIPT_LABEL( OP_STORE_FTOS );
+		SCRIPT_LABEL( OP_STORE_BTOS );
+		SCRIPT_LABEL( OP_STORE_VTOS );
+		SCRIPT_LABEL( OP_STORE_FTOBOOL );
+		SCRIPT_LABEL( OP_STORE_BOOLTOF );
+		SCRIPT_LABEL( OP_STOREP_F );
+		SCRIPT_LABEL( OP_STOREP_ENT );
+		SCRIPT_LABEL( OP_STOREP_FLD );
+		SCRIPT_LABEL( OP_STOREP_BOOL );
+		SCRIPT_LABEL( OP_STOREP_S );
+		SCRIPT_LABEL( OP_STOREP_V );
+		SCRIPT_LABEL( OP_STOREP_FTOS );
+		SCRIPT_LABEL( OP_STOREP_BTOS );
+		SCRIPT_LABEL( OP_STOREP_VTOS );
+		SCRIPT_LABEL( OP_STOREP_FTOBOOL );
+		SCRIPT_LABEL( OP_STOREP_BOOLTOF );
+		SCRIPT_LABEL( OP_STOREP_OBJ );
+		SCRIPT_LABEL( OP_STOREP_OBJENT );
+		SCRIPT_LABEL( OP_ADDRESS );
+		SCRIPT_LABEL( OP_INDIRECT_F );
+		SCRIPT_LABEL( OP_INDIRECT_ENT );
+		SCRIPT_LABEL( OP_INDIRECT_BOOL );
+		SCRIPT_LABEL( OP_INDIRECT_S );
+		SCRIPT_LABEL( OP_INDIRECT_V );
+		SCRIPT_LABEL( OP_INDIRECT_OBJ );
+		SCRIPT_LABEL( OP_PUSH_F );
+		SCRIPT_LABEL( OP_PUSH_FTOS );
+		SCRIPT_LABEL( OP_PUSH_BTOF );
+		SCRIPT_LABEL( OP_PUSH_FTOB );
+		SCRIPT_LABEL( OP_PUSH_VTOS );
+		SCRIPT_LABEL( OP_PUSH_BTOS );
+		SCRIPT_LABEL( OP_PUSH_ENT );
+		SCRIPT_LABEL( OP_PUSH_S );
+		SCRIPT_LABEL( OP_PUSH_V );
+		SCRIPT_LABEL( OP_PUSH_OBJ );
+		SCRIPT_LABEL( OP_PUSH_OBJENT );
+		SCRIPT_LABEL( OP_EQ_F_IF );
+		SCRIPT_LABEL( OP_EQ_F_IFNOT );
+		SCRIPT_LABEL( OP_NE_F_IF );
+		SCRIPT_LABEL( OP_NE_F_IFNOT );
+		SCRIPT_LABEL( OP_LT_IF );
+		SCRIPT_LABEL( OP_LT_IFNOT );
+		SCRIPT_LABEL( OP_LE_IF );
+		SCRIPT_LABEL( OP_LE_IFNOT );
+		SCRIPT_LABEL( OP_GT_IF );
+		SCRIPT_LABEL( OP_GT_IFNOT );
+		SCRIPT_LABEL( OP_GE_IF );
+		SCRIPT_LABEL( OP_GE_IFNOT );
+		SCRIPT_LABEL( OP_EQ_E_IF );
+		SCRIPT_LABEL( OP_EQ_E_IFNOT );
+		SCRIPT_LABEL( OP_NE_E_IF );
+		SCRIPT_LABEL( OP_NE_E_IFNOT );
+		SCRIPT_LABEL( OP_AND_IF );
+		SCRIPT_LABEL( OP_AND_IFNOT );
+		SCRIPT_LABEL( OP_OR_IF );
+		SCRIPT_LABEL( OP_OR_IFNOT );
+		SCRIPT_LABEL( OP_NOT_F_IF );
+		SCRIPT_LABEL( OP_NOT_F_IFNOT );
+		SCRIPT_LABEL( OP_NOT_BOOL_IF );
+		SCRIPT_LABEL( OP_NOT_BOOL_IFNOT );
+		SCRIPT_LABEL( OP_NOT_ENT_IF );
+		SCRIPT_LABEL( OP_NOT_ENT_IFNOT );
+		SCRIPT_LABEL( OP_ADD_F_STORE );
+		SCRIPT_LABEL( OP_SUB_F_STORE );
+		SCRIPT_LABEL( OP_MUL_F_STORE );
+		SCRIPT_LABEL( OP_ADD_V_STORE );
+		SCRIPT_LABEL( OP_SUB_V_STORE );
+		SCRIPT_LABEL( OP_PUSH_PAIR );
+		SCRIPT_LABEL( OP_BREAK );
+		SCRIPT_LABEL( OP_CONTINUE );
+	}
+#endif
+
 	if ( multiFrameEvent ) {
 		// move to previous instruction and call it again
 		instructionPointer--;
@@ -996,50 +1409,62 @@ bool idInterpreter::Execute( void ) {
 
 	runaway = 5000000;
 
+	// the debugger has to see every statement, so only pay for the check while it's in use
+	debugging = gameDebuggerActive() || g_debugScript.GetBool();
+
+	// charge the time from here on to the running function
+	profiled = scriptProfiling;
+	if ( profiled ) {
+		profileCaller = ScriptProfileSwitch( ScriptProfileFunction( currentFunction ) );
+	}
+
+	code = gameLocal.program.GetDecodedStatements();
+
 	doneProcessing = false;
-	while( !doneProcessing && !threadDying ) {
-		instructionPointer++;
 
+#ifdef SCRIPT_COMPUTED_GOTO
+	dispatch = debugging ? debugLabels : opLabels;
+	SCRIPT_NEXT();
+
+	{
+#else
+	while( !doneProcessing && !threadDying ) {
 		if ( !--runaway ) {
 			Error( "runaway loop error" );
 		}
 
 		// next statement
-		st = &gameLocal.program.GetStatement( instructionPointer );
-
-		if ( !updateGameDebugger( this, &gameLocal.program, instructionPointer )
-			&& g_debugScript.GetBool( ) ) 
-		{
-			static int lastLineNumber = -1;
-			if ( lastLineNumber != gameLocal.program.GetStatement ( instructionPointer ).linenumber ) {				
-				gameLocal.Printf ( "%s (%d)\n", 
-					gameLocal.program.GetFilename ( gameLocal.program.GetStatement ( instructionPointer ).file ),
-					gameLocal.program.GetStatement ( instructionPointer ).linenumber
-					);
-				lastLineNumber = gameLocal.program.GetStatement ( instructionPointer ).linenumber;
-			}
+		op = &code[ ++instructionPointer ];
+		opnum = op->op;
+		if ( debugging ) {
+			DebugStatement();
+			opnum = op->baseOp;
 		}
 
-		switch( st->op ) {
-		case OP_RETURN:
-			LeaveFunction( st->a );
-			break;
+		switch( opnum ) {
+#endif
+		SCRIPT_OP( OP_RETURN )
+			LeaveFunction( gameLocal.program.GetStatement( instructionPointer ).a );
+			if ( profiled ) {
+				ScriptProfileSwitch( ScriptProfileFunction( currentFunction ) );
+			}
+			SCRIPT_NEXT();
 
-		case OP_THREAD:
-			newThread = new idThread( this, st->a->value.functionPtr, st->b->value.argSize );
+		SCRIPT_OP( OP_THREAD )
+			newThread = new idThread( this, op->a.functionPtr, op->b.argSize );
 			newThread->Start();
 
 			// return the thread number to the script
 			gameLocal.program.ReturnFloat( newThread->GetThreadNum() );
-			PopParms( st->b->value.argSize );
-			break;
+			PopParms( op->b.argSize );
+			SCRIPT_NEXT();
 
-		case OP_OBJTHREAD:
-			var_a = GetVariable( st->a );
+		SCRIPT_OP( OP_OBJTHREAD )
+			var_a = GetOperand( op->a, op->localA );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
 			if ( obj ) {
-				func = obj->GetTypeDef()->GetFunction( st->b->value.virtualFunction );
-				assert( st->c->value.argSize == func->parmTotal );
+				func = obj->GetTypeDef()->GetFunction( op->b.virtualFunction );
+				assert( op->c.argSize == func->parmTotal );
 				newThread = new idThread( this, GetEntity( *var_a.entityNumberPtr ), func, func->parmTotal );
 				newThread->Start();
 
@@ -1049,142 +1474,171 @@ bool idInterpreter::Execute( void ) {
 				// return a null thread to the script
 				gameLocal.program.ReturnFloat( 0.0f );
 			}
-			PopParms( st->c->value.argSize );
-			break;
+			PopParms( op->c.argSize );
+			SCRIPT_NEXT();
 
-		case OP_CALL:
-			EnterFunction( st->a->value.functionPtr, false );
-			break;
+		SCRIPT_OP( OP_CALL )
+			EnterFunction( op->a.functionPtr, false );
+			if ( profiled ) {
+				ScriptProfileSwitch( ScriptProfileFunction( currentFunction ) );
+			}
+			SCRIPT_NEXT();
 
-		case OP_EVENTCALL:
-			CallEvent( st->a->value.functionPtr, st->b->value.argSize );
-			break;
+		SCRIPT_OP( OP_EVENTCALL )
+			if ( profiled ) {
+				ScriptProfileSwitch( ScriptProfileEvent( op->a.functionPtr ) );
+			}
+			CallEvent( op->a.functionPtr, op->b.argSize );
+			if ( profiled ) {
+				ScriptProfileSwitch( ScriptProfileFunction( currentFunction ) );
+			}
+			SCRIPT_NEXT();
 
-		case OP_OBJECTCALL:
-			var_a = GetVariable( st->a );
+		SCRIPT_OP( OP_OBJECTCALL )
+			var_a = GetOperand( op->a, op->localA );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
 			if ( obj ) {
-				func = obj->GetTypeDef()->GetFunction( st->b->value.virtualFunction );
+				func = obj->GetTypeDef()->GetFunction( op->b.virtualFunction );
 				EnterFunction( func, false );
+				if ( profiled ) {
+					ScriptProfileSwitch( ScriptProfileFunction( currentFunction ) );
+				}
 			} else {
 				// return a 'safe' value
 				gameLocal.program.ReturnVector( vec3_zero );
 				gameLocal.program.ReturnString( "" );
-				PopParms( st->c->value.argSize );
+				PopParms( op->c.argSize );
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_SYSCALL:
-			CallSysEvent( st->a->value.functionPtr, st->b->value.argSize );
-			break;
+		SCRIPT_OP( OP_SYSCALL )
+			if ( profiled ) {
+				ScriptProfileSwitch( ScriptProfileEvent( op->a.functionPtr ) );
+			}
+			CallSysEvent( op->a.functionPtr, op->b.argSize );
+			if ( profiled ) {
+				ScriptProfileSwitch( ScriptProfileFunction( currentFunction ) );
+			}
+			SCRIPT_NEXT();
 
-		case OP_IFNOT:
-			var_a = GetVariable( st->a );
+		SCRIPT_OP( OP_IFNOT )
+			var_a = GetOperand( op->a, op->localA );
 			if ( *var_a.intPtr == 0 ) {
-				NextInstruction( instructionPointer + st->b->value.jumpOffset );
+				NextInstruction( instructionPointer + op->b.jumpOffset );
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_IF:
-			var_a = GetVariable( st->a );
+		SCRIPT_OP( OP_IF )
+			var_a = GetOperand( op->a, op->localA );
 			if ( *var_a.intPtr != 0 ) {
-				NextInstruction( instructionPointer + st->b->value.jumpOffset );
+				NextInstruction( instructionPointer + op->b.jumpOffset );
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_GOTO:
-			NextInstruction( instructionPointer + st->a->value.jumpOffset );
-			break;
+		SCRIPT_OP( OP_GOTO )
+			NextInstruction( instructionPointer + op->a.jumpOffset );
+			SCRIPT_NEXT();
 
-		case OP_ADD_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_ADD_F )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = *var_a.floatPtr + *var_b.floatPtr;
-			break;
+			SCRIPT_NEXT();
 
-		case OP_ADD_V:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_ADD_V )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.vectorPtr = *var_a.vectorPtr + *var_b.vectorPtr;
-			break;
-
-		case OP_ADD_S:
-			SetString( st->c, GetString( st->a ) );
-			AppendString( st->c, GetString( st->b ) );
-			break;
-
-		case OP_ADD_FS:
-			var_a = GetVariable( st->a );
-			SetString( st->c, FloatToString( *var_a.floatPtr ) );
-			AppendString( st->c, GetString( st->b ) );
-			break;
-
-		case OP_ADD_SF:
-			var_b = GetVariable( st->b );
-			SetString( st->c, GetString( st->a ) );
-			AppendString( st->c, FloatToString( *var_b.floatPtr ) );
-			break;
-
-		case OP_ADD_VS:
-			var_a = GetVariable( st->a );
-			SetString( st->c, var_a.vectorPtr->ToString() );
-			AppendString( st->c, GetString( st->b ) );
-			break;
-
-		case OP_ADD_SV:
-			var_b = GetVariable( st->b );
-			SetString( st->c, GetString( st->a ) );
-			AppendString( st->c, var_b.vectorPtr->ToString() );
-			break;
-
-		case OP_SUB_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_ADD_S )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
+			SetString( var_c, var_a.stringPtr );
+			AppendString( var_c, var_b.stringPtr );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_ADD_FS )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
+			SetString( var_c, FloatToString( *var_a.floatPtr ) );
+			AppendString( var_c, var_b.stringPtr );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_ADD_SF )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
+			SetString( var_c, var_a.stringPtr );
+			AppendString( var_c, FloatToString( *var_b.floatPtr ) );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_ADD_VS )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
+			SetString( var_c, var_a.vectorPtr->ToString() );
+			AppendString( var_c, var_b.stringPtr );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_ADD_SV )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
+			SetString( var_c, var_a.stringPtr );
+			AppendString( var_c, var_b.vectorPtr->ToString() );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_SUB_F )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = *var_a.floatPtr - *var_b.floatPtr;
-			break;
+			SCRIPT_NEXT();
 
-		case OP_SUB_V:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_SUB_V )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.vectorPtr = *var_a.vectorPtr - *var_b.vectorPtr;
-			break;
+			SCRIPT_NEXT();
 
-		case OP_MUL_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_MUL_F )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = *var_a.floatPtr * *var_b.floatPtr;
-			break;
+			SCRIPT_NEXT();
 
-		case OP_MUL_V:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_MUL_V )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = *var_a.vectorPtr * *var_b.vectorPtr;
-			break;
+			SCRIPT_NEXT();
 
-		case OP_MUL_FV:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_MUL_FV )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.vectorPtr = *var_a.floatPtr * *var_b.vectorPtr;
-			break;
+			SCRIPT_NEXT();
 
-		case OP_MUL_VF:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_MUL_VF )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.vectorPtr = *var_a.vectorPtr * *var_b.floatPtr;
-			break;
+			SCRIPT_NEXT();
 
-		case OP_DIV_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_DIV_F )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 
 			if ( *var_b.floatPtr == 0.0f ) {
 				Warning( "Divide by zero" );
@@ -1192,12 +1646,12 @@ bool idInterpreter::Execute( void ) {
 			} else {
 				*var_c.floatPtr = *var_a.floatPtr / *var_b.floatPtr;
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_MOD_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable ( st->c );
+		SCRIPT_OP( OP_MOD_F )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 
 			if ( *var_b.floatPtr == 0.0f ) {
 				Warning( "Divide by zero" );
@@ -1205,252 +1659,255 @@ bool idInterpreter::Execute( void ) {
 			} else {
 				*var_c.floatPtr = static_cast<int>( *var_a.floatPtr ) % static_cast<int>( *var_b.floatPtr );
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_BITAND:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_BITAND )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = static_cast<int>( *var_a.floatPtr ) & static_cast<int>( *var_b.floatPtr );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_BITOR:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_BITOR )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = static_cast<int>( *var_a.floatPtr ) | static_cast<int>( *var_b.floatPtr );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_GE:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_GE )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ( *var_a.floatPtr >= *var_b.floatPtr );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_LE:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_LE )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ( *var_a.floatPtr <= *var_b.floatPtr );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_GT:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_GT )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ( *var_a.floatPtr > *var_b.floatPtr );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_LT:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_LT )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ( *var_a.floatPtr < *var_b.floatPtr );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_AND:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_AND )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ( *var_a.floatPtr != 0.0f ) && ( *var_b.floatPtr != 0.0f );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_AND_BOOLF:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_AND_BOOLF )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ( *var_a.intPtr != 0 ) && ( *var_b.floatPtr != 0.0f );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_AND_FBOOL:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_AND_FBOOL )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ( *var_a.floatPtr != 0.0f ) && ( *var_b.intPtr != 0 );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_AND_BOOLBOOL:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_AND_BOOLBOOL )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ( *var_a.intPtr != 0 ) && ( *var_b.intPtr != 0 );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_OR:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_OR )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ( *var_a.floatPtr != 0.0f ) || ( *var_b.floatPtr != 0.0f );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_OR_BOOLF:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_OR_BOOLF )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ( *var_a.intPtr != 0 ) || ( *var_b.floatPtr != 0.0f );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_OR_FBOOL:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_OR_FBOOL )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ( *var_a.floatPtr != 0.0f ) || ( *var_b.intPtr != 0 );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_OR_BOOLBOOL:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_OR_BOOLBOOL )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ( *var_a.intPtr != 0 ) || ( *var_b.intPtr != 0 );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_NOT_BOOL:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_NOT_BOOL )
+			var_a = GetOperand( op->a, op->localA );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ( *var_a.intPtr == 0 );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_NOT_F:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_NOT_F )
+			var_a = GetOperand( op->a, op->localA );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ( *var_a.floatPtr == 0.0f );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_NOT_V:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_NOT_V )
+			var_a = GetOperand( op->a, op->localA );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ( *var_a.vectorPtr == vec3_zero );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_NOT_S:
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( strlen( GetString( st->a ) ) == 0 );
-			break;
+		SCRIPT_OP( OP_NOT_S )
+			var_a = GetOperand( op->a, op->localA );
+			var_c = GetOperand( op->c, op->localC );
+			*var_c.floatPtr = ( strlen( var_a.stringPtr ) == 0 );
+			SCRIPT_NEXT();
 
-		case OP_NOT_ENT:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_NOT_ENT )
+			var_a = GetOperand( op->a, op->localA );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ( GetEntity( *var_a.entityNumberPtr ) == NULL );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_NEG_F:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_NEG_F )
+			var_a = GetOperand( op->a, op->localA );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = -*var_a.floatPtr;
-			break;
+			SCRIPT_NEXT();
 
-		case OP_NEG_V:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_NEG_V )
+			var_a = GetOperand( op->a, op->localA );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.vectorPtr = -*var_a.vectorPtr;
-			break;
+			SCRIPT_NEXT();
 
-		case OP_INT_F:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_INT_F )
+			var_a = GetOperand( op->a, op->localA );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = static_cast<int>( *var_a.floatPtr );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_EQ_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_EQ_F )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ( *var_a.floatPtr == *var_b.floatPtr );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_EQ_V:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_EQ_V )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ( *var_a.vectorPtr == *var_b.vectorPtr );
-			break;
-
-		case OP_EQ_S:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( idStr::Cmp( GetString( st->a ), GetString( st->b ) ) == 0 );
-			break;
-
-		case OP_EQ_E:
-		case OP_EQ_EO:
-		case OP_EQ_OE:
-		case OP_EQ_OO:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_EQ_S )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
+			*var_c.floatPtr = ( idStr::Cmp( var_a.stringPtr, var_b.stringPtr ) == 0 );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_EQ_E )
+		SCRIPT_OP( OP_EQ_EO )
+		SCRIPT_OP( OP_EQ_OE )
+		SCRIPT_OP( OP_EQ_OO )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ( *var_a.entityNumberPtr == *var_b.entityNumberPtr );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_NE_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_NE_F )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ( *var_a.floatPtr != *var_b.floatPtr );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_NE_V:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_NE_V )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ( *var_a.vectorPtr != *var_b.vectorPtr );
-			break;
-
-		case OP_NE_S:
-			var_c = GetVariable( st->c );
-			*var_c.floatPtr = ( idStr::Cmp( GetString( st->a ), GetString( st->b ) ) != 0 );
-			break;
-
-		case OP_NE_E:
-		case OP_NE_EO:
-		case OP_NE_OE:
-		case OP_NE_OO:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
-			var_c = GetVariable( st->c );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_NE_S )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
+			*var_c.floatPtr = ( idStr::Cmp( var_a.stringPtr, var_b.stringPtr ) != 0 );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_NE_E )
+		SCRIPT_OP( OP_NE_EO )
+		SCRIPT_OP( OP_NE_OE )
+		SCRIPT_OP( OP_NE_OO )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ( *var_a.entityNumberPtr != *var_b.entityNumberPtr );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_UADD_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_UADD_F )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
 			*var_b.floatPtr += *var_a.floatPtr;
-			break;
+			SCRIPT_NEXT();
 
-		case OP_UADD_V:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_UADD_V )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
 			*var_b.vectorPtr += *var_a.vectorPtr;
-			break;
+			SCRIPT_NEXT();
 
-		case OP_USUB_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_USUB_F )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
 			*var_b.floatPtr -= *var_a.floatPtr;
-			break;
+			SCRIPT_NEXT();
 
-		case OP_USUB_V:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_USUB_V )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
 			*var_b.vectorPtr -= *var_a.vectorPtr;
-			break;
+			SCRIPT_NEXT();
 
-		case OP_UMUL_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_UMUL_F )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
 			*var_b.floatPtr *= *var_a.floatPtr;
-			break;
+			SCRIPT_NEXT();
 
-		case OP_UMUL_V:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_UMUL_V )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
 			*var_b.vectorPtr *= *var_a.floatPtr;
-			break;
+			SCRIPT_NEXT();
 
-		case OP_UDIV_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_UDIV_F )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
 
 			if ( *var_a.floatPtr == 0.0f ) {
 				Warning( "Divide by zero" );
@@ -1458,11 +1915,11 @@ bool idInterpreter::Execute( void ) {
 			} else {
 				*var_b.floatPtr = *var_b.floatPtr / *var_a.floatPtr;
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_UDIV_V:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_UDIV_V )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
 
 			if ( *var_a.floatPtr == 0.0f ) {
 				Warning( "Divide by zero" );
@@ -1470,11 +1927,11 @@ bool idInterpreter::Execute( void ) {
 			} else {
 				*var_b.vectorPtr = *var_b.vectorPtr / *var_a.floatPtr;
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_UMOD_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_UMOD_F )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
 
 			if ( *var_a.floatPtr == 0.0f ) {
 				Warning( "Divide by zero" );
@@ -1482,241 +1939,247 @@ bool idInterpreter::Execute( void ) {
 			} else {
 				*var_b.floatPtr = static_cast<int>( *var_b.floatPtr ) % static_cast<int>( *var_a.floatPtr );
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_UOR_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_UOR_F )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
 			*var_b.floatPtr = static_cast<int>( *var_b.floatPtr ) | static_cast<int>( *var_a.floatPtr );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_UAND_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_UAND_F )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
 			*var_b.floatPtr = static_cast<int>( *var_b.floatPtr ) & static_cast<int>( *var_a.floatPtr );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_UINC_F:
-			var_a = GetVariable( st->a );
+		SCRIPT_OP( OP_UINC_F )
+			var_a = GetOperand( op->a, op->localA );
 			( *var_a.floatPtr )++;
-			break;
+			SCRIPT_NEXT();
 
-		case OP_UINCP_F:
-			var_a = GetVariable( st->a );
+		SCRIPT_OP( OP_UINCP_F )
+			var_a = GetOperand( op->a, op->localA );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
 			if ( obj ) {
-				var.bytePtr = &obj->data[ st->b->value.ptrOffset ];
+				var.bytePtr = &obj->data[ op->b.ptrOffset ];
 				( *var.floatPtr )++;
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_UDEC_F:
-			var_a = GetVariable( st->a );
+		SCRIPT_OP( OP_UDEC_F )
+			var_a = GetOperand( op->a, op->localA );
 			( *var_a.floatPtr )--;
-			break;
+			SCRIPT_NEXT();
 
-		case OP_UDECP_F:
-			var_a = GetVariable( st->a );
+		SCRIPT_OP( OP_UDECP_F )
+			var_a = GetOperand( op->a, op->localA );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
 			if ( obj ) {
-				var.bytePtr = &obj->data[ st->b->value.ptrOffset ];
+				var.bytePtr = &obj->data[ op->b.ptrOffset ];
 				( *var.floatPtr )--;
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_COMP_F:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_COMP_F )
+			var_a = GetOperand( op->a, op->localA );
+			var_c = GetOperand( op->c, op->localC );
 			*var_c.floatPtr = ~static_cast<int>( *var_a.floatPtr );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_STORE_F:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_STORE_F )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
 			*var_b.floatPtr = *var_a.floatPtr;
-			break;
+			SCRIPT_NEXT();
 
-		case OP_STORE_ENT:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_STORE_ENT )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
 			*var_b.entityNumberPtr = *var_a.entityNumberPtr;
-			break;
+			SCRIPT_NEXT();
 
-		case OP_STORE_BOOL:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_STORE_BOOL )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
 			*var_b.intPtr = *var_a.intPtr;
-			break;
+			SCRIPT_NEXT();
 
-		case OP_STORE_OBJENT:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_STORE_OBJENT )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
 			if ( !obj ) {
 				*var_b.entityNumberPtr = 0;
-			} else if ( !obj->GetTypeDef()->Inherits( st->b->TypeDef() ) ) {
+			} else if ( !obj->GetTypeDef()->Inherits( gameLocal.program.GetStatement( instructionPointer ).b->TypeDef() ) ) {
 				//Warning( "object '%s' cannot be converted to '%s'", obj->GetTypeName(), st->b->TypeDef()->Name() );
 				*var_b.entityNumberPtr = 0;
 			} else {
 				*var_b.entityNumberPtr = *var_a.entityNumberPtr;
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_STORE_OBJ:
-		case OP_STORE_ENTOBJ:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_STORE_OBJ )
+		SCRIPT_OP( OP_STORE_ENTOBJ )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
 			*var_b.entityNumberPtr = *var_a.entityNumberPtr;
-			break;
+			SCRIPT_NEXT();
 
-		case OP_STORE_S:
-			SetString( st->b, GetString( st->a ) );
-			break;
+		SCRIPT_OP( OP_STORE_S )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			SetString( var_b, var_a.stringPtr );
+			SCRIPT_NEXT();
 
-		case OP_STORE_V:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_STORE_V )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
 			*var_b.vectorPtr = *var_a.vectorPtr;
-			break;
-
-		case OP_STORE_FTOS:
-			var_a = GetVariable( st->a );
-			SetString( st->b, FloatToString( *var_a.floatPtr ) );
-			break;
-
-		case OP_STORE_BTOS:
-			var_a = GetVariable( st->a );
-			SetString( st->b, *var_a.intPtr ? "true" : "false" );
-			break;
-
-		case OP_STORE_VTOS:
-			var_a = GetVariable( st->a );
-			SetString( st->b, var_a.vectorPtr->ToString() );
-			break;
-
-		case OP_STORE_FTOBOOL:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_STORE_FTOS )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			SetString( var_b, FloatToString( *var_a.floatPtr ) );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_STORE_BTOS )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			SetString( var_b, *var_a.intPtr ? "true" : "false" );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_STORE_VTOS )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			SetString( var_b, var_a.vectorPtr->ToString() );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_STORE_FTOBOOL )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
 			if ( *var_a.floatPtr != 0.0f ) {
 				*var_b.intPtr = 1;
 			} else {
 				*var_b.intPtr = 0;
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_STORE_BOOLTOF:
-			var_a = GetVariable( st->a );
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_STORE_BOOLTOF )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
 			*var_b.floatPtr = static_cast<float>( *var_a.intPtr );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_STOREP_F:
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_STOREP_F )
+			var_b = GetOperand( op->b, op->localB );
 			if ( var_b.evalPtr && var_b.evalPtr->floatPtr ) {
-				var_a = GetVariable( st->a );
+				var_a = GetOperand( op->a, op->localA );
 				*var_b.evalPtr->floatPtr = *var_a.floatPtr;
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_STOREP_ENT:
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_STOREP_ENT )
+			var_b = GetOperand( op->b, op->localB );
 			if ( var_b.evalPtr && var_b.evalPtr->entityNumberPtr ) {
-				var_a = GetVariable( st->a );
+				var_a = GetOperand( op->a, op->localA );
 				*var_b.evalPtr->entityNumberPtr = *var_a.entityNumberPtr;
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_STOREP_FLD:
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_STOREP_FLD )
+			var_b = GetOperand( op->b, op->localB );
 			if ( var_b.evalPtr && var_b.evalPtr->intPtr ) {
-				var_a = GetVariable( st->a );
+				var_a = GetOperand( op->a, op->localA );
 				*var_b.evalPtr->intPtr = *var_a.intPtr;
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_STOREP_BOOL:
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_STOREP_BOOL )
+			var_b = GetOperand( op->b, op->localB );
 			if ( var_b.evalPtr && var_b.evalPtr->intPtr ) {
-				var_a = GetVariable( st->a );
+				var_a = GetOperand( op->a, op->localA );
 				*var_b.evalPtr->intPtr = *var_a.intPtr;
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_STOREP_S:
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_STOREP_S )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
 			if ( var_b.evalPtr && var_b.evalPtr->stringPtr ) {
-				idStr::Copynz( var_b.evalPtr->stringPtr, GetString( st->a ), MAX_STRING_LEN );
+				idStr::Copynz( var_b.evalPtr->stringPtr, var_a.stringPtr, MAX_STRING_LEN );
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_STOREP_V:
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_STOREP_V )
+			var_b = GetOperand( op->b, op->localB );
 			if ( var_b.evalPtr && var_b.evalPtr->vectorPtr ) {
-				var_a = GetVariable( st->a );
+				var_a = GetOperand( op->a, op->localA );
 				*var_b.evalPtr->vectorPtr = *var_a.vectorPtr;
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_STOREP_FTOS:
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_STOREP_FTOS )
+			var_b = GetOperand( op->b, op->localB );
 			if ( var_b.evalPtr && var_b.evalPtr->stringPtr ) {
-				var_a = GetVariable( st->a );
+				var_a = GetOperand( op->a, op->localA );
 				idStr::Copynz( var_b.evalPtr->stringPtr, FloatToString( *var_a.floatPtr ), MAX_STRING_LEN );
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_STOREP_BTOS:
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_STOREP_BTOS )
+			var_b = GetOperand( op->b, op->localB );
 			if ( var_b.evalPtr && var_b.evalPtr->stringPtr ) {
-				var_a = GetVariable( st->a );
+				var_a = GetOperand( op->a, op->localA );
 				if ( *var_a.floatPtr != 0.0f ) {
 					idStr::Copynz( var_b.evalPtr->stringPtr, "true", MAX_STRING_LEN );
 				} else {
 					idStr::Copynz( var_b.evalPtr->stringPtr, "false", MAX_STRING_LEN );
 				}
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_STOREP_VTOS:
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_STOREP_VTOS )
+			var_b = GetOperand( op->b, op->localB );
 			if ( var_b.evalPtr && var_b.evalPtr->stringPtr ) {
-				var_a = GetVariable( st->a );
+				var_a = GetOperand( op->a, op->localA );
 				idStr::Copynz( var_b.evalPtr->stringPtr, var_a.vectorPtr->ToString(), MAX_STRING_LEN );
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_STOREP_FTOBOOL:
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_STOREP_FTOBOOL )
+			var_b = GetOperand( op->b, op->localB );
 			if ( var_b.evalPtr && var_b.evalPtr->intPtr ) {
-				var_a = GetVariable( st->a );
+				var_a = GetOperand( op->a, op->localA );
 				if ( *var_a.floatPtr != 0.0f ) {
 					*var_b.evalPtr->intPtr = 1;
 				} else {
 					*var_b.evalPtr->intPtr = 0;
 				}
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_STOREP_BOOLTOF:
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_STOREP_BOOLTOF )
+			var_b = GetOperand( op->b, op->localB );
 			if ( var_b.evalPtr && var_b.evalPtr->floatPtr ) {
-				var_a = GetVariable( st->a );
+				var_a = GetOperand( op->a, op->localA );
 				*var_b.evalPtr->floatPtr = static_cast<float>( *var_a.intPtr );
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_STOREP_OBJ:
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_STOREP_OBJ )
+			var_b = GetOperand( op->b, op->localB );
 			if ( var_b.evalPtr && var_b.evalPtr->entityNumberPtr ) {
-				var_a = GetVariable( st->a );
+				var_a = GetOperand( op->a, op->localA );
 				*var_b.evalPtr->entityNumberPtr = *var_a.entityNumberPtr;
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_STOREP_OBJENT:
-			var_b = GetVariable( st->b );
+		SCRIPT_OP( OP_STOREP_OBJENT )
+			var_b = GetOperand( op->b, op->localB );
 			if ( var_b.evalPtr && var_b.evalPtr->entityNumberPtr ) {
-				var_a = GetVariable( st->a );
+				var_a = GetOperand( op->a, op->localA );
 				obj = GetScriptObject( *var_a.entityNumberPtr );
 				if ( !obj ) {
 					*var_b.evalPtr->entityNumberPtr = 0;
@@ -1724,163 +2187,365 @@ bool idInterpreter::Execute( void ) {
 				// st->b points to type_pointer, which is just a temporary that gets its type reassigned, so we store the real type in st->c
 				// so that we can do a type check during run time since we don't know what type the script object is at compile time because it
 				// comes from an entity
-				} else if ( !obj->GetTypeDef()->Inherits( st->c->TypeDef() ) ) {
+				} else if ( !obj->GetTypeDef()->Inherits( gameLocal.program.GetStatement( instructionPointer ).c->TypeDef() ) ) {
 					//Warning( "object '%s' cannot be converted to '%s'", obj->GetTypeName(), st->c->TypeDef()->Name() );
 					*var_b.evalPtr->entityNumberPtr = 0;
 				} else {
 					*var_b.evalPtr->entityNumberPtr = *var_a.entityNumberPtr;
 				}
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_ADDRESS:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_ADDRESS )
+			var_a = GetOperand( op->a, op->localA );
+			var_c = GetOperand( op->c, op->localC );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
 			if ( obj ) {
-				var_c.evalPtr->bytePtr = &obj->data[ st->b->value.ptrOffset ];
+				var_c.evalPtr->bytePtr = &obj->data[ op->b.ptrOffset ];
 			} else {
 				var_c.evalPtr->bytePtr = NULL;
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_INDIRECT_F:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_INDIRECT_F )
+			var_a = GetOperand( op->a, op->localA );
+			var_c = GetOperand( op->c, op->localC );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
 			if ( obj ) {
-				var.bytePtr = &obj->data[ st->b->value.ptrOffset ];
+				var.bytePtr = &obj->data[ op->b.ptrOffset ];
 				*var_c.floatPtr = *var.floatPtr;
 			} else {
 				*var_c.floatPtr = 0.0f;
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_INDIRECT_ENT:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_INDIRECT_ENT )
+			var_a = GetOperand( op->a, op->localA );
+			var_c = GetOperand( op->c, op->localC );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
 			if ( obj ) {
-				var.bytePtr = &obj->data[ st->b->value.ptrOffset ];
+				var.bytePtr = &obj->data[ op->b.ptrOffset ];
 				*var_c.entityNumberPtr = *var.entityNumberPtr;
 			} else {
 				*var_c.entityNumberPtr = 0;
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_INDIRECT_BOOL:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_INDIRECT_BOOL )
+			var_a = GetOperand( op->a, op->localA );
+			var_c = GetOperand( op->c, op->localC );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
 			if ( obj ) {
-				var.bytePtr = &obj->data[ st->b->value.ptrOffset ];
+				var.bytePtr = &obj->data[ op->b.ptrOffset ];
 				*var_c.intPtr = *var.intPtr;
 			} else {
 				*var_c.intPtr = 0;
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_INDIRECT_S:
-			var_a = GetVariable( st->a );
+		SCRIPT_OP( OP_INDIRECT_S )
+			var_a = GetOperand( op->a, op->localA );
+			var_c = GetOperand( op->c, op->localC );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
 			if ( obj ) {
-				var.bytePtr = &obj->data[ st->b->value.ptrOffset ];
-				SetString( st->c, var.stringPtr );
+				var.bytePtr = &obj->data[ op->b.ptrOffset ];
+				SetString( var_c, var.stringPtr );
 			} else {
-				SetString( st->c, "" );
+				SetString( var_c, "" );
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_INDIRECT_V:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_INDIRECT_V )
+			var_a = GetOperand( op->a, op->localA );
+			var_c = GetOperand( op->c, op->localC );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
 			if ( obj ) {
-				var.bytePtr = &obj->data[ st->b->value.ptrOffset ];
+				var.bytePtr = &obj->data[ op->b.ptrOffset ];
 				*var_c.vectorPtr = *var.vectorPtr;
 			} else {
 				var_c.vectorPtr->Zero();
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_INDIRECT_OBJ:
-			var_a = GetVariable( st->a );
-			var_c = GetVariable( st->c );
+		SCRIPT_OP( OP_INDIRECT_OBJ )
+			var_a = GetOperand( op->a, op->localA );
+			var_c = GetOperand( op->c, op->localC );
 			obj = GetScriptObject( *var_a.entityNumberPtr );
 			if ( !obj ) {
 				*var_c.entityNumberPtr = 0;
 			} else {
-				var.bytePtr = &obj->data[ st->b->value.ptrOffset ];
+				var.bytePtr = &obj->data[ op->b.ptrOffset ];
 				*var_c.entityNumberPtr = *var.entityNumberPtr;
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_PUSH_F:
-			var_a = GetVariable( st->a );
+		SCRIPT_OP( OP_PUSH_F )
+			var_a = GetOperand( op->a, op->localA );
 			Push( *var_a.intPtr );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_PUSH_FTOS:
-			var_a = GetVariable( st->a );
+		SCRIPT_OP( OP_PUSH_FTOS )
+			var_a = GetOperand( op->a, op->localA );
 			PushString( FloatToString( *var_a.floatPtr ) );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_PUSH_BTOF:
-			var_a = GetVariable( st->a );
+		SCRIPT_OP( OP_PUSH_BTOF )
+			var_a = GetOperand( op->a, op->localA );
 			floatVal = *var_a.intPtr;
 			Push( *reinterpret_cast<int *>( &floatVal ) );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_PUSH_FTOB:
-			var_a = GetVariable( st->a );
+		SCRIPT_OP( OP_PUSH_FTOB )
+			var_a = GetOperand( op->a, op->localA );
 			if ( *var_a.floatPtr != 0.0f ) {
 				Push( 1 );
 			} else {
 				Push( 0 );
 			}
-			break;
+			SCRIPT_NEXT();
 
-		case OP_PUSH_VTOS:
-			var_a = GetVariable( st->a );
+		SCRIPT_OP( OP_PUSH_VTOS )
+			var_a = GetOperand( op->a, op->localA );
 			PushString( var_a.vectorPtr->ToString() );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_PUSH_BTOS:
-			var_a = GetVariable( st->a );
+		SCRIPT_OP( OP_PUSH_BTOS )
+			var_a = GetOperand( op->a, op->localA );
 			PushString( *var_a.intPtr ? "true" : "false" );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_PUSH_ENT:
-			var_a = GetVariable( st->a );
+		SCRIPT_OP( OP_PUSH_ENT )
+			var_a = GetOperand( op->a, op->localA );
 			Push( *var_a.entityNumberPtr );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_PUSH_S:
-			PushString( GetString( st->a ) );
-			break;
+		SCRIPT_OP( OP_PUSH_S )
+			var_a = GetOperand( op->a, op->localA );
+			PushString( var_a.stringPtr );
+			SCRIPT_NEXT();
 
-		case OP_PUSH_V:
-			var_a = GetVariable( st->a );
+		SCRIPT_OP( OP_PUSH_V )
+			var_a = GetOperand( op->a, op->localA );
 			PushVector(*var_a.vectorPtr);
-			break;
+			SCRIPT_NEXT();
 
-		case OP_PUSH_OBJ:
-			var_a = GetVariable( st->a );
+		SCRIPT_OP( OP_PUSH_OBJ )
+			var_a = GetOperand( op->a, op->localA );
 			Push( *var_a.entityNumberPtr );
-			break;
+			SCRIPT_NEXT();
 
-		case OP_PUSH_OBJENT:
-			var_a = GetVariable( st->a );
+		SCRIPT_OP( OP_PUSH_OBJENT )
+			var_a = GetOperand( op->a, op->localA );
 			Push( *var_a.entityNumberPtr );
-			break;
+			SCRIPT_NEXT();
+
+		// superinstructions, see FusedOpcode in Script_Program.cpp
+
+		SCRIPT_OP( OP_EQ_F_IF )
+		SCRIPT_OP( OP_EQ_F_IFNOT )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
+			result = ( *var_a.floatPtr == *var_b.floatPtr );
+			*var_c.floatPtr = result;
+			FusedJump( op, result, op->op == OP_EQ_F_IF );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_NE_F_IF )
+		SCRIPT_OP( OP_NE_F_IFNOT )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
+			result = ( *var_a.floatPtr != *var_b.floatPtr );
+			*var_c.floatPtr = result;
+			FusedJump( op, result, op->op == OP_NE_F_IF );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_LT_IF )
+		SCRIPT_OP( OP_LT_IFNOT )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
+			result = ( *var_a.floatPtr < *var_b.floatPtr );
+			*var_c.floatPtr = result;
+			FusedJump( op, result, op->op == OP_LT_IF );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_LE_IF )
+		SCRIPT_OP( OP_LE_IFNOT )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
+			result = ( *var_a.floatPtr <= *var_b.floatPtr );
+			*var_c.floatPtr = result;
+			FusedJump( op, result, op->op == OP_LE_IF );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_GT_IF )
+		SCRIPT_OP( OP_GT_IFNOT )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
+			result = ( *var_a.floatPtr > *var_b.floatPtr );
+			*var_c.floatPtr = result;
+			FusedJump( op, result, op->op == OP_GT_IF );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_GE_IF )
+		SCRIPT_OP( OP_GE_IFNOT )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
+			result = ( *var_a.floatPtr >= *var_b.floatPtr );
+			*var_c.floatPtr = result;
+			FusedJump( op, result, op->op == OP_GE_IF );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_EQ_E_IF )
+		SCRIPT_OP( OP_EQ_E_IFNOT )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
+			result = ( *var_a.entityNumberPtr == *var_b.entityNumberPtr );
+			*var_c.floatPtr = result;
+			FusedJump( op, result, op->op == OP_EQ_E_IF );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_NE_E_IF )
+		SCRIPT_OP( OP_NE_E_IFNOT )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
+			result = ( *var_a.entityNumberPtr != *var_b.entityNumberPtr );
+			*var_c.floatPtr = result;
+			FusedJump( op, result, op->op == OP_NE_E_IF );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_AND_IF )
+		SCRIPT_OP( OP_AND_IFNOT )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
+			result = ( ( *var_a.floatPtr != 0.0f ) && ( *var_b.floatPtr != 0.0f ) );
+			*var_c.floatPtr = result;
+			FusedJump( op, result, op->op == OP_AND_IF );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_OR_IF )
+		SCRIPT_OP( OP_OR_IFNOT )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
+			result = ( ( *var_a.floatPtr != 0.0f ) || ( *var_b.floatPtr != 0.0f ) );
+			*var_c.floatPtr = result;
+			FusedJump( op, result, op->op == OP_OR_IF );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_NOT_F_IF )
+		SCRIPT_OP( OP_NOT_F_IFNOT )
+			var_a = GetOperand( op->a, op->localA );
+			var_c = GetOperand( op->c, op->localC );
+			result = ( *var_a.floatPtr == 0.0f );
+			*var_c.floatPtr = result;
+			FusedJump( op, result, op->op == OP_NOT_F_IF );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_NOT_BOOL_IF )
+		SCRIPT_OP( OP_NOT_BOOL_IFNOT )
+			var_a = GetOperand( op->a, op->localA );
+			var_c = GetOperand( op->c, op->localC );
+			result = ( *var_a.intPtr == 0 );
+			*var_c.floatPtr = result;
+			FusedJump( op, result, op->op == OP_NOT_BOOL_IF );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_NOT_ENT_IF )
+		SCRIPT_OP( OP_NOT_ENT_IFNOT )
+			var_a = GetOperand( op->a, op->localA );
+			var_c = GetOperand( op->c, op->localC );
+			result = ( GetEntity( *var_a.entityNumberPtr ) == NULL );
+			*var_c.floatPtr = result;
+			FusedJump( op, result, op->op == OP_NOT_ENT_IF );
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_ADD_F_STORE )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
+			*var_c.floatPtr = *var_a.floatPtr + *var_b.floatPtr;
+			var = GetOperand( op[ 1 ].b, op[ 1 ].localB );
+			*var.floatPtr = *var_c.floatPtr;
+			instructionPointer++;
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_SUB_F_STORE )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
+			*var_c.floatPtr = *var_a.floatPtr - *var_b.floatPtr;
+			var = GetOperand( op[ 1 ].b, op[ 1 ].localB );
+			*var.floatPtr = *var_c.floatPtr;
+			instructionPointer++;
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_MUL_F_STORE )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
+			*var_c.floatPtr = *var_a.floatPtr * *var_b.floatPtr;
+			var = GetOperand( op[ 1 ].b, op[ 1 ].localB );
+			*var.floatPtr = *var_c.floatPtr;
+			instructionPointer++;
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_ADD_V_STORE )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
+			*var_c.vectorPtr = *var_a.vectorPtr + *var_b.vectorPtr;
+			var = GetOperand( op[ 1 ].b, op[ 1 ].localB );
+			*var.vectorPtr = *var_c.vectorPtr;
+			instructionPointer++;
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_SUB_V_STORE )
+			var_a = GetOperand( op->a, op->localA );
+			var_b = GetOperand( op->b, op->localB );
+			var_c = GetOperand( op->c, op->localC );
+			*var_c.vectorPtr = *var_a.vectorPtr - *var_b.vectorPtr;
+			var = GetOperand( op[ 1 ].b, op[ 1 ].localB );
+			*var.vectorPtr = *var_c.vectorPtr;
+			instructionPointer++;
+			SCRIPT_NEXT();
 
-		case OP_BREAK:
-		case OP_CONTINUE:
-		default:
-			Error( "Bad opcode %i", st->op );
-			break;
+		SCRIPT_OP( OP_PUSH_PAIR )
+			var_a = GetOperand( op->a, op->localA );
+			Push( *var_a.intPtr );
+			var_a = GetOperand( op[ 1 ].a, op[ 1 ].localA );
+			Push( *var_a.intPtr );
+			instructionPointer++;
+			SCRIPT_NEXT();
+
+		SCRIPT_OP( OP_BREAK )
+		SCRIPT_OP( OP_CONTINUE )
+		SCRIPT_BAD_OP
+			Error( "Bad opcode %i", op->op );
+			SCRIPT_NEXT();
+#ifdef SCRIPT_COMPUTED_GOTO
+		label_debug:
+			DebugStatement();
+			goto *opLabels[ op->baseOp ];
+	}
+
+finished:
+#else
 		}
 	}
+#endif
+
+	if ( profiled ) {
+		ScriptProfileSwitch( profileCaller );
+	}
 
 	return threadDying;
 }
@@ -27,7 +27,9 @@ If you have questions concerning this license or the applicable additional terms
 */
 
 #include "sys/platform.h"
+#include "idlib/hashing/CRC32.h"
 #include "idlib/hashing/MD4.h"
+#include "idlib/Timer.h"
 #include "framework/FileSystem.h"
 
 #include "gamesys/Event.h"
@@ -1742,6 +1744,134 @@ void idProgram::Disassemble( void ) const {
 	fileSystem->CloseFile( file );
 }
 
+/*
+==============
+DecodeOperand
+==============
+*/
+static void DecodeOperand( const idVarDef *def, varEval_t &value, bool &local ) {
+	value.intPtr = NULL;
+	local = false;
+	if ( !def ) {
+		return;
+	}
+	if ( def->initialized == idVarDef::stackVariable ) {
+		value.stackOffset = def->value.stackOffset;
+		local = true;
+	} else {
+		value = def->value;
+	}
+}
+
+/*
+==============
+FusedOpcode
+
+Returns the superinstruction that does the statement together with the next
+one, or the opcode of the statement when they don't fuse.  The next statement
+still gets decoded on its own, so jumps to it work as before.
+==============
+*/
+static int FusedOpcode( const statement_t &st, const statement_t &next ) {
+	if ( ( next.op == OP_IF ) || ( next.op == OP_IFNOT ) ) {
+		int fused;
+
+		if ( !st.c || ( next.a != st.c ) ) {
+			return st.op;
+		}
+
+		switch( st.op ) {
+		case OP_EQ_F :		fused = OP_EQ_F_IF; break;
+		case OP_NE_F :		fused = OP_NE_F_IF; break;
+		case OP_LT :		fused = OP_LT_IF; break;
+		case OP_LE :		fused = OP_LE_IF; break;
+		case OP_GT :		fused = OP_GT_IF; break;
+		case OP_GE :		fused = OP_GE_IF; break;
+		case OP_EQ_E :
+		case OP_EQ_EO :
+		case OP_EQ_OE :
+		case OP_EQ_OO :		fused = OP_EQ_E_IF; break;
+		case OP_NE_E :
+		case OP_NE_EO :
+		case OP_NE_OE :
+		case OP_NE_OO :		fused = OP_NE_E_IF; break;
+		case OP_AND :		fused = OP_AND_IF; break;
+		case OP_OR :		fused = OP_OR_IF; break;
+		case OP_NOT_F :		fused = OP_NOT_F_IF; break;
+		case OP_NOT_BOOL :	fused = OP_NOT_BOOL_IF; break;
+		case OP_NOT_ENT :	fused = OP_NOT_ENT_IF; break;
+		default :			return st.op;
+		}
+
+		return ( next.op == OP_IF ) ? fused : fused + 1;
+	}
+
+	if ( next.op == OP_STORE_F && st.c && next.a == st.c ) {
+		switch( st.op ) {
+		case OP_ADD_F :		return OP_ADD_F_STORE;
+		case OP_SUB_F :		return OP_SUB_F_STORE;
+		case OP_MUL_F :		return OP_MUL_F_STORE;
+		default :			return st.op;
+		}
+	}
+
+	if ( next.op == OP_STORE_V && st.c && next.a == st.c ) {
+		switch( st.op ) {
+		case OP_ADD_V :		return OP_ADD_V_STORE;
+		case OP_SUB_V :		return OP_SUB_V_STORE;
+		default :			return st.op;
+		}
+	}
+
+	switch( st.op ) {
+	case OP_PUSH_F :
+	case OP_PUSH_ENT :
+	case OP_PUSH_OBJ :
+	case OP_PUSH_OBJENT :
+		switch( next.op ) {
+		case OP_PUSH_F :
+		case OP_PUSH_ENT :
+		case OP_PUSH_OBJ :
+		case OP_PUSH_OBJENT :
+			return OP_PUSH_PAIR;
+		}
+		break;
+	}
+
+	return st.op;
+}
+
+/*
+==============
+idProgram::DecodeStatements
+
+Decodes the statements added since the last call for the interpreter.  The
+last statement decoded before is done again, since it may fuse with the first
+new one.  Called whenever compiling or loading adds statements, so decoding
+never happens while a thread runs.
+==============
+*/
+void idProgram::DecodeStatements( void ) {
+	int i;
+
+	i = Max( decoded.Num() - 1, 0 );
+	decoded.SetNum( statements.Num() );
+	for( ; i < statements.Num(); i++ ) {
+		const statement_t &st = statements[ i ];
+		scriptOp_t &op = decoded[ i ];
+
+		op.baseOp = st.op;
+		if ( i + 1 < statements.Num() ) {
+			op.op = FusedOpcode( st, statements[ i + 1 ] );
+		} else {
+			op.op = st.op;
+		}
+		DecodeOperand( st.a, op.a, op.localA );
+		DecodeOperand( st.b, op.b, op.localB );
+		DecodeOperand( st.c, op.c, op.localC );
+	}
+}
+
 /*
 ==============
 idProgram::FinishCompilation
@@ -1758,6 +1888,8 @@ void idProgram::FinishCompilation( void ) {
 	top_defs		= varDefs.Num();
 	top_files		= fileList.Num();
 
+	DecodeStatements();
+
 	variableDefaults.Clear();
 	variableDefaults.SetNum( numVariables );
 
@@ -1830,13 +1962,14 @@ bool idProgram::CompileText( const char *source, const char *text, bool console
 	int			i;
 	idVarDef	*def;
 	idStr		ospath;
+	idStrList	includes;
 
 	// use a full os path for GetFilenum since it calls OSPathToRelativePath to convert filenames from the parser
 	ospath = fileSystem->RelativePathToOSPath( source );
 	filenum = GetFilenum( ospath );
 
 	try {
-		compiler.CompileFile( text, filename, console );
+		compiler.CompileFile( text, filename, console, &includes );
 
 		// check to make sure all functions prototyped have code
 		for( i = 0; i < varDefs.Num(); i++ ) {
@@ -1852,13 +1985,21 @@ bool idProgram::CompileText( const char *source, const char *text, bool console
 	catch( idCompileError &err ) {
 		if ( console ) {
 			gameLocal.Printf( "%s\n", err.error );
+			DecodeStatements();
 			return false;
 		} else {
 			gameLocal.Error( "%s\n", err.error );
 		}
 	};
 
+	DecodeStatements();
+
 	if ( !console ) {
+		// every file read for the text, for the compiled script cache
+		sourceFiles.AddUnique( source );
+		for( i = 0; i < includes.Num(); i++ ) {
+			sourceFiles.AddUnique( includes[ i ] );
+		}
 		CompileStats();
 	}
 
@@ -1944,7 +2085,9 @@ void idProgram::FreeData( void ) {
 
 	filename.Clear();
 	fileList.Clear();
+	sourceFiles.Clear();
 	statements.Clear();
+	decoded.Clear();
 	functions.Clear();
 
 	top_functions	= 0;
@@ -1972,12 +2115,663 @@ void idProgram::Startup( const char *defaultScript ) {
 
 	// load the default script
 	if ( defaultScript && *defaultScript ) {
-		CompileFile( defaultScript );
+		if ( LoadCompiled( defaultScript ) ) {
+			CompileStats();
+			if ( g_disasm.GetBool() ) {
+				Disassemble();
+			}
+		} else {
+			CompileFile( defaultScript );
+			SaveCompiled( defaultScript );
+		}
 	}
 
 	FinishCompilation();
 }
 
+/*
+================
+Compiled script cache
+
+The default script is written to <name>.bscript after it has been compiled.
+Types, defs and functions are stored by index, with the built-in types and
+defs in front, so the program can be rebuilt without running the compiler.
+The cache is used as long as every source file the parser read, including
+the ones that only hold defines, is unchanged and the game code has the
+same events and opcodes.
+================
+*/
+
+#define SCRIPT_CACHE_ID				( ( 'T' << 24 ) | ( 'P' << 16 ) | ( 'C' << 8 ) | 'S' )
+#define SCRIPT_CACHE_VERSION		2
+
+typedef struct {
+	int						ident;
+	int						version;
+	unsigned int			buildChecksum;
+	int						payloadLength;
+	unsigned int			payloadCRC;
+} scriptCacheHeader_t;
+
+// how the value of a def is stored
+typedef enum {
+	SCRIPT_CACHE_VALUE_INT,				// stack offset, field offset, jump offset, arg size or virtual function number
+	SCRIPT_CACHE_VALUE_VARIABLE,		// offset in the global variables
+	SCRIPT_CACHE_VALUE_FUNCTION			// function number
+} scriptCacheValue_t;
+
+static idTypeDef *scriptCacheTypes[] = {
+	&type_void, &type_scriptevent, &type_namespace, &type_string, &type_float, &type_vector, &type_entity, &type_field,
+	&type_function, &type_virtualfunction, &type_pointer, &type_object, &type_jumpoffset, &type_argsize, &type_boolean
+};
+
+static idVarDef *scriptCacheDefs[] = {
+	&def_void, &def_scriptevent, &def_namespace, &def_string, &def_float, &def_vector, &def_entity, &def_field,
+	&def_function, &def_virtualfunction, &def_pointer, &def_object, &def_jumpoffset, &def_argsize, &def_boolean
+};
+
+static const int NUM_SCRIPT_CACHE_TYPES = sizeof( scriptCacheTypes ) / sizeof( scriptCacheTypes[0] );
+static const int NUM_SCRIPT_CACHE_DEFS = sizeof( scriptCacheDefs ) / sizeof( scriptCacheDefs[0] );
+
+/*
+================
+ScriptCacheName
+================
+*/
+static idStr ScriptCacheName( const char *filename ) {
+	idStr cacheName = filename;
+	cacheName.SetFileExtension( "bscript" );
+	return cacheName;
+}
+
+/*
+================
+ScriptCacheBuildChecksum
+
+The compiled code refers to events and opcodes by number and depends on
+the sizes of the script types.
+================
+*/
+static unsigned int ScriptCacheBuildChecksum( void ) {
+	idStr build;
+	int i;
+
+	sprintf( build, "%d %d %d %d %d %zd", MAX_STRING_LEN, MAX_GLOBALS, MAX_FUNCS, MAX_STATEMENTS, E_EVENT_SIZEOF_VEC, sizeof( intptr_t ) );
+	for ( i = 0; idCompiler::opcodes[ i ].name; i++ ) {
+		build += " ";
+		build += idCompiler::opcodes[ i ].opname;
+	}
+	for ( i = 0; i < idEventDef::NumEventCommands(); i++ ) {
+		const idEventDef *ev = idEventDef::GetEventCommand( i );
+		build += va( " %s(%s)%c", ev->GetName(), ev->GetArgFormat(), ev->GetReturnType() ? ev->GetReturnType() : '0' );
+	}
+
+	return MD4_BlockChecksum( build.c_str(), build.Length() );
+}
+
+/*
+================
+ScriptCacheTypeKey
+================
+*/
+static int ScriptCacheTypeKey( const idTypeDef *type ) {
+	return (int)( ( (intptr_t)type ) >> 3 );
+}
+
+/*
+================
+idProgram::TypeRef
+================
+*/
+int idProgram::TypeRef( const idTypeDef *type, const idHashIndex &typeHash ) const {
+	int i;
+
+	if ( !type ) {
+		return -1;
+	}
+	for ( i = 0; i < NUM_SCRIPT_CACHE_TYPES; i++ ) {
+		if ( scriptCacheTypes[ i ] == type ) {
+			return i;
+		}
+	}
+	for ( i = typeHash.First( ScriptCacheTypeKey( type ) ); i != -1; i = typeHash.Next( i ) ) {
+		if ( types[ i ] == type ) {
+			return NUM_SCRIPT_CACHE_TYPES + i;
+		}
+	}
+
+	// not a type of this program
+	return -2;
+}
+
+/*
+================
+idProgram::TypeForRef
+================
+*/
+idTypeDef *idProgram::TypeForRef( int ref, bool &ok ) const {
+	if ( ref == -1 ) {
+		return NULL;
+	}
+	if ( ref >= 0 && ref < NUM_SCRIPT_CACHE_TYPES ) {
+		return scriptCacheTypes[ ref ];
+	}
+	ref -= NUM_SCRIPT_CACHE_TYPES;
+	if ( ref >= 0 && ref < types.Num() ) {
+		return types[ ref ];
+	}
+	ok = false;
+	return NULL;
+}
+
+/*
+================
+idProgram::DefRef
+================
+*/
+int idProgram::DefRef( const idVarDef *def ) const {
+	int i;
+
+	if ( !def ) {
+		return -1;
+	}
+	for ( i = 0; i < NUM_SCRIPT_CACHE_DEFS; i++ ) {
+		if ( scriptCacheDefs[ i ] == def ) {
+			return i;
+		}
+	}
+	if ( def->num >= 0 && def->num < varDefs.Num() && varDefs[ def->num ] == def ) {
+		return NUM_SCRIPT_CACHE_DEFS + def->num;
+	}
+
+	// not a def of this program
+	return -2;
+}
+
+/*
+================
+idProgram::DefForRef
+================
+*/
+idVarDef *idProgram::DefForRef( int ref, bool &ok ) const {
+	if ( ref == -1 ) {
+		return NULL;
+	}
+	if ( ref >= 0 && ref < NUM_SCRIPT_CACHE_DEFS ) {
+		return scriptCacheDefs[ ref ];
+	}
+	ref -= NUM_SCRIPT_CACHE_DEFS;
+	if ( ref >= 0 && ref < varDefs.Num() ) {
+		return varDefs[ ref ];
+	}
+	ok = false;
+	return NULL;
+}
+
+/*
+================
+idProgram::SaveCompiled
+
+Writes the program as compiled from a single file, before anything else is
+added to it.  Nothing is written if a reference can't be expressed as an index.
+================
+*/
+void idProgram::SaveCompiled( const char *filename ) const {
+	scriptCacheHeader_t	header;
+	idHashIndex			typeHash;
+	int					i, j, ref;
+	bool				ok;
+
+	if ( !g_scriptCache.GetBool() ) {
+		return;
+	}
+
+	idFile_Memory f( filename );
+
+	// the sources, so a changed file can be detected before anything is rebuilt
+	f.WriteInt( sourceFiles.Num() );
+	for ( i = 0; i < sourceFiles.Num(); i++ ) {
+		void *buffer;
+		int length = fileSystem->ReadFile( sourceFiles[ i ], &buffer );
+		if ( !buffer ) {
+			gameLocal.DPrintf( "not caching %s, can't read %s\n", filename, sourceFiles[ i ].c_str() );
+			return;
+		}
+		f.WriteString( sourceFiles[ i ] );
+		f.WriteInt( length );
+		f.WriteUnsignedInt( MD4_BlockChecksum( buffer, length ) );
+		fileSystem->FreeFile( buffer );
+	}
+
+	// the file names the statements refer to
+	f.WriteInt( fileList.Num() );
+	for ( i = 0; i < fileList.Num(); i++ ) {
+		f.WriteString( fileList[ i ] );
+	}
+
+	f.WriteInt( numVariables );
+	f.Write( variables, numVariables );
+
+	f.WriteInt( types.Num() );
+	f.WriteInt( varDefs.Num() );
+	f.WriteInt( functions.Num() );
+	f.WriteInt( statements.Num() );
+	f.WriteInt( varDefNames.Num() );
+
+	for ( i = 0; i < types.Num(); i++ ) {
+		typeHash.Add( ScriptCacheTypeKey( types[ i ] ), i );
+	}
+
+	ok = true;
+	for ( i = 0; i < types.Num() && ok; i++ ) {
+		const idTypeDef *type = types[ i ];
+
+		f.WriteInt( type->type );
+		f.WriteString( type->name );
+		f.WriteInt( type->size );
+		f.WriteInt( ref = TypeRef( type->auxType, typeHash ) );
+		ok &= ( ref >= -1 );
+		f.WriteInt( ref = DefRef( type->def ) );
+		ok &= ( ref >= -1 );
+		f.WriteInt( type->parmTypes.Num() );
+		for ( j = 0; j < type->parmTypes.Num(); j++ ) {
+			f.WriteInt( ref = TypeRef( type->parmTypes[ j ], typeHash ) );
+			ok &= ( ref >= -1 );
+			f.WriteString( type->parmNames[ j ] );
+		}
+		f.WriteInt( type->functions.Num() );
+		for ( j = 0; j < type->functions.Num(); j++ ) {
+			f.WriteInt( type->functions[ j ] - functions.Ptr() );
+		}
+	}
+
+	for ( i = 0; i < varDefs.Num() && ok; i++ ) {
+		const idVarDef *def = varDefs[ i ];
+
+		f.WriteInt( ref = TypeRef( def->TypeDef(), typeHash ) );
+		ok &= ( ref >= -1 );
+		f.WriteInt( ref = DefRef( def->scope ) );
+		ok &= ( ref >= -1 );
+		f.WriteInt( def->numUsers );
+		f.WriteInt( def->initialized );
+
+		// the value is a union, so work out which member is in use the same way AllocDef did
+		const function_t *func = def->value.functionPtr;
+		if ( def->Type() == ev_function && func >= functions.Ptr() && func < functions.Ptr() + functions.Num() ) {
+			f.WriteInt( SCRIPT_CACHE_VALUE_FUNCTION );
+			f.WriteInt( func - functions.Ptr() );
+		} else if ( def->initialized == idVarDef::stackVariable || def->Type() == ev_jumpoffset || def->Type() == ev_argsize || def->Type() == ev_virtualfunction ||
+						( def->scope && def->scope->TypeDef()->Inherits( &type_object ) ) ) {
+			f.WriteInt( SCRIPT_CACHE_VALUE_INT );
+			f.WriteInt( def->value.stackOffset );
+		} else if ( def->value.bytePtr >= variables && def->value.bytePtr <= variables + numVariables ) {
+			f.WriteInt( SCRIPT_CACHE_VALUE_VARIABLE );
+			f.WriteInt( def->value.bytePtr - variables );
+		} else {
+			ok = false;
+		}
+	}
+
+	for ( i = 0; i < functions.Num() && ok; i++ ) {
+		const function_t &func = functions[ i ];
+
+		f.WriteString( func.Name() );
+		f.WriteString( func.eventdef ? func.eventdef->GetName() : "" );
+		f.WriteInt( ref = DefRef( func.def ) );
+		ok &= ( ref >= -1 );
+		f.WriteInt( ref = TypeRef( func.type, typeHash ) );
+		ok &= ( ref >= -1 );
+		f.WriteInt( func.firstStatement );
+		f.WriteInt( func.numStatements );
+		f.WriteInt( func.parmTotal );
+		f.WriteInt( func.locals );
+		f.WriteInt( func.filenum );
+		f.WriteInt( func.parmSize.Num() );
+		for ( j = 0; j < func.parmSize.Num(); j++ ) {
+			f.WriteInt( func.parmSize[ j ] );
+		}
+	}
+
+	for ( i = 0; i < statements.Num() && ok; i++ ) {
+		const statement_t &statement = statements[ i ];
+		int a = DefRef( statement.a );
+		int b = DefRef( statement.b );
+		int c = DefRef( statement.c );
+
+		f.WriteUnsignedShort( statement.op );
+		f.WriteUnsignedShort( statement.flags );
+		f.WriteUnsignedShort( statement.linenumber );
+		f.WriteUnsignedShort( statement.file );
+		f.WriteInt( a );
+		f.WriteInt( b );
+		f.WriteInt( c );
+		ok &= ( a >= -1 && b >= -1 && c >= -1 );
+	}
+
+	// defs with the same name are chained, newest first
+	for ( i = 0; i < varDefNames.Num() && ok; i++ ) {
+		const idVarDef *def;
+
+		f.WriteString( varDefNames[ i ]->Name() );
+		for ( j = 0, def = varDefNames[ i ]->GetDefs(); def; def = def->Next() ) {
+			j++;
+		}
+		f.WriteInt( j );
+		for ( def = varDefNames[ i ]->GetDefs(); def; def = def->Next() ) {
+			f.WriteInt( def->num );
+		}
+	}
+
+	f.WriteInt( DefRef( returnDef ) );
+	f.WriteInt( DefRef( returnStringDef ) );
+	f.WriteInt( DefRef( sysDef ) );
+
+	if ( !ok ) {
+		gameLocal.Warning( "couldn't cache the compiled %s", filename );
+		return;
+	}
+
+	idStr cacheName = ScriptCacheName( filename );
+	idFile *file = fileSystem->OpenFileWrite( cacheName );
+	if ( !file ) {
+		gameLocal.Warning( "couldn't write %s", cacheName.c_str() );
+		return;
+	}
+
+	memset( &header, 0, sizeof( header ) );
+	header.ident = SCRIPT_CACHE_ID;
+	header.version = SCRIPT_CACHE_VERSION;
+	header.buildChecksum = ScriptCacheBuildChecksum();
+	header.payloadLength = f.Length();
+	header.payloadCRC = CRC32_BlockChecksum( f.GetDataPtr(), f.Length() );
+
+	file->Write( &header, sizeof( header ) );
+	file->Write( f.GetDataPtr(), f.Length() );
+
+	fileSystem->CloseFile( file );
+}
+
+/*
+================
+idProgram::LoadCompiled
+
+Rebuilds the program from the cache written by SaveCompiled.  Expects to be
+called right after BeginCompilation, and leaves the program in that state
+when the cache can't be used.
+================
+*/
+bool idProgram::LoadCompiled( const char *filename ) {
+	scriptCacheHeader_t	header;
+	idTimer				loadTime;
+	void *				buffer;
+	idStr				name;
+	int					i, j, num, length, ref;
+	int					numTypes, numDefs, numFunctions, numStatements, numNames;
+	bool				ok;
+
+	if ( !g_scriptCache.GetBool() ) {
+		return false;
+	}
+
+	loadTime.Start();
+
+	idStr cacheName = ScriptCacheName( filename );
+	length = fileSystem->ReadFile( cacheName, &buffer );
+	if ( !buffer ) {
+		return false;
+	}
+
+	if ( length < (int)sizeof( header ) ) {
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+	memcpy( &header, buffer, sizeof( header ) );
+
+	const char *payload = (const char *)buffer + sizeof( header );
+	if ( header.ident != SCRIPT_CACHE_ID || header.version != SCRIPT_CACHE_VERSION || header.buildChecksum != ScriptCacheBuildChecksum() ||
+			header.payloadLength != length - (int)sizeof( header ) || CRC32_BlockChecksum( payload, header.payloadLength ) != header.payloadCRC ) {
+		gameLocal.DPrintf( "ignoring out of date %s\n", cacheName.c_str() );
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
+	idFile_Memory f( cacheName, payload, header.payloadLength );
+
+	// make sure none of the sources changed
+	idStrList sources;
+	f.ReadInt( num );
+	for ( i = 0; i < num; i++ ) {
+		void *source;
+		int sourceLength, checksum;
+
+		f.ReadString( name );
+		f.ReadInt( sourceLength );
+		f.ReadInt( checksum );
+
+		int readLength = fileSystem->ReadFile( name, &source );
+		if ( !source ) {
+			break;
+		}
+		ok = ( readLength == sourceLength && MD4_BlockChecksum( source, readLength ) == (unsigned int)checksum );
+		fileSystem->FreeFile( source );
+		if ( !ok ) {
+			break;
+		}
+		sources.Append( name );
+	}
+	if ( num <= 0 || sources.Num() != num ) {
+		gameLocal.DPrintf( "%s changed, recompiling\n", num > 0 ? name.c_str() : filename );
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
+	FreeData();
+
+	sourceFiles = sources;
+
+	f.ReadInt( num );
+	ok = ( num >= 0 && num <= header.payloadLength / 4 );
+	fileList.SetNum( ok ? num : 0 );
+	for ( i = 0; i < fileList.Num(); i++ ) {
+		f.ReadString( fileList[ i ] );
+	}
+
+	f.ReadInt( numVariables );
+	ok &= ( numVariables >= 0 && numVariables <= (int)sizeof( variables ) );
+	if ( ok ) {
+		f.Read( variables, numVariables );
+	}
+
+	f.ReadInt( numTypes );
+	f.ReadInt( numDefs );
+	f.ReadInt( numFunctions );
+	f.ReadInt( numStatements );
+	f.ReadInt( numNames );
+	ok &= ( numTypes >= 0 && numTypes <= header.payloadLength && numDefs >= 0 && numDefs <= header.payloadLength && numNames >= 0 && numNames <= numDefs );
+	ok &= ( numFunctions >= 0 && numFunctions <= functions.Max() && numStatements > 0 && numStatements <= statements.Max() );
+
+	// allocate everything first, so the references can be resolved in one pass
+	if ( ok ) {
+		for ( i = 0; i < numTypes; i++ ) {
+			AllocType( ev_void, NULL, "", 0, NULL );
+		}
+		for ( i = 0; i < numDefs; i++ ) {
+			idVarDef *def = new idVarDef();
+			def->num = varDefs.Append( def );
+		}
+		functions.SetNum( numFunctions );
+		statements.SetNum( numStatements );
+
+		// the cache replaces every statement, decode them all once it's read
+		decoded.Clear();
+	}
+
+	for ( i = 0; i < types.Num() && ok; i++ ) {
+		idTypeDef *type = types[ i ];
+		int etype;
+
+		f.ReadInt( etype );
+		f.ReadString( type->name );
+		f.ReadInt( type->size );
+		type->type = (etype_t)etype;
+		f.ReadInt( ref );
+		type->auxType = TypeForRef( ref, ok );
+		f.ReadInt( ref );
+		type->def = DefForRef( ref, ok );
+
+		f.ReadInt( num );
+		ok &= ( num >= 0 && num <= header.payloadLength );
+		for ( j = 0; j < num && ok; j++ ) {
+			f.ReadInt( ref );
+			type->parmTypes.Append( TypeForRef( ref, ok ) );
+			f.ReadString( type->parmNames.Alloc() );
+		}
+
+		f.ReadInt( num );
+		ok &= ( num >= 0 && num <= header.payloadLength );
+		for ( j = 0; j < num && ok; j++ ) {
+			f.ReadInt( ref );
+			ok &= ( ref >= 0 && ref < functions.Num() );
+			if ( ok ) {
+				type->functions.Append( &functions[ ref ] );
+			}
+		}
+	}
+
+	for ( i = 0; i < varDefs.Num() && ok; i++ ) {
+		idVarDef *def = varDefs[ i ];
+		int initialized, valueType, value;
+
+		f.ReadInt( ref );
+		def->SetTypeDef( TypeForRef( ref, ok ) );
+		f.ReadInt( ref );
+		def->scope = DefForRef( ref, ok );
+		f.ReadInt( def->numUsers );
+		f.ReadInt( initialized );
+		def->initialized = (idVarDef::initialized_t)initialized;
+
+		f.ReadInt( valueType );
+		f.ReadInt( value );
+		if ( valueType == SCRIPT_CACHE_VALUE_FUNCTION && value >= 0 && value < functions.Num() ) {
+			def->value.functionPtr = &functions[ value ];
+		} else if ( valueType == SCRIPT_CACHE_VALUE_VARIABLE && value >= 0 && value <= numVariables ) {
+			def->value.bytePtr = &variables[ value ];
+		} else if ( valueType == SCRIPT_CACHE_VALUE_INT ) {
+			def->value.stackOffset = value;
+		} else {
+			ok = false;
+		}
+		ok &= ( def->TypeDef() != NULL );
+	}
+
+	for ( i = 0; i < functions.Num() && ok; i++ ) {
+		function_t &func = functions[ i ];
+
+		func.Clear();
+		func.parmSize.SetGranularity( 1 );
+
+		f.ReadString( name );
+		func.SetName( name );
+		f.ReadString( name );
+		if ( name.Length() ) {
+			func.eventdef = idEventDef::FindEvent( name );
+			ok &= ( func.eventdef != NULL );
+		}
+		f.ReadInt( ref );
+		func.def = DefForRef( ref, ok );
+		f.ReadInt( ref );
+		func.type = TypeForRef( ref, ok );
+		f.ReadInt( func.firstStatement );
+		f.ReadInt( func.numStatements );
+		f.ReadInt( func.parmTotal );
+		f.ReadInt( func.locals );
+		f.ReadInt( func.filenum );
+		ok &= ( func.firstStatement >= 0 && func.numStatements >= 0 && func.firstStatement + func.numStatements <= statements.Num() );
+
+		f.ReadInt( num );
+		ok &= ( num >= 0 && num <= header.payloadLength );
+		if ( ok ) {
+			func.parmSize.SetNum( num );
+			for ( j = 0; j < num; j++ ) {
+				f.ReadInt( func.parmSize[ j ] );
+			}
+		}
+	}
+
+	for ( i = 0; i < statements.Num() && ok; i++ ) {
+		statement_t &statement = statements[ i ];
+
+		f.ReadUnsignedShort( statement.op );
+		f.ReadUnsignedShort( statement.flags );
+		f.ReadUnsignedShort( statement.linenumber );
+		f.ReadUnsignedShort( statement.file );
+		f.ReadInt( ref );
+		statement.a = DefForRef( ref, ok );
+		f.ReadInt( ref );
+		statement.b = DefForRef( ref, ok );
+		f.ReadInt( ref );
+		statement.c = DefForRef( ref, ok );
+		ok &= ( statement.file < fileList.Num() );
+	}
+
+	// rebuild the name chains oldest first, so they end up in the same order
+	idList<bool> named;
+	named.SetNum( varDefs.Num() );
+	memset( named.Ptr(), 0, varDefs.Num() * sizeof( bool ) );
+	for ( i = 0; i < numNames && ok; i++ ) {
+		idList<int> defNums;
+
+		f.ReadString( name );
+		f.ReadInt( num );
+		ok &= ( num > 0 && num <= varDefs.Num() );
+		if ( !ok ) {
+			break;
+		}
+		defNums.SetNum( num );
+		for ( j = 0; j < num; j++ ) {
+			f.ReadInt( defNums[ j ] );
+			ok &= ( defNums[ j ] >= 0 && defNums[ j ] < varDefs.Num() && !named[ defNums[ j ] ] );
+			if ( ok ) {
+				named[ defNums[ j ] ] = true;
+			}
+		}
+		for ( j = num - 1; j >= 0 && ok; j-- ) {
+			AddDefToNameList( varDefs[ defNums[ j ] ], name );
+		}
+	}
+
+	if ( ok ) {
+		f.ReadInt( ref );
+		returnDef = DefForRef( ref, ok );
+		f.ReadInt( ref );
+		returnStringDef = DefForRef( ref, ok );
+		f.ReadInt( ref );
+		sysDef = DefForRef( ref, ok );
+	}
+
+	// every def needs a name
+	for ( i = 0; i < varDefs.Num() && ok; i++ ) {
+		ok = named[ i ];
+	}
+
+	ok &= ( f.Tell() == f.Length() && returnDef && returnStringDef && sysDef );
+
+	fileSystem->FreeFile( buffer );
+
+	if ( !ok ) {
+		gameLocal.Warning( "%s is corrupt", cacheName.c_str() );
+		BeginCompilation();
+		return false;
+	}
+
+	DecodeStatements();
+
+	loadTime.Stop();
+	gameLocal.Printf( "Loaded compiled '%s': %u ms\n", filename, loadTime.Milliseconds() );
+
+	return true;
+}
+
 /*
 ================
 idProgram::Save
@@ -2156,6 +2950,8 @@ void idProgram::Restart( void ) {
 	functions.SetNum( top_functions	);
 
 	statements.SetNum( top_statements );
+	decoded.SetNum( top_statements );
+	DecodeStatements();
 	fileList.SetNum( top_files, false );
 	filename.Clear();
 
@@ -30,6 +30,8 @@ If you have questions concerning this license or the applicable additional terms
 #include "idlib/Heap.h"
 #include "framework/Common.h"
 #include "framework/FileSystem.h"
+#include "framework/CmdSystem.h"
+#include "idlib/Timer.h"
 
 #include "idlib/Lexer.h"
 
@@ -114,6 +116,46 @@ int default_punctuationtable[256];
 int default_nextpunctuation[sizeof(default_punctuations) / sizeof(punctuation_t)];
 int default_setup;
 
+// character classes used by the scanning loops
+#define LEXCHAR_SPACE			1		// white space, everything up to ' ' but the terminating zero
+#define LEXCHAR_NAMESTART		2		// a-z A-Z _
+#define LEXCHAR_NAME			4		// a-z A-Z 0-9 _
+#define LEXCHAR_PATH			8		// / \ : .
+#define LEXCHAR_DASH			16		// -
+
+class idLexerCharClass {
+public:
+	idLexerCharClass( void ) {
+		for ( int i = 0; i < 256; i++ ) {
+			int c = i;
+			bits[i] = 0;
+			// compare as plain char, so bytes above 127 are white space where char is signed, like before
+			if ( i && (char)i <= ' ' ) {
+				bits[i] |= LEXCHAR_SPACE;
+			}
+			if ( ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' ) || c == '_' ) {
+				bits[i] |= LEXCHAR_NAMESTART | LEXCHAR_NAME;
+			}
+			if ( c >= '0' && c <= '9' ) {
+				bits[i] |= LEXCHAR_NAME;
+			}
+			if ( c == '/' || c == '\\' || c == ':' || c == '.' ) {
+				bits[i] |= LEXCHAR_PATH;
+			}
+			if ( c == '-' ) {
+				bits[i] |= LEXCHAR_DASH;
+			}
+		}
+	}
+
+	byte	bits[256];
+};
+
+// set up during static initialization, so lexers on other threads never see it half done
+static idLexerCharClass lexerCharClass;
+
+#define LEXCHAR_IS( c, mask )	( lexerCharClass.bits[(byte)(c)] & (mask) )
+
 char idLexer::baseFolder[ 256 ];
 
 /*
@@ -289,27 +331,25 @@ When a newline character is found the scripts line counter is increased.
 int idLexer::ReadWhiteSpace( void ) {
 	while(1) {
 		// skip white space
-		while(*idLexer::script_p <= ' ') {
-			if (!*idLexer::script_p) {
-				return 0;
-			}
+		while( LEXCHAR_IS( *idLexer::script_p, LEXCHAR_SPACE ) ) {
 			if (*idLexer::script_p == '\n') {
 				idLexer::line++;
 			}
 			idLexer::script_p++;
 		}
+		if (!*idLexer::script_p) {
+			return 0;
+		}
 		// skip comments
 		if (*idLexer::script_p == '/') {
 			// comments //
 			if (*(idLexer::script_p+1) == '/') {
-				idLexer::script_p++;
-				do {
-					idLexer::script_p++;
-					if ( !*idLexer::script_p ) {
-						return 0;
-					}
+				// strcspn stops at the terminating zero as well and is vectorized by most C libraries
+				idLexer::script_p += 2;
+				idLexer::script_p += strcspn( idLexer::script_p, "\n" );
+				if ( !*idLexer::script_p ) {
+					return 0;
 				}
-				while( *idLexer::script_p != '\n' );
 				idLexer::line++;
 				idLexer::script_p++;
 				if ( !*idLexer::script_p ) {
@@ -322,13 +362,15 @@ int idLexer::ReadWhiteSpace( void ) {
 				idLexer::script_p++;
 				while( 1 ) {
 					idLexer::script_p++;
+					// jump to the next character that needs a look
+					idLexer::script_p += strcspn( idLexer::script_p, "\n/" );
 					if ( !*idLexer::script_p ) {
 						return 0;
 					}
 					if ( *idLexer::script_p == '\n' ) {
 						idLexer::line++;
 					}
-					else if ( *idLexer::script_p == '/' ) {
+					else {
 						if ( *(idLexer::script_p-1) == '*' ) {
 							break;
 						}
@@ -510,7 +552,12 @@ int idLexer::ReadString( idToken *token, int quote ) {
 				idLexer::Error( "newline inside string" );
 				return 0;
 			}
-			token->AppendDirty( *idLexer::script_p++ );
+			// copy the run of plain characters in one go
+			const char *start = idLexer::script_p;
+			do {
+				idLexer::script_p++;
+			} while ( *idLexer::script_p != quote && *idLexer::script_p != '\\' && *idLexer::script_p != '\n' && *idLexer::script_p != '\0' );
+			token->AppendDirty( start, idLexer::script_p - start );
 		}
 	}
 	token->data[token->len] = '\0';
@@ -536,20 +583,25 @@ idLexer::ReadName
 ================
 */
 int idLexer::ReadName( idToken *token ) {
-	char c;
+	const char *start;
+	int mask;
+
+	mask = LEXCHAR_NAME;
+	// if treating all tokens as strings, don't parse '-' as a seperate token
+	if ( idLexer::flags & LEXFL_ONLYSTRINGS ) {
+		mask |= LEXCHAR_DASH;
+	}
+	// if special path name characters are allowed
+	if ( idLexer::flags & LEXFL_ALLOWPATHNAMES ) {
+		mask |= LEXCHAR_PATH;
+	}
 
 	token->type = TT_NAME;
+	start = idLexer::script_p;
 	do {
-		token->AppendDirty( *idLexer::script_p++ );
-		c = *idLexer::script_p;
-	} while ((c >= 'a' && c <= 'z') ||
-				(c >= 'A' && c <= 'Z') ||
-				(c >= '0' && c <= '9') ||
-				c == '_' ||
-				// if treating all tokens as strings, don't parse '-' as a seperate token
-				((idLexer::flags & LEXFL_ONLYSTRINGS) && (c == '-')) ||
-				// if special path name characters are allowed
-				((idLexer::flags & LEXFL_ALLOWPATHNAMES) && (c == '/' || c == '\\' || c == ':' || c == '.')) );
+		idLexer::script_p++;
+	} while ( LEXCHAR_IS( *idLexer::script_p, mask ) );
+	token->AppendDirty( start, idLexer::script_p - start );
 	token->data[token->len] = '\0';
 	//the sub type is the length of the name
 	token->subtype = token->Length();
@@ -881,7 +933,7 @@ int idLexer::ReadToken( idToken *token ) {
 		// if names are allowed to start with a number
 		if ( idLexer::flags & LEXFL_ALLOWNUMBERNAMES ) {
 			c = *idLexer::script_p;
-			if ( (c >= 'a' && c <= 'z') ||	(c >= 'A' && c <= 'Z') || c == '_' ) {
+			if ( LEXCHAR_IS( c, LEXCHAR_NAMESTART ) ) {
 				if ( !idLexer::ReadName( token ) ) {
 					return 0;
 				}
@@ -895,7 +947,7 @@ int idLexer::ReadToken( idToken *token ) {
 		}
 	}
 	// if there is a name
-	else if ( (c >= 'a' && c <= 'z') ||	(c >= 'A' && c <= 'Z') || c == '_' ) {
+	else if ( LEXCHAR_IS( c, LEXCHAR_NAMESTART ) ) {
 		if ( !idLexer::ReadName( token ) ) {
 			return 0;
 		}
@@ -1798,3 +1850,83 @@ idLexer::HadError
 bool idLexer::HadError( void ) const {
 	return hadError;
 }
+
+/*
+================
+idLexer::Test_f
+
+Measures the token throughput over a folder of text files, by default the
+entity and material decls.  The files are loaded first, so only the lexer
+is timed.
+================
+*/
+void idLexer::Test_f( const idCmdArgs &args ) {
+	const char *	folder = "def";
+	const char *	extension = ".def";
+	int				passes = 4;
+	idStrList		names;
+	idList<char *>	buffers;
+	idList<int>		lengths;
+	idToken			token;
+	idTimer			timer;
+	int				totalBytes = 0;
+	int				numTokens = 0;
+
+	if ( args.Argc() >= 3 ) {
+		folder = args.Argv( 1 );
+		extension = args.Argv( 2 );
+	} else {
+		idLib::common->Printf( "usage: testLexer [folder extension [passes]], testing def/*.def and materials/*.mtr\n" );
+	}
+	if ( args.Argc() >= 4 ) {
+		passes = Max( 1, atoi( args.Argv( 3 ) ) );
+	}
+
+	for ( int i = 0; i < 2; i++ ) {
+		idFileList *fileList = idLib::fileSystem->ListFiles( folder, extension, true, true );
+		for ( int j = 0; j < fileList->GetNumFiles(); j++ ) {
+			char *buffer;
+			int length = idLib::fileSystem->ReadFile( fileList->GetFile( j ), (void **)&buffer );
+			if ( length <= 0 ) {
+				continue;
+			}
+			names.Append( fileList->GetFile( j ) );
+			buffers.Append( buffer );
+			lengths.Append( length );
+			totalBytes += length;
+		}
+		idLib::fileSystem->FreeFileList( fileList );
+
+		if ( args.Argc() >= 3 ) {
+			break;
+		}
+		folder = "materials";
+		extension = ".mtr";
+	}
+
+	if ( !buffers.Num() ) {
+		idLib::common->Printf( "no files to test\n" );
+		return;
+	}
+
+	timer.Start();
+	for ( int pass = 0; pass < passes; pass++ ) {
+		for ( int i = 0; i < buffers.Num(); i++ ) {
+			idLexer src( LEXFL_NOSTRINGCONCAT | LEXFL_NOSTRINGESCAPECHARS | LEXFL_ALLOWPATHNAMES | LEXFL_ALLOWMULTICHARLITERALS |
+							LEXFL_ALLOWBACKSLASHSTRINGCONCAT | LEXFL_NOFATALERRORS | LEXFL_NOERRORS | LEXFL_NOWARNINGS );
+			src.LoadMemory( buffers[i], lengths[i], names[i] );
+			while ( src.ReadToken( &token ) ) {
+				numTokens++;
+			}
+		}
+	}
+	timer.Stop();
+
+	float ms = Max( 1.0f, (float)timer.Milliseconds() );
+	idLib::common->Printf( "%d files, %d kB, %d passes: %d ms, %.1f MB/s, %.0f ktokens/s\n", buffers.Num(), totalBytes >> 10, passes,
+						(int)ms, (float)totalBytes * passes / ( ms * 1000.0f ), numTokens / ms );
+
+	for ( int i = 0; i < buffers.Num(); i++ ) {
+		idLib::fileSystem->FreeFile( buffers[i] );
+	}
+}
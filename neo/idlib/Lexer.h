@@ -242,6 +242,8 @@ public:
 
 					// set the base folder to load files from
 	static void		SetBaseFolder( const char *path );
+					// prints the lexer throughput over a folder of text files
+	static void		Test_f( const class idCmdArgs &args );
 
 private:
 	int				loaded;					// set when a script file is loaded from file or memory
@@ -1005,6 +1005,9 @@ int idParser::Directive_include( void ) {
 		idParser::Error( "file '%s' not found", path.c_str() );
 		return false;
 	}
+	if ( idParser::includeList ) {
+		idParser::includeList->AddUnique( script->GetFileName() );
+	}
 	script->SetFlags( idParser::flags );
 	script->SetPunctuations( idParser::punctuations );
 	idParser::PushScript( script );
@@ -2974,6 +2977,15 @@ void idParser::SetIncludePath( const char *path ) {
 	}
 }
 
+/*
+================
+idParser::SetIncludeList
+================
+*/
+void idParser::SetIncludeList( idStrList *list ) {
+	idParser::includeList = list;
+}
+
 /*
 ================
 idParser::SetPunctuations
@@ -3184,6 +3196,7 @@ idParser::idParser() {
 	this->defines = NULL;
 	this->tokens = NULL;
 	this->marker_p = NULL;
+	this->includeList = NULL;
 }
 
 /*
@@ -3202,6 +3215,7 @@ idParser::idParser( int flags ) {
 	this->defines = NULL;
 	this->tokens = NULL;
 	this->marker_p = NULL;
+	this->includeList = NULL;
 }
 
 /*
@@ -3220,6 +3234,7 @@ idParser::idParser( const char *filename, int flags, bool OSPath ) {
 	this->defines = NULL;
 	this->tokens = NULL;
 	this->marker_p = NULL;
+	this->includeList = NULL;
 	LoadFile( filename, OSPath );
 }
 
@@ -3239,6 +3254,7 @@ idParser::idParser( const char *ptr, int length, const char *name, int flags ) {
 	this->defines = NULL;
 	this->tokens = NULL;
 	this->marker_p = NULL;
+	this->includeList = NULL;
 	LoadMemory( ptr, length, name );
 }
 
@@ -31,6 +31,7 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "idlib/Token.h"
 #include "idlib/Lexer.h"
+#include "idlib/containers/StrList.h"
 
 /*
 ===============================================================================
@@ -149,6 +150,8 @@ public:
 	void			AddBuiltinDefines( void );
 					// set the source include path
 	void			SetIncludePath( const char *path );
+					// add the name of every file opened through #include to the given list, NULL stops it
+	void			SetIncludeList( idStrList *list );
 					// set the punctuation set
 	void			SetPunctuations( const punctuation_t *p );
 					// returns a pointer to the punctuation with the given id
@@ -195,6 +198,7 @@ private:
 	indent_t *		indentstack;				// stack with indents
 	int				skip;						// > 0 if skipping conditional code
 	const char*		marker_p;
+	idStrList *		includeList;				// names of the included files
 
 	static define_t *globaldefines;				// list with global defines added to every source loaded
 
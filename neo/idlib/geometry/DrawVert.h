@@ -106,4 +106,48 @@ ID_INLINE dword idDrawVert::GetColor( void ) const {
 	return *reinterpret_cast<const dword *>(this->color);
 }
 
+/*
+===============================================================================
+
+	Packed Draw Vertex.
+
+	The layout idDrawVert is stored in for the GPU, 36 instead of 60 bytes.
+	The normal and tangents are normalized signed bytes with a padding byte.
+
+===============================================================================
+*/
+
+class idPackedDrawVert {
+public:
+	idVec3			xyz;
+	idVec2			st;
+	signed char		normal[4];
+	signed char		tangents[2][4];
+	byte			color[4];
+
+	void			Pack( const idDrawVert &v );
+
+	static signed char	PackComponent( const float f );
+};
+
+ID_INLINE signed char idPackedDrawVert::PackComponent( const float f ) {
+	return (signed char)idMath::FtoiFast( idMath::ClampFloat( -1.0f, 1.0f, f ) * 127.0f );
+}
+
+ID_INLINE void idPackedDrawVert::Pack( const idDrawVert &v ) {
+	xyz = v.xyz;
+	st = v.st;
+	normal[0] = PackComponent( v.normal[0] );
+	normal[1] = PackComponent( v.normal[1] );
+	normal[2] = PackComponent( v.normal[2] );
+	normal[3] = 0;
+	for ( int i = 0; i < 2; i++ ) {
+		tangents[i][0] = PackComponent( v.tangents[i][0] );
+		tangents[i][1] = PackComponent( v.tangents[i][1] );
+		tangents[i][2] = PackComponent( v.tangents[i][2] );
+		tangents[i][3] = 0;
+	}
+	*reinterpret_cast<dword *>(color) = v.GetColor();
+}
+
 #endif /* !__DRAWVERT_H__ */
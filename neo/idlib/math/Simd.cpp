@@ -3239,6 +3239,219 @@ void TestCreateShadowCache( void ) {
 	PrintClocks( va( "   simd->CreateVertexProgramShadowCache() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
 }
 
+/*
+============
+TestDeforms
+============
+*/
+void TestDeforms( void ) {
+	int i, j;
+	TIME_TYPE start, end, bestClocksGeneric, bestClocksSIMD;
+	ALIGN16( idDrawVert drawVerts[COUNT] );
+	ALIGN16( idDrawVert drawVerts1[COUNT] );
+	ALIGN16( idDrawVert drawVerts2[COUNT] );
+	idVec3 leftDir, upDir;
+	float dist;
+	const char *result;
+
+	idRandom srnd( RANDOM_SEED );
+
+	for ( i = 0; i < COUNT; i++ ) {
+		for ( j = 0; j < 3; j++ ) {
+			drawVerts[i].xyz[j] = srnd.CRandomFloat() * 100.0f;
+			drawVerts[i].normal[j] = srnd.CRandomFloat();
+		}
+		for ( j = 0; j < 2; j++ ) {
+			drawVerts[i].st[j] = srnd.CRandomFloat();
+		}
+		drawVerts[i].normal.Normalize();
+	}
+	leftDir.Set( srnd.CRandomFloat(), srnd.CRandomFloat(), srnd.CRandomFloat() );
+	leftDir.Normalize();
+	upDir = leftDir.Cross( idVec3( 0.0f, 0.0f, 1.0f ) );
+	upDir.Normalize();
+	dist = srnd.CRandomFloat() * 10.0f;
+
+	bestClocksGeneric = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_generic->DeformAutosprite( drawVerts1, drawVerts, leftDir, upDir, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksGeneric );
+	}
+	PrintClocks( "generic->DeformAutosprite()", COUNT, bestClocksGeneric );
+
+	bestClocksSIMD = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_simd->DeformAutosprite( drawVerts2, drawVerts, leftDir, upDir, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksSIMD );
+	}
+
+	for ( i = 0; i < COUNT; i++ ) {
+		if ( !drawVerts1[i].xyz.Compare( drawVerts2[i].xyz, 1e-2f ) ) {
+			break;
+		}
+		if ( !drawVerts1[i].st.Compare( drawVerts2[i].st, 1e-4f ) ) {
+			break;
+		}
+		if ( !drawVerts1[i].normal.Compare( drawVerts2[i].normal, 1e-4f ) ) {
+			break;
+		}
+	}
+	result = ( i >= COUNT ) ? "ok" :  S_COLOR_RED "X";
+	PrintClocks( va( "   simd->DeformAutosprite() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
+
+	bestClocksGeneric = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_generic->DeformExpand( drawVerts1, drawVerts, dist, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksGeneric );
+	}
+	PrintClocks( "generic->DeformExpand()", COUNT, bestClocksGeneric );
+
+	bestClocksSIMD = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_simd->DeformExpand( drawVerts2, drawVerts, dist, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksSIMD );
+	}
+
+	for ( i = 0; i < COUNT; i++ ) {
+		if ( !drawVerts1[i].xyz.Compare( drawVerts2[i].xyz, 1e-2f ) ) {
+			break;
+		}
+		if ( !drawVerts1[i].st.Compare( drawVerts2[i].st, 1e-4f ) ) {
+			break;
+		}
+		if ( !drawVerts1[i].normal.Compare( drawVerts2[i].normal, 1e-4f ) ) {
+			break;
+		}
+	}
+	result = ( i >= COUNT ) ? "ok" :  S_COLOR_RED "X";
+	PrintClocks( va( "   simd->DeformExpand() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
+}
+
+/*
+============
+TestPackDrawVerts
+============
+*/
+void TestPackDrawVerts( void ) {
+	int i, j, k;
+	TIME_TYPE start, end, bestClocksGeneric, bestClocksSIMD;
+	ALIGN16( idDrawVert drawVerts[COUNT] );
+	ALIGN16( idPackedDrawVert packedVerts1[COUNT] );
+	ALIGN16( idPackedDrawVert packedVerts2[COUNT] );
+	const char *result;
+
+	idRandom srnd( RANDOM_SEED );
+
+	for ( i = 0; i < COUNT; i++ ) {
+		for ( j = 0; j < 3; j++ ) {
+			drawVerts[i].xyz[j] = srnd.CRandomFloat() * 100.0f;
+			drawVerts[i].normal[j] = srnd.CRandomFloat();
+			drawVerts[i].tangents[0][j] = srnd.CRandomFloat();
+			drawVerts[i].tangents[1][j] = srnd.CRandomFloat();
+		}
+		for ( j = 0; j < 2; j++ ) {
+			drawVerts[i].st[j] = srnd.CRandomFloat();
+		}
+		drawVerts[i].normal.Normalize();
+		drawVerts[i].tangents[0].Normalize();
+		drawVerts[i].tangents[1].Normalize();
+		drawVerts[i].SetColor( srnd.RandomInt( 0x7fffffff ) );
+	}
+
+	bestClocksGeneric = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_generic->PackDrawVerts( packedVerts1, drawVerts, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksGeneric );
+	}
+	PrintClocks( "generic->PackDrawVerts()", COUNT, bestClocksGeneric );
+
+	bestClocksSIMD = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_simd->PackDrawVerts( packedVerts2, drawVerts, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksSIMD );
+	}
+
+	for ( i = 0; i < COUNT; i++ ) {
+		if ( !packedVerts1[i].xyz.Compare( packedVerts2[i].xyz ) || !packedVerts1[i].st.Compare( packedVerts2[i].st ) ) {
+			break;
+		}
+		for ( k = 0; k < 4; k++ ) {
+			if ( idMath::Abs( packedVerts1[i].normal[k] - packedVerts2[i].normal[k] ) > 1 ||
+					idMath::Abs( packedVerts1[i].tangents[0][k] - packedVerts2[i].tangents[0][k] ) > 1 ||
+						idMath::Abs( packedVerts1[i].tangents[1][k] - packedVerts2[i].tangents[1][k] ) > 1 ||
+							packedVerts1[i].color[k] != packedVerts2[i].color[k] ) {
+				break;
+			}
+		}
+		if ( k < 4 ) {
+			break;
+		}
+	}
+	result = ( i >= COUNT ) ? "ok" :  S_COLOR_RED "X";
+	PrintClocks( va( "   simd->PackDrawVerts() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
+}
+
+/*
+============
+TestDequantizeShorts
+============
+*/
+void TestDequantizeShorts( void ) {
+	int i;
+	TIME_TYPE start, end, bestClocksGeneric, bestClocksSIMD;
+	ALIGN16( unsigned short src[COUNT] );
+	ALIGN16( float scale[COUNT] );
+	ALIGN16( float bias[COUNT] );
+	ALIGN16( float dst1[COUNT] );
+	ALIGN16( float dst2[COUNT] );
+	const char *result;
+
+	idRandom srnd( RANDOM_SEED );
+
+	for ( i = 0; i < COUNT; i++ ) {
+		src[i] = srnd.RandomInt( 65536 );
+		scale[i] = srnd.RandomFloat() / 65535.0f;
+		bias[i] = srnd.CRandomFloat() * 10.0f;
+	}
+
+	bestClocksGeneric = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_generic->DequantizeShorts( dst1, src, scale, bias, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksGeneric );
+	}
+	PrintClocks( "generic->DequantizeShorts()", COUNT, bestClocksGeneric );
+
+	bestClocksSIMD = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_simd->DequantizeShorts( dst2, src, scale, bias, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksSIMD );
+	}
+
+	for ( i = 0; i < COUNT; i++ ) {
+		if ( idMath::Fabs( dst1[i] - dst2[i] ) > 1e-5f ) {
+			break;
+		}
+	}
+	result = ( i >= COUNT ) ? "ok" :  S_COLOR_RED "X";
+	PrintClocks( va( "   simd->DequantizeShorts() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
+}
+
 /*
 ============
 TestSoundUpSampling
@@ -4099,6 +4312,9 @@ void idSIMD::Test_f( const idCmdArgs &args ) {
 	TestGetTextureSpaceLightVectors();
 	TestGetSpecularTextureCoords();
 	TestCreateShadowCache();
+	TestDeforms();
+	TestPackDrawVerts();
+	TestDequantizeShorts();
 
 	idLib::common->Printf("====================================\n" );
 
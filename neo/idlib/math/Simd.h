@@ -79,6 +79,7 @@ class idMat6;
 class idMatX;
 class idPlane;
 class idDrawVert;
+class idPackedDrawVert;
 class idJointQuat;
 class idJointMat;
 struct dominantTri_s;
@@ -193,6 +194,10 @@ public:
 	virtual void VPCALL CreateSpecularTextureCoords( idVec4 *texCoords, const idVec3 &lightOrigin, const idVec3 &viewOrigin, const idDrawVert *verts, const int numVerts, const int *indexes, const int numIndexes ) = 0;
 	virtual int  VPCALL CreateShadowCache( idVec4 *vertexCache, int *vertRemap, const idVec3 &lightOrigin, const idDrawVert *verts, const int numVerts ) = 0;
 	virtual int  VPCALL CreateVertexProgramShadowCache( idVec4 *vertexCache, const idDrawVert *verts, const int numVerts ) = 0;
+	virtual void VPCALL DeformAutosprite( idDrawVert *verts, const idDrawVert *src, const idVec3 &leftDir, const idVec3 &upDir, const int numVerts ) = 0;
+	virtual void VPCALL DeformExpand( idDrawVert *verts, const idDrawVert *src, const float dist, const int numVerts ) = 0;
+	virtual void VPCALL PackDrawVerts( idPackedDrawVert *dst, const idDrawVert *src, const int numVerts ) = 0;
+	virtual void VPCALL DequantizeShorts( float *dst, const unsigned short *src, const float *scale, const float *bias, const int count ) = 0;
 
 	// sound mixing
 	virtual void VPCALL UpSamplePCMTo44kHz( float *dest, const short *pcm, const int numSamples, const int kHz, const int numChannels ) = 0;
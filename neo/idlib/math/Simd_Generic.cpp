@@ -3045,6 +3045,87 @@ int VPCALL idSIMD_Generic::CreateVertexProgramShadowCache( idVec4 *vertexCache,
 	return numVerts * 2;
 }
 
+/*
+============
+idSIMD_Generic::DeformAutosprite
+
+  Rebuilds each group of four vertices as a quad facing along leftDir and upDir.
+  The quad is centered on the midpoint of the source vertices and keeps their size.
+============
+*/
+void VPCALL idSIMD_Generic::DeformAutosprite( idDrawVert *verts, const idDrawVert *src, const idVec3 &leftDir, const idVec3 &upDir, const int numVerts ) {
+	for ( int i = 0; i < numVerts; i += 4 ) {
+		const idDrawVert *v = src + i;
+		idVec3 mid;
+
+		mid.x = 0.25f * ( v[0].xyz.x + v[1].xyz.x + v[2].xyz.x + v[3].xyz.x );
+		mid.y = 0.25f * ( v[0].xyz.y + v[1].xyz.y + v[2].xyz.y + v[3].xyz.y );
+		mid.z = 0.25f * ( v[0].xyz.z + v[1].xyz.z + v[2].xyz.z + v[3].xyz.z );
+
+		float radius = ( v[0].xyz - mid ).Length() * 0.707f;		// / sqrt(2)
+
+		idVec3 left = leftDir * radius;
+		idVec3 up = upDir * radius;
+
+		verts[i+0] = v[0];
+		verts[i+0].xyz = mid + left + up;
+		verts[i+0].st[0] = 0.0f;
+		verts[i+0].st[1] = 0.0f;
+		verts[i+1] = v[1];
+		verts[i+1].xyz = mid - left + up;
+		verts[i+1].st[0] = 1.0f;
+		verts[i+1].st[1] = 0.0f;
+		verts[i+2] = v[2];
+		verts[i+2].xyz = mid - left - up;
+		verts[i+2].st[0] = 1.0f;
+		verts[i+2].st[1] = 1.0f;
+		verts[i+3] = v[3];
+		verts[i+3].xyz = mid + left - up;
+		verts[i+3].st[0] = 0.0f;
+		verts[i+3].st[1] = 1.0f;
+	}
+}
+
+/*
+============
+idSIMD_Generic::DeformExpand
+
+  verts[i] = src[i], verts[i].xyz = src[i].xyz + src[i].normal * dist
+============
+*/
+void VPCALL idSIMD_Generic::DeformExpand( idDrawVert *verts, const idDrawVert *src, const float dist, const int numVerts ) {
+	for ( int i = 0; i < numVerts; i++ ) {
+		verts[i] = src[i];
+		verts[i].xyz = src[i].xyz + src[i].normal * dist;
+	}
+}
+
+/*
+============
+idSIMD_Generic::PackDrawVerts
+
+  dst[i].Pack( src[i] )
+============
+*/
+void VPCALL idSIMD_Generic::PackDrawVerts( idPackedDrawVert *dst, const idDrawVert *src, const int numVerts ) {
+	for ( int i = 0; i < numVerts; i++ ) {
+		dst[i].Pack( src[i] );
+	}
+}
+
+/*
+============
+idSIMD_Generic::DequantizeShorts
+
+  dst[i] = bias[i] + scale[i] * src[i];
+============
+*/
+void VPCALL idSIMD_Generic::DequantizeShorts( float *dst, const unsigned short *src, const float *scale, const float *bias, const int count ) {
+	for ( int i = 0; i < count; i++ ) {
+		dst[i] = bias[i] + scale[i] * src[i];
+	}
+}
+
 /*
 ============
 idSIMD_Generic::UpSamplePCMTo44kHz
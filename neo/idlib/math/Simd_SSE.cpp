@@ -617,6 +617,93 @@ void VPCALL idSIMD_SSE::Dot( float *dst, const idVec3 &constant, const idPlane *
 	*/
 }
 
+/*
+============
+idSIMD_SSE::DeformAutosprite
+============
+*/
+void VPCALL idSIMD_SSE::DeformAutosprite( idDrawVert *verts, const idDrawVert *src, const idVec3 &leftDir, const idVec3 &upDir, const int numVerts ) {
+	__m128 xyzMask, quarter, scale, left, up, st0, st1;
+
+	assert( sizeof( idDrawVert ) == DRAWVERT_SIZE );
+	assert( ptrdiff_t(&src->xyz) - ptrdiff_t(src) == DRAWVERT_XYZ_OFFSET );
+	assert( ptrdiff_t(&src->st) - ptrdiff_t(src) == DRAWVERT_ST_OFFSET );
+
+	// all ones in x, y and z, zero in w so the s texture coordinate that follows xyz is masked off
+	xyzMask = _mm_cmpeq_ps( _mm_set_ps( 1.0f, 0.0f, 0.0f, 0.0f ), _mm_setzero_ps() );
+	quarter = _mm_set1_ps( 0.25f );
+	scale = _mm_set1_ps( 0.707f );		// / sqrt(2)
+	left = _mm_set_ps( 0.0f, leftDir.z, leftDir.y, leftDir.x );
+	up = _mm_set_ps( 0.0f, upDir.z, upDir.y, upDir.x );
+	st0 = _mm_set_ps( 0.0f, 0.0f, 0.0f, 0.0f );
+	st1 = _mm_set_ps( 1.0f, 0.0f, 0.0f, 0.0f );
+
+	for ( int i = 0; i < numVerts; i += 4 ) {
+		const idDrawVert *v = src + i;
+		idDrawVert *d = verts + i;
+		__m128 p0, p1, p2, p3, mid, delta, len;
+
+		p0 = _mm_loadu_ps( v[0].xyz.ToFloatPtr() );
+		p1 = _mm_loadu_ps( v[1].xyz.ToFloatPtr() );
+		p2 = _mm_loadu_ps( v[2].xyz.ToFloatPtr() );
+		p3 = _mm_loadu_ps( v[3].xyz.ToFloatPtr() );
+
+		mid = _mm_add_ps( _mm_add_ps( p0, p1 ), _mm_add_ps( p2, p3 ) );
+		mid = _mm_and_ps( _mm_mul_ps( mid, quarter ), xyzMask );
+
+		delta = _mm_and_ps( _mm_sub_ps( p0, mid ), xyzMask );
+		len = _mm_mul_ps( delta, delta );
+		len = _mm_add_ps( len, _mm_shuffle_ps( len, len, R_SHUFFLEPS( 1, 0, 3, 2 ) ) );
+		len = _mm_add_ps( len, _mm_shuffle_ps( len, len, R_SHUFFLEPS( 2, 3, 0, 1 ) ) );
+		len = _mm_mul_ps( _mm_sqrt_ps( len ), scale );
+
+		__m128 l = _mm_mul_ps( left, len );
+		__m128 u = _mm_mul_ps( up, len );
+
+		d[0] = v[0];
+		d[1] = v[1];
+		d[2] = v[2];
+		d[3] = v[3];
+
+		// the w component of each store lands on st[0]
+		_mm_storeu_ps( d[0].xyz.ToFloatPtr(), _mm_add_ps( _mm_add_ps( mid, l ), _mm_add_ps( u, st0 ) ) );
+		_mm_storeu_ps( d[1].xyz.ToFloatPtr(), _mm_add_ps( _mm_sub_ps( mid, l ), _mm_add_ps( u, st1 ) ) );
+		_mm_storeu_ps( d[2].xyz.ToFloatPtr(), _mm_sub_ps( _mm_sub_ps( mid, l ), _mm_sub_ps( u, st1 ) ) );
+		_mm_storeu_ps( d[3].xyz.ToFloatPtr(), _mm_sub_ps( _mm_add_ps( mid, l ), _mm_sub_ps( u, st0 ) ) );
+
+		d[0].st[1] = 0.0f;
+		d[1].st[1] = 0.0f;
+		d[2].st[1] = 1.0f;
+		d[3].st[1] = 1.0f;
+	}
+}
+
+/*
+============
+idSIMD_SSE::DeformExpand
+============
+*/
+void VPCALL idSIMD_SSE::DeformExpand( idDrawVert *verts, const idDrawVert *src, const float dist, const int numVerts ) {
+	__m128 xyzMask, scale;
+
+	assert( sizeof( idDrawVert ) == DRAWVERT_SIZE );
+	assert( ptrdiff_t(&src->xyz) - ptrdiff_t(src) == DRAWVERT_XYZ_OFFSET );
+	assert( ptrdiff_t(&src->normal) - ptrdiff_t(src) == DRAWVERT_NORMAL_OFFSET );
+
+	xyzMask = _mm_cmpeq_ps( _mm_set_ps( 1.0f, 0.0f, 0.0f, 0.0f ), _mm_setzero_ps() );
+	scale = _mm_and_ps( _mm_set1_ps( dist ), xyzMask );
+
+	for ( int i = 0; i < numVerts; i++ ) {
+		__m128 xyz = _mm_loadu_ps( src[i].xyz.ToFloatPtr() );			// x, y, z, s
+		__m128 normal = _mm_loadu_ps( src[i].normal.ToFloatPtr() );		// x, y, z, tangent x
+
+		normal = _mm_and_ps( _mm_mul_ps( normal, scale ), xyzMask );
+
+		verts[i] = src[i];
+		_mm_storeu_ps( verts[i].xyz.ToFloatPtr(), _mm_add_ps( xyz, normal ) );
+	}
+}
+
 #elif defined(_MSC_VER) && defined(_M_IX86)
 
 #include <xmmintrin.h>
@@ -49,6 +49,8 @@ public:
 	virtual void VPCALL Dot( float *dst,			const idPlane &constant,const idDrawVert *src,	const int count );
 	virtual	void VPCALL MinMax( idVec3 &min,		idVec3 &max,			const idDrawVert *src,	const int *indexes,		const int count );
 	virtual void VPCALL Dot( float *dst,			const idVec3 &constant,	const idPlane *src,		const int count );
+	virtual void VPCALL DeformAutosprite( idDrawVert *verts, const idDrawVert *src, const idVec3 &leftDir, const idVec3 &upDir, const int numVerts );
+	virtual void VPCALL DeformExpand( idDrawVert *verts, const idDrawVert *src, const float dist, const int numVerts );
 
 #elif defined(_MSC_VER) && defined(_M_IX86)
 	virtual const char * VPCALL GetName( void ) const;
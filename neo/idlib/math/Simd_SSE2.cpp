@@ -27,6 +27,7 @@ If you have questions concerning this license or the applicable additional terms
 */
 
 #include "sys/platform.h"
+#include "idlib/geometry/DrawVert.h"
 
 #include "idlib/math/Simd_SSE2.h"
 
@@ -239,6 +240,79 @@ void VPCALL idSIMD_SSE2::CmpLT( byte *dst, const byte bitNum, const float *src0,
 	}
 }
 
+/*
+============
+idSIMD_SSE2::PackDrawVerts
+============
+*/
+void VPCALL idSIMD_SSE2::PackDrawVerts( idPackedDrawVert *dst, const idDrawVert *src, const int numVerts ) {
+	__m128 xyzMask, scale, one, minusOne;
+	__m128i zero;
+
+	assert( sizeof( idPackedDrawVert ) == 36 );
+	assert( ptrdiff_t(&dst->normal) - ptrdiff_t(dst) == 20 );
+	assert( ptrdiff_t(&dst->color) - ptrdiff_t(dst) == 32 );
+
+	// the fourth float of each load is the first component of the next field
+	xyzMask = _mm_cmpeq_ps( _mm_set_ps( 1.0f, 0.0f, 0.0f, 0.0f ), _mm_setzero_ps() );
+	scale = _mm_set1_ps( 127.0f );
+	one = _mm_set1_ps( 1.0f );
+	minusOne = _mm_set1_ps( -1.0f );
+	zero = _mm_setzero_si128();
+
+	for ( int i = 0; i < numVerts; i++ ) {
+		const idDrawVert &v = src[i];
+		idPackedDrawVert &p = dst[i];
+		__m128 n, t0, t1;
+		__m128i packed;
+
+		// xyz and st have the same layout
+		_mm_storeu_ps( p.xyz.ToFloatPtr(), _mm_loadu_ps( v.xyz.ToFloatPtr() ) );
+		p.st[1] = v.st[1];
+
+		n = _mm_and_ps( _mm_loadu_ps( v.normal.ToFloatPtr() ), xyzMask );
+		t0 = _mm_and_ps( _mm_loadu_ps( v.tangents[0].ToFloatPtr() ), xyzMask );
+		t1 = _mm_and_ps( _mm_loadu_ps( v.tangents[1].ToFloatPtr() ), xyzMask );
+
+		n = _mm_mul_ps( _mm_max_ps( _mm_min_ps( n, one ), minusOne ), scale );
+		t0 = _mm_mul_ps( _mm_max_ps( _mm_min_ps( t0, one ), minusOne ), scale );
+		t1 = _mm_mul_ps( _mm_max_ps( _mm_min_ps( t1, one ), minusOne ), scale );
+
+		// n0 n1 n2 0 t00 t01 t02 0 t10 t11 t12 0 0 0 0 0
+		packed = _mm_packs_epi16( _mm_packs_epi32( _mm_cvtps_epi32( n ), _mm_cvtps_epi32( t0 ) ),
+								  _mm_packs_epi32( _mm_cvtps_epi32( t1 ), zero ) );
+
+		_mm_storel_epi64( (__m128i *)p.normal, packed );
+		*reinterpret_cast<int *>(p.tangents[1]) = _mm_cvtsi128_si32( _mm_srli_si128( packed, 8 ) );
+		*reinterpret_cast<dword *>(p.color) = v.GetColor();
+	}
+}
+
+/*
+============
+idSIMD_SSE2::DequantizeShorts
+
+  dst[i] = bias[i] + scale[i] * src[i];
+============
+*/
+void VPCALL idSIMD_SSE2::DequantizeShorts( float *dst, const unsigned short *src, const float *scale, const float *bias, const int count ) {
+	__m128i zero = _mm_setzero_si128();
+	int i;
+
+	for ( i = 0; i + 8 <= count; i += 8 ) {
+		__m128i s = _mm_loadu_si128( (const __m128i *)( src + i ) );
+		__m128 lo = _mm_cvtepi32_ps( _mm_unpacklo_epi16( s, zero ) );
+		__m128 hi = _mm_cvtepi32_ps( _mm_unpackhi_epi16( s, zero ) );
+		lo = _mm_add_ps( _mm_loadu_ps( bias + i + 0 ), _mm_mul_ps( _mm_loadu_ps( scale + i + 0 ), lo ) );
+		hi = _mm_add_ps( _mm_loadu_ps( bias + i + 4 ), _mm_mul_ps( _mm_loadu_ps( scale + i + 4 ), hi ) );
+		_mm_storeu_ps( dst + i + 0, lo );
+		_mm_storeu_ps( dst + i + 4, hi );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = bias[i] + scale[i] * src[i];
+	}
+}
+
 #elif defined(_MSC_VER) && defined(_M_IX86)
 
 #include <xmmintrin.h>
@@ -46,6 +46,8 @@ public:
 
 	virtual const char * VPCALL GetName( void ) const;
 	virtual void VPCALL CmpLT( byte *dst,			const byte bitNum,		const float *src0,		const float constant,	const int count );
+	virtual void VPCALL PackDrawVerts( idPackedDrawVert *dst, const idDrawVert *src, const int numVerts );
+	virtual void VPCALL DequantizeShorts( float *dst, const unsigned short *src, const float *scale, const float *bias, const int count );
 
 #elif defined(_MSC_VER) && defined(_M_IX86)
 	virtual const char * VPCALL GetName( void ) const;
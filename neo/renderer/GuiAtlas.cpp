@@ -0,0 +1,375 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "sys/platform.h"
+#include "renderer/tr_local.h"
+
+#include "renderer/GuiAtlas.h"
+
+idGuiAtlas			guiAtlas;
+
+static const int	GUI_ATLAS_PAGE_SIZE = 1024;
+static const int	GUI_ATLAS_MAX_PAGES = 4;
+static const int	GUI_ATLAS_MAX_IMAGE_SIZE = 256;	// larger images keep their own texture
+static const int	GUI_ATLAS_BORDER = 4;			// edge texels are replicated this far so filtering doesn't bleed
+static const int	GUI_ATLAS_ALIGN = 8;			// keeps the first mip levels of neighbouring images apart
+
+// the state bits of a "blend blend" stage on a translucent material
+static const int	GUI_ATLAS_STATE_BITS = GLS_SRCBLEND_SRC_ALPHA | GLS_DSTBLEND_ONE_MINUS_SRC_ALPHA | GLS_DEPTHFUNC_LESS | GLS_DEPTHMASK;
+
+/*
+================
+R_GuiAtlasImage
+
+Generator function for the atlas pages
+================
+*/
+static void R_GuiAtlasImage( idImage *image ) {
+	guiAtlas.GeneratePageImage( image );
+}
+
+/*
+================
+idGuiAtlas::idGuiAtlas
+================
+*/
+idGuiAtlas::idGuiAtlas() {
+	entries.SetGranularity( 256 );
+}
+
+/*
+================
+idGuiAtlas::Shutdown
+================
+*/
+void idGuiAtlas::Shutdown() {
+	for ( int i = 0; i < pages.Num(); i++ ) {
+		R_StaticFree( pages[i]->pic );
+	}
+	pages.DeleteContents( true );
+	entries.Clear();
+	entryHash.Free();
+}
+
+/*
+================
+idGuiAtlas::NumImages
+================
+*/
+int idGuiAtlas::NumImages() const {
+	int num = 0;
+	for ( int i = 0; i < pages.Num(); i++ ) {
+		num += pages[i]->numImages;
+	}
+	return num;
+}
+
+/*
+================
+idGuiAtlas::CanAtlas
+
+The material has to draw exactly like the atlas material, except for the
+image and for taking the color from the shader parms.
+================
+*/
+bool idGuiAtlas::CanAtlas( const idMaterial *material ) const {
+	if ( material->GetNumStages() != 1 || material->HasGui() || material->Deform() != DFRM_NONE ) {
+		return false;
+	}
+	if ( material->GetSort() != SS_GUI || material->GetNumOps() != 0 ) {
+		return false;
+	}
+
+	const shaderStage_t *stage = material->GetStage( 0 );
+
+	if ( stage->lighting != SL_AMBIENT || stage->newStage || stage->hasAlphaTest || stage->vertexColor != SVC_IGNORE ) {
+		return false;
+	}
+	if ( stage->drawStateBits != GUI_ATLAS_STATE_BITS || stage->privatePolygonOffset ) {
+		return false;
+	}
+	for ( int i = 0; i < 4; i++ ) {
+		if ( stage->color.registers[i] != EXP_REG_PARM0 + i ) {
+			return false;
+		}
+	}
+
+	// without any ops, a condition that isn't a predefined register is a constant
+	if ( stage->conditionRegister < EXP_REG_NUM_PREDEFINED ) {
+		return false;
+	}
+	float *regs = (float *)_alloca( material->GetNumRegisters() * sizeof( float ) );
+	float shaderParms[MAX_ENTITY_SHADER_PARMS];
+	viewDef_t viewDef;
+	memset( shaderParms, 0, sizeof( shaderParms ) );
+	memset( &viewDef, 0, sizeof( viewDef ) );
+	material->EvaluateRegisters( regs, shaderParms, &viewDef );
+	if ( regs[stage->conditionRegister] == 0.0f ) {
+		return false;
+	}
+
+	const textureStage_t *texture = &stage->texture;
+
+	if ( texture->cinematic || texture->dynamic != DI_STATIC || texture->texgen != TG_EXPLICIT || texture->hasMatrix ) {
+		return false;
+	}
+	if ( !texture->image || texture->image->generatorFunction || texture->image->cubeFiles != CF_2D ) {
+		return false;
+	}
+	if ( texture->image->filter != TF_DEFAULT && texture->image->filter != TF_LINEAR ) {
+		return false;
+	}
+
+	return true;
+}
+
+/*
+================
+idGuiAtlas::AllocRect
+
+Simple shelf packing, images go on the first shelf that is tall enough
+without wasting more than half of it.
+================
+*/
+bool idGuiAtlas::AllocRect( guiAtlasPage_t *page, int width, int height, int &x, int &y ) {
+	for ( int i = 0; i < page->shelves.Num(); i++ ) {
+		guiAtlasShelf_t &shelf = page->shelves[i];
+		if ( height > shelf.height || height * 2 < shelf.height ) {
+			continue;
+		}
+		if ( shelf.x + width > GUI_ATLAS_PAGE_SIZE ) {
+			continue;
+		}
+		x = shelf.x;
+		y = shelf.y;
+		shelf.x += width;
+		return true;
+	}
+
+	if ( page->shelfEnd + height > GUI_ATLAS_PAGE_SIZE ) {
+		return false;
+	}
+
+	guiAtlasShelf_t &shelf = page->shelves.Alloc();
+	shelf.y = page->shelfEnd;
+	shelf.height = height;
+	shelf.x = width;
+	page->shelfEnd += height;
+
+	x = 0;
+	y = shelf.y;
+	return true;
+}
+
+/*
+================
+idGuiAtlas::AllocPage
+================
+*/
+guiAtlasPage_t *idGuiAtlas::AllocPage() {
+	if ( pages.Num() >= GUI_ATLAS_MAX_PAGES ) {
+		return NULL;
+	}
+
+	guiAtlasPage_t *page = new guiAtlasPage_t;
+	idStr name = va( "_guiAtlas%i", pages.Num() );
+
+	page->pic = (byte *)R_StaticAlloc( GUI_ATLAS_PAGE_SIZE * GUI_ATLAS_PAGE_SIZE * 4 );
+	memset( page->pic, 0, GUI_ATLAS_PAGE_SIZE * GUI_ATLAS_PAGE_SIZE * 4 );
+	page->shelfEnd = 0;
+	page->numImages = 0;
+	page->generation = 0;
+	page->queuedGeneration = 0;
+	page->uploadedGeneration = 0;
+
+	page->image = globalImages->ImageFromFunction( name, R_GuiAtlasImage );
+	page->image->referencedOutsideLevelLoad = true;
+
+	// the implicit material would take the color from the shader parms,
+	// the atlas material takes it from the vertexes instead
+	idMaterial *material = const_cast<idMaterial *>( declManager->FindMaterial( name ) );
+	material->SetText( va(
+		"material %s // GUI ATLAS\n"
+		"{\n"
+		"{\n"
+		"blend blend\n"
+		"vertexColor\n"
+		"map %s\n"
+		"clamp\n"
+		"}\n"
+		"}\n", name.c_str(), name.c_str() ) );
+	material->Invalidate();
+	material->EnsureNotPurged();
+	material->SetSort( SS_GUI );
+	page->material = material;
+
+	// the backend looks the page up when it generates the image
+	Sys_EnterCriticalSection( CRITICAL_SECTION_TWO );
+	pages.Append( page );
+	Sys_LeaveCriticalSection( CRITICAL_SECTION_TWO );
+
+	return page;
+}
+
+/*
+================
+idGuiAtlas::AddEntry
+================
+*/
+void idGuiAtlas::AddEntry( guiAtlasEntry_t &entry ) {
+	entryHash.Add( entry.material->Index(), entries.Append( entry ) );
+}
+
+/*
+================
+idGuiAtlas::FindEntry
+================
+*/
+const guiAtlasEntry_t *idGuiAtlas::FindEntry( const idMaterial *material ) {
+	int i, x, y;
+
+	for ( i = entryHash.First( material->Index() ); i != -1; i = entryHash.Next( i ) ) {
+		if ( entries[i].material == material ) {
+			return ( entries[i].page >= 0 ) ? &entries[i] : NULL;
+		}
+	}
+
+	guiAtlasEntry_t entry;
+	entry.material = material;
+	entry.page = -1;
+	entry.scale[0] = entry.scale[1] = 1.0f;
+	entry.bias[0] = entry.bias[1] = 0.0f;
+
+	if ( !CanAtlas( material ) ) {
+		AddEntry( entry );
+		return NULL;
+	}
+
+	byte *pic;
+	int width, height;
+
+	R_LoadImageProgram( material->GetStage( 0 )->texture.image->imgName, &pic, &width, &height, NULL );
+
+	if ( pic == NULL || width > GUI_ATLAS_MAX_IMAGE_SIZE || height > GUI_ATLAS_MAX_IMAGE_SIZE ) {
+		if ( pic ) {
+			R_StaticFree( pic );
+		}
+		AddEntry( entry );
+		return NULL;
+	}
+
+	const int allocWidth = ( width + 2 * GUI_ATLAS_BORDER + GUI_ATLAS_ALIGN - 1 ) & ~( GUI_ATLAS_ALIGN - 1 );
+	const int allocHeight = ( height + 2 * GUI_ATLAS_BORDER + GUI_ATLAS_ALIGN - 1 ) & ~( GUI_ATLAS_ALIGN - 1 );
+
+	guiAtlasPage_t *page = NULL;
+	for ( i = 0; i < pages.Num(); i++ ) {
+		if ( AllocRect( pages[i], allocWidth, allocHeight, x, y ) ) {
+			page = pages[i];
+			break;
+		}
+	}
+	if ( !page ) {
+		page = AllocPage();
+		if ( !page || !AllocRect( page, allocWidth, allocHeight, x, y ) ) {
+			R_StaticFree( pic );
+			AddEntry( entry );
+			return NULL;
+		}
+		i = pages.Num() - 1;
+	}
+
+	// copy the image with its edges replicated into the border, the backend
+	// may be generating the page texture from the same pixels right now
+	Sys_EnterCriticalSection( CRITICAL_SECTION_TWO );
+	for ( int row = -GUI_ATLAS_BORDER; row < height + GUI_ATLAS_BORDER; row++ ) {
+		const byte *src = pic + idMath::ClampInt( 0, height - 1, row ) * width * 4;
+		byte *dst = page->pic + ( ( y + GUI_ATLAS_BORDER + row ) * GUI_ATLAS_PAGE_SIZE + x ) * 4;
+		for ( int col = -GUI_ATLAS_BORDER; col < width + GUI_ATLAS_BORDER; col++ ) {
+			*(dword *)( dst + ( col + GUI_ATLAS_BORDER ) * 4 ) = *(const dword *)( src + idMath::ClampInt( 0, width - 1, col ) * 4 );
+		}
+	}
+	page->generation++;
+	Sys_LeaveCriticalSection( CRITICAL_SECTION_TWO );
+
+	R_StaticFree( pic );
+
+	entry.page = i;
+	entry.scale[0] = (float)width / GUI_ATLAS_PAGE_SIZE;
+	entry.scale[1] = (float)height / GUI_ATLAS_PAGE_SIZE;
+	entry.bias[0] = (float)( x + GUI_ATLAS_BORDER ) / GUI_ATLAS_PAGE_SIZE;
+	entry.bias[1] = (float)( y + GUI_ATLAS_BORDER ) / GUI_ATLAS_PAGE_SIZE;
+	AddEntry( entry );
+
+	page->numImages++;
+
+	return &entries[entries.Num() - 1];
+}
+
+/*
+================
+idGuiAtlas::QueueUploads
+
+A page is queued at most once per frame however many images were added to
+it, and only if images were added since it was last generated or queued.
+================
+*/
+void idGuiAtlas::QueueUploads() {
+	for ( int i = 0; i < pages.Num(); i++ ) {
+		guiAtlasPage_t *page = pages[i];
+
+		Sys_EnterCriticalSection( CRITICAL_SECTION_TWO );
+		const bool changed = ( page->generation != page->uploadedGeneration && page->generation != page->queuedGeneration );
+		page->queuedGeneration = page->generation;
+		Sys_LeaveCriticalSection( CRITICAL_SECTION_TWO );
+
+		// the backend regenerates the texture before it draws the frame
+		if ( changed ) {
+			globalImages->AddAllocList( page->image );
+		}
+	}
+}
+
+/*
+================
+idGuiAtlas::GeneratePageImage
+================
+*/
+void idGuiAtlas::GeneratePageImage( idImage *image ) {
+	Sys_EnterCriticalSection( CRITICAL_SECTION_TWO );
+	for ( int i = 0; i < pages.Num(); i++ ) {
+		guiAtlasPage_t *page = pages[i];
+		if ( page->image == image ) {
+			image->GenerateImage( page->pic, GUI_ATLAS_PAGE_SIZE, GUI_ATLAS_PAGE_SIZE, TF_DEFAULT, false, TR_CLAMP, TD_HIGH_QUALITY );
+			page->uploadedGeneration = page->generation;
+			Sys_LeaveCriticalSection( CRITICAL_SECTION_TWO );
+			return;
+		}
+	}
+	Sys_LeaveCriticalSection( CRITICAL_SECTION_TWO );
+	image->MakeDefault();
+}
@@ -0,0 +1,122 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __GUIATLAS_H__
+#define __GUIATLAS_H__
+
+/*
+===============================================================================
+
+	GUI atlas
+
+	Small gui images and font glyph pages are packed into a few shared
+	textures, so idGuiModel can keep drawing into the same surface when
+	a gui switches between them.
+
+	Only materials that draw a single blended "colored" stage from a
+	static image can be put in the atlas, which covers the implicitly
+	generated gui materials and the font pages. The atlas material takes
+	the color from the vertexes instead of the shader parms, so color
+	changes don't break the surface either.
+
+	Atlas calls should only be made by the front end, except for
+	GeneratePageImage. The page pixels are shared with the backend thread,
+	so they are only touched inside CRITICAL_SECTION_TWO.
+
+===============================================================================
+*/
+
+#include "idlib/containers/List.h"
+#include "idlib/containers/HashIndex.h"
+
+class idMaterial;
+class idImage;
+
+typedef struct guiAtlasEntry_s {
+	const idMaterial *	material;			// the source material
+	int					page;				// -1 if the material can't be drawn from the atlas
+	float				scale[2];			// maps the texcoords of the source image into the page
+	float				bias[2];
+} guiAtlasEntry_t;
+
+typedef struct {
+	int					y;
+	int					height;
+	int					x;					// first free column
+} guiAtlasShelf_t;
+
+typedef struct {
+	idImage *			image;
+	const idMaterial *	material;
+	byte *				pic;				// kept to regenerate the texture after a purge
+	idList<guiAtlasShelf_t>	shelves;
+	int					shelfEnd;			// first row not used by a shelf
+	int					numImages;
+	int					generation;			// bumped whenever an image is copied into pic
+	int					queuedGeneration;	// generation the texture was last queued for upload at
+	int					uploadedGeneration;	// generation the texture was last generated from
+} guiAtlasPage_t;
+
+class idGuiAtlas {
+public:
+						idGuiAtlas();
+
+	void				Shutdown();
+
+	// returns the atlas entry for the material, adding its image to an atlas page the
+	// first time the material is seen.  Returns NULL if the material can't be drawn
+	// from the atlas.
+	const guiAtlasEntry_t *	FindEntry( const idMaterial *material );
+
+	// material used to draw the surfaces of an atlas page
+	const idMaterial *	PageMaterial( int page ) const { return pages[page]->material; }
+
+	int					NumPages() const { return pages.Num(); }
+	int					NumImages() const;
+
+	// queues the pages that changed since their last upload, called once at the end
+	// of each frontend frame so the images added during the frame go up together
+	void				QueueUploads();
+
+	// called by the backend through the image generator function
+	void				GeneratePageImage( idImage *image );
+
+private:
+	bool				CanAtlas( const idMaterial *material ) const;
+	bool				AllocRect( guiAtlasPage_t *page, int width, int height, int &x, int &y );
+	guiAtlasPage_t *	AllocPage();
+	void				AddEntry( guiAtlasEntry_t &entry );
+
+	idList<guiAtlasEntry_t>	entries;
+	idHashIndex			entryHash;
+	idList<guiAtlasPage_t *>pages;
+};
+
+extern idGuiAtlas		guiAtlas;
+
+#endif /* !__GUIATLAS_H__ */
@@ -28,8 +28,10 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "sys/platform.h"
 #include "framework/DemoFile.h"
+#include "framework/Session.h"
 #include "renderer/tr_local.h"
 #include "renderer/VertexCache.h"
+#include "renderer/GuiAtlas.h"
 
 #include "renderer/GuiModel.h"
 
@@ -41,6 +43,8 @@ idGuiModel::idGuiModel
 idGuiModel::idGuiModel() {
 	indexes.SetGranularity( 1000 );
 	verts.SetGranularity( 1000 );
+	color[0] = color[1] = color[2] = color[3] = 1.0f;
+	lastDrawMaterial = NULL;
 }
 
 /*
@@ -55,6 +59,8 @@ void idGuiModel::Clear() {
 	indexes.SetNum( 0, false );
 	verts.SetNum( 0, false );
 	AdvanceSurf();
+	color[0] = color[1] = color[2] = color[3] = 1.0f;
+	lastDrawMaterial = NULL;
 }
 
 /*
@@ -154,6 +160,7 @@ void idGuiModel::ReadFromDemo( idDemoFile *demo ) {
 		demo->ReadInt( surf->numVerts );
 		demo->ReadInt( surf->firstIndex );
 		demo->ReadInt( surf->numIndexes );
+		surf->numMerged = 0;
 		surf->material = declManager->FindMaterial( demo->ReadHashString() );
 	}
 }
@@ -170,6 +177,9 @@ void idGuiModel::EmitSurface( guiModelSurface_t *surf, float modelMatrix[16], fl
 		return;		// nothing in the surface
 	}
 
+	tr.pc.c_guiModelSurfs++;
+	tr.pc.c_guiModelSurfsUnbatched += 1 + surf->numMerged;
+
 	// copy verts and indexes
 	tri = (srfTriangles_t *)R_ClearedFrameAlloc( sizeof( *tri ) );
 
@@ -185,7 +195,7 @@ void idGuiModel::EmitSurface( guiModelSurface_t *surf, float modelMatrix[16], fl
 	memcpy( tri->verts, &verts[surf->firstVert], tri->numVerts * sizeof( tri->verts[0] ) );
 
 	// move the verts to the vertex cache
-	tri->ambientCache = vertexCache.AllocFrameTemp( tri->verts, tri->numVerts * sizeof( tri->verts[0] ), false );
+	tri->ambientCache = vertexCache.AllocFrameTempVerts( tri->verts, tri->numVerts );
 	tri->indexCache   = vertexCache.AllocFrameTemp( tri->indexes, tri->numIndexes * sizeof( glIndex_t ), true );
 
 	// if we are out of vertex cache, don't create the surface
@@ -333,6 +343,7 @@ void idGuiModel::AdvanceSurf() {
 	s.firstIndex = indexes.Num();
 	s.numVerts = 0;
 	s.firstVert = verts.Num();
+	s.numMerged = 0;
 
 	surfaces.Append( s );
 	surf = &surfaces[ surfaces.Num() - 1 ];
@@ -347,20 +358,110 @@ void idGuiModel::SetColor( float r, float g, float b, float a ) {
 	if ( !glConfig.isInitialized ) {
 		return;
 	}
-	if ( r == surf->color[0] && g == surf->color[1]
-		&& b == surf->color[2] && a == surf->color[3] ) {
-		return;	// no change
+
+	// the surface is broken by the next draw if it needs the new color
+	color[0] = r;
+	color[1] = g;
+	color[2] = b;
+	color[3] = a;
+}
+
+/*
+=============
+AtlasEntry
+
+Returns the gui atlas entry to draw the verts with, or NULL if
+they have to be drawn with the material itself
+=============
+*/
+const guiAtlasEntry_t *idGuiModel::AtlasEntry( const idMaterial *material, const idDrawVert *dverts, int vertCount ) const {
+	if ( !r_guiAtlas.GetBool() ) {
+		return NULL;
+	}
+	// demos reference the materials by name, and the atlas contents aren't saved
+	if ( session->writeDemo ) {
+		return NULL;
+	}
+
+	// the atlas can't repeat the image, so the texcoords must stay inside of it
+	for ( int i = 0; i < vertCount; i++ ) {
+		if ( dverts[i].st[0] < 0.0f || dverts[i].st[0] > 1.0f || dverts[i].st[1] < 0.0f || dverts[i].st[1] > 1.0f ) {
+			return NULL;
+		}
 	}
 
-	if ( surf->numVerts ) {
-		AdvanceSurf();
+	return guiAtlas.FindEntry( material );
+}
+
+/*
+=============
+BeginDraw
+
+Breaks the current surface if we are changing to a new material or color.
+Draws from the gui atlas only break it when changing to another atlas page.
+=============
+*/
+void idGuiModel::BeginDraw( const idMaterial *material, const guiAtlasEntry_t *atlas ) {
+	const idMaterial *surfMaterial = material;
+	const float *surfColor = color;
+
+	if ( atlas ) {
+		surfMaterial = guiAtlas.PageMaterial( atlas->page );
+		surfColor = colorWhite.ToFloatPtr();
 	}
 
-	// change the parms
-	surf->color[0] = r;
-	surf->color[1] = g;
-	surf->color[2] = b;
-	surf->color[3] = a;
+	bool newDraw = ( material != lastDrawMaterial || color[0] != lastDrawColor[0] || color[1] != lastDrawColor[1]
+						|| color[2] != lastDrawColor[2] || color[3] != lastDrawColor[3] );
+
+	if ( surfMaterial != surf->material || surfColor[0] != surf->color[0] || surfColor[1] != surf->color[1]
+			|| surfColor[2] != surf->color[2] || surfColor[3] != surf->color[3] ) {
+		if ( surf->numVerts ) {
+			AdvanceSurf();
+		}
+		if ( surfMaterial != surf->material ) {
+			const_cast<idMaterial *>(surfMaterial)->EnsureNotPurged();	// in case it was a gui item started before a level change
+			surf->material = surfMaterial;
+		}
+		surf->color[0] = surfColor[0];
+		surf->color[1] = surfColor[1];
+		surf->color[2] = surfColor[2];
+		surf->color[3] = surfColor[3];
+	} else if ( newDraw && surf->numVerts ) {
+		// without the atlas this would have started a new surface
+		surf->numMerged++;
+	}
+
+	lastDrawMaterial = material;
+	lastDrawColor[0] = color[0];
+	lastDrawColor[1] = color[1];
+	lastDrawColor[2] = color[2];
+	lastDrawColor[3] = color[3];
+}
+
+/*
+=============
+RemapAtlasVerts
+
+Moves the texcoords of the verts added since firstVert into the atlas
+page and stores the current color in the verts
+=============
+*/
+void idGuiModel::RemapAtlasVerts( const guiAtlasEntry_t *atlas, int firstVert ) {
+	byte	vertColor[4];
+
+	for ( int i = 0; i < 4; i++ ) {
+		vertColor[i] = idMath::ClampInt( 0, 255, idMath::FtoiFast( color[i] * 255.0f ) );
+	}
+
+	for ( int i = firstVert; i < verts.Num(); i++ ) {
+		idDrawVert *dv = &verts[i];
+		dv->st[0] = atlas->bias[0] + dv->st[0] * atlas->scale[0];
+		dv->st[1] = atlas->bias[1] + dv->st[1] * atlas->scale[1];
+		dv->color[0] = vertColor[0];
+		dv->color[1] = vertColor[1];
+		dv->color[2] = vertColor[2];
+		dv->color[3] = vertColor[3];
+	}
 }
 
 /*
@@ -377,14 +478,11 @@ void idGuiModel::DrawStretchPic( const idDrawVert *dverts, const glIndex_t *dind
 		return;
 	}
 
-	// break the current surface if we are changing to a new material
-	if ( hShader != surf->material ) {
-		if ( surf->numVerts ) {
-			AdvanceSurf();
-		}
-		const_cast<idMaterial *>(hShader)->EnsureNotPurged();	// in case it was a gui item started before a level change
-		surf->material = hShader;
-	}
+	const guiAtlasEntry_t *atlas = AtlasEntry( hShader, dverts, vertCount );
+
+	BeginDraw( hShader, atlas );
+
+	int firstVert = verts.Num();
 
 	// add the verts and indexes to the current surface
 
@@ -459,6 +557,10 @@ void idGuiModel::DrawStretchPic( const idDrawVert *dverts, const glIndex_t *dind
 
 		memcpy( &verts[numVerts], dverts, vertCount * sizeof( verts[0] ) );
 	}
+
+	if ( atlas ) {
+		RemapAtlasVerts( atlas, firstVert );
+	}
 }
 
 /*
@@ -636,15 +738,9 @@ void idGuiModel::DrawStretchTri( idVec2 p1, idVec2 p2, idVec2 p3, idVec2 t1, idV
 	tempVerts[2].tangents[1][1] = 1;
 	tempVerts[2].tangents[1][2] = 0;
 
-	// break the current surface if we are changing to a new material
-	if ( material != surf->material ) {
-		if ( surf->numVerts ) {
-			AdvanceSurf();
-		}
-		const_cast<idMaterial *>(material)->EnsureNotPurged();	// in case it was a gui item started before a level change
-		surf->material = material;
-	}
+	const guiAtlasEntry_t *atlas = AtlasEntry( material, tempVerts, vertCount );
 
+	BeginDraw( material, atlas );
 
 	int numVerts = verts.Num();
 	int numIndexes = indexes.Num();
@@ -660,4 +756,8 @@ void idGuiModel::DrawStretchTri( idVec2 p1, idVec2 p2, idVec2 p3, idVec2 t1, idV
 	}
 
 	memcpy( &verts[numVerts], tempVerts, vertCount * sizeof( verts[0] ) );
+
+	if ( atlas ) {
+		RemapAtlasVerts( atlas, numVerts );
+	}
 }
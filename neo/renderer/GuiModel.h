@@ -39,6 +39,7 @@ typedef struct {
 	int					numVerts;
 	int					firstIndex;
 	int					numIndexes;
+	int					numMerged;		// material or color changes drawn into this surface through the gui atlas
 } guiModelSurface_t;
 
 class idGuiModel {
@@ -66,8 +67,16 @@ private:
 	void	AdvanceSurf();
 	void	EmitSurface( guiModelSurface_t *surf, float modelMatrix[16], float modelViewMatrix[16], bool depthHack );
 
+	const struct guiAtlasEntry_s *AtlasEntry( const idMaterial *material, const idDrawVert *dverts, int vertCount ) const;
+	void	BeginDraw( const idMaterial *material, const struct guiAtlasEntry_s *atlas );
+	void	RemapAtlasVerts( const struct guiAtlasEntry_s *atlas, int firstVert );
+
 	guiModelSurface_t		*surf;
 
+	float					color[4];			// from SetColor, applied to the next draws
+	const idMaterial *		lastDrawMaterial;	// to count the surfaces that would be needed without the atlas
+	float					lastDrawColor[4];
+
 	idList<guiModelSurface_t>	surfaces;
 	idList<glIndex_t>		indexes;
 	idList<idDrawVert>	verts;
@@ -531,8 +531,8 @@ static void LoadTGA( const char *name, byte **pic, int *width, int *height, ID_T
 	int		columns, rows, numPixels, fileSize, numBytes;
 	byte	*pixbuf;
 	int		row, column;
-	byte	*buf_p;
-	byte	*buffer;
+	const byte	*buf_p;
+	const void	*buffer;
 	TargaHeader	targa_header;
 	byte		*targa_rgba;
 
@@ -544,14 +544,14 @@ static void LoadTGA( const char *name, byte **pic, int *width, int *height, ID_T
 	*pic = NULL;
 
 	//
-	// load the file
+	// load the file, stored tgas in a mapped pak are read in place
 	//
-	fileSize = fileSystem->ReadFile( name, (void **)&buffer, timestamp );
+	fileSize = fileSystem->ReadFileMapped( name, &buffer, timestamp );
 	if ( !buffer ) {
 		return;
 	}
 
-	buf_p = buffer;
+	buf_p = (const byte *)buffer;
 
 	targa_header.id_length = *buf_p++;
 	targa_header.colormap_type = *buf_p++;
@@ -756,7 +756,7 @@ static void LoadTGA( const char *name, byte **pic, int *width, int *height, ID_T
 		R_VerticalFlip( *pic, *width, *height );
 	}
 
-	fileSystem->FreeFile( buffer );
+	fileSystem->FreeFileMapped( buffer );
 }
 
 /*
@@ -29,6 +29,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "sys/platform.h"
 #include "framework/async/AsyncNetwork.h"
 #include "framework/Session.h"
+#include "framework/ResourceManifest.h"
 #include "renderer/tr_local.h"
 
 #include "renderer/Image.h"
@@ -1431,6 +1432,10 @@ idImage	*idImageManager::ImageFromFile( const char *_name, textureFilter_t filte
 	name.Replace( ".tga", "" );
 	name.BackSlashesToSlashes();
 
+	if ( resourceManifest.IsRecording() && name[0] != '_' ) {
+		resourceManifest.AddImage( name, filter, allowDownSize, repeat, depth, cubeMap );
+	}
+
 	//
 	// see if the image is already loaded, unless we
 	// are in a reloadImages call
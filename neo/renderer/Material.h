@@ -171,6 +171,7 @@ typedef struct {
 	dynamicidImage_t	dynamic;
 	int					width, height;
 	int					dynamicFrameCount;
+	int					dynamicRenderTime;	// msec of the last capture into an image owned by the stage, 0 = none
 } textureStage_t;
 
 // the order BUMP / DIFFUSE / SPECULAR is necessary for interactions to draw correctly on low end cards
@@ -578,6 +579,9 @@ public:
 						// returns number of registers this material contains
 	const int			GetNumRegisters() const { return numRegisters; }
 
+						// number of expression ops, zero if all registers are constants or predefined
+	const int			GetNumOps() const { return numOps; }
+
 						// regs should point to a float array large enough to hold GetNumRegisters() floats
 	void				EvaluateRegisters( float *regs, const float entityParms[MAX_ENTITY_SHADER_PARMS],
 											const struct viewDef_s *view, idSoundEmitter *soundEmitter = NULL ) const;
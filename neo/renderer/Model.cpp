@@ -28,6 +28,7 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "sys/platform.h"
 #include "idlib/containers/VectorSet.h"
+#include "idlib/hashing/CRC32.h"
 #include "framework/DemoFile.h"
 #include "renderer/tr_local.h"
 #include "renderer/Model_local.h"
@@ -42,6 +43,9 @@ idCVar idRenderModelStatic::r_mergeModelSurfaces( "r_mergeModelSurfaces", "1", C
 idCVar idRenderModelStatic::r_slopVertex( "r_slopVertex", "0.01", CVAR_RENDERER, "merge xyz coordinates this far apart" );
 idCVar idRenderModelStatic::r_slopTexCoord( "r_slopTexCoord", "0.001", CVAR_RENDERER, "merge texture coordinates this far apart" );
 idCVar idRenderModelStatic::r_slopNormal( "r_slopNormal", "0.02", CVAR_RENDERER, "merge normals that dot less than this" );
+idCVar idRenderModelStatic::r_binaryModels( "r_binaryModels", "1", CVAR_BOOL|CVAR_RENDERER, "load processed models from binary files written after the first load of the source model" );
+idCVar idRenderModelStatic::r_modelLODs( "r_modelLODs", "2", CVAR_INTEGER|CVAR_RENDERER, "number of reduced detail versions generated for each model at load time", 0, 3, idCmdSystem::ArgCompletion_Integer<0,3> );
+idCVar idRenderModelStatic::r_lodMinTris( "r_lodMinTris", "500", CVAR_INTEGER|CVAR_RENDERER, "don't generate reduced detail versions of models with fewer triangles" );
 
 /*
 ================
@@ -130,6 +134,10 @@ int idRenderModelStatic::Memory() const {
 		totalBytes += R_TriSurfMemory( surf->geometry );
 	}
 
+	for ( int j = 0 ; j < lods.Num() ; j++ ) {
+		totalBytes += lods[j]->Memory();
+	}
+
 	return totalBytes;
 }
 
@@ -287,6 +295,12 @@ void idRenderModelStatic::InitFromFile( const char *fileName ) {
 
 	name.ExtractFileExtension( extension );
 
+	if ( LoadBinarySurfaces() ) {
+		reloadable = true;
+		GenerateLODs();
+		return;
+	}
+
 	if ( extension.Icmp( "ase" ) == 0 ) {
 		loaded		= LoadASE( name );
 		reloadable	= true;
@@ -315,6 +329,10 @@ void idRenderModelStatic::InitFromFile( const char *fileName ) {
 
 	// create the bounds for culling and dynamic surface creation
 	FinishSurfaces();
+
+	WriteBinarySurfaces();
+
+	GenerateLODs();
 }
 
 /*
@@ -407,6 +425,30 @@ const modelSurface_t *idRenderModelStatic::Surface( int surfaceNum ) const {
 	return &surfaces[surfaceNum];
 }
 
+/*
+================
+idRenderModelStatic::NumLODs
+================
+*/
+int idRenderModelStatic::NumLODs() const {
+	return lods.Num();
+}
+
+/*
+================
+idRenderModelStatic::LOD
+================
+*/
+idRenderModel *idRenderModelStatic::LOD( int level ) {
+	if ( level <= 0 || lods.Num() == 0 ) {
+		return this;
+	}
+	if ( level > lods.Num() ) {
+		level = lods.Num();
+	}
+	return lods[level - 1];
+}
+
 /*
 ================
 idRenderModelStatic::AllocSurfaceTriangles
@@ -555,6 +597,21 @@ int idRenderModelStatic::NearestJoint( int surfaceNum, int a, int b, int c ) con
 //=====================================================================
 
 
+/*
+================
+R_AddSurfaceArea
+================
+*/
+static void R_AddSurfaceArea( const modelSurface_t *surf ) {
+	const srfTriangles_t	*tri = surf->geometry;
+
+	for ( int j = 0 ; j < tri->numIndexes ; j += 3 ) {
+		float	area = idWinding::TriangleArea( tri->verts[tri->indexes[j]].xyz,
+			 tri->verts[tri->indexes[j+1]].xyz,  tri->verts[tri->indexes[j+2]].xyz );
+		const_cast<idMaterial *>(surf->shader)->AddToSurfaceArea( area );
+	}
+}
+
 /*
 ================
 idRenderModelStatic::FinishSurfaces
@@ -664,14 +721,7 @@ void idRenderModelStatic::FinishSurfaces() {
 
 	// add up the total surface area for development information
 	for ( i = 0 ; i < surfaces.Num() ; i++ ) {
-		const modelSurface_t	*surf = &surfaces[i];
-		srfTriangles_t	*tri = surf->geometry;
-
-		for ( int j = 0 ; j < tri->numIndexes ; j += 3 ) {
-			float	area = idWinding::TriangleArea( tri->verts[tri->indexes[j]].xyz,
-				 tri->verts[tri->indexes[j+1]].xyz,  tri->verts[tri->indexes[j+2]].xyz );
-			const_cast<idMaterial *>(surf->shader)->AddToSurfaceArea( area );
-		}
+		R_AddSurfaceArea( &surfaces[i] );
 	}
 
 	// calculate the bounds
@@ -2102,6 +2152,275 @@ bool idRenderModelStatic::LoadFLT( const char *fileName ) {
 
 //=============================================================================
 
+/*
+===============================================================================
+
+	Binary models
+
+	The processed surfaces of a model are written to <name>.b<ext> after
+	the source file was loaded the first time, so later loads skip the
+	parsers, the cleanup and the tangent / silhouette generation.  The
+	header records the length and timestamp of the source file, the layout
+	of the stored arrays and the settings that change the processing.
+
+===============================================================================
+*/
+
+#define BINARY_MODEL_ID			( ( 'L' << 24 ) | ( 'D' << 16 ) | ( 'M' << 8 ) | 'B' )
+#define BINARY_MODEL_VERSION	2
+
+typedef struct binaryModelHeader_s {
+	int							ident;
+	int							version;
+	int							sourceLength;
+	int							sourceTimeStamp;
+	int							structSizes[8];
+	int							mergeSurfaces;
+	int							orderIndexes;
+	float						slop[3];
+	int							payloadLength;
+	unsigned int				payloadCRC;
+} binaryModelHeader_t;
+
+/*
+================
+R_BinaryModelName
+================
+*/
+static idStr R_BinaryModelName( const idStr &name ) {
+	idStr extension, binaryName;
+
+	name.ExtractFileExtension( extension );
+	binaryName = name;
+	binaryName.StripFileExtension();
+	binaryName += ".b";
+	binaryName += extension;
+	return binaryName;
+}
+
+/*
+================
+R_BinaryModelMaterialFlags
+
+Material settings that FinishSurfaces and the deform setup depend on
+================
+*/
+int R_BinaryModelMaterialFlags( const idMaterial *shader ) {
+	int flags = 0;
+	if ( shader->ShouldCreateBackSides() ) {
+		flags |= BIT( 0 );
+	}
+	if ( shader->UseUnsmoothedTangents() ) {
+		flags |= BIT( 1 );
+	}
+	if ( shader->Deform() != DFRM_NONE ) {
+		flags |= BIT( 2 );
+	}
+	if ( shader->SurfaceCastsShadow() ) {
+		flags |= BIT( 3 );
+	}
+	return flags;
+}
+
+/*
+================
+R_SetBinaryModelHeader
+================
+*/
+static void R_SetBinaryModelHeader( binaryModelHeader_t &header, int sourceLength, ID_TIME_T sourceTimeStamp,
+									const idCVar &mergeSurfaces, const idCVar &slopVertex, const idCVar &slopTexCoord, const idCVar &slopNormal ) {
+	memset( &header, 0, sizeof( header ) );
+	header.ident = BINARY_MODEL_ID;
+	header.version = BINARY_MODEL_VERSION;
+	header.sourceLength = sourceLength;
+	header.sourceTimeStamp = (int)sourceTimeStamp;
+	header.structSizes[0] = sizeof( idDrawVert );
+	header.structSizes[1] = sizeof( glIndex_t );
+	header.structSizes[2] = sizeof( silEdge_t );
+	header.structSizes[3] = sizeof( dominantTri_t );
+	header.structSizes[4] = sizeof( idPlane );
+	header.structSizes[5] = sizeof( shadowCache_t );
+	header.structSizes[6] = sizeof( idJointMat );
+	header.structSizes[7] = sizeof( idJointQuat );
+	header.mergeSurfaces = mergeSurfaces.GetInteger();
+	header.orderIndexes = r_orderIndexes.GetBool();
+	header.slop[0] = slopVertex.GetFloat();
+	header.slop[1] = slopTexCoord.GetFloat();
+	header.slop[2] = slopNormal.GetFloat();
+}
+
+/*
+================
+idRenderModelStatic::OpenBinaryModel
+================
+*/
+idFile_Memory *idRenderModelStatic::OpenBinaryModel( void ) {
+	binaryModelHeader_t	header, expected;
+	ID_TIME_T			sourceTimeStamp;
+	void *				buffer;
+
+	if ( !r_binaryModels.GetBool() || fastLoad ) {
+		return NULL;
+	}
+
+	int sourceLength = fileSystem->ReadFile( name, NULL, &sourceTimeStamp );
+	if ( sourceLength <= 0 ) {
+		return NULL;
+	}
+
+	idStr binaryName = R_BinaryModelName( name );
+	int length = fileSystem->ReadFile( binaryName, &buffer );
+	if ( !buffer ) {
+		return NULL;
+	}
+	if ( length < (int)sizeof( header ) ) {
+		fileSystem->FreeFile( buffer );
+		return NULL;
+	}
+
+	memcpy( &header, buffer, sizeof( header ) );
+	R_SetBinaryModelHeader( expected, sourceLength, sourceTimeStamp, r_mergeModelSurfaces, r_slopVertex, r_slopTexCoord, r_slopNormal );
+	expected.payloadLength = length - sizeof( header );
+	expected.payloadCRC = header.payloadCRC;
+
+	const char *payload = (const char *)buffer + sizeof( header );
+	if ( memcmp( &header, &expected, sizeof( header ) ) != 0 || CRC32_BlockChecksum( payload, expected.payloadLength ) != header.payloadCRC ) {
+		fileSystem->FreeFile( buffer );
+		return NULL;
+	}
+
+	idFile_Memory *f = new idFile_Memory( binaryName );
+	f->SetGranularity( Max( expected.payloadLength, 1 ) );
+	f->Write( payload, expected.payloadLength );
+	f->MakeReadOnly();
+
+	fileSystem->FreeFile( buffer );
+
+	// set the timestamp for reloadmodels
+	timeStamp = sourceTimeStamp;
+
+	return f;
+}
+
+/*
+================
+idRenderModelStatic::WriteBinaryModel
+================
+*/
+void idRenderModelStatic::WriteBinaryModel( idFile_Memory *payload ) {
+	binaryModelHeader_t	header;
+	ID_TIME_T			sourceTimeStamp;
+
+	int sourceLength = fileSystem->ReadFile( name, NULL, &sourceTimeStamp );
+	if ( sourceLength <= 0 ) {
+		return;
+	}
+
+	idStr binaryName = R_BinaryModelName( name );
+	idFile *f = fileSystem->OpenFileWrite( binaryName );
+	if ( !f ) {
+		common->Warning( "couldn't write %s", binaryName.c_str() );
+		return;
+	}
+
+	R_SetBinaryModelHeader( header, sourceLength, sourceTimeStamp, r_mergeModelSurfaces, r_slopVertex, r_slopTexCoord, r_slopNormal );
+	header.payloadLength = payload->Length();
+	header.payloadCRC = CRC32_BlockChecksum( payload->GetDataPtr(), payload->Length() );
+
+	f->Write( &header, sizeof( header ) );
+	f->Write( payload->GetDataPtr(), payload->Length() );
+
+	fileSystem->CloseFile( f );
+}
+
+/*
+================
+idRenderModelStatic::LoadBinarySurfaces
+
+Returns false and leaves the model empty if there is no usable binary model
+================
+*/
+bool idRenderModelStatic::LoadBinarySurfaces( void ) {
+	idFile_Memory *	f;
+	idStr			materialName;
+	int				i, numSurfaces, flags;
+
+	f = OpenBinaryModel();
+	if ( !f ) {
+		return false;
+	}
+
+	f->ReadInt( numSurfaces );
+	f->ReadVec3( bounds[0] );
+	f->ReadVec3( bounds[1] );
+
+	for ( i = 0 ; i < numSurfaces ; i++ ) {
+		modelSurface_t	surf;
+
+		f->ReadInt( surf.id );
+		f->ReadString( materialName );
+		f->ReadInt( flags );
+
+		// the material may have changed since the model was processed
+		surf.shader = declManager->FindMaterial( materialName );
+		if ( R_BinaryModelMaterialFlags( surf.shader ) != flags ) {
+			break;
+		}
+
+		surf.geometry = R_ReadStaticTriSurf( f );
+		if ( !surf.geometry ) {
+			break;
+		}
+		surfaces.Append( surf );
+	}
+
+	delete f;
+
+	if ( i < numSurfaces || numSurfaces <= 0 ) {
+		PurgeModel();
+		bounds.Zero();
+		return false;
+	}
+
+	// add up the total surface area for development information
+	for ( i = 0 ; i < surfaces.Num() ; i++ ) {
+		R_AddSurfaceArea( &surfaces[i] );
+	}
+
+	// it is now available for use
+	purged = false;
+
+	return true;
+}
+
+/*
+================
+idRenderModelStatic::WriteBinarySurfaces
+================
+*/
+void idRenderModelStatic::WriteBinarySurfaces( void ) {
+	if ( !r_binaryModels.GetBool() || fastLoad || defaulted || surfaces.Num() == 0 ) {
+		return;
+	}
+
+	idFile_Memory payload( name );
+
+	payload.WriteInt( surfaces.Num() );
+	payload.WriteVec3( bounds[0] );
+	payload.WriteVec3( bounds[1] );
+
+	for ( int i = 0 ; i < surfaces.Num() ; i++ ) {
+		const modelSurface_t *surf = &surfaces[i];
+
+		payload.WriteInt( surf->id );
+		payload.WriteString( surf->shader->GetName() );
+		payload.WriteInt( R_BinaryModelMaterialFlags( surf->shader ) );
+		R_WriteStaticTriSurf( &payload, surf->geometry );
+	}
+
+	WriteBinaryModel( &payload );
+}
+
 /*
 ================
 idRenderModelStatic::PurgeModel
@@ -2120,9 +2439,93 @@ void idRenderModelStatic::PurgeModel() {
 	}
 	surfaces.Clear();
 
+	FreeLODs();
+
 	purged = true;
 }
 
+/*
+================
+idRenderModelStatic::FreeLODs
+================
+*/
+void idRenderModelStatic::FreeLODs( void ) {
+	lods.DeleteContents( true );
+}
+
+/*
+================
+idRenderModelStatic::GenerateLODs
+
+Each level has about half the triangles of the previous one.  Surfaces with
+deforms and small surfaces are kept as they are, and generation stops when a
+level doesn't reduce the model enough to be worth the memory.
+================
+*/
+void idRenderModelStatic::GenerateLODs( void ) {
+	int		i, level, totalTris, lodTris;
+
+	FreeLODs();
+
+	if ( fastLoad || defaulted || isStaticWorldModel || r_modelLODs.GetInteger() <= 0 ) {
+		return;
+	}
+
+	totalTris = 0;
+	for ( i = 0 ; i < surfaces.Num() ; i++ ) {
+		if ( surfaces[i].geometry ) {
+			totalTris += surfaces[i].geometry->numIndexes / 3;
+		}
+	}
+	if ( totalTris < r_lodMinTris.GetInteger() ) {
+		return;
+	}
+
+	const idRenderModelStatic *previous = this;
+	for ( level = 1 ; level <= r_modelLODs.GetInteger() ; level++ ) {
+		idRenderModelStatic *lod = new idRenderModelStatic;
+		lod->InitEmpty( va( "%s_lod%i", name.c_str(), level ) );
+		lod->bounds = bounds;
+		lod->timeStamp = timeStamp;
+
+		lodTris = 0;
+		for ( i = 0 ; i < previous->surfaces.Num() ; i++ ) {
+			const modelSurface_t *surf = &previous->surfaces[i];
+			const srfTriangles_t *tri = surf->geometry;
+			if ( !tri ) {
+				continue;
+			}
+
+			int targetIndexes = tri->numIndexes;
+			if ( surf->shader->Deform() == DFRM_NONE && tri->numIndexes >= 3 * 32 ) {
+				targetIndexes = ( tri->numIndexes / 6 ) * 3;
+			}
+
+			modelSurface_t newSurf;
+			newSurf.id = surf->id;
+			newSurf.shader = surf->shader;
+			newSurf.geometry = R_SimplifyStaticTriSurf( tri, targetIndexes, surf->shader->UseUnsmoothedTangents() );
+
+			// keep the expanded bounds of deformed surfaces
+			if ( surf->shader->Deform() != DFRM_NONE ) {
+				newSurf.geometry->bounds = tri->bounds;
+			}
+
+			lodTris += newSurf.geometry->numIndexes / 3;
+			lod->surfaces.Append( newSurf );
+		}
+
+		if ( lodTris > totalTris * 0.8f ) {
+			delete lod;
+			break;
+		}
+
+		lods.Append( lod );
+		previous = lod;
+		totalTris = lodTris;
+	}
+}
+
 /*
 ==============
 idRenderModelStatic::FreeVertexCache
@@ -2131,6 +2534,10 @@ We are about to restart the vertex cache, so dump everything
 ==============
 */
 void idRenderModelStatic::FreeVertexCache( void ) {
+	for ( int j = 0 ; j < lods.Num() ; j++ ) {
+		lods[j]->FreeVertexCache();
+	}
+
 	for ( int j = 0 ; j < surfaces.Num() ; j++ ) {
 		srfTriangles_t *tri = surfaces[j].geometry;
 		if ( !tri ) {
@@ -134,6 +134,13 @@ typedef struct srfTriangles_s {
 	struct vertCache_s *		indexCache;				// int
 	struct vertCache_s *		ambientCache;			// idDrawVert
 	struct vertCache_s *		shadowCache;			// shadowCache_t
+
+	// material deform results of static surfaces, see R_DeformDrawSurf
+	deform_t					deformType;				// DFRM_NONE if nothing is cached
+	const idMaterial *			deformMaterial;
+	float						deformParms[6];			// the inputs the deformCache was generated from
+	struct vertCache_s *		deformCache;			// idDrawVert
+	struct vertCache_s *		deformIndexCache;		// glIndex_t
 } srfTriangles_t;
 
 typedef idList<srfTriangles_t *> idTriList;
@@ -241,6 +248,12 @@ public:
 	// get a pointer to a surface
 	virtual const modelSurface_t *Surface( int surfaceNum ) const = 0;
 
+	// number of reduced detail versions generated at load time, not counting the model itself
+	virtual int					NumLODs() const = 0;
+
+	// returns the model itself for level 0 and the most reduced version for levels past NumLODs()
+	virtual idRenderModel *		LOD( int level ) = 0;
+
 	// Allocates surface triangles.
 	// Allocates memory for srfTriangles_t::verts and srfTriangles_t::indexes
 	// The allocated memory is not initialized.
@@ -513,7 +513,7 @@ void idRenderModelDecal::AddDecalDrawSurf( viewEntity_t *space ) {
 	*newTri = tri;
 
 	// copy the current vertexes to temp vertex cache
-	newTri->ambientCache = vertexCache.AllocFrameTemp( tri.verts, tri.numVerts * sizeof( idDrawVert ), false);
+	newTri->ambientCache = vertexCache.AllocFrameTempVerts( tri.verts, tri.numVerts );
 	newTri->indexCache   = vertexCache.AllocFrameTemp( tri.indexes, tri.numIndexes * sizeof( glIndex_t ), true );
 
 	// create the drawsurf
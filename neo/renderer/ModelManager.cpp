@@ -29,6 +29,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "sys/platform.h"
 #include "framework/CVarSystem.h"
 #include "framework/Session.h"
+#include "framework/ResourceManifest.h"
 #include "renderer/RenderWorld.h"
 #include "renderer/Model_local.h"
 #include "renderer/tr_local.h"	// just for R_FreeWorldInteractions and R_CreateWorldInteractions
@@ -72,6 +73,7 @@ private:
 	static void				ListModels_f( const idCmdArgs &args );
 	static void				ReloadModels_f( const idCmdArgs &args );
 	static void				TouchModel_f( const idCmdArgs &args );
+	static void				ReportVertexCache_f( const idCmdArgs &args );
 };
 
 
@@ -179,6 +181,106 @@ void idRenderModelManagerLocal::TouchModel_f( const idCmdArgs &args ) {
 	}
 }
 
+/*
+==============
+R_SurfaceCacheLoads
+
+Adds the vertex cache loads of the index list as it is and after reordering it
+==============
+*/
+static void R_SurfaceCacheLoads( int numIndexes, const glIndex_t *indexes, int cacheSize, int &loads, int &optimizedLoads ) {
+	int		i;
+
+	glIndex_t *optimized = (glIndex_t *)Mem_Alloc( numIndexes * sizeof( optimized[0] ) );
+	int *intIndexes = (int *)Mem_Alloc( numIndexes * sizeof( intIndexes[0] ) );
+
+	int numVerts = 0;
+	for ( i = 0 ; i < numIndexes ; i++ ) {
+		intIndexes[i] = indexes[i];
+		numVerts = Max( numVerts, intIndexes[i] + 1 );
+	}
+	R_OptimizeIndexOrder( numVerts, numIndexes, intIndexes );
+	for ( i = 0 ; i < numIndexes ; i++ ) {
+		optimized[i] = intIndexes[i];
+	}
+
+	loads += R_MeshCost( numIndexes, indexes, cacheSize );
+	optimizedLoads += R_MeshCost( numIndexes, optimized, cacheSize );
+
+	Mem_Free( intIndexes );
+	Mem_Free( optimized );
+}
+
+/*
+==============
+idRenderModelManagerLocal::ReportVertexCache_f
+
+Prints the average cache miss ratio of every loaded model for the index order
+in memory and after vertex cache optimization.  Load with r_orderIndexes 0 to
+compare against the order of the source files.
+==============
+*/
+void idRenderModelManagerLocal::ReportVertexCache_f( const idCmdArgs &args ) {
+	int		cacheSize = 32;
+	int		totalTris = 0;
+	int		totalLoads = 0;
+	int		totalOptimizedLoads = 0;
+
+	if ( args.Argc() > 1 ) {
+		cacheSize = Max( 3, atoi( args.Argv( 1 ) ) );
+	}
+
+	common->Printf( "ACMR for a %i entry FIFO cache\n", cacheSize );
+	common->Printf( "  tris  ACMR optimized\n" );
+	common->Printf( "  ----  ---- ---------\n" );
+
+	for ( int i = 0 ; i < localModelManager.models.Num() ; i++ ) {
+		idRenderModel	*model = localModelManager.models[i];
+		int				tris = 0;
+		int				loads = 0;
+		int				optimizedLoads = 0;
+
+		if ( !model->IsLoaded() ) {
+			continue;
+		}
+
+		idRenderModelMD5 *md5 = dynamic_cast<idRenderModelMD5 *>( model );
+		if ( md5 ) {
+			for ( int j = 0 ; j < md5->NumMeshes() ; j++ ) {
+				int numIndexes;
+				const glIndex_t *indexes = md5->MeshIndexes( j, numIndexes );
+				if ( indexes ) {
+					R_SurfaceCacheLoads( numIndexes, indexes, cacheSize, loads, optimizedLoads );
+					tris += numIndexes / 3;
+				}
+			}
+		} else if ( model->IsDynamicModel() == DM_STATIC ) {
+			for ( int j = 0 ; j < model->NumSurfaces() ; j++ ) {
+				const srfTriangles_t *tri = model->Surface( j )->geometry;
+				if ( tri && tri->indexes ) {
+					R_SurfaceCacheLoads( tri->numIndexes, tri->indexes, cacheSize, loads, optimizedLoads );
+					tris += tri->numIndexes / 3;
+				}
+			}
+		}
+
+		if ( !tris ) {
+			continue;
+		}
+
+		common->Printf( "%6i %5.2f %5.2f     %s\n", tris, (float)loads / tris, (float)optimizedLoads / tris, model->Name() );
+
+		totalTris += tris;
+		totalLoads += loads;
+		totalOptimizedLoads += optimizedLoads;
+	}
+
+	if ( totalTris ) {
+		common->Printf( "  ----  ---- ---------\n" );
+		common->Printf( "%6i %5.2f %5.2f     total\n", totalTris, (float)totalLoads / totalTris, (float)totalOptimizedLoads / totalTris );
+	}
+}
+
 /*
 =================
 idRenderModelManagerLocal::WritePrecacheCommands
@@ -212,6 +314,7 @@ void idRenderModelManagerLocal::Init() {
 	cmdSystem->AddCommand( "printModel", PrintModel_f, CMD_FL_RENDERER, "prints model info", idCmdSystem::ArgCompletion_ModelName );
 	cmdSystem->AddCommand( "reloadModels", ReloadModels_f, CMD_FL_RENDERER|CMD_FL_CHEAT, "reloads models" );
 	cmdSystem->AddCommand( "touchModel", TouchModel_f, CMD_FL_RENDERER, "touches a model", idCmdSystem::ArgCompletion_ModelName );
+	cmdSystem->AddCommand( "reportVertexCache", ReportVertexCache_f, CMD_FL_RENDERER, "prints the vertex cache miss ratio of all models before and after optimization" );
 
 	insideLevelLoad = false;
 
@@ -279,6 +382,9 @@ idRenderModel *idRenderModelManagerLocal::GetModel( const char *modelName, bool
 				model->TouchData();
 			}
 			model->SetLevelLoadReferenced( true );
+			if ( resourceManifest.IsRecording() && !model->IsDefaultModel() ) {
+				resourceManifest.AddModel( model->Name() );
+			}
 			return model;
 		}
 	}
@@ -337,6 +443,10 @@ idRenderModel *idRenderModelManagerLocal::GetModel( const char *modelName, bool
 
 	AddModel( model );
 
+	if ( resourceManifest.IsRecording() && !model->IsDefaultModel() ) {
+		resourceManifest.AddModel( model->Name() );
+	}
+
 	return model;
 }
 
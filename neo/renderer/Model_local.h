@@ -32,6 +32,8 @@ If you have questions concerning this license or the applicable additional terms
 #include "idlib/geometry/JointTransform.h"
 #include "renderer/Model.h"
 
+class idFile_Memory;
+
 /*
 ===============================================================================
 
@@ -69,6 +71,8 @@ public:
 	virtual int					NumSurfaces() const;
 	virtual int					NumBaseSurfaces() const;
 	virtual const modelSurface_t *Surface( int surfaceNum ) const;
+	virtual int					NumLODs() const;
+	virtual idRenderModel *		LOD( int level );
 	virtual srfTriangles_t *	AllocSurfaceTriangles( int numVerts, int numIndexes ) const;
 	virtual void				FreeSurfaceTriangles( srfTriangles_t *tris ) const;
 	virtual srfTriangles_t *	ShadowHull() const;
@@ -105,6 +109,14 @@ public:
 	void						DeleteSurfacesWithNegativeId( void );
 	bool						FindSurfaceWithId( int id, int &surfaceNum );
 
+	idFile_Memory *				OpenBinaryModel( void );	// NULL if there is no binary model matching the source file
+	void						WriteBinaryModel( idFile_Memory *payload );
+	bool						LoadBinarySurfaces( void );
+	void						WriteBinarySurfaces( void );
+
+	virtual void				GenerateLODs( void );
+	void						FreeLODs( void );
+
 public:
 	idList<modelSurface_t>		surfaces;
 	idBounds					bounds;
@@ -123,11 +135,15 @@ protected:
 	bool						reloadable;				// if not, reloadModels won't check timestamp
 	bool						levelLoadReferenced;	// for determining if it needs to be freed
 	ID_TIME_T						timeStamp;
+	idList<idRenderModel *>		lods;					// reduced detail versions, each with about half the triangles of the previous one
 
 	static idCVar				r_mergeModelSurfaces;	// combine model surfaces with the same material
 	static idCVar				r_slopVertex;			// merge xyz coordinates this far apart
 	static idCVar				r_slopTexCoord;			// merge texture coordinates this far apart
 	static idCVar				r_slopNormal;			// merge normals that dot less than this
+	static idCVar				r_binaryModels;			// cache processed models in binary files
+	static idCVar				r_modelLODs;			// number of reduced detail versions to generate for each model
+	static idCVar				r_lodMinTris;			// don't generate LODs for models with fewer triangles
 };
 
 /*
@@ -138,6 +154,8 @@ protected:
 ===============================================================================
 */
 
+#define MD5_LOD_SURFACE_IDS			1024		// each LOD level of an MD5 model uses its own range of surface ids
+
 class idMD5Mesh {
 	friend class				idRenderModelMD5;
 
@@ -153,6 +171,10 @@ public:
 	int							NumTris( void ) const;
 	int							NumWeights( void ) const;
 
+	void						WriteBinary( idFile *f ) const;
+	bool						ReadBinary( idFile *f );
+	void						InitLOD( const idMD5Mesh &source, const idJointMat *joints, int targetIndexes );
+
 private:
 	idList<idVec2>				texCoords;			// texture coordinates
 	int							numWeights;			// number of weights
@@ -169,6 +191,8 @@ private:
 
 class idRenderModelMD5 : public idRenderModelStatic {
 public:
+								idRenderModelMD5();
+
 	virtual void				InitFromFile( const char *fileName );
 	virtual dynamicModel_t		IsDynamicModel() const;
 	virtual idBounds			Bounds( const struct renderEntity_s *ent ) const;
@@ -186,15 +210,23 @@ public:
 	virtual const idJointQuat *	GetDefaultPose( void ) const;
 	virtual int					NearestJoint( int surfaceNum, int a, int b, int c ) const;
 
+	int							NumMeshes( void ) const;
+	const glIndex_t *			MeshIndexes( int meshNum, int &numIndexes ) const;
+
 private:
 	idList<idMD5Joint>			joints;
 	idList<idJointQuat>			defaultPose;
 	idList<idMD5Mesh>			meshes;
+	int							lodLevel;			// offsets the surface ids so overlays never get applied to another level
 
+	virtual void				GenerateLODs( void );
+	int							SurfaceId( int meshNum ) const { return meshNum + lodLevel * MD5_LOD_SURFACE_IDS; }
 	void						CalculateBounds( const idJointMat *joints );
 	void						GetFrameBounds( const renderEntity_t *ent, idBounds &bounds ) const;
 	void						DrawJoints( const renderEntity_t *ent, const struct viewDef_s *view ) const;
 	void						ParseJoint( idLexer &parser, idMD5Joint *joint, idJointQuat *defaultPose );
+	bool						LoadBinaryMeshes( void );
+	void						WriteBinaryMeshes( void );
 };
 
 /*
@@ -79,6 +79,20 @@ idMD5Mesh::~idMD5Mesh() {
 	}
 }
 
+/*
+====================
+R_AddMD5MeshCounters
+====================
+*/
+static void R_AddMD5MeshCounters( int numVerts, int numWeights, const int *weightIndex ) {
+	c_numVerts += numVerts;
+	c_numWeights += numWeights;
+	c_numWeightJoints++;
+	for ( int i = 0; i < numWeights; i++ ) {
+		c_numWeightJoints += weightIndex[i*2+1];
+	}
+}
+
 /*
 ====================
 idMD5Mesh::ParseMesh
@@ -171,6 +185,22 @@ void idMD5Mesh::ParseMesh( idLexer &parser, int numJoints, const idJointMat *joi
 		tris[ i * 3 + 2 ] = parser.ParseInt();
 	}
 
+	// reorder the triangles for the vertex cache and the vertexes for fetch locality
+	if ( r_orderIndexes.GetBool() && R_OptimizeIndexOrder( texCoords.Num(), tris.Num(), tris.Ptr() ) ) {
+		idList<int> remap;
+		remap.SetNum( texCoords.Num() );
+		R_OptimizeVertexOrder( texCoords.Num(), tris.Num(), tris.Ptr(), remap.Ptr() );
+
+		idList<idVec2> oldTexCoords = texCoords;
+		idList<int> oldFirstWeight = firstWeightForVertex;
+		idList<int> oldNumWeights = numWeightsForVertex;
+		for ( i = 0; i < texCoords.Num(); i++ ) {
+			texCoords[ remap[ i ] ] = oldTexCoords[ i ];
+			firstWeightForVertex[ remap[ i ] ] = oldFirstWeight[ i ];
+			numWeightsForVertex[ remap[ i ] ] = oldNumWeights[ i ];
+		}
+	}
+
 	//
 	// parse weights
 	//
@@ -224,12 +254,7 @@ void idMD5Mesh::ParseMesh( idLexer &parser, int numJoints, const idJointMat *joi
 	parser.ExpectTokenString( "}" );
 
 	// update counters
-	c_numVerts += texCoords.Num();
-	c_numWeights += numWeights;
-	c_numWeightJoints++;
-	for ( i = 0; i < numWeights; i++ ) {
-		c_numWeightJoints += weightIndex[i*2+1];
-	}
+	R_AddMD5MeshCounters( texCoords.Num(), numWeights, weightIndex );
 
 	//
 	// build the information that will be common to all animations of this mesh:
@@ -244,6 +269,160 @@ void idMD5Mesh::ParseMesh( idLexer &parser, int numJoints, const idJointMat *joi
 	deformInfo = R_BuildDeformInfo( texCoords.Num(), verts, tris.Num(), tris.Ptr(), shader->UseUnsmoothedTangents() );
 }
 
+/*
+====================
+idMD5Mesh::WriteBinary
+====================
+*/
+void idMD5Mesh::WriteBinary( idFile *f ) const {
+	f->WriteString( shader->GetName() );
+	f->WriteInt( R_BinaryModelMaterialFlags( shader ) );
+	f->WriteInt( texCoords.Num() );
+	f->Write( texCoords.Ptr(), texCoords.Num() * sizeof( texCoords[0] ) );
+	f->WriteInt( numWeights );
+	f->Write( scaledWeights, numWeights * sizeof( scaledWeights[0] ) );
+	f->Write( weightIndex, numWeights * 2 * sizeof( weightIndex[0] ) );
+	f->WriteInt( numTris );
+	R_WriteDeformInfo( f, deformInfo );
+}
+
+/*
+====================
+idMD5Mesh::ReadBinary
+
+Reads a mesh written by WriteBinary, returns false if the data doesn't match the current materials
+====================
+*/
+bool idMD5Mesh::ReadBinary( idFile *f ) {
+	idStr	shaderName;
+	int		flags, numVerts;
+
+	f->ReadString( shaderName );
+	shader = declManager->FindMaterial( shaderName );
+	f->ReadInt( flags );
+	if ( R_BinaryModelMaterialFlags( shader ) != flags ) {
+		return false;
+	}
+
+	f->ReadInt( numVerts );
+	if ( numVerts < 0 || numVerts * (int)sizeof( texCoords[0] ) > f->Length() - f->Tell() ) {
+		return false;
+	}
+	texCoords.SetNum( numVerts );
+	f->Read( texCoords.Ptr(), numVerts * sizeof( texCoords[0] ) );
+
+	f->ReadInt( numWeights );
+	if ( numWeights < numVerts || numWeights * (int)( sizeof( scaledWeights[0] ) + 2 * sizeof( weightIndex[0] ) ) > f->Length() - f->Tell() ) {
+		return false;
+	}
+	scaledWeights = (idVec4 *) Mem_Alloc16( numWeights * sizeof( scaledWeights[0] ) );
+	weightIndex = (int *) Mem_Alloc16( numWeights * 2 * sizeof( weightIndex[0] ) );
+	f->Read( scaledWeights, numWeights * sizeof( scaledWeights[0] ) );
+	f->Read( weightIndex, numWeights * 2 * sizeof( weightIndex[0] ) );
+
+	f->ReadInt( numTris );
+	deformInfo = R_ReadDeformInfo( f );
+	if ( !deformInfo || deformInfo->numIndexes != numTris * 3 ) {
+		return false;
+	}
+
+	// update counters
+	R_AddMD5MeshCounters( texCoords.Num(), numWeights, weightIndex );
+
+	return true;
+}
+
+/*
+====================
+idMD5Mesh::InitLOD
+
+Creates a reduced version of the source mesh.  The vertexes are a subset of the
+source vertexes, so they keep their texture coordinates and joint weights.
+====================
+*/
+void idMD5Mesh::InitLOD( const idMD5Mesh &source, const idJointMat *entJoints, int targetIndexes ) {
+	int i, j, numSourceVerts, numVerts, numIndexes, base;
+
+	const deformInfo_t *sourceInfo = source.deformInfo;
+	numSourceVerts = source.texCoords.Num();
+
+	// source vertexes in the default pose
+	idDrawVert *verts = (idDrawVert *) Mem_Alloc16( numSourceVerts * sizeof( verts[0] ) );
+	for ( i = 0; i < numSourceVerts; i++ ) {
+		verts[i].Clear();
+		verts[i].st = source.texCoords[i];
+	}
+	SIMDProcessor->TransformVerts( verts, numSourceVerts, entJoints, source.scaledWeights, source.weightIndex, source.numWeights );
+
+	// source triangles, without the vertexes busted for mirrored texture seams
+	int *sourceIndexes = (int *) Mem_Alloc( sourceInfo->numIndexes * sizeof( sourceIndexes[0] ) );
+	int *lodIndexes = (int *) Mem_Alloc( sourceInfo->numIndexes * sizeof( lodIndexes[0] ) );
+	base = sourceInfo->numOutputVerts - sourceInfo->numMirroredVerts;
+	for ( i = 0; i < sourceInfo->numIndexes; i++ ) {
+		int v = sourceInfo->indexes[i];
+		sourceIndexes[i] = ( v >= base ) ? sourceInfo->mirroredVerts[v - base] : v;
+	}
+
+	numIndexes = R_SimplifyTriangles( verts, numSourceVerts, sourceIndexes, sourceInfo->numIndexes, targetIndexes, lodIndexes );
+
+	// first weight of each source vertex
+	int *firstWeight = (int *) Mem_Alloc( ( numSourceVerts + 1 ) * sizeof( firstWeight[0] ) );
+	for ( i = 0, j = 0; i < numSourceVerts; i++ ) {
+		firstWeight[i] = j;
+		while ( !source.weightIndex[j * 2 + 1] ) {
+			j++;
+		}
+		j++;
+	}
+	firstWeight[numSourceVerts] = j;
+
+	// keep only the vertexes still used, in their original order
+	int *remap = (int *) Mem_Alloc( numSourceVerts * sizeof( remap[0] ) );
+	for ( i = 0; i < numSourceVerts; i++ ) {
+		remap[i] = -1;
+	}
+	for ( i = 0; i < numIndexes; i++ ) {
+		remap[lodIndexes[i]] = 0;
+	}
+	numVerts = 0;
+	numWeights = 0;
+	for ( i = 0; i < numSourceVerts; i++ ) {
+		if ( remap[i] != -1 ) {
+			remap[i] = numVerts++;
+			numWeights += firstWeight[i + 1] - firstWeight[i];
+		}
+	}
+
+	texCoords.SetNum( numVerts );
+	scaledWeights = (idVec4 *) Mem_Alloc16( numWeights * sizeof( scaledWeights[0] ) );
+	weightIndex = (int *) Mem_Alloc16( numWeights * 2 * sizeof( weightIndex[0] ) );
+	for ( i = 0, j = 0; i < numSourceVerts; i++ ) {
+		if ( remap[i] == -1 ) {
+			continue;
+		}
+		int count = firstWeight[i + 1] - firstWeight[i];
+		memcpy( scaledWeights + j, source.scaledWeights + firstWeight[i], count * sizeof( scaledWeights[0] ) );
+		memcpy( weightIndex + j * 2, source.weightIndex + firstWeight[i] * 2, count * 2 * sizeof( weightIndex[0] ) );
+		texCoords[remap[i]] = source.texCoords[i];
+		verts[remap[i]] = verts[i];
+		j += count;
+	}
+	for ( i = 0; i < numIndexes; i++ ) {
+		lodIndexes[i] = remap[lodIndexes[i]];
+	}
+
+	shader = source.shader;
+	numTris = numIndexes / 3;
+
+	deformInfo = R_BuildDeformInfo( numVerts, verts, numIndexes, lodIndexes, shader->UseUnsmoothedTangents() );
+
+	Mem_Free16( verts );
+	Mem_Free( sourceIndexes );
+	Mem_Free( lodIndexes );
+	Mem_Free( firstWeight );
+	Mem_Free( remap );
+}
+
 /*
 ====================
 idMD5Mesh::TransformVerts
@@ -433,6 +612,15 @@ int	idMD5Mesh::NumWeights( void ) const {
 
 ***********************************************************************/
 
+/*
+====================
+idRenderModelMD5::idRenderModelMD5
+====================
+*/
+idRenderModelMD5::idRenderModelMD5() {
+	lodLevel = 0;
+}
+
 /*
 ====================
 idRenderModelMD5::ParseJoint
@@ -503,6 +691,11 @@ void idRenderModelMD5::LoadModel() {
 	}
 	purged = false;
 
+	if ( LoadBinaryMeshes() ) {
+		GenerateLODs();
+		return;
+	}
+
 	if ( !parser.LoadFile( name ) ) {
 		MakeDefaultModel();
 		return;
@@ -570,6 +763,181 @@ void idRenderModelMD5::LoadModel() {
 
 	// set the timestamp for reloadmodels
 	fileSystem->ReadFile( name, NULL, &timeStamp );
+
+	WriteBinaryMeshes();
+
+	GenerateLODs();
+}
+
+/*
+====================
+idRenderModelMD5::LoadBinaryMeshes
+
+Returns false and leaves the model purged if there is no usable binary model
+====================
+*/
+bool idRenderModelMD5::LoadBinaryMeshes( void ) {
+	idFile_Memory *	f;
+	int				i, num, parentNum;
+	bool			ok;
+
+	f = OpenBinaryModel();
+	if ( !f ) {
+		return false;
+	}
+
+	ok = true;
+
+	f->ReadInt( num );
+	if ( num <= 0 || num * (int)sizeof( idJointQuat ) > f->Length() - f->Tell() ) {
+		delete f;
+		return false;
+	}
+	joints.SetGranularity( 1 );
+	joints.SetNum( num );
+	defaultPose.SetGranularity( 1 );
+	defaultPose.SetNum( num );
+	for ( i = 0; i < num; i++ ) {
+		f->ReadString( joints[i].name );
+		f->ReadInt( parentNum );
+		if ( parentNum >= i ) {
+			ok = false;
+			break;
+		}
+		joints[i].parent = ( parentNum >= 0 ) ? &joints[parentNum] : NULL;
+	}
+	if ( ok ) {
+		f->Read( defaultPose.Ptr(), num * sizeof( defaultPose[0] ) );
+
+		f->ReadInt( num );
+		if ( num < 0 || num > f->Length() - f->Tell() ) {
+			ok = false;
+		}
+	}
+	if ( ok ) {
+		meshes.SetGranularity( 1 );
+		meshes.SetNum( num );
+		for ( i = 0; i < num && ok; i++ ) {
+			ok = meshes[i].ReadBinary( f );
+		}
+		f->ReadVec3( bounds[0] );
+		f->ReadVec3( bounds[1] );
+	}
+
+	delete f;
+
+	if ( !ok ) {
+		PurgeModel();
+		purged = false;
+		return false;
+	}
+
+	return true;
+}
+
+/*
+====================
+idRenderModelMD5::WriteBinaryMeshes
+====================
+*/
+void idRenderModelMD5::WriteBinaryMeshes( void ) {
+	int i;
+
+	if ( !r_binaryModels.GetBool() || defaulted || meshes.Num() == 0 ) {
+		return;
+	}
+
+	idFile_Memory payload( name );
+
+	payload.WriteInt( joints.Num() );
+	for ( i = 0; i < joints.Num(); i++ ) {
+		payload.WriteString( joints[i].name );
+		payload.WriteInt( joints[i].parent ? joints[i].parent - joints.Ptr() : -1 );
+	}
+	payload.Write( defaultPose.Ptr(), defaultPose.Num() * sizeof( defaultPose[0] ) );
+
+	payload.WriteInt( meshes.Num() );
+	for ( i = 0; i < meshes.Num(); i++ ) {
+		meshes[i].WriteBinary( &payload );
+	}
+	payload.WriteVec3( bounds[0] );
+	payload.WriteVec3( bounds[1] );
+
+	WriteBinaryModel( &payload );
+}
+
+/*
+====================
+idRenderModelMD5::GenerateLODs
+
+The reduced meshes are built from the default pose and skinned with the
+original joint weights, so they animate exactly like the full detail model.
+====================
+*/
+void idRenderModelMD5::GenerateLODs( void ) {
+	int		i, level, totalTris, lodTris;
+
+	FreeLODs();
+
+	if ( defaulted || r_modelLODs.GetInteger() <= 0 || joints.Num() == 0 ) {
+		return;
+	}
+
+	totalTris = 0;
+	for ( i = 0; i < meshes.Num(); i++ ) {
+		totalTris += meshes[i].deformInfo->numIndexes / 3;
+	}
+	if ( totalTris < r_lodMinTris.GetInteger() ) {
+		return;
+	}
+
+	// joint matrices of the default pose
+	idJointMat *poseMats = (idJointMat *) _alloca16( joints.Num() * sizeof( poseMats[0] ) );
+	int *parents = (int *) _alloca16( joints.Num() * sizeof( parents[0] ) );
+	for ( i = 0; i < joints.Num(); i++ ) {
+		parents[i] = joints[i].parent ? joints[i].parent - joints.Ptr() : -1;
+	}
+	SIMDProcessor->ConvertJointQuatsToJointMats( poseMats, defaultPose.Ptr(), joints.Num() );
+	SIMDProcessor->TransformJoints( poseMats, parents, 1, joints.Num() - 1 );
+
+	const idRenderModelMD5 *previous = this;
+	for ( level = 1; level <= r_modelLODs.GetInteger(); level++ ) {
+		idRenderModelMD5 *lod = new idRenderModelMD5;
+		lod->InitEmpty( va( "%s_lod%i", name.c_str(), level ) );
+		lod->lodLevel = level;
+		lod->bounds = bounds;
+		lod->timeStamp = timeStamp;
+
+		lod->joints = joints;
+		for ( i = 0; i < joints.Num(); i++ ) {
+			lod->joints[i].parent = ( parents[i] >= 0 ) ? &lod->joints[parents[i]] : NULL;
+		}
+		lod->defaultPose = defaultPose;
+
+		lod->meshes.SetGranularity( 1 );
+		lod->meshes.SetNum( previous->meshes.Num() );
+
+		lodTris = 0;
+		for ( i = 0; i < previous->meshes.Num(); i++ ) {
+			const idMD5Mesh *mesh = &previous->meshes[i];
+
+			int targetIndexes = mesh->deformInfo->numIndexes;
+			if ( mesh->shader->Deform() == DFRM_NONE && targetIndexes >= 3 * 32 ) {
+				targetIndexes = ( targetIndexes / 6 ) * 3;
+			}
+			lod->meshes[i].InitLOD( *mesh, poseMats, targetIndexes );
+			lodTris += lod->meshes[i].deformInfo->numIndexes / 3;
+		}
+
+		if ( lodTris > totalTris * 0.8f ) {
+			delete lod;
+			break;
+		}
+
+		lods.Append( lod );
+		previous = lod;
+		totalTris = lodTris;
+	}
 }
 
 /*
@@ -778,14 +1146,14 @@ idRenderModel *idRenderModelMD5::InstantiateDynamicModel( const struct renderEnt
 		shader = R_RemapShaderBySkin( shader, ent->customSkin, ent->customShader );
 
 		if ( !shader || ( !shader->IsDrawn() && !shader->SurfaceCastsShadow() ) ) {
-			staticModel->DeleteSurfaceWithId( i );
+			staticModel->DeleteSurfaceWithId( SurfaceId( i ) );
 			mesh->surfaceNum = -1;
 			continue;
 		}
 
 		modelSurface_t *surf;
 
-		if ( staticModel->FindSurfaceWithId( i, surfaceNum ) ) {
+		if ( staticModel->FindSurfaceWithId( SurfaceId( i ), surfaceNum ) ) {
 			mesh->surfaceNum = surfaceNum;
 			surf = &staticModel->surfaces[surfaceNum];
 		} else {
@@ -797,7 +1165,7 @@ idRenderModel *idRenderModelMD5::InstantiateDynamicModel( const struct renderEnt
 			surf = &staticModel->surfaces.Alloc();
 			surf->geometry = NULL;
 			surf->shader = NULL;
-			surf->id = i;
+			surf->id = SurfaceId( i );
 		}
 
 		mesh->UpdateSurface( ent, ent->joints, surf );
@@ -916,6 +1284,26 @@ void idRenderModelMD5::TouchData() {
 	}
 }
 
+/*
+===================
+idRenderModelMD5::NumMeshes
+===================
+*/
+int idRenderModelMD5::NumMeshes( void ) const {
+	return meshes.Num();
+}
+
+/*
+===================
+idRenderModelMD5::MeshIndexes
+===================
+*/
+const glIndex_t *idRenderModelMD5::MeshIndexes( int meshNum, int &numIndexes ) const {
+	const deformInfo_t *deform = meshes[meshNum].deformInfo;
+	numIndexes = deform ? deform->numIndexes : 0;
+	return deform ? deform->indexes : NULL;
+}
+
 /*
 ===================
 idRenderModelMD5::PurgeModel
@@ -929,6 +1317,7 @@ void idRenderModelMD5::PurgeModel() {
 	joints.Clear();
 	defaultPose.Clear();
 	meshes.Clear();
+	FreeLODs();
 }
 
 /*
@@ -957,5 +1346,9 @@ int	idRenderModelMD5::Memory() const {
 		total += sizeof( mesh->deformInfo );
 		total += R_DeformInfoMemoryUsed( mesh->deformInfo );
 	}
+
+	for ( i = 0 ; i < lods.Num() ; i++ ) {
+		total += lods[i]->Memory();
+	}
 	return total;
 }
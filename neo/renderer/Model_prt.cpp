@@ -33,6 +33,9 @@ If you have questions concerning this license or the applicable additional terms
 
 static const char *parametricParticle_SnapshotName = "_ParametricParticle_Snapshot_";
 
+// particles are collected and handed to idParticleStage::CreateParticles in batches of this size
+static const int MAX_PARTICLE_BATCH = 256;
+
 /*
 ====================
 idRenderModelPrt::idRenderModelPrt
@@ -108,6 +111,11 @@ idRenderModel *idRenderModelPrt::InstantiateDynamicModel( const struct renderEnt
 	}
 
 	particleGen_t g;
+	int			batchIndexes[MAX_PARTICLE_BATCH];
+	float		batchFracs[MAX_PARTICLE_BATCH];
+	idRandom	batchRandoms[MAX_PARTICLE_BATCH];
+
+	tr.pc.c_particleSystems++;
 
 	g.renderEnt = renderEntity;
 	g.renderView = &viewDef->renderView;
@@ -158,6 +166,12 @@ idRenderModel *idRenderModelPrt::InstantiateDynamicModel( const struct renderEnt
 		int numVerts = 0;
 		idDrawVert *verts = surf->geometry->verts;
 
+		const bool batch = r_batchParticles.GetBool();
+		int numBatch = 0;
+		int numCulled = 0;
+
+		tr.pc.c_particles += stage->totalParticles;
+
 		for ( int index = 0; index < stage->totalParticles; index++ ) {
 			g.index = index;
 
@@ -204,13 +218,36 @@ idRenderModel *idRenderModelPrt::InstantiateDynamicModel( const struct renderEnt
 				continue;
 			}
 
+			tr.pc.c_particlesEvaluated++;
+
+			if ( batch ) {
+				batchIndexes[numBatch] = index;
+				batchFracs[numBatch] = g.frac;
+				batchRandoms[numBatch] = g.random;
+				if ( ++numBatch == MAX_PARTICLE_BATCH ) {
+					numVerts += stage->CreateParticles( &g, numBatch, batchIndexes, batchFracs, batchRandoms, verts + numVerts, numCulled );
+					tr.pc.c_particlesCulled += numCulled;
+					numBatch = 0;
+				}
+				continue;
+			}
+
 			// this is needed so aimed particles can calculate origins at different times
 			g.originalRandom = g.random;
 
 			g.age = g.frac * stage->particleLife;
 
 			// if the particle doesn't get drawn because it is faded out or beyond a kill region, don't increment the verts
-			numVerts += stage->CreateParticle( &g, verts + numVerts );
+			int particleVerts = stage->CreateParticle( &g, verts + numVerts );
+			if ( !particleVerts ) {
+				tr.pc.c_particlesCulled++;
+			}
+			numVerts += particleVerts;
+		}
+
+		if ( numBatch ) {
+			numVerts += stage->CreateParticles( &g, numBatch, batchIndexes, batchFracs, batchRandoms, verts + numVerts, numCulled );
+			tr.pc.c_particlesCulled += numCulled;
 		}
 
 		// numVerts must be a multiple of 4
@@ -33,6 +33,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "renderer/ModelManager.h"
 #include "renderer/Material.h"
 #include "renderer/GuiModel.h"
+#include "renderer/GuiAtlas.h"
 #include "renderer/VertexCache.h"
 #include "renderer/RenderWorld_local.h"
 
@@ -80,13 +81,40 @@ static void R_PerformanceCounters( void ) {
 	}
 
 	if ( r_showDynamic.GetBool() ) {
-		common->Printf( "callback:%i md5:%i dfrmVerts:%i dfrmTris:%i tangTris:%i guis:%i\n",
+		common->Printf( "callback:%i md5:%i dfrmVerts:%i dfrmTris:%i tangTris:%i guis:%i mtrDfrms:%i (cached:%i)\n",
 			tr.pc.c_entityDefCallbacks,
 			tr.pc.c_generateMd5,
 			tr.pc.c_deformedVerts,
 			tr.pc.c_deformedIndexes/3,
 			tr.pc.c_tangentIndexes/3,
-			tr.pc.c_guiSurfs
+			tr.pc.c_guiSurfs,
+			tr.pc.c_materialDeforms,
+			tr.pc.c_materialDeformsCached
+			);
+	}
+
+	if ( r_showParticleStats.GetBool() ) {
+		common->Printf( "prtSystems:%i particles:%i evaluated:%i culled:%i\n",
+			tr.pc.c_particleSystems,
+			tr.pc.c_particles,
+			tr.pc.c_particlesEvaluated,
+			tr.pc.c_particlesCulled
+			);
+	}
+
+	if ( r_showGuiAtlas.GetBool() ) {
+		common->Printf( "guiSurfs:%i (without atlas:%i) atlasImages:%i atlasPages:%i\n",
+			tr.pc.c_guiModelSurfs,
+			tr.pc.c_guiModelSurfsUnbatched,
+			guiAtlas.NumImages(),
+			guiAtlas.NumPages()
+			);
+	}
+
+	if ( r_showSubviews.GetBool() ) {
+		common->Printf( "subviews:%i skipped:%i\n",
+			tr.pc.c_subviewsRendered,
+			tr.pc.c_subviewsSkipped
 			);
 	}
 
@@ -824,6 +852,9 @@ void idRenderSystemLocal::EndFrame( int *frontEndMsec, int *backEndMsec ) {
 	guiModel->EmitFullScreen();
 	guiModel->Clear();
 
+	// upload the atlas pages that got new images this frame
+	guiAtlas.QueueUploads();
+
 	// save out timing information
 	if ( frontEndMsec ) {
 		*frontEndMsec = pc.frontEndMsec;
@@ -35,6 +35,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "renderer/ModelManager.h"
 #include "renderer/RenderWorld_local.h"
 #include "renderer/GuiModel.h"
+#include "renderer/GuiAtlas.h"
 #include "sound/sound.h"
 #include "ui/UserInterface.h"
 
@@ -70,6 +71,8 @@ idCVar r_useInteractionTable( "r_useInteractionTable", "1", CVAR_RENDERER | CVAR
 idCVar r_useTurboShadow( "r_useTurboShadow", "1", CVAR_RENDERER | CVAR_BOOL, "use the infinite projection with W technique for dynamic shadows" );
 idCVar r_useDeferredTangents( "r_useDeferredTangents", "1", CVAR_RENDERER | CVAR_BOOL, "defer tangents calculations after deform" );
 idCVar r_useCachedDynamicModels( "r_useCachedDynamicModels", "1", CVAR_RENDERER | CVAR_BOOL, "cache snapshots of dynamic models" );
+idCVar r_lodScale( "r_lodScale", "1", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_FLOAT, "scale for the projected model size used to select model LODs, 0 = always use full detail" );
+idCVar r_forceLOD( "r_forceLOD", "-1", CVAR_RENDERER | CVAR_INTEGER, "use this LOD for all models with generated LODs, -1 = select by projected size" );
 
 idCVar r_useVertexBuffers( "r_useVertexBuffers", "1", CVAR_RENDERER | CVAR_INTEGER, "use ARB_vertex_buffer_object for vertexes", 0, 1, idCmdSystem::ArgCompletion_Integer<0,1>  );
 idCVar r_useIndexBuffers( "r_useIndexBuffers", "0", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_INTEGER, "use ARB_vertex_buffer_object for indexes", 0, 1, idCmdSystem::ArgCompletion_Integer<0,1>  );
@@ -101,6 +104,8 @@ idCVar r_skipNewAmbient( "r_skipNewAmbient", "0", CVAR_RENDERER | CVAR_BOOL | CV
 idCVar r_skipBlendLights( "r_skipBlendLights", "0", CVAR_RENDERER | CVAR_BOOL, "skip all blend lights" );
 idCVar r_skipFogLights( "r_skipFogLights", "0", CVAR_RENDERER | CVAR_BOOL, "skip all fog lights" );
 idCVar r_skipDeforms( "r_skipDeforms", "0", CVAR_RENDERER | CVAR_BOOL, "leave all deform materials in their original state" );
+idCVar r_useDeformCache( "r_useDeformCache", "1", CVAR_RENDERER | CVAR_BOOL, "reuse the deformed vertexes of static surfaces while the deform inputs don't change" );
+idCVar r_batchDeforms( "r_batchDeforms", "1", CVAR_RENDERER | CVAR_BOOL, "process material deforms grouped by type after all the surfaces of a view are added" );
 idCVar r_skipFrontEnd( "r_skipFrontEnd", "0", CVAR_RENDERER | CVAR_BOOL, "bypasses all front end work, but 2D gui rendering still draws" );
 idCVar r_skipUpdates( "r_skipUpdates", "0", CVAR_RENDERER | CVAR_BOOL, "1 = don't accept any entity or light updates, making everything static" );
 idCVar r_skipOverlays( "r_skipOverlays", "0", CVAR_RENDERER | CVAR_BOOL, "skip overlay surfaces" );
@@ -128,8 +133,15 @@ idCVar r_offsetUnits( "r_offsetunits", "-600", CVAR_RENDERER | CVAR_FLOAT, "poly
 idCVar r_shadowPolygonOffset( "r_shadowPolygonOffset", "-1", CVAR_RENDERER | CVAR_FLOAT, "bias value added to depth test for stencil shadow drawing" );
 idCVar r_shadowPolygonFactor( "r_shadowPolygonFactor", "0", CVAR_RENDERER | CVAR_FLOAT, "scale value for stencil shadow drawing" );
 idCVar r_skipSubviews( "r_skipSubviews", "0", CVAR_RENDERER | CVAR_INTEGER, "1 = don't render any gui elements on surfaces" );
+idCVar r_subviewMaxHz( "r_subviewMaxHz", "0", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_INTEGER, "refresh rate of mirror, remote camera and xray textures, 0 = every frame" );
+idCVar r_subviewMinHz( "r_subviewMinHz", "10", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_INTEGER, "lowest refresh rate of distant or small subview textures" );
+idCVar r_subviewFullRateDistance( "r_subviewFullRateDistance", "256", CVAR_RENDERER | CVAR_FLOAT, "subview textures further away than this refresh slower, 0 = ignore distance" );
+idCVar r_subviewFullRateSize( "r_subviewFullRateSize", "0.25", CVAR_RENDERER | CVAR_FLOAT, "subview textures covering less of the view than this fraction refresh slower, 0 = ignore size" );
+idCVar r_subviewBudget( "r_subviewBudget", "0", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_INTEGER, "msec of subview rendering per frame after which textures are only refreshed at r_subviewMinHz, 0 = no budget" );
 idCVar r_skipGuiShaders( "r_skipGuiShaders", "0", CVAR_RENDERER | CVAR_INTEGER, "1 = skip all gui elements on surfaces, 2 = skip drawing but still handle events, 3 = draw but skip events", 0, 3, idCmdSystem::ArgCompletion_Integer<0,3> );
 idCVar r_skipParticles( "r_skipParticles", "0", CVAR_RENDERER | CVAR_INTEGER, "1 = skip all particle systems", 0, 1, idCmdSystem::ArgCompletion_Integer<0,1> );
+idCVar r_batchParticles( "r_batchParticles", "1", CVAR_RENDERER | CVAR_BOOL, "evaluate particle colors and orientations in batches with the SIMD processor" );
+idCVar r_guiAtlas( "r_guiAtlas", "1", CVAR_RENDERER | CVAR_BOOL, "pack small gui images and font pages into shared textures to draw guis with fewer surfaces" );
 idCVar r_subviewOnly( "r_subviewOnly", "0", CVAR_RENDERER | CVAR_BOOL, "1 = don't render main view, allowing subviews to be debugged" );
 idCVar r_shadows( "r_shadows", "1", CVAR_RENDERER | CVAR_BOOL  | CVAR_ARCHIVE, "enable shadows" );
 idCVar r_testGamma( "r_testGamma", "0", CVAR_RENDERER | CVAR_FLOAT, "if > 0 draw a grid pattern to test gamma levels", 0, 195 );
@@ -152,6 +164,7 @@ idCVar r_singleSurface( "r_singleSurface", "-1", CVAR_RENDERER | CVAR_INTEGER, "
 idCVar r_singleArea( "r_singleArea", "0", CVAR_RENDERER | CVAR_BOOL, "only draw the portal area the view is actually in" );
 idCVar r_forceLoadImages( "r_forceLoadImages", "0", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_BOOL, "draw all images to screen after registration" );
 idCVar r_orderIndexes( "r_orderIndexes", "1", CVAR_RENDERER | CVAR_BOOL, "perform index reorganization to optimize vertex use" );
+idCVar r_binaryProc( "r_binaryProc", "1", CVAR_RENDERER | CVAR_BOOL, "load the world from a binary .bproc written after the first .proc parse" );
 idCVar r_lightAllBackFaces( "r_lightAllBackFaces", "0", CVAR_RENDERER | CVAR_BOOL, "light all the back faces, even when they would be shadowed" );
 
 // visual debugging info
@@ -162,6 +175,9 @@ idCVar r_showVertexColor( "r_showVertexColor", "0", CVAR_RENDERER | CVAR_BOOL, "
 idCVar r_showUpdates( "r_showUpdates", "0", CVAR_RENDERER | CVAR_BOOL, "report entity and light updates and ref counts" );
 idCVar r_showDemo( "r_showDemo", "0", CVAR_RENDERER | CVAR_BOOL, "report reads and writes to the demo file" );
 idCVar r_showDynamic( "r_showDynamic", "0", CVAR_RENDERER | CVAR_BOOL, "report stats on dynamic surface generation" );
+idCVar r_showParticleStats( "r_showParticleStats", "0", CVAR_RENDERER | CVAR_BOOL, "report stats on particle evaluation" );
+idCVar r_showGuiAtlas( "r_showGuiAtlas", "0", CVAR_RENDERER | CVAR_BOOL, "report gui model surfaces with and without the gui atlas" );
+idCVar r_showSubviews( "r_showSubviews", "0", CVAR_RENDERER | CVAR_BOOL, "report rendered and skipped subviews" );
 idCVar r_showDefs( "r_showDefs", "0", CVAR_RENDERER | CVAR_BOOL, "report the number of modeDefs and lightDefs in view" );
 idCVar r_showIntensity( "r_showIntensity", "0", CVAR_RENDERER | CVAR_BOOL, "draw the screen colors based on intensity, red = 0, green = 128, blue = 255" );
 idCVar r_showLights( "r_showLights", "0", CVAR_RENDERER | CVAR_INTEGER, "1 = just print volumes numbers, highlighting ones covering the view, 2 = also draw planes of each volume, 3 = also draw edges of each volume", 0, 3, idCmdSystem::ArgCompletion_Integer<0,3> );
@@ -1616,6 +1632,8 @@ void idRenderSystemLocal::Shutdown( void ) {
 
 	R_DoneFreeType( );
 
+	guiAtlas.Shutdown();
+
 	if ( glConfig.isInitialized ) {
 		globalImages->PurgeAllImages();
 	}
@@ -49,6 +49,11 @@ class idRenderModel;
 #define PROC_FILE_EXT				"proc"
 #define	PROC_FILE_ID				"mapProcFile003"
 
+// binary copy of the .proc, written the first time a map is loaded from text
+#define BPROC_FILE_EXT				"bproc"
+#define BPROC_FILE_ID				( ( 'C' << 24 ) | ( 'R' << 16 ) | ( 'P' << 8 ) | 'B' )
+#define BPROC_FILE_VERSION			1
+
 // shader parms
 const int MAX_GLOBAL_SHADER_PARMS	= 12;
 
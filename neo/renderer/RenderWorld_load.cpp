@@ -27,12 +27,70 @@ If you have questions concerning this license or the applicable additional terms
 */
 
 #include "sys/platform.h"
+#include "idlib/hashing/CRC32.h"
 #include "framework/Session.h"
 #include "renderer/ModelManager.h"
 #include "renderer/RenderWorld_local.h"
 
 #include "renderer/tr_local.h"
 
+/*
+===============================================================================
+
+	Binary .proc
+
+	The text .proc is parsed once and a .bproc with the same content is
+	written next to it.  Vertex and index arrays are 16 byte aligned in the
+	file so they are read in place from the loaded buffer.  The header has
+	the length and timestamp of the .proc it was made from and a checksum
+	of the rest of the file.
+
+===============================================================================
+*/
+
+static const int BPROC_HEADER_SIZE		= 32;
+static const int BPROC_ALIGN			= 16;
+
+typedef enum {
+	BPROC_END,
+	BPROC_MODEL,
+	BPROC_SHADOW_MODEL,
+	BPROC_INTER_AREA_PORTALS,
+	BPROC_NODES
+} bprocChunk_t;
+
+/*
+================
+R_WriteBinaryProcAlign
+
+The payload starts at BPROC_HEADER_SIZE, so aligning the payload aligns the file
+================
+*/
+static void R_WriteBinaryProcAlign( idFile *f ) {
+	static const byte pad[BPROC_ALIGN] = { 0 };
+	int misalign = f->Tell() & ( BPROC_ALIGN - 1 );
+	if ( misalign ) {
+		f->Write( pad, BPROC_ALIGN - misalign );
+	}
+}
+
+/*
+================
+R_ReadBinaryProcArray
+
+Returns a pointer to an aligned array in the loaded file, or NULL if it would run past the end
+================
+*/
+static const void *R_ReadBinaryProcArray( idFile_Memory *f, int count, int elementSize ) {
+	int offset = ( f->Tell() + BPROC_ALIGN - 1 ) & ~( BPROC_ALIGN - 1 );
+	// divide instead of multiplying, a bad count could overflow
+	if ( count < 0 || offset > f->Length() || count > ( f->Length() - offset ) / elementSize ) {
+		return NULL;
+	}
+	f->Seek( offset + count * elementSize, FS_SEEK_SET );
+	return f->GetDataPtr() + offset;
+}
+
 /*
 ================
 idRenderWorldLocal::FreeWorld
@@ -136,6 +194,12 @@ idRenderModel *idRenderWorldLocal::ParseModel( idLexer *src ) {
 		src->Error( "R_ParseModel: bad numSurfaces" );
 	}
 
+	if ( binaryProc ) {
+		binaryProc->WriteInt( BPROC_MODEL );
+		binaryProc->WriteString( token );
+		binaryProc->WriteInt( numSurfaces );
+	}
+
 	for ( i = 0 ; i < numSurfaces ; i++ ) {
 		src->ExpectTokenString( "{" );
 
@@ -173,6 +237,22 @@ idRenderModel *idRenderWorldLocal::ParseModel( idLexer *src ) {
 		}
 		src->ExpectTokenString( "}" );
 
+		if ( binaryProc ) {
+			binaryProc->WriteString( surf.shader->GetName() );
+			binaryProc->WriteInt( tri->numVerts );
+			binaryProc->WriteInt( tri->numIndexes );
+			R_WriteBinaryProcAlign( binaryProc );
+			for ( j = 0 ; j < tri->numVerts ; j++ ) {
+				binaryProc->WriteVec3( tri->verts[j].xyz );
+				binaryProc->WriteVec2( tri->verts[j].st );
+				binaryProc->WriteVec3( tri->verts[j].normal );
+			}
+			R_WriteBinaryProcAlign( binaryProc );
+			for ( j = 0 ; j < tri->numIndexes ; j++ ) {
+				binaryProc->WriteInt( tri->indexes[j] );
+			}
+		}
+
 		// add the completed surface to the model
 		model->AddSurface( surf );
 	}
@@ -239,6 +319,24 @@ idRenderModel *idRenderWorldLocal::ParseShadowModel( idLexer *src ) {
 
 	src->ExpectTokenString( "}" );
 
+	if ( binaryProc ) {
+		binaryProc->WriteInt( BPROC_SHADOW_MODEL );
+		binaryProc->WriteString( model->Name() );
+		binaryProc->WriteInt( tri->numVerts );
+		binaryProc->WriteInt( tri->numShadowIndexesNoCaps );
+		binaryProc->WriteInt( tri->numShadowIndexesNoFrontCaps );
+		binaryProc->WriteInt( tri->numIndexes );
+		binaryProc->WriteInt( tri->shadowCapPlaneBits );
+		R_WriteBinaryProcAlign( binaryProc );
+		for ( j = 0 ; j < tri->numVerts ; j++ ) {
+			binaryProc->WriteVec3( tri->shadowVertexes[j].xyz.ToVec3() );
+		}
+		R_WriteBinaryProcAlign( binaryProc );
+		for ( j = 0 ; j < tri->numIndexes ; j++ ) {
+			binaryProc->WriteInt( tri->indexes[j] );
+		}
+	}
+
 	// we do NOT do a model->FinishSurfaceces, because we don't need sil edges, planes, tangents, etc.
 //	model->FinishSurfaces();
 
@@ -265,6 +363,57 @@ void idRenderWorldLocal::SetupAreaRefs() {
 	}
 }
 
+/*
+================
+idRenderWorldLocal::AllocPortalAreas
+================
+*/
+void idRenderWorldLocal::AllocPortalAreas( int numAreas, int numPortals ) {
+	numPortalAreas = numAreas;
+	portalAreas = (portalArea_t *)R_ClearedStaticAlloc( numPortalAreas * sizeof( portalAreas[0] ) );
+	areaScreenRect = (idScreenRect *) R_ClearedStaticAlloc( numPortalAreas * sizeof( idScreenRect ) );
+
+	// set the doubly linked lists
+	SetupAreaRefs();
+
+	numInterAreaPortals = numPortals;
+	doublePortals = (doublePortal_t *)R_ClearedStaticAlloc( numInterAreaPortals *
+		sizeof( doublePortals [0] ) );
+}
+
+/*
+================
+idRenderWorldLocal::AddInterAreaPortal
+================
+*/
+void idRenderWorldLocal::AddInterAreaPortal( int portalNum, int a1, int a2, idWinding *w ) {
+	portal_t	*p;
+
+	// add the portal to a1
+	p = (portal_t *)R_ClearedStaticAlloc( sizeof( *p ) );
+	p->intoArea = a2;
+	p->doublePortal = &doublePortals[portalNum];
+	p->w = w;
+	p->w->GetPlane( p->plane );
+
+	p->next = portalAreas[a1].portals;
+	portalAreas[a1].portals = p;
+
+	doublePortals[portalNum].portals[0] = p;
+
+	// reverse it for a2
+	p = (portal_t *)R_ClearedStaticAlloc( sizeof( *p ) );
+	p->intoArea = a1;
+	p->doublePortal = &doublePortals[portalNum];
+	p->w = w->Reverse();
+	p->w->GetPlane( p->plane );
+
+	p->next = portalAreas[a2].portals;
+	portalAreas[a2].portals = p;
+
+	doublePortals[portalNum].portals[1] = p;
+}
+
 /*
 ================
 idRenderWorldLocal::ParseInterAreaPortals
@@ -275,30 +424,29 @@ void idRenderWorldLocal::ParseInterAreaPortals( idLexer *src ) {
 
 	src->ExpectTokenString( "{" );
 
-	numPortalAreas = src->ParseInt();
-	if ( numPortalAreas < 0 ) {
+	int numAreas = src->ParseInt();
+	if ( numAreas < 0 ) {
 		src->Error( "R_ParseInterAreaPortals: bad numPortalAreas" );
 		return;
 	}
-	portalAreas = (portalArea_t *)R_ClearedStaticAlloc( numPortalAreas * sizeof( portalAreas[0] ) );
-	areaScreenRect = (idScreenRect *) R_ClearedStaticAlloc( numPortalAreas * sizeof( idScreenRect ) );
 
-	// set the doubly linked lists
-	SetupAreaRefs();
-
-	numInterAreaPortals = src->ParseInt();
-	if ( numInterAreaPortals < 0 ) {
+	int numPortals = src->ParseInt();
+	if ( numPortals < 0 ) {
 		src->Error(  "R_ParseInterAreaPortals: bad numInterAreaPortals" );
 		return;
 	}
 
-	doublePortals = (doublePortal_t *)R_ClearedStaticAlloc( numInterAreaPortals *
-		sizeof( doublePortals [0] ) );
+	AllocPortalAreas( numAreas, numPortals );
+
+	if ( binaryProc ) {
+		binaryProc->WriteInt( BPROC_INTER_AREA_PORTALS );
+		binaryProc->WriteInt( numPortalAreas );
+		binaryProc->WriteInt( numInterAreaPortals );
+	}
 
 	for ( i = 0 ; i < numInterAreaPortals ; i++ ) {
 		int		numPoints, a1, a2;
 		idWinding	*w;
-		portal_t	*p;
 
 		numPoints = src->ParseInt();
 		a1 = src->ParseInt();
@@ -313,29 +461,16 @@ void idRenderWorldLocal::ParseInterAreaPortals( idLexer *src ) {
 			(*w)[j][4] = 0;
 		}
 
-		// add the portal to a1
-		p = (portal_t *)R_ClearedStaticAlloc( sizeof( *p ) );
-		p->intoArea = a2;
-		p->doublePortal = &doublePortals[i];
-		p->w = w;
-		p->w->GetPlane( p->plane );
-
-		p->next = portalAreas[a1].portals;
-		portalAreas[a1].portals = p;
-
-		doublePortals[i].portals[0] = p;
-
-		// reverse it for a2
-		p = (portal_t *)R_ClearedStaticAlloc( sizeof( *p ) );
-		p->intoArea = a1;
-		p->doublePortal = &doublePortals[i];
-		p->w = w->Reverse();
-		p->w->GetPlane( p->plane );
-
-		p->next = portalAreas[a2].portals;
-		portalAreas[a2].portals = p;
+		if ( binaryProc ) {
+			binaryProc->WriteInt( numPoints );
+			binaryProc->WriteInt( a1 );
+			binaryProc->WriteInt( a2 );
+			for ( j = 0 ; j < numPoints ; j++ ) {
+				binaryProc->WriteVec3( (*w)[j].ToVec3() );
+			}
+		}
 
-		doublePortals[i].portals[1] = p;
+		AddInterAreaPortal( i, a1, a2, w );
 	}
 
 	src->ExpectTokenString( "}" );
@@ -368,6 +503,370 @@ void idRenderWorldLocal::ParseNodes( idLexer *src ) {
 	}
 
 	src->ExpectTokenString( "}" );
+
+	if ( binaryProc ) {
+		binaryProc->WriteInt( BPROC_NODES );
+		binaryProc->WriteInt( numAreaNodes );
+		R_WriteBinaryProcAlign( binaryProc );
+		for ( i = 0 ; i < numAreaNodes ; i++ ) {
+			binaryProc->WriteVec4( areaNodes[i].plane.ToVec4() );
+			binaryProc->WriteInt( areaNodes[i].children[0] );
+			binaryProc->WriteInt( areaNodes[i].children[1] );
+		}
+	}
+}
+
+/*
+================
+R_ValidBinaryProcIndexes
+================
+*/
+static bool R_ValidBinaryProcIndexes( const int *indexes, int numIndexes, int numVerts ) {
+	for ( int i = 0 ; i < numIndexes ; i++ ) {
+		int index = LittleInt( indexes[i] );
+		if ( index < 0 || index >= numVerts ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+================
+idRenderWorldLocal::ReadBinaryModel
+================
+*/
+idRenderModel *idRenderWorldLocal::ReadBinaryModel( idFile_Memory *f ) {
+	idRenderModel	*model;
+	idStr			name;
+	int				i, j;
+	srfTriangles_t	*tri;
+	modelSurface_t	surf;
+
+	f->ReadString( name );
+
+	model = renderModelManager->AllocModel();
+	model->InitEmpty( name );
+
+	int numSurfaces;
+	f->ReadInt( numSurfaces );
+
+	for ( i = 0 ; i < numSurfaces ; i++ ) {
+		int numVerts, numIndexes;
+
+		f->ReadString( name );
+		f->ReadInt( numVerts );
+		f->ReadInt( numIndexes );
+
+		const float *v = (const float *)R_ReadBinaryProcArray( f, numVerts, 8 * sizeof( float ) );
+		const int *indexes = (const int *)R_ReadBinaryProcArray( f, numIndexes, sizeof( int ) );
+		if ( !v || !indexes || !R_ValidBinaryProcIndexes( indexes, numIndexes, numVerts ) ) {
+			renderModelManager->FreeModel( model );
+			return NULL;
+		}
+
+		surf.shader = declManager->FindMaterial( name );
+
+		((idMaterial*)surf.shader)->AddReference();
+
+		tri = R_AllocStaticTriSurf();
+		surf.geometry = tri;
+
+		tri->numVerts = numVerts;
+		tri->numIndexes = numIndexes;
+
+		R_AllocStaticTriSurfVerts( tri, tri->numVerts );
+		for ( j = 0 ; j < tri->numVerts ; j++, v += 8 ) {
+			tri->verts[j].xyz[0] = LittleFloat( v[0] );
+			tri->verts[j].xyz[1] = LittleFloat( v[1] );
+			tri->verts[j].xyz[2] = LittleFloat( v[2] );
+			tri->verts[j].st[0] = LittleFloat( v[3] );
+			tri->verts[j].st[1] = LittleFloat( v[4] );
+			tri->verts[j].normal[0] = LittleFloat( v[5] );
+			tri->verts[j].normal[1] = LittleFloat( v[6] );
+			tri->verts[j].normal[2] = LittleFloat( v[7] );
+		}
+
+		R_AllocStaticTriSurfIndexes( tri, tri->numIndexes );
+		for ( j = 0 ; j < tri->numIndexes ; j++ ) {
+			tri->indexes[j] = LittleInt( indexes[j] );
+		}
+
+		// add the completed surface to the model
+		model->AddSurface( surf );
+	}
+
+	model->FinishSurfaces();
+
+	return model;
+}
+
+/*
+================
+idRenderWorldLocal::ReadBinaryShadowModel
+================
+*/
+idRenderModel *idRenderWorldLocal::ReadBinaryShadowModel( idFile_Memory *f ) {
+	idRenderModel	*model;
+	idStr			name;
+	int				j;
+	srfTriangles_t	*tri;
+	modelSurface_t	surf;
+	int				numVerts, numShadowIndexesNoCaps, numShadowIndexesNoFrontCaps, numIndexes, shadowCapPlaneBits;
+
+	f->ReadString( name );
+	f->ReadInt( numVerts );
+	f->ReadInt( numShadowIndexesNoCaps );
+	f->ReadInt( numShadowIndexesNoFrontCaps );
+	f->ReadInt( numIndexes );
+	f->ReadInt( shadowCapPlaneBits );
+
+	const float *v = (const float *)R_ReadBinaryProcArray( f, numVerts, 3 * sizeof( float ) );
+	const int *indexes = (const int *)R_ReadBinaryProcArray( f, numIndexes, sizeof( int ) );
+	if ( !v || !indexes || !R_ValidBinaryProcIndexes( indexes, numIndexes, numVerts ) ) {
+		return NULL;
+	}
+
+	model = renderModelManager->AllocModel();
+	model->InitEmpty( name );
+
+	surf.shader = tr.defaultMaterial;
+
+	tri = R_AllocStaticTriSurf();
+	surf.geometry = tri;
+
+	tri->numVerts = numVerts;
+	tri->numShadowIndexesNoCaps = numShadowIndexesNoCaps;
+	tri->numShadowIndexesNoFrontCaps = numShadowIndexesNoFrontCaps;
+	tri->numIndexes = numIndexes;
+	tri->shadowCapPlaneBits = shadowCapPlaneBits;
+
+	R_AllocStaticTriSurfShadowVerts( tri, tri->numVerts );
+	tri->bounds.Clear();
+	for ( j = 0 ; j < tri->numVerts ; j++, v += 3 ) {
+		tri->shadowVertexes[j].xyz[0] = LittleFloat( v[0] );
+		tri->shadowVertexes[j].xyz[1] = LittleFloat( v[1] );
+		tri->shadowVertexes[j].xyz[2] = LittleFloat( v[2] );
+		tri->shadowVertexes[j].xyz[3] = 1;		// no homogenous value
+
+		tri->bounds.AddPoint( tri->shadowVertexes[j].xyz.ToVec3() );
+	}
+
+	R_AllocStaticTriSurfIndexes( tri, tri->numIndexes );
+	for ( j = 0 ; j < tri->numIndexes ; j++ ) {
+		tri->indexes[j] = LittleInt( indexes[j] );
+	}
+
+	// add the completed surface to the model
+	model->AddSurface( surf );
+
+	return model;
+}
+
+/*
+================
+idRenderWorldLocal::ReadBinaryInterAreaPortals
+================
+*/
+bool idRenderWorldLocal::ReadBinaryInterAreaPortals( idFile_Memory *f ) {
+	int i, j;
+	int numAreas, numPortals;
+
+	f->ReadInt( numAreas );
+	f->ReadInt( numPortals );
+	if ( numAreas < 0 || numPortals < 0 ) {
+		return false;
+	}
+
+	AllocPortalAreas( numAreas, numPortals );
+
+	for ( i = 0 ; i < numInterAreaPortals ; i++ ) {
+		int		numPoints, a1, a2;
+		idWinding	*w;
+
+		f->ReadInt( numPoints );
+		f->ReadInt( a1 );
+		f->ReadInt( a2 );
+		if ( numPoints < 0 || a1 < 0 || a1 >= numPortalAreas || a2 < 0 || a2 >= numPortalAreas ) {
+			return false;
+		}
+
+		w = new idWinding( numPoints );
+		w->SetNumPoints( numPoints );
+		for ( j = 0 ; j < numPoints ; j++ ) {
+			idVec3 point;
+			f->ReadVec3( point );
+			(*w)[j].ToVec3() = point;
+			// no texture coordinates
+			(*w)[j][3] = 0;
+			(*w)[j][4] = 0;
+		}
+
+		AddInterAreaPortal( i, a1, a2, w );
+	}
+
+	return true;
+}
+
+/*
+================
+idRenderWorldLocal::ReadBinaryNodes
+================
+*/
+bool idRenderWorldLocal::ReadBinaryNodes( idFile_Memory *f ) {
+	int			i;
+
+	f->ReadInt( numAreaNodes );
+
+	const float *n = (const float *)R_ReadBinaryProcArray( f, numAreaNodes, 6 * sizeof( float ) );
+	if ( !n ) {
+		numAreaNodes = 0;
+		return false;
+	}
+	areaNodes = (areaNode_t *)R_ClearedStaticAlloc( numAreaNodes * sizeof( areaNodes[0] ) );
+
+	for ( i = 0 ; i < numAreaNodes ; i++, n += 6 ) {
+		areaNode_t	*node;
+
+		node = &areaNodes[i];
+
+		node->plane[0] = LittleFloat( n[0] );
+		node->plane[1] = LittleFloat( n[1] );
+		node->plane[2] = LittleFloat( n[2] );
+		node->plane[3] = LittleFloat( n[3] );
+		node->children[0] = LittleInt( ((const int *)n)[4] );
+		node->children[1] = LittleInt( ((const int *)n)[5] );
+
+		// dmap numbers the nodes depth first, so a child always comes after its parent and
+		// the tree walks can't loop. Without any areas FinishWorld replaces the nodes.
+		for ( int j = 0 ; j < 2 ; j++ ) {
+			int child = node->children[j];
+			if ( child > 0 ? ( child <= i || child >= numAreaNodes ) : ( numPortalAreas && -1 - child >= numPortalAreas ) ) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/*
+================
+idRenderWorldLocal::LoadBinaryProc
+
+Returns false if there is no .bproc matching the .proc, the world is left empty in that case
+================
+*/
+bool idRenderWorldLocal::LoadBinaryProc( const char *fileName, int procLength, ID_TIME_T procTimeStamp ) {
+	void *			buffer;
+	int				header[BPROC_HEADER_SIZE / 4];
+	int				i;
+
+	int length = fileSystem->ReadFile( fileName, &buffer );
+	if ( length < BPROC_HEADER_SIZE ) {
+		if ( buffer ) {
+			fileSystem->FreeFile( buffer );
+		}
+		return false;
+	}
+
+	for ( i = 0 ; i < BPROC_HEADER_SIZE / 4 ; i++ ) {
+		header[i] = LittleInt( ((int *)buffer)[i] );
+	}
+
+	const byte *payload = (const byte *)buffer + BPROC_HEADER_SIZE;
+	int payloadLength = length - BPROC_HEADER_SIZE;
+
+	if ( header[0] != BPROC_FILE_ID || header[1] != BPROC_FILE_VERSION || header[2] != procLength || header[3] != (int)procTimeStamp
+			|| header[4] != payloadLength || header[5] != (int)CRC32_BlockChecksum( payload, payloadLength ) ) {
+		common->DPrintf( "%s is out of date\n", fileName );
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
+	idFile_Memory f( fileName, (const char *)payload, payloadLength );
+	bool ok = true;
+
+	while ( ok ) {
+		int chunk = BPROC_END;
+
+		f.ReadInt( chunk );
+		if ( chunk == BPROC_END ) {
+			break;
+		}
+
+		idRenderModel *model = NULL;
+
+		switch ( chunk ) {
+		case BPROC_MODEL:
+			model = ReadBinaryModel( &f );
+			ok = ( model != NULL );
+			break;
+		case BPROC_SHADOW_MODEL:
+			model = ReadBinaryShadowModel( &f );
+			ok = ( model != NULL );
+			break;
+		case BPROC_INTER_AREA_PORTALS:
+			ok = ReadBinaryInterAreaPortals( &f );
+			break;
+		case BPROC_NODES:
+			ok = ReadBinaryNodes( &f );
+			break;
+		default:
+			ok = false;
+			break;
+		}
+
+		if ( model ) {
+			// add it to the model manager list
+			renderModelManager->AddModel( model );
+
+			// save it in the list to free when clearing this map
+			localModels.Append( model );
+		}
+	}
+
+	fileSystem->FreeFile( buffer );
+
+	if ( !ok ) {
+		common->Warning( "idRenderWorldLocal::InitFromMap: bad binary proc file %s", fileName );
+		FreeWorld();
+		return false;
+	}
+
+	return true;
+}
+
+/*
+================
+idRenderWorldLocal::WriteBinaryProc
+================
+*/
+void idRenderWorldLocal::WriteBinaryProc( const char *fileName, int procLength, ID_TIME_T procTimeStamp ) {
+	binaryProc->WriteInt( BPROC_END );
+
+	idFile *f = fileSystem->OpenFileWrite( fileName );
+	if ( !f ) {
+		common->Warning( "idRenderWorldLocal::InitFromMap: couldn't write %s", fileName );
+		return;
+	}
+
+	const char *payload = binaryProc->GetDataPtr();
+	int payloadLength = binaryProc->Length();
+
+	f->WriteInt( BPROC_FILE_ID );
+	f->WriteInt( BPROC_FILE_VERSION );
+	f->WriteInt( procLength );
+	f->WriteInt( (int)procTimeStamp );
+	f->WriteInt( payloadLength );
+	f->WriteInt( (int)CRC32_BlockChecksum( payload, payloadLength ) );
+	f->WriteInt( 0 );
+	f->WriteInt( 0 );
+	f->Write( payload, payloadLength );
+
+	fileSystem->CloseFile( f );
+
+	common->DPrintf( "wrote %s\n", fileName );
 }
 
 /*
@@ -499,7 +998,7 @@ bool idRenderWorldLocal::InitFromMap( const char *name ) {
 	// if we are reloading the same map, check the timestamp
 	// and try to skip all the work
 	ID_TIME_T currentTimeStamp;
-	fileSystem->ReadFile( filename, NULL, &currentTimeStamp );
+	int procLength = fileSystem->ReadFile( filename, NULL, &currentTimeStamp );
 
 	if ( name == mapName ) {
 		if ( currentTimeStamp != FILE_NOT_FOUND_TIMESTAMP && currentTimeStamp == mapTimeStamp ) {
@@ -515,6 +1014,22 @@ bool idRenderWorldLocal::InitFromMap( const char *name ) {
 
 	FreeWorld();
 
+	// use the binary version if it was written from this .proc
+	idStr binaryFilename = name;
+	binaryFilename.SetFileExtension( BPROC_FILE_EXT );
+
+	if ( r_binaryProc.GetBool() && procLength > 0 && LoadBinaryProc( binaryFilename, procLength, currentTimeStamp ) ) {
+		mapName = name;
+		mapTimeStamp = currentTimeStamp;
+
+		// if we are writing a demo, archive the load command
+		if ( session->writeDemo ) {
+			WriteLoadMap();
+		}
+
+		return FinishWorld();
+	}
+
 	src = new idLexer( filename, LEXFL_NOSTRINGCONCAT | LEXFL_NODOLLARPRECOMPILE );
 	if ( !src->IsLoaded() ) {
 		common->Printf( "idRenderWorldLocal::InitFromMap: %s not found\n", filename.c_str() );
@@ -537,6 +1052,10 @@ bool idRenderWorldLocal::InitFromMap( const char *name ) {
 		return false;
 	}
 
+	if ( r_binaryProc.GetBool() ) {
+		binaryProc = new idFile_Memory( binaryFilename );
+	}
+
 	// parse the file
 	while ( 1 ) {
 		if ( !src->ReadToken( &token ) ) {
@@ -580,6 +1099,21 @@ bool idRenderWorldLocal::InitFromMap( const char *name ) {
 
 	delete src;
 
+	if ( binaryProc ) {
+		WriteBinaryProc( binaryFilename, procLength, currentTimeStamp );
+		delete binaryProc;
+		binaryProc = NULL;
+	}
+
+	return FinishWorld();
+}
+
+/*
+=================
+idRenderWorldLocal::FinishWorld
+=================
+*/
+bool idRenderWorldLocal::FinishWorld() {
 	// if it was a trivial map without any areas, create a single area
 	if ( !numPortalAreas ) {
 		ClearWorld();
@@ -141,6 +141,7 @@ public:
 
 	idStr					mapName;				// ie: maps/tim_dm2.proc, written to demoFile
 	ID_TIME_T					mapTimeStamp;			// for fast reloads of the same level
+	idFile_Memory *			binaryProc;				// the .bproc being recorded while a .proc is parsed
 
 	areaNode_t *			areaNodes;
 	int						numAreaNodes;
@@ -181,8 +182,17 @@ public:
 	idRenderModel *			ParseModel( idLexer *src );
 	idRenderModel *			ParseShadowModel( idLexer *src );
 	void					SetupAreaRefs();
+	void					AllocPortalAreas( int numAreas, int numPortals );
+	void					AddInterAreaPortal( int portalNum, int a1, int a2, idWinding *w );
 	void					ParseInterAreaPortals( idLexer *src );
 	void					ParseNodes( idLexer *src );
+	idRenderModel *			ReadBinaryModel( idFile_Memory *f );
+	idRenderModel *			ReadBinaryShadowModel( idFile_Memory *f );
+	bool					ReadBinaryInterAreaPortals( idFile_Memory *f );
+	bool					ReadBinaryNodes( idFile_Memory *f );
+	bool					LoadBinaryProc( const char *fileName, int procLength, ID_TIME_T procTimeStamp );
+	void					WriteBinaryProc( const char *fileName, int procLength, ID_TIME_T procTimeStamp );
+	bool					FinishWorld();
 	int						CommonChildrenArea_r( areaNode_t *node );
 	void					FreeWorld();
 	void					ClearWorld();
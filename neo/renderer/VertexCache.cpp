@@ -50,6 +50,7 @@ static const int	EXPAND_HEADERS = 1024;
 idCVar idVertexCache::r_showVertexCache("r_showVertexCache", "0", CVAR_INTEGER | CVAR_RENDERER, "");
 idCVar idVertexCache::r_vertexBufferMegs("r_vertexBufferMegs", "128", CVAR_INTEGER | CVAR_RENDERER, "");
 idCVar idVertexCache::r_freeVertexBuffer("r_freeVertexBuffer", "1", CVAR_BOOL | CVAR_RENDERER, "");
+idCVar idVertexCache::r_packedVerts("r_packedVerts", "1", CVAR_BOOL | CVAR_RENDERER, "store vertexes as 36 byte idPackedDrawVert with byte normals and tangents instead of 60 byte idDrawVert");
 
 idVertexCache		vertexCache;
 
@@ -470,8 +471,11 @@ void idVertexCache::Alloc(void* data, int size, vertCache_t** buffer, bool index
 	block->size = size;
 #endif
 
-	memcpy( block->frontEndMemory, data, size );
+	if ( data ) {
+		memcpy( block->frontEndMemory, data, size );
+	}
 	block->frontEndMemoryDirty = true;
+	block->packedVerts = false;
 
 	//Position(block);
 }
@@ -654,18 +658,65 @@ vertCache_t* idVertexCache::AllocFrameTemp(void* data, int size, bool indexBuffe
 
 	block->user = NULL;
 	block->frameUsed = 0;
+	block->packedVerts = false;
 
 	// copy the data
 	if (indexBuffer) {
 		block->vbo = tempIndexBuffers[listNum]->vbo;
-        memcpy( (char*)tempIndexBuffers[listNum]->frontEndMemory + block->offset, data, size);
-        block->frontEndMemory = tempIndexBuffers[listNum]->frontEndMemory;
-    } else {
-    	block->vbo = tempBuffers[listNum]->vbo;
-        memcpy( (char*)tempBuffers[listNum]->frontEndMemory + block->offset, data, size);
-        block->frontEndMemory = tempBuffers[listNum]->frontEndMemory;
+		block->frontEndMemory = tempIndexBuffers[listNum]->frontEndMemory;
+	} else {
+		block->vbo = tempBuffers[listNum]->vbo;
+		block->frontEndMemory = tempBuffers[listNum]->frontEndMemory;
+	}
+	if (data) {
+		memcpy( FrontEndPosition(block), data, size );
+	}
+
+
+	return block;
+}
+
+/*
+===========
+idVertexCache::AllocVerts
+
+Skinned and deformed surfaces come through here every frame,
+so packing them directly into the block saves both the copy
+and close to half of the upload.
+===========
+*/
+void idVertexCache::AllocVerts(const idDrawVert* verts, int numVerts, vertCache_t** buffer) {
+	if (!r_packedVerts.GetBool()) {
+		Alloc((void*)verts, numVerts * sizeof(idDrawVert), buffer, false);
+		return;
 	}
 
+	Alloc(NULL, numVerts * sizeof(idPackedDrawVert), buffer, false);
+	if (!*buffer) {
+		return;
+	}
+	SIMDProcessor->PackDrawVerts((idPackedDrawVert*)FrontEndPosition(*buffer), verts, numVerts);
+	(*buffer)->packedVerts = true;
+}
+
+/*
+===========
+idVertexCache::AllocFrameTempVerts
+===========
+*/
+vertCache_t* idVertexCache::AllocFrameTempVerts(const idDrawVert* verts, int numVerts) {
+	vertCache_t* block;
+
+	if (!r_packedVerts.GetBool()) {
+		return AllocFrameTemp((void*)verts, numVerts * sizeof(idDrawVert), false);
+	}
+
+	block = AllocFrameTemp(NULL, numVerts * sizeof(idPackedDrawVert), false);
+	if (!block) {
+		return NULL;
+	}
+	SIMDProcessor->PackDrawVerts((idPackedDrawVert*)FrontEndPosition(block), verts, numVerts);
+	block->packedVerts = true;
 
 	return block;
 }
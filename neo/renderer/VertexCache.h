@@ -52,6 +52,7 @@ typedef struct vertCache_s {
 	int frameUsed;      // it can't be purged if near the current frame
 	void* frontEndMemory;
 	bool frontEndMemoryDirty;
+	bool packedVerts;    // holds idPackedDrawVert instead of idDrawVert
 } vertCache_t;
 
 
@@ -70,8 +71,14 @@ public:
 	// Alloc does NOT do a touch, which allows purging of things
 	// created at level load time even if a frame hasn't passed yet.
 	// These allocations can be purged, which will zero the pointer.
+	// If data is NULL, the memory is left for the caller to fill in.
 	void Alloc(void *data, int bytes, vertCache_t **buffer, bool indexBuffer);
 
+	// Allocates ambient vertexes, packed to idPackedDrawVert when
+	// r_packedVerts is set.  The backend checks packedVerts on the
+	// block to set up the matching vertex attributes.
+	void AllocVerts(const idDrawVert *verts, int numVerts, vertCache_t **buffer);
+
 	// This will be a real pointer with virtual memory,
 	// but it will be an int offset cast to a pointer of ARB_vertex_buffer_object
 	void *Position(vertCache_t *buffer);
@@ -85,6 +92,9 @@ public:
 	// As with Position(), this may not actually be a pointer you can access.
 	vertCache_t *AllocFrameTemp(void *data, int bytes, bool indexBuffer);
 
+	// frame temp version of AllocVerts
+	vertCache_t *AllocFrameTempVerts(const idDrawVert *verts, int numVerts);
+
 	// notes that a buffer is used this frame, so it can't be purged
 	// out from under the GPU
 	void Touch(vertCache_t *buffer);
@@ -112,11 +122,15 @@ public:
 private:
 	void InitMemoryBlocks(int size);
 
+	// the front end copy of the block, for filling in NULL data allocations
+	void *FrontEndPosition(vertCache_t *block) { return (byte *)block->frontEndMemory + block->offset; }
+
 	void ActuallyFree(vertCache_t *block);
 
 	static idCVar r_showVertexCache;
 	static idCVar r_vertexBufferMegs;
 	static idCVar r_freeVertexBuffer;
+	static idCVar r_packedVerts;
 
 	int staticCountTotal;
 	int staticAllocTotal;    // for end of frame purging
@@ -121,6 +121,74 @@ static void GL_VertexAttribPointer(GLuint index, GLint size, GLenum type,
 	                       size, type, normalized, stride, pointer);
 }
 
+typedef enum {
+	AMBIENT_XYZ,
+	AMBIENT_ST,
+	AMBIENT_NORMAL,
+	AMBIENT_TANGENT,
+	AMBIENT_BITANGENT,
+	AMBIENT_COLOR
+} ambientAttrib_t;
+
+/*
+====================
+RB_AmbientAttribPointer
+
+Ambient caches hold either idDrawVert or idPackedDrawVert, see
+idVertexCache::AllocVerts.  Packed normals and tangents are
+normalized signed bytes, so the shaders still see vec3s.
+====================
+*/
+static void RB_AmbientAttribPointer(GLuint index, ambientAttrib_t attrib, const vertCache_t* cache, const void* position) {
+	if ( cache->packedVerts ) {
+		const idPackedDrawVert* pv = (const idPackedDrawVert*) position;
+
+		switch ( attrib ) {
+		case AMBIENT_XYZ:
+			GL_VertexAttribPointer(index, 3, GL_FLOAT, false, sizeof(idPackedDrawVert), pv->xyz.ToFloatPtr());
+			break;
+		case AMBIENT_ST:
+			GL_VertexAttribPointer(index, 2, GL_FLOAT, false, sizeof(idPackedDrawVert), pv->st.ToFloatPtr());
+			break;
+		case AMBIENT_NORMAL:
+			GL_VertexAttribPointer(index, 3, GL_BYTE, true, sizeof(idPackedDrawVert), pv->normal);
+			break;
+		case AMBIENT_TANGENT:
+			GL_VertexAttribPointer(index, 3, GL_BYTE, true, sizeof(idPackedDrawVert), pv->tangents[0]);
+			break;
+		case AMBIENT_BITANGENT:
+			GL_VertexAttribPointer(index, 3, GL_BYTE, true, sizeof(idPackedDrawVert), pv->tangents[1]);
+			break;
+		case AMBIENT_COLOR:
+			GL_VertexAttribPointer(index, 4, GL_UNSIGNED_BYTE, false, sizeof(idPackedDrawVert), pv->color);
+			break;
+		}
+	} else {
+		const idDrawVert* ac = (const idDrawVert*) position;
+
+		switch ( attrib ) {
+		case AMBIENT_XYZ:
+			GL_VertexAttribPointer(index, 3, GL_FLOAT, false, sizeof(idDrawVert), ac->xyz.ToFloatPtr());
+			break;
+		case AMBIENT_ST:
+			GL_VertexAttribPointer(index, 2, GL_FLOAT, false, sizeof(idDrawVert), ac->st.ToFloatPtr());
+			break;
+		case AMBIENT_NORMAL:
+			GL_VertexAttribPointer(index, 3, GL_FLOAT, false, sizeof(idDrawVert), ac->normal.ToFloatPtr());
+			break;
+		case AMBIENT_TANGENT:
+			GL_VertexAttribPointer(index, 3, GL_FLOAT, false, sizeof(idDrawVert), ac->tangents[0].ToFloatPtr());
+			break;
+		case AMBIENT_BITANGENT:
+			GL_VertexAttribPointer(index, 3, GL_FLOAT, false, sizeof(idDrawVert), ac->tangents[1].ToFloatPtr());
+			break;
+		case AMBIENT_COLOR:
+			GL_VertexAttribPointer(index, 4, GL_UNSIGNED_BYTE, false, sizeof(idDrawVert), ac->color);
+			break;
+		}
+	}
+}
+
 /*
 =================
 R_LoadGLSLShader
@@ -776,20 +844,14 @@ static void RB_GLSL_CreateDrawInteractions(const drawSurf_t* surf, const viewLig
 		}
 
 		// set the vertex pointers
-		idDrawVert* ac = (idDrawVert*) vertexCache.Position(surf->ambientCache);
-
-		GL_VertexAttribPointer(offsetof(shaderProgram_t, attr_Normal), 3, GL_FLOAT, false, sizeof(idDrawVert),
-		                       ac->normal.ToFloatPtr());
-		GL_VertexAttribPointer(offsetof(shaderProgram_t, attr_Bitangent), 3, GL_FLOAT, false, sizeof(idDrawVert),
-		                       ac->tangents[1].ToFloatPtr());
-		GL_VertexAttribPointer(offsetof(shaderProgram_t, attr_Tangent), 3, GL_FLOAT, false, sizeof(idDrawVert),
-		                       ac->tangents[0].ToFloatPtr());
-		GL_VertexAttribPointer(offsetof(shaderProgram_t, attr_TexCoord), 2, GL_FLOAT, false, sizeof(idDrawVert),
-		                       ac->st.ToFloatPtr());
-		GL_VertexAttribPointer(offsetof(shaderProgram_t, attr_Vertex), 3, GL_FLOAT, false, sizeof(idDrawVert),
-		                       ac->xyz.ToFloatPtr());
-		GL_VertexAttribPointer(offsetof(shaderProgram_t, attr_Color), 4, GL_UNSIGNED_BYTE, false, sizeof(idDrawVert),
-		                       (void*) &ac->color);
+		void* ac = vertexCache.Position(surf->ambientCache);
+
+		RB_AmbientAttribPointer(offsetof(shaderProgram_t, attr_Normal), AMBIENT_NORMAL, surf->ambientCache, ac);
+		RB_AmbientAttribPointer(offsetof(shaderProgram_t, attr_Bitangent), AMBIENT_BITANGENT, surf->ambientCache, ac);
+		RB_AmbientAttribPointer(offsetof(shaderProgram_t, attr_Tangent), AMBIENT_TANGENT, surf->ambientCache, ac);
+		RB_AmbientAttribPointer(offsetof(shaderProgram_t, attr_TexCoord), AMBIENT_ST, surf->ambientCache, ac);
+		RB_AmbientAttribPointer(offsetof(shaderProgram_t, attr_Vertex), AMBIENT_XYZ, surf->ambientCache, ac);
+		RB_AmbientAttribPointer(offsetof(shaderProgram_t, attr_Color), AMBIENT_COLOR, surf->ambientCache, ac);
 
 		// this may cause RB_GLSL_DrawInteraction to be exacuted multiple
 		// times with different colors and images if the surface or light have multiple layers
@@ -1151,10 +1213,9 @@ static void RB_T_GLSL_BasicFog(const drawSurf_t* surf, const viewLight_t* vLight
 		GL_UniformMatrix4fv(offsetof(shaderProgram_t, fogMatrix), fogMatrix.ToFloatPtr());
 	}
 
-	idDrawVert* ac = (idDrawVert*) vertexCache.Position(surf->ambientCache);
+	void* ac = vertexCache.Position(surf->ambientCache);
 
-	GL_VertexAttribPointer(offsetof(shaderProgram_t, attr_Vertex), 3, GL_FLOAT, false, sizeof(idDrawVert),
-	                       ac->xyz.ToFloatPtr());
+	RB_AmbientAttribPointer(offsetof(shaderProgram_t, attr_Vertex), AMBIENT_XYZ, surf->ambientCache, ac);
 
 	RB_DrawElementsWithCounters(surf);
 }
@@ -1362,13 +1423,11 @@ void RB_T_GLSL_FillDepthBuffer(const drawSurf_t* surf) {
 	GL_Uniform4fv(offsetof(shaderProgram_t, glColor), color);
 
 	// Get vertex data
-	idDrawVert* ac = (idDrawVert*) vertexCache.Position(surf->ambientCache);
+	void* ac = vertexCache.Position(surf->ambientCache);
 
 	// Setup attribute pointers
-	GL_VertexAttribPointer(offsetof(shaderProgram_t, attr_Vertex), 3, GL_FLOAT, false, sizeof(idDrawVert),
-	                       ac->xyz.ToFloatPtr());
-	GL_VertexAttribPointer(offsetof(shaderProgram_t, attr_TexCoord), 2, GL_FLOAT, false, sizeof(idDrawVert),
-	                       ac->st.ToFloatPtr());
+	RB_AmbientAttribPointer(offsetof(shaderProgram_t, attr_Vertex), AMBIENT_XYZ, surf->ambientCache, ac);
+	RB_AmbientAttribPointer(offsetof(shaderProgram_t, attr_TexCoord), AMBIENT_ST, surf->ambientCache, ac);
 
 	bool drawSolid = false;
 
@@ -1719,7 +1778,7 @@ void RB_GLSL_T_RenderShaderPasses(const drawSurf_t* surf, const float mvp[16]) {
 	GL_Cull(shader->GetCullType());
 
 	// Location of vertex attributes data
-	const idDrawVert* const ac = (const idDrawVert* const) vertexCache.Position(surf->ambientCache);
+	const void* const ac = vertexCache.Position(surf->ambientCache);
 
 	// get the expressions for conditionals / color / texcoords
 	const float* const regs = surf->shaderRegisters;
@@ -1813,8 +1872,7 @@ void RB_GLSL_T_RenderShaderPasses(const drawSurf_t* surf, const float mvp[16]) {
 				// Possible that normals should be transformed by a normal matrix in the shader ? I am not sure...
 
 				// Setup texcoord array to use the normals
-				GL_VertexAttribPointer(offsetof(shaderProgram_t, attr_TexCoord), 3, GL_FLOAT, false, sizeof(idDrawVert),
-				                       ac->normal.ToFloatPtr());
+				RB_AmbientAttribPointer(offsetof(shaderProgram_t, attr_TexCoord), AMBIENT_NORMAL, surf->ambientCache, ac);
 
 				// Setup the texture matrix
 				if ( pStage->texture.hasMatrix ) {
@@ -1876,8 +1934,7 @@ void RB_GLSL_T_RenderShaderPasses(const drawSurf_t* surf, const float mvp[16]) {
 				// This is not implemented for now, we only do standard reflection cubemaping. Visual difference is really minor.
 
 				// Setup texcoord array to use the normals
-				GL_VertexAttribPointer(offsetof(shaderProgram_t, attr_TexCoord), 3, GL_FLOAT, false, sizeof(idDrawVert),
-				                       ac->normal.ToFloatPtr());
+				RB_AmbientAttribPointer(offsetof(shaderProgram_t, attr_TexCoord), AMBIENT_NORMAL, surf->ambientCache, ac);
 
 				// Setup the modelViewMatrix, we will need it to compute the reflection
 				GL_UniformMatrix4fv(offsetof(shaderProgram_t, modelViewMatrix), surf->space->modelViewMatrix);
@@ -1892,8 +1949,7 @@ void RB_GLSL_T_RenderShaderPasses(const drawSurf_t* surf, const float mvp[16]) {
 				GL_UseProgram(&diffuseMapShader);
 
 				// Setup the TexCoord pointer
-				GL_VertexAttribPointer(offsetof(shaderProgram_t, attr_TexCoord), 2, GL_FLOAT, false, sizeof(idDrawVert),
-				                       ac->st.ToFloatPtr());
+				RB_AmbientAttribPointer(offsetof(shaderProgram_t, attr_TexCoord), AMBIENT_ST, surf->ambientCache, ac);
 
 				// Setup the texture matrix
 				if ( pStage->texture.hasMatrix ) {
@@ -1912,12 +1968,10 @@ void RB_GLSL_T_RenderShaderPasses(const drawSurf_t* surf, const float mvp[16]) {
 				if ( !bVASet[pStage->texture.texgen] ) {
 
 					// Setup the Vertex Attrib pointer
-					GL_VertexAttribPointer(offsetof(shaderProgram_t, attr_Vertex), 3, GL_FLOAT, false, sizeof(idDrawVert),
-					                       ac->xyz.ToFloatPtr());
+					RB_AmbientAttribPointer(offsetof(shaderProgram_t, attr_Vertex), AMBIENT_XYZ, surf->ambientCache, ac);
 
 					// Setup the Color pointer
-					GL_VertexAttribPointer(offsetof(shaderProgram_t, attr_Color), 4, GL_UNSIGNED_BYTE, false, sizeof(idDrawVert),
-					                       (void*) &ac->color);
+					RB_AmbientAttribPointer(offsetof(shaderProgram_t, attr_Color), AMBIENT_COLOR, surf->ambientCache, ac);
 
 					bVASet[pStage->texture.texgen] = true;
 				}
@@ -2212,8 +2266,8 @@ static void RB_T_GLSL_BlendLight(const drawSurf_t *surf, const viewLight_t* vLig
 
 	// This gets used for both blend lights and shadow draws
 	if (surf->ambientCache) {
-		idDrawVert *ac = (idDrawVert *) vertexCache.Position(surf->ambientCache);
-		GL_VertexAttribPointer(offsetof(shaderProgram_t, attr_Vertex), 3, GL_FLOAT, false, sizeof(idDrawVert), ac->xyz.ToFloatPtr());
+		void *ac = vertexCache.Position(surf->ambientCache);
+		RB_AmbientAttribPointer(offsetof(shaderProgram_t, attr_Vertex), AMBIENT_XYZ, surf->ambientCache, ac);
 	} else if (surf->shadowCache) {
 		shadowCache_t *sc = (shadowCache_t *) vertexCache.Position(surf->shadowCache);
 		GL_VertexAttribPointer(offsetof(shaderProgram_t, attr_Vertex), 3, GL_FLOAT, false, sizeof(idDrawVert), sc->xyz.ToFloatPtr());
@@ -33,15 +33,118 @@ If you have questions concerning this license or the applicable additional terms
 #include "renderer/tr_local.h"
 
 
+/*
+=================
+R_SetDeformedDrawSurf
+=================
+*/
+static void R_SetDeformedDrawSurf( drawSurf_t *drawSurf, srfTriangles_t *newTri ) {
+	drawSurf->geoFrontEnd = newTri;
+	drawSurf->ambientCache = newTri->ambientCache;
+	drawSurf->indexCache = newTri->indexCache;
+	drawSurf->numIndexes = newTri->numIndexes;
+	drawSurf->numShadowIndexesNoFrontCaps = newTri->numShadowIndexesNoFrontCaps;
+	drawSurf->numShadowIndexesNoCaps = newTri->numShadowIndexesNoCaps;
+	drawSurf->shadowCapPlaneBits = newTri->shadowCapPlaneBits;
+}
+
+/*
+=================
+R_FreeDeformCache
+=================
+*/
+void R_FreeDeformCache( srfTriangles_t *tri ) {
+	if ( tri->deformCache ) {
+		vertexCache.Free( tri->deformCache );
+		tri->deformCache = NULL;
+	}
+	if ( tri->deformIndexCache ) {
+		vertexCache.Free( tri->deformIndexCache );
+		tri->deformIndexCache = NULL;
+	}
+	tri->deformType = DFRM_NONE;
+	tri->deformMaterial = NULL;
+}
+
+/*
+=================
+R_DeformFromCache
+
+The deformed vertexes of a static model surface only depend on the few
+deform inputs in parms, so if they are the same as the last time the
+surface was deformed the previous result can be drawn again.
+
+Inputs that change every frame never get a static cache allocated, they
+have to be seen twice in a row first.  When that happens, cacheTri is set
+and R_FinishDeform will keep the new result for the next frame.
+=================
+*/
+static bool R_DeformFromCache( drawSurf_t *drawSurf, const float parms[6], srfTriangles_t **cacheTri ) {
+	*cacheTri = NULL;
+
+	if ( !r_useDeformCache.GetBool() ) {
+		return false;
+	}
+
+	// dynamic models regenerate their surfaces, so only static ones can be cached
+	const idRenderEntityLocal *def = drawSurf->space->entityDef;
+	if ( def == NULL || def->dynamicModel != NULL ) {
+		return false;
+	}
+
+	srfTriangles_t *tri = const_cast<srfTriangles_t *>( drawSurf->geoFrontEnd );
+
+	if ( tri->deformType != drawSurf->material->Deform() || tri->deformMaterial != drawSurf->material
+			|| memcmp( tri->deformParms, parms, sizeof( tri->deformParms ) ) != 0 ) {
+		R_FreeDeformCache( tri );
+		tri->deformType = drawSurf->material->Deform();
+		tri->deformMaterial = drawSurf->material;
+		memcpy( tri->deformParms, parms, sizeof( tri->deformParms ) );
+		return false;
+	}
+
+	// either never created, or purged from the vertex cache
+	if ( !tri->deformCache || !tri->deformIndexCache ) {
+		if ( tri->deformCache ) {
+			vertexCache.Free( tri->deformCache );
+			tri->deformCache = NULL;
+		}
+		if ( tri->deformIndexCache ) {
+			vertexCache.Free( tri->deformIndexCache );
+			tri->deformIndexCache = NULL;
+		}
+		*cacheTri = tri;
+		return false;
+	}
+
+	vertexCache.Touch( tri->deformCache );
+	vertexCache.Touch( tri->deformIndexCache );
+
+	// the cpu side vertexes are not kept, only the counts and caches are used from here on
+	srfTriangles_t *newTri = (srfTriangles_t *)R_ClearedFrameAlloc( sizeof( *newTri ) );
+	newTri->numVerts = tri->numVerts;
+	newTri->numIndexes = tri->numIndexes;
+	newTri->indexes = tri->indexes;
+	newTri->ambientCache = tri->deformCache;
+	newTri->indexCache = tri->deformIndexCache;
+
+	R_SetDeformedDrawSurf( drawSurf, newTri );
+
+	tr.pc.c_materialDeformsCached++;
+
+	return true;
+}
+
 /*
 =================
 R_FinishDeform
 
-The ambientCache is on the stack, so we don't want to leave a reference
+The ambientCache is in scratch memory, so we don't want to leave a reference
 to it that would try to be freed later.  Create the ambientCache immediately.
+If cacheTri is set, the result is kept in static vertex memory for R_DeformFromCache.
 =================
 */
-static void R_FinishDeform( drawSurf_t *drawSurf, srfTriangles_t *newTri, idDrawVert *ac ) {
+static void R_FinishDeform( drawSurf_t *drawSurf, srfTriangles_t *newTri, idDrawVert *ac, srfTriangles_t *cacheTri = NULL ) {
 	if ( !newTri ) {
 		return;
 	}
@@ -58,16 +161,22 @@ static void R_FinishDeform( drawSurf_t *drawSurf, srfTriangles_t *newTri, idDraw
 		newTri->verts = NULL;
 	}
 
-	newTri->ambientCache = vertexCache.AllocFrameTemp( ac, newTri->numVerts * sizeof( idDrawVert ), false );
-	newTri->indexCache = vertexCache.AllocFrameTemp( newTri->indexes, newTri->numIndexes * sizeof( glIndex_t ), true );
+	if ( cacheTri ) {
+		vertexCache.AllocVerts( ac, newTri->numVerts, &cacheTri->deformCache );
+		vertexCache.Alloc( newTri->indexes, newTri->numIndexes * sizeof( glIndex_t ), &cacheTri->deformIndexCache, true );
+	}
 
-	drawSurf->geoFrontEnd = newTri;
-	drawSurf->ambientCache = newTri->ambientCache;
-	drawSurf->indexCache = newTri->indexCache;
-	drawSurf->numIndexes = newTri->numIndexes;
-	drawSurf->numShadowIndexesNoFrontCaps = newTri->numShadowIndexesNoFrontCaps;
-	drawSurf->numShadowIndexesNoCaps = newTri->numShadowIndexesNoCaps;
-	drawSurf->shadowCapPlaneBits = newTri->shadowCapPlaneBits;
+	if ( cacheTri && cacheTri->deformCache && cacheTri->deformIndexCache ) {
+		vertexCache.Touch( cacheTri->deformCache );
+		vertexCache.Touch( cacheTri->deformIndexCache );
+		newTri->ambientCache = cacheTri->deformCache;
+		newTri->indexCache = cacheTri->deformIndexCache;
+	} else {
+		newTri->ambientCache = vertexCache.AllocFrameTempVerts( ac, newTri->numVerts );
+		newTri->indexCache = vertexCache.AllocFrameTemp( newTri->indexes, newTri->numIndexes * sizeof( glIndex_t ), true );
+	}
+
+	R_SetDeformedDrawSurf( drawSurf, newTri );
 }
 
 /*
@@ -78,15 +187,12 @@ Assuming all the triangles for this shader are independant
 quads, rebuild them as forward facing sprites
 =====================
 */
-static void R_AutospriteDeform( drawSurf_t *surf ) {
+static void R_AutospriteDeform( drawSurf_t *surf, idDrawVert *ac ) {
 	int		i;
-	const idDrawVert	*v;
-	idVec3	mid, delta;
-	float	radius;
-	idVec3	left, up;
 	idVec3	leftDir, upDir;
 	const srfTriangles_t	*tri;
 	srfTriangles_t	*newTri;
+	srfTriangles_t	*cacheTri;
 
 	tri = surf->geoFrontEnd;
 
@@ -106,6 +212,12 @@ static void R_AutospriteDeform( drawSurf_t *surf ) {
 		leftDir = vec3_origin - leftDir;
 	}
 
+	// the local view directions are all the result depends on
+	const float parms[6] = { leftDir.x, leftDir.y, leftDir.z, upDir.x, upDir.y, upDir.z };
+	if ( R_DeformFromCache( surf, parms, &cacheTri ) ) {
+		return;
+	}
+
 	// this srfTriangles_t and all its indexes and caches are in frame
 	// memory, and will be automatically disposed of
 	newTri = (srfTriangles_t *)R_ClearedFrameAlloc( sizeof( *newTri ) );
@@ -113,35 +225,9 @@ static void R_AutospriteDeform( drawSurf_t *surf ) {
 	newTri->numIndexes = tri->numIndexes;
 	newTri->indexes = (glIndex_t *)R_FrameAlloc( newTri->numIndexes * sizeof( newTri->indexes[0] ) );
 
-	idDrawVert	*ac = (idDrawVert *)_alloca16( newTri->numVerts * sizeof( idDrawVert ) );
+	SIMDProcessor->DeformAutosprite( ac, tri->verts, leftDir, upDir, tri->numVerts );
 
 	for ( i = 0 ; i < tri->numVerts ; i+=4 ) {
-		// find the midpoint
-		v = &tri->verts[i];
-
-		mid[0] = 0.25 * (v->xyz[0] + (v+1)->xyz[0] + (v+2)->xyz[0] + (v+3)->xyz[0]);
-		mid[1] = 0.25 * (v->xyz[1] + (v+1)->xyz[1] + (v+2)->xyz[1] + (v+3)->xyz[1]);
-		mid[2] = 0.25 * (v->xyz[2] + (v+1)->xyz[2] + (v+2)->xyz[2] + (v+3)->xyz[2]);
-
-		delta = v->xyz - mid;
-		radius = delta.Length() * 0.707;		// / sqrt(2)
-
-		left = leftDir * radius;
-		up = upDir * radius;
-
-		ac[i+0].xyz = mid + left + up;
-		ac[i+0].st[0] = 0;
-		ac[i+0].st[1] = 0;
-		ac[i+1].xyz = mid - left + up;
-		ac[i+1].st[0] = 1;
-		ac[i+1].st[1] = 0;
-		ac[i+2].xyz = mid - left - up;
-		ac[i+2].st[0] = 1;
-		ac[i+2].st[1] = 1;
-		ac[i+3].xyz = mid + left - up;
-		ac[i+3].st[0] = 0;
-		ac[i+3].st[1] = 1;
-
 		newTri->indexes[6*(i>>2)+0] = i;
 		newTri->indexes[6*(i>>2)+1] = i+1;
 		newTri->indexes[6*(i>>2)+2] = i+2;
@@ -151,7 +237,7 @@ static void R_AutospriteDeform( drawSurf_t *surf ) {
 		newTri->indexes[6*(i>>2)+5] = i+3;
 	}
 
-	R_FinishDeform( surf, newTri, ac );
+	R_FinishDeform( surf, newTri, ac, cacheTri );
 }
 
 /*
@@ -166,7 +252,7 @@ Make sure this is used with twosided translucent shaders, because the exact side
 order may not be correct.
 =====================
 */
-static void R_TubeDeform( drawSurf_t *surf ) {
+static void R_TubeDeform( drawSurf_t *surf, idDrawVert *ac ) {
 	int		i, j;
 	int		indexes;
 	const srfTriangles_t *tri;
@@ -201,7 +287,6 @@ static int edgeVerts[6][2] = {
 	newTri->indexes = (glIndex_t *)R_FrameAlloc( newTri->numIndexes * sizeof( newTri->indexes[0] ) );
 	memcpy( newTri->indexes, tri->indexes, newTri->numIndexes * sizeof( newTri->indexes[0] ) );
 
-	idDrawVert	*ac = (idDrawVert *)_alloca16( newTri->numVerts * sizeof( idDrawVert ) );
 	memset( ac, 0, sizeof( idDrawVert ) * newTri->numVerts );
 
 	// this is a lot of work for two triangles...
@@ -512,7 +597,7 @@ static void R_FlareDeform( drawSurf_t *surf ) {
 }
 */
 
-static void R_FlareDeform( drawSurf_t *surf ) {
+static void R_FlareDeform( drawSurf_t *surf, idDrawVert *ac ) {
 	const srfTriangles_t *tri;
 	srfTriangles_t		*newTri;
 	idPlane	plane;
@@ -535,8 +620,6 @@ static void R_FlareDeform( drawSurf_t *surf ) {
 	newTri->numIndexes = 18*3;
 	newTri->indexes = (glIndex_t *)R_FrameAlloc( newTri->numIndexes * sizeof( newTri->indexes[0] ) );
 
-	idDrawVert *ac = (idDrawVert *)_alloca16( newTri->numVerts * sizeof( idDrawVert ) );
-
 	// find the plane
 	if (!plane.FromPoints( tri->verts[tri->indexes[0]].xyz, tri->verts[tri->indexes[1]].xyz, tri->verts[tri->indexes[2]].xyz )) {
 		common->Warning( "R_FlareDeform: plane.FromPoints failed" );
@@ -707,8 +790,7 @@ R_ExpandDeform
 Expands the surface along it's normals by a shader amount
 =====================
 */
-static void R_ExpandDeform( drawSurf_t *surf ) {
-	int		i;
+static void R_ExpandDeform( drawSurf_t *surf, idDrawVert *ac ) {
 	const srfTriangles_t	*tri;
 	srfTriangles_t	*newTri;
 
@@ -721,13 +803,8 @@ static void R_ExpandDeform( drawSurf_t *surf ) {
 	newTri->numIndexes = tri->numIndexes;
 	newTri->indexes = tri->indexes;
 
-	idDrawVert *ac = (idDrawVert *)_alloca16( newTri->numVerts * sizeof( idDrawVert ) );
-
 	float dist = surf->shaderRegisters[ surf->material->GetDeformRegister(0) ];
-	for ( i = 0 ; i < tri->numVerts ; i++ ) {
-		ac[i] = *(idDrawVert *)&tri->verts[i];
-		ac[i].xyz = tri->verts[i].xyz + tri->verts[i].normal * dist;
-	}
+	SIMDProcessor->DeformExpand( ac, tri->verts, dist, tri->numVerts );
 
 	R_FinishDeform( surf, newTri, ac );
 }
@@ -739,7 +816,7 @@ R_MoveDeform
 Moves the surface along the X axis, mostly just for demoing the deforms
 =====================
 */
-static void  R_MoveDeform( drawSurf_t *surf ) {
+static void  R_MoveDeform( drawSurf_t *surf, idDrawVert *ac ) {
 	int		i;
 	const srfTriangles_t	*tri;
 	srfTriangles_t	*newTri;
@@ -753,11 +830,9 @@ static void  R_MoveDeform( drawSurf_t *surf ) {
 	newTri->numIndexes = tri->numIndexes;
 	newTri->indexes = tri->indexes;
 
-	idDrawVert *ac = (idDrawVert *)_alloca16( newTri->numVerts * sizeof( idDrawVert ) );
-
 	float dist = surf->shaderRegisters[ surf->material->GetDeformRegister(0) ];
+	SIMDProcessor->Memcpy( ac, tri->verts, tri->numVerts * sizeof( idDrawVert ) );
 	for ( i = 0 ; i < tri->numVerts ; i++ ) {
-		ac[i] = *(idDrawVert *)&tri->verts[i];
 		ac[i].xyz[0] += dist;
 	}
 
@@ -773,13 +848,26 @@ R_TurbulentDeform
 Turbulently deforms the XYZ, S, and T values
 =====================
 */
-static void  R_TurbulentDeform( drawSurf_t *surf ) {
+static void  R_TurbulentDeform( drawSurf_t *surf, idDrawVert *ac ) {
 	int		i;
 	const srfTriangles_t	*tri;
 	srfTriangles_t	*newTri;
+	srfTriangles_t	*cacheTri;
 
 	tri = surf->geoFrontEnd;
 
+	idDeclTable	*table = (idDeclTable *)surf->material->GetDeformDecl();
+	float range = surf->shaderRegisters[ surf->material->GetDeformRegister(0) ];
+	float timeOfs = surf->shaderRegisters[ surf->material->GetDeformRegister(1) ];
+	float domain = surf->shaderRegisters[ surf->material->GetDeformRegister(2) ];
+	float tOfs = 0.5;
+
+	// usually time based, but a paused or stopped clock leaves them unchanged
+	const float parms[6] = { range, timeOfs, domain, 0.0f, 0.0f, 0.0f };
+	if ( R_DeformFromCache( surf, parms, &cacheTri ) ) {
+		return;
+	}
+
 	// this srfTriangles_t and all its indexes and caches are in frame
 	// memory, and will be automatically disposed of
 	newTri = (srfTriangles_t *)R_ClearedFrameAlloc( sizeof( *newTri ) );
@@ -787,27 +875,19 @@ static void  R_TurbulentDeform( drawSurf_t *surf ) {
 	newTri->numIndexes = tri->numIndexes;
 	newTri->indexes = tri->indexes;
 
-	idDrawVert *ac = (idDrawVert *)_alloca16( newTri->numVerts * sizeof( idDrawVert ) );
+	// f = timeOfs + domain * ( xyz * ( 0.003, 0.007, 0.011 ) ) + timeOfs
+	float *f = (float *)_alloca16( tri->numVerts * sizeof( float ) );
+	idPlane turbPlane( domain * 0.003f, domain * 0.007f, domain * 0.011f, timeOfs + timeOfs );
+	SIMDProcessor->Dot( f, turbPlane, tri->verts, tri->numVerts );
 
-	idDeclTable	*table = (idDeclTable *)surf->material->GetDeformDecl();
-	float range = surf->shaderRegisters[ surf->material->GetDeformRegister(0) ];
-	float timeOfs = surf->shaderRegisters[ surf->material->GetDeformRegister(1) ];
-	float domain = surf->shaderRegisters[ surf->material->GetDeformRegister(2) ];
-	float tOfs = 0.5;
+	SIMDProcessor->Memcpy( ac, tri->verts, tri->numVerts * sizeof( idDrawVert ) );
 
 	for ( i = 0 ; i < tri->numVerts ; i++ ) {
-		float	f = tri->verts[i].xyz[0] * 0.003 + tri->verts[i].xyz[1] * 0.007 + tri->verts[i].xyz[2] * 0.011;
-
-		f = timeOfs + domain * f;
-		f += timeOfs;
-
-		ac[i] = *(idDrawVert *)&tri->verts[i];
-
-		ac[i].st[0] += range * table->TableLookup( f );
-		ac[i].st[1] += range * table->TableLookup( f + tOfs );
+		ac[i].st[0] += range * table->TableLookup( f[i] );
+		ac[i].st[1] += range * table->TableLookup( f[i] + tOfs );
 	}
 
-	R_FinishDeform( surf, newTri, ac );
+	R_FinishDeform( surf, newTri, ac, cacheTri );
 }
 
 //=====================================================================================
@@ -876,7 +956,7 @@ Each eyeball surface should have an separate upright triangle behind it, long en
 pointing out the eye, and another single triangle in front of the eye for the focus point.
 =====================
 */
-static void R_EyeballDeform( drawSurf_t *surf ) {
+static void R_EyeballDeform( drawSurf_t *surf, idDrawVert *ac ) {
 	int		i, j, k;
 	const srfTriangles_t	*tri;
 	srfTriangles_t	*newTri;
@@ -923,7 +1003,6 @@ static void R_EyeballDeform( drawSurf_t *surf ) {
 	newTri->numVerts = tri->numVerts;
 	newTri->numIndexes = tri->numIndexes;
 	newTri->indexes = (glIndex_t *)R_FrameAlloc( tri->numIndexes * sizeof( newTri->indexes[0] ) );
-	idDrawVert *ac = (idDrawVert *)_alloca16( tri->numVerts * sizeof( idDrawVert ) );
 
 	newTri->numIndexes = 0;
 
@@ -1216,7 +1295,7 @@ static void R_ParticleDeform( drawSurf_t *surf, bool useArea ) {
 					indexes += 6;
 				}
 				tri->numIndexes = indexes;
-				tri->ambientCache = vertexCache.AllocFrameTemp( tri->verts, tri->numVerts * sizeof( idDrawVert ), false );
+				tri->ambientCache = vertexCache.AllocFrameTempVerts( tri->verts, tri->numVerts );
 				tri->indexCache = vertexCache.AllocFrameTemp( tri->indexes, tri->numIndexes * sizeof( glIndex_t ), true );
 
 				// add the drawsurf
@@ -1230,40 +1309,55 @@ static void R_ParticleDeform( drawSurf_t *surf, bool useArea ) {
 
 /*
 =================
-R_DeformDrawSurf
+R_DeformScratchVerts
+
+Number of vertexes the deform builds its result in
 =================
 */
-void R_DeformDrawSurf( drawSurf_t *drawSurf ) {
-	if ( !drawSurf->material ) {
-		return;
+static int R_DeformScratchVerts( const drawSurf_t *drawSurf ) {
+	switch ( drawSurf->material->Deform() ) {
+	case DFRM_FLARE:
+		return 16;
+	case DFRM_PARTICLE:
+	case DFRM_PARTICLE2:
+		// the particles are written straight into their own surfaces
+		return 0;
+	default:
+		return drawSurf->geoFrontEnd->numVerts;
 	}
+}
 
-	if ( r_skipDeforms.GetBool() ) {
-		return;
-	}
+/*
+=================
+R_RunDeform
+
+ac must have room for R_DeformScratchVerts() vertexes
+=================
+*/
+static void R_RunDeform( drawSurf_t *drawSurf, idDrawVert *ac ) {
 	switch ( drawSurf->material->Deform() ) {
 	case DFRM_NONE:
 		return;
 	case DFRM_SPRITE:
-		R_AutospriteDeform( drawSurf );
+		R_AutospriteDeform( drawSurf, ac );
 		break;
 	case DFRM_TUBE:
-		R_TubeDeform( drawSurf );
+		R_TubeDeform( drawSurf, ac );
 		break;
 	case DFRM_FLARE:
-		R_FlareDeform( drawSurf );
+		R_FlareDeform( drawSurf, ac );
 		break;
 	case DFRM_EXPAND:
-		R_ExpandDeform( drawSurf );
+		R_ExpandDeform( drawSurf, ac );
 		break;
 	case DFRM_MOVE:
-		R_MoveDeform( drawSurf );
+		R_MoveDeform( drawSurf, ac );
 		break;
 	case DFRM_TURB:
-		R_TurbulentDeform( drawSurf );
+		R_TurbulentDeform( drawSurf, ac );
 		break;
 	case DFRM_EYEBALL:
-		R_EyeballDeform( drawSurf );
+		R_EyeballDeform( drawSurf, ac );
 		break;
 	case DFRM_PARTICLE:
 		R_ParticleDeform( drawSurf, true );
@@ -1273,3 +1367,108 @@ void R_DeformDrawSurf( drawSurf_t *drawSurf ) {
 		break;
 	}
 }
+
+static const int INITIAL_DEFORM_DRAWSURFS = 0x100;
+
+/*
+=================
+R_DeformDrawSurf
+
+While the surfaces of a view are being added, deforms are only queued
+and R_DeformDrawSurfs runs them grouped by type afterwards.
+=================
+*/
+void R_DeformDrawSurf( drawSurf_t *drawSurf ) {
+	if ( !drawSurf->material ) {
+		return;
+	}
+
+	if ( r_skipDeforms.GetBool() ) {
+		return;
+	}
+
+	deform_t deform = drawSurf->material->Deform();
+	if ( deform == DFRM_NONE ) {
+		return;
+	}
+
+	tr.pc.c_materialDeforms++;
+
+	// particles use the time group time that is only set while the surface is being added,
+	// and gui surfaces are culled against the deformed geometry right after this
+	if ( tr.viewDef->deferDeforms && deform != DFRM_PARTICLE && deform != DFRM_PARTICLE2
+			&& !drawSurf->material->HasGui() ) {
+		viewDef_t *viewDef = tr.viewDef;
+
+		// if it doesn't fit, resize the list
+		if ( viewDef->numDeformDrawSurfs == viewDef->maxDeformDrawSurfs ) {
+			drawSurf_t	**old = viewDef->deformDrawSurfs;
+			int			count;
+
+			if ( viewDef->maxDeformDrawSurfs == 0 ) {
+				viewDef->maxDeformDrawSurfs = INITIAL_DEFORM_DRAWSURFS;
+				count = 0;
+			} else {
+				count = viewDef->maxDeformDrawSurfs * sizeof( viewDef->deformDrawSurfs[0] );
+				viewDef->maxDeformDrawSurfs *= 2;
+			}
+			viewDef->deformDrawSurfs = (drawSurf_t **)R_FrameAlloc( viewDef->maxDeformDrawSurfs * sizeof( viewDef->deformDrawSurfs[0] ) );
+			memcpy( viewDef->deformDrawSurfs, old, count );
+		}
+		viewDef->deformDrawSurfs[viewDef->numDeformDrawSurfs] = drawSurf;
+		viewDef->numDeformDrawSurfs++;
+		return;
+	}
+
+	idDrawVert *ac = (idDrawVert *)_alloca16( R_DeformScratchVerts( drawSurf ) * sizeof( idDrawVert ) );
+	R_RunDeform( drawSurf, ac );
+}
+
+/*
+=================
+R_DeformDrawSurfs
+
+Runs the deforms queued by R_DeformDrawSurf for the current view.
+All the surfaces of one deform type are done back to back, sharing a
+single scratch buffer sized for the largest of them.
+=================
+*/
+void R_DeformDrawSurfs( void ) {
+	viewDef_t *viewDef = tr.viewDef;
+
+	viewDef->deferDeforms = false;
+
+	if ( viewDef->numDeformDrawSurfs == 0 ) {
+		return;
+	}
+
+	for ( int deform = DFRM_SPRITE; deform <= DFRM_TURB; deform++ ) {
+		int i, count, maxVerts;
+
+		count = 0;
+		maxVerts = 0;
+		for ( i = 0; i < viewDef->numDeformDrawSurfs; i++ ) {
+			const drawSurf_t *drawSurf = viewDef->deformDrawSurfs[i];
+			if ( drawSurf->material->Deform() != deform ) {
+				continue;
+			}
+			maxVerts = Max( maxVerts, R_DeformScratchVerts( drawSurf ) );
+			count++;
+		}
+		if ( count == 0 ) {
+			continue;
+		}
+
+		idDrawVert *ac = (idDrawVert *)R_FrameAlloc( maxVerts * sizeof( idDrawVert ) );
+
+		for ( i = 0; i < viewDef->numDeformDrawSurfs; i++ ) {
+			drawSurf_t *drawSurf = viewDef->deformDrawSurfs[i];
+			if ( drawSurf->material->Deform() != deform ) {
+				continue;
+			}
+			R_RunDeform( drawSurf, ac );
+		}
+	}
+
+	viewDef->numDeformDrawSurfs = 0;
+}
@@ -66,7 +66,7 @@ bool R_CreateAmbientCache(srfTriangles_t* tri, bool needsLighting) {
 		}
 
 		// Build the ambient cache
-		vertexCache.Alloc(tri->verts, tri->numVerts * sizeof(tri->verts[0]), &tri->ambientCache, false);
+		vertexCache.AllocVerts(tri->verts, tri->numVerts, &tri->ambientCache);
 
 		// Check for errors
 		if ( !tri->ambientCache ) {
@@ -993,6 +993,8 @@ idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def ) {
 		common->Error( "R_EntityDefDynamicModel: NULL model" );
 	}
 
+	model = model->LOD( def->lodLevel );
+
 	if ( model->IsDynamicModel() == DM_STATIC ) {
 		def->dynamicModel = NULL;
 		def->dynamicModelFrameCount = 0;
@@ -1237,7 +1239,7 @@ static void R_AddAmbientDrawsurfs( viewEntity_t *vEntity ) {
 	if ( def->dynamicModel ) {
 		model = def->dynamicModel;
 	} else {
-		model = def->parms.hModel;
+		model = def->parms.hModel->LOD( def->lodLevel );
 	}
 
 	// add all the surfaces
@@ -1338,6 +1340,81 @@ idScreenRect R_CalcEntityScissorRectangle( viewEntity_t *vEntity ) {
 	return R_ScreenRectFromViewFrustumBounds( bounds );
 }
 
+/*
+===================
+R_LODForSize
+
+Each level is used below half the size of the previous one
+===================
+*/
+static const float	LOD_FULL_DETAIL_SIZE = 0.1f;	// fraction of the view width
+static const float	LOD_HYSTERESIS = 1.15f;
+
+static int R_LODForSize( float size, int numLODs ) {
+	int		level;
+	float	threshold;
+
+	threshold = LOD_FULL_DETAIL_SIZE;
+	for ( level = 0; level < numLODs && size < threshold; level++ ) {
+		threshold *= 0.5f;
+	}
+	return level;
+}
+
+/*
+===================
+R_SelectEntityLOD
+
+Picks the model LOD from the projected size of the entity.  When the level
+changes the dynamic model and the interaction surfaces are regenerated,
+so shadows are always cast by the level that is drawn.
+===================
+*/
+static void R_SelectEntityLOD( idRenderEntityLocal *def ) {
+	int				level;
+	idRenderModel	*model = def->parms.hModel;
+
+	// subviews keep whatever the main view selected
+	if ( !model || model->NumLODs() == 0 || tr.viewDef->isSubview ) {
+		return;
+	}
+
+	if ( r_forceLOD.GetInteger() >= 0 ) {
+		level = Min( r_forceLOD.GetInteger(), model->NumLODs() );
+	} else if ( r_lodScale.GetFloat() <= 0.0f || def->parms.weaponDepthHack ) {
+		level = 0;
+	} else {
+		idVec3 center = def->referenceBounds.GetCenter();
+		float radius = def->referenceBounds.GetRadius( center );
+		float dist = ( def->parms.origin + center * def->parms.axis - tr.viewDef->renderView.vieworg ).Length();
+
+		if ( dist <= radius ) {
+			level = 0;
+		} else {
+			float size = r_lodScale.GetFloat() * radius / ( dist * idMath::Tan( DEG2RAD( tr.viewDef->renderView.fov_x ) * 0.5f ) );
+
+			level = R_LODForSize( size, model->NumLODs() );
+			if ( level < def->lodLevel ) {
+				// don't go back to more detail until clearly past the threshold, so it doesn't flicker
+				level = Min( def->lodLevel, R_LODForSize( size / LOD_HYSTERESIS, model->NumLODs() ) );
+			}
+		}
+	}
+
+	if ( level == def->lodLevel ) {
+		return;
+	}
+	def->lodLevel = level;
+
+	R_ClearEntityDefDynamicModel( def );
+
+	// the cached snapshot has the surfaces of the old level
+	if ( def->cachedDynamicModel ) {
+		delete def->cachedDynamicModel;
+		def->cachedDynamicModel = NULL;
+	}
+}
+
 /*
 ===================
 R_AddModelSurfaces
@@ -1358,6 +1435,11 @@ void R_AddModelSurfaces( void ) {
 	tr.viewDef->numDrawSurfs = 0;
 	tr.viewDef->maxDrawSurfs = 0;	// will be set to INITIAL_DRAWSURFS on R_AddDrawSurf
 
+	// deforms are queued while the surfaces are added, and run at the end
+	tr.viewDef->numDeformDrawSurfs = 0;
+	tr.viewDef->maxDeformDrawSurfs = 0;
+	tr.viewDef->deferDeforms = r_batchDeforms.GetBool();
+
 	// go through each entity that is either visible to the view, or to
 	// any light that intersects the view (for shadows)
 	for ( vEntity = tr.viewDef->viewEntitys; vEntity; vEntity = vEntity->next ) {
@@ -1386,6 +1468,8 @@ void R_AddModelSurfaces( void ) {
 			tr.viewDef->renderView.time = game->GetTimeGroupTime( vEntity->entityDef->parms.timeGroup );
 		}
 
+		R_SelectEntityLOD( vEntity->entityDef );
+
 		if ( tr.viewDef->isXraySubview && vEntity->entityDef->parms.xrayIndex == 1 ) {
 			if ( vEntity->entityDef->parms.timeGroup ) {
 				tr.viewDef->floatTime = oldFloatTime;
@@ -1452,6 +1536,8 @@ void R_AddModelSurfaces( void ) {
 		}
 
 	}
+
+	R_DeformDrawSurfs();
 }
 
 /*
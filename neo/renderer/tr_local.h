@@ -275,6 +275,7 @@ public:
 	int						dynamicModelFrameCount;	// continuously animating dynamic models will recreate
 													// dynamicModel if this doesn't == tr.viewCount
 	idRenderModel *			cachedDynamicModel;
+	int						lodLevel;				// parms.hModel->LOD( lodLevel ) is used for rendering and interactions
 
 	idBounds				referenceBounds;		// the local bounds used to place entityRefs, either from parms or a model
 
@@ -439,6 +440,10 @@ typedef struct viewDef_s {
 	// crossing a closed door.  This is used to avoid drawing interactions
 	// when the light is behind a closed door.
 
+	bool				deferDeforms;			// set while R_AddModelSurfaces runs, deforms are queued
+	drawSurf_t **		deformDrawSurfs;		// surfaces waiting for R_DeformDrawSurfs, which runs all
+	int					numDeformDrawSurfs;		// the surfaces of a deform type back to back
+	int					maxDeformDrawSurfs;		// in frame temporary memory like drawSurfs
 } viewDef_t;
 
 
@@ -595,8 +600,18 @@ typedef struct {
 	int		c_deformedVerts;	// idMD5Mesh::GenerateSurface
 	int		c_deformedIndexes;	// idMD5Mesh::GenerateSurface
 	int		c_tangentIndexes;	// R_DeriveTangents()
+	int		c_materialDeforms;	// R_DeformDrawSurf
+	int		c_materialDeformsCached;	// material deforms reused from a previous frame
+	int		c_particleSystems;	// idRenderModelPrt::InstantiateDynamicModel
+	int		c_particles;		// particles of all the instantiated stages
+	int		c_particlesEvaluated;	// particles inside their life time
+	int		c_particlesCulled;	// evaluated particles that were completely faded out
 	int		c_entityUpdates, c_lightUpdates, c_entityReferences, c_lightReferences;
 	int		c_guiSurfs;
+	int		c_subviewsRendered;	// R_GenerateSurfaceSubview
+	int		c_subviewsSkipped;	// texture subviews that kept their last capture
+	int		c_guiModelSurfs;	// idGuiModel::EmitSurface
+	int		c_guiModelSurfsUnbatched;	// surfaces the gui model would have emitted without the gui atlas
 	int		frontEndMsec;		// sum of time in all RE_RenderScene's in a frame
 } performanceCounters_t;
 
@@ -883,6 +898,8 @@ extern idCVar r_useOptimizedShadows;	// 1 = use the dmap generated static shadow
 extern idCVar r_useShadowProjectedCull;	// 1 = discard triangles outside light volume before shadowing
 extern idCVar r_useDeferredTangents;	// 1 = don't always calc tangents after deform
 extern idCVar r_useCachedDynamicModels;	// 1 = cache snapshots of dynamic models
+extern idCVar r_lodScale;				// scale for the projected size used to select model LODs, 0 = never use LODs
+extern idCVar r_forceLOD;				// use this LOD for all models if >= 0
 extern idCVar r_useInfiniteFarZ;		// 1 = use the no-far-clip-plane trick
 extern idCVar r_useScissor;				// 1 = scissor clip as portals and lights are processed
 extern idCVar r_usePortals;				// 1 = use portals to perform area culling, otherwise draw everything
@@ -905,10 +922,19 @@ extern idCVar r_skipNewAmbient;			// bypasses all vertex/fragment program ambien
 extern idCVar r_skipBlendLights;		// skip all blend lights
 extern idCVar r_skipFogLights;			// skip all fog lights
 extern idCVar r_skipSubviews;			// 1 = don't render any mirrors / cameras / etc
+extern idCVar r_subviewMaxHz;			// refresh rate of texture subviews, 0 = every frame
+extern idCVar r_subviewMinHz;			// lowest refresh rate for distant or small texture subviews
+extern idCVar r_subviewFullRateDistance;	// texture subviews further away refresh slower
+extern idCVar r_subviewFullRateSize;	// texture subviews covering less of the view refresh slower
+extern idCVar r_subviewBudget;			// msec of subview rendering per frame before refreshes are deferred
 extern idCVar r_skipGuiShaders;			// 1 = don't render any gui elements on surfaces
 extern idCVar r_skipParticles;			// 1 = don't render any particles
+extern idCVar r_batchParticles;			// evaluate particles in batches with the SIMD processor
+extern idCVar r_guiAtlas;				// pack small gui images and font pages into shared textures
 extern idCVar r_skipUpdates;			// 1 = don't accept any entity or light updates, making everything static
 extern idCVar r_skipDeforms;			// leave all deform materials in their original state
+extern idCVar r_useDeformCache;			// reuse deformed vertexes of static surfaces while the deform inputs are unchanged
+extern idCVar r_batchDeforms;			// queue material deforms and process them grouped by type after all surfaces are added
 extern idCVar r_skipDynamicTextures;	// don't dynamically create textures
 extern idCVar r_skipBump;				// uses a flat surface instead of the bump map
 extern idCVar r_skipSpecular;			// use black for specular
@@ -928,6 +954,9 @@ extern idCVar r_showVertexColor;		// draws all triangles with the solid vertex c
 extern idCVar r_showUpdates;			// report entity and light updates and ref counts
 extern idCVar r_showDemo;				// report reads and writes to the demo file
 extern idCVar r_showDynamic;			// report stats on dynamic surface generation
+extern idCVar r_showParticleStats;		// report stats on particle evaluation
+extern idCVar r_showGuiAtlas;			// report gui model surfaces with and without the gui atlas
+extern idCVar r_showSubviews;			// report rendered and skipped subviews
 extern idCVar r_showIntensity;			// draw the screen colors based on intensity, red = 0, green = 128, blue = 255
 extern idCVar r_showDefs;				// report the number of modeDefs and lightDefs in view
 extern idCVar r_showDepth;				// display the contents of the depth buffer and the depth range
@@ -973,6 +1002,7 @@ extern idCVar r_jitter;					// randomly subpixel jitter the projection matrix
 extern idCVar r_lightSourceRadius;		// for soft-shadow sampling
 extern idCVar r_lockSurfaces;
 extern idCVar r_orderIndexes;			// perform index reorganization to optimize vertex use
+extern idCVar r_binaryProc;			// load the world from a .bproc written after the first .proc parse
 
 extern idCVar r_debugLineDepthTest;		// perform depth test on debug lines
 extern idCVar r_debugLineWidth;			// width of debug lines
@@ -1449,6 +1479,13 @@ deformInfo_t *		R_BuildDeformInfo( int numVerts, const idDrawVert *verts, int nu
 void				R_FreeDeformInfo( deformInfo_t *deformInfo );
 int					R_DeformInfoMemoryUsed( deformInfo_t *deformInfo );
 
+// the binary model cache stores fully processed surfaces
+void				R_WriteStaticTriSurf( idFile *f, const srfTriangles_t *tri );
+srfTriangles_t *	R_ReadStaticTriSurf( idFile *f );
+void				R_WriteDeformInfo( idFile *f, const deformInfo_t *deform );
+deformInfo_t *		R_ReadDeformInfo( idFile *f );
+int					R_BinaryModelMaterialFlags( const idMaterial *shader );
+
 /*
 ============================================================
 
@@ -1512,6 +1549,21 @@ TR_ORDERINDEXES
 */
 
 void R_OrderIndexes( int numIndexes, glIndex_t *indexes );
+bool R_OptimizeIndexOrder( int numVerts, int numIndexes, int *indexes );
+void R_OptimizeVertexOrder( int numVerts, int numIndexes, int *indexes, int *remap );
+void R_OrderTriSurf( srfTriangles_t *tri );
+int R_MeshCost( int numIndexes, const glIndex_t *indexes, int cacheSize );
+
+/*
+=============================================================
+
+TR_SIMPLIFY
+
+=============================================================
+*/
+
+int R_SimplifyTriangles( const idDrawVert *verts, int numVerts, const int *indexes, int numIndexes, int targetIndexes, int *outIndexes );
+srfTriangles_t *R_SimplifyStaticTriSurf( const srfTriangles_t *tri, int targetIndexes, bool useUnsmoothedTangents );
 
 /*
 =============================================================
@@ -1522,6 +1574,8 @@ TR_DEFORM
 */
 
 void R_DeformDrawSurf( drawSurf_t *drawSurf );
+void R_DeformDrawSurfs( void );
+void R_FreeDeformCache( srfTriangles_t *tri );
 
 /*
 =============================================================
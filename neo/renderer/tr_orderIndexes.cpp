@@ -30,54 +30,236 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "renderer/tr_local.h"
 
+/*
+===============================================================================
+
+	Vertex cache optimization
+
+	The triangle order is chosen with the linear-speed vertex cache
+	optimization described by Tom Forsyth: each vertex is scored by its
+	position in a simulated LRU cache and by the number of triangles that
+	still use it, and the highest scoring triangle is emitted next.
+	Afterwards the vertexes are renumbered in the order the triangles first
+	use them, so vertex fetches walk through memory front to back.
+
+===============================================================================
+*/
+
+#define	VERTEX_CACHE_SIZE		32
+#define CACHE_DECAY_POWER		1.5f
+#define LAST_TRI_SCORE			0.75f
+#define VALENCE_BOOST_SCALE		2.0f
+#define VALENCE_BOOST_POWER		0.5f
+
 /*
 ===============
-R_MeshCost
+R_VertexCacheScore
 ===============
 */
-#if 0
-#define	CACHE_SIZE	24
-#define	STALL_SIZE	8
-int	R_MeshCost( int numIndexes, glIndex_t *indexes ) {
-	int	inCache[CACHE_SIZE];
-	int	i, j, v;
-	int	c_stalls;
-	int	c_loads;
-	int	fifo;
+static float R_VertexCacheScore( int cachePosition, int numActiveTris ) {
+	float	score;
 
-	for ( i = 0 ; i < CACHE_SIZE ; i++ ) {
-		inCache[i] = -1;
+	if ( numActiveTris == 0 ) {
+		// no triangles left to use this vertex
+		return -1.0f;
 	}
 
-	c_loads = 0;
-	c_stalls = 0;
-	fifo = 0;
+	if ( cachePosition < 0 ) {
+		// not in the cache
+		score = 0.0f;
+	} else if ( cachePosition < 3 ) {
+		// used by the last triangle, which makes it a bad choice for the next one
+		score = LAST_TRI_SCORE;
+	} else {
+		const float scaler = 1.0f / ( VERTEX_CACHE_SIZE - 3 );
+		score = 1.0f - ( cachePosition - 3 ) * scaler;
+		score = idMath::Pow( score, CACHE_DECAY_POWER );
+	}
+
+	// bonus for vertexes with few remaining triangles, so lone triangles don't get left behind
+	score += VALENCE_BOOST_SCALE * idMath::Pow( (float)numActiveTris, -VALENCE_BOOST_POWER );
+
+	return score;
+}
+
+/*
+===============
+R_OptimizeIndexOrder
+
+Reorders the triangles for the post-transform vertex cache.
+Returns false and leaves the indexes alone if they reference vertexes outside numVerts.
+===============
+*/
+bool R_OptimizeIndexOrder( int numVerts, int numIndexes, int *indexes ) {
+	int		i, j, k;
+	int		numTris;
+
+	numTris = numIndexes / 3;
+	if ( numTris < 2 ) {
+		return true;
+	}
 
 	for ( i = 0 ; i < numIndexes ; i++ ) {
-		v = indexes[i];
-		for ( j = 0 ; j < CACHE_SIZE ; j++ ) {
-			if ( inCache[ ( fifo + j ) % CACHE_SIZE ] == v ) {
-				break;
+		if ( indexes[i] < 0 || indexes[i] >= numVerts ) {
+			return false;
+		}
+	}
+
+	int *	numActiveTris = (int *)Mem_ClearedAlloc( numVerts * sizeof( int ) );
+	int *	firstTri = (int *)Mem_Alloc( ( numVerts + 1 ) * sizeof( int ) );
+	int *	vertTris = (int *)Mem_Alloc( numIndexes * sizeof( int ) );
+	int *	cachePosition = (int *)Mem_Alloc( numVerts * sizeof( int ) );
+	float *	vertScore = (float *)Mem_Alloc( numVerts * sizeof( float ) );
+	float *	triScore = (float *)Mem_Alloc( numTris * sizeof( float ) );
+	bool *	triAdded = (bool *)Mem_ClearedAlloc( numTris * sizeof( bool ) );
+	int *	oldIndexes = (int *)Mem_Alloc( numIndexes * sizeof( int ) );
+
+	memcpy( oldIndexes, indexes, numIndexes * sizeof( int ) );
+
+	// build the list of triangles using each vertex
+	for ( i = 0 ; i < numIndexes ; i++ ) {
+		numActiveTris[oldIndexes[i]]++;
+	}
+	firstTri[0] = 0;
+	for ( i = 0 ; i < numVerts ; i++ ) {
+		firstTri[i+1] = firstTri[i] + numActiveTris[i];
+		numActiveTris[i] = 0;
+	}
+	for ( i = 0 ; i < numIndexes ; i++ ) {
+		int v = oldIndexes[i];
+		vertTris[firstTri[v] + numActiveTris[v]++] = i / 3;
+	}
+
+	for ( i = 0 ; i < numVerts ; i++ ) {
+		cachePosition[i] = -1;
+		vertScore[i] = R_VertexCacheScore( -1, numActiveTris[i] );
+	}
+	for ( i = 0 ; i < numTris ; i++ ) {
+		triScore[i] = vertScore[oldIndexes[i*3+0]] + vertScore[oldIndexes[i*3+1]] + vertScore[oldIndexes[i*3+2]];
+	}
+
+	int		cache[VERTEX_CACHE_SIZE + 3];
+	int		cacheSize = 0;
+	int		bestTri = -1;
+	int		nextUnusedTri = 0;
+
+	for ( int numEmitted = 0 ; numEmitted < numTris ; numEmitted++ ) {
+		if ( bestTri < 0 ) {
+			// nothing in the cache is usable, find the best remaining triangle
+			float bestScore = -1.0f;
+			while ( triAdded[nextUnusedTri] ) {
+				nextUnusedTri++;
+			}
+			for ( i = nextUnusedTri ; i < numTris ; i++ ) {
+				if ( !triAdded[i] && triScore[i] > bestScore ) {
+					bestScore = triScore[i];
+					bestTri = i;
+				}
 			}
 		}
-		if ( j == CACHE_SIZE ) {
-			c_loads++;
-			inCache[ fifo % CACHE_SIZE ] = v;
-			fifo++;
-		} else if ( j < STALL_SIZE ) {
-			c_stalls++;
+
+		// emit it
+		const int *tri = oldIndexes + bestTri * 3;
+		indexes[numEmitted*3+0] = tri[0];
+		indexes[numEmitted*3+1] = tri[1];
+		indexes[numEmitted*3+2] = tri[2];
+		triAdded[bestTri] = true;
+
+		// remove the triangle from the vertex lists and move its vertexes to the front of the cache
+		int newCache[VERTEX_CACHE_SIZE + 3];
+		int newCacheSize = 0;
+		for ( i = 0 ; i < 3 ; i++ ) {
+			int v = tri[i];
+			int *list = vertTris + firstTri[v];
+			for ( j = 0 ; j < numActiveTris[v] ; j++ ) {
+				if ( list[j] == bestTri ) {
+					list[j] = list[--numActiveTris[v]];
+					break;
+				}
+			}
+			newCache[newCacheSize++] = v;
+		}
+		for ( i = 0 ; i < cacheSize ; i++ ) {
+			int v = cache[i];
+			if ( v != tri[0] && v != tri[1] && v != tri[2] ) {
+				newCache[newCacheSize++] = v;
+			}
+		}
+
+		// rescore everything still in the cache, vertexes pushed out lose their cache bonus
+		cacheSize = Min( newCacheSize, VERTEX_CACHE_SIZE );
+		for ( i = 0 ; i < newCacheSize ; i++ ) {
+			int v = newCache[i];
+			cachePosition[v] = ( i < VERTEX_CACHE_SIZE ) ? i : -1;
+			vertScore[v] = R_VertexCacheScore( cachePosition[v], numActiveTris[v] );
+			if ( i < VERTEX_CACHE_SIZE ) {
+				cache[i] = v;
+			}
+		}
+
+		// update the triangles touching the cache and pick the best one for the next round
+		float bestScore = -1.0f;
+		bestTri = -1;
+		for ( i = 0 ; i < newCacheSize ; i++ ) {
+			int v = newCache[i];
+			const int *list = vertTris + firstTri[v];
+			for ( j = 0 ; j < numActiveTris[v] ; j++ ) {
+				int t = list[j];
+				float score = 0.0f;
+				for ( k = 0 ; k < 3 ; k++ ) {
+					score += vertScore[oldIndexes[t*3+k]];
+				}
+				triScore[t] = score;
+				if ( score > bestScore ) {
+					bestScore = score;
+					bestTri = t;
+				}
+			}
 		}
 	}
 
-	return c_loads;
+	Mem_Free( numActiveTris );
+	Mem_Free( firstTri );
+	Mem_Free( vertTris );
+	Mem_Free( cachePosition );
+	Mem_Free( vertScore );
+	Mem_Free( triScore );
+	Mem_Free( triAdded );
+	Mem_Free( oldIndexes );
+
+	return true;
 }
-#endif
 
+/*
+===============
+R_OptimizeVertexOrder
+
+Renumbers the vertexes in the order they are first referenced.  remap[oldVert]
+receives the new number, vertexes without triangles go to the end.
+===============
+*/
+void R_OptimizeVertexOrder( int numVerts, int numIndexes, int *indexes, int *remap ) {
+	int		i, next;
+
+	for ( i = 0 ; i < numVerts ; i++ ) {
+		remap[i] = -1;
+	}
+
+	next = 0;
+	for ( i = 0 ; i < numIndexes ; i++ ) {
+		int v = indexes[i];
+		if ( remap[v] == -1 ) {
+			remap[v] = next++;
+		}
+		indexes[i] = remap[v];
+	}
 
-typedef struct vertRef_s {
-	struct vertRef_s	*next;
-	int			tri;
-} vertRef_t;
+	for ( i = 0 ; i < numVerts ; i++ ) {
+		if ( remap[i] == -1 ) {
+			remap[i] = next++;
+		}
+	}
+}
 
 /*
 ====================
@@ -88,125 +270,107 @@ of the internal GPU vertex caches
 ====================
 */
 void R_OrderIndexes( int numIndexes, glIndex_t *indexes ) {
-	bool	*triangleUsed;
-	int			numTris;
-	glIndex_t	*oldIndexes;
-	glIndex_t	*base;
-	int			numOldIndexes;
-	int			tri;
-	int			i;
-	vertRef_t	*vref, **vrefs, *vrefTable;
-	int			numVerts;
-	int			v1, v2;
-	int			c_starts;
-	//int			c_cost;
+	int		i, numVerts;
+	int		*intIndexes;
 
 	if ( !r_orderIndexes.GetBool() ) {
 		return;
 	}
 
-	// save off the original indexes
-	oldIndexes = (glIndex_t *)_alloca( numIndexes * sizeof( *oldIndexes ) );
-	memcpy( oldIndexes, indexes, numIndexes * sizeof( *oldIndexes ) );
-	numOldIndexes = numIndexes;
-
-	// make a table to mark the triangles when they are emited
-	numTris = numIndexes / 3;
-	triangleUsed = (bool *)_alloca( numTris * sizeof( *triangleUsed ) );
-	memset( triangleUsed, 0, numTris * sizeof( *triangleUsed ) );
+	intIndexes = (int *)Mem_Alloc( numIndexes * sizeof( intIndexes[0] ) );
 
-	// find the highest vertex number
 	numVerts = 0;
 	for ( i = 0 ; i < numIndexes ; i++ ) {
-		if ( indexes[i] > numVerts ) {
-			numVerts = indexes[i];
+		intIndexes[i] = indexes[i];
+		numVerts = Max( numVerts, intIndexes[i] + 1 );
+	}
+
+	if ( R_OptimizeIndexOrder( numVerts, numIndexes, intIndexes ) ) {
+		for ( i = 0 ; i < numIndexes ; i++ ) {
+			indexes[i] = intIndexes[i];
 		}
 	}
-	numVerts++;
 
-	// create a table of triangles used by each vertex
-	vrefs = (vertRef_t **)_alloca( numVerts * sizeof( *vrefs ) );
-	memset( vrefs, 0, numVerts * sizeof( *vrefs ) );
+	Mem_Free( intIndexes );
+}
 
-	vrefTable = (vertRef_t *)_alloca( numIndexes * sizeof( *vrefTable ) );
-	for ( i = 0 ; i < numIndexes ; i++ ) {
-		tri = i / 3;
+/*
+====================
+R_OrderTriSurf
+
+Reorders the triangles and then the vertexes of a surface that has
+nothing but verts and indexes yet
+====================
+*/
+void R_OrderTriSurf( srfTriangles_t *tri ) {
+	int		i;
+	int		*intIndexes, *remap;
 
-		vrefTable[i].tri = tri;
-		vrefTable[i].next = vrefs[oldIndexes[i]];
-		vrefs[oldIndexes[i]] = &vrefTable[i];
+	if ( !r_orderIndexes.GetBool() || tri->numIndexes < 6 ) {
+		return;
 	}
 
-	// generate new indexes
-	numIndexes = 0;
-	c_starts = 0;
-	while ( numIndexes != numOldIndexes ) {
-		// find a triangle that hasn't been used
-		for ( tri = 0 ; tri < numTris ; tri++ ) {
-			if ( !triangleUsed[tri] ) {
-				break;
-			}
-		}
-		if ( tri == numTris ) {
-			common->Error( "R_OrderIndexes: ran out of unused tris" );
-		}
+	intIndexes = (int *)Mem_Alloc( tri->numIndexes * sizeof( intIndexes[0] ) );
+	for ( i = 0 ; i < tri->numIndexes ; i++ ) {
+		intIndexes[i] = tri->indexes[i];
+	}
 
-		c_starts++;
-
-		do {
-			// emit this tri
-			base = oldIndexes + tri * 3;
-			indexes[numIndexes+0] = base[0];
-			indexes[numIndexes+1] = base[1];
-			indexes[numIndexes+2] = base[2];
-			numIndexes += 3;
-
-			triangleUsed[tri] = true;
-
-			// try to find a shared edge to another unused tri
-			for ( i = 0 ; i < 3 ; i++ ) {
-				v1 = base[i];
-				v2 = base[(i+1)%3];
-
-				for ( vref = vrefs[v1] ; vref ; vref = vref->next ) {
-					tri = vref->tri;
-					if ( triangleUsed[tri] ) {
-						continue;
-					}
-
-					// if this triangle also uses v2, grab it
-					if ( oldIndexes[tri*3+0] == v2
-						|| oldIndexes[tri*3+1] == v2
-						|| oldIndexes[tri*3+2] == v2 ) {
-						break;
-					}
-				}
-				if ( vref ) {
-					break;
-				}
-			}
+	if ( R_OptimizeIndexOrder( tri->numVerts, tri->numIndexes, intIndexes ) ) {
+		remap = (int *)Mem_Alloc( tri->numVerts * sizeof( remap[0] ) );
+		R_OptimizeVertexOrder( tri->numVerts, tri->numIndexes, intIndexes, remap );
 
-			// if we couldn't chain off of any verts, we need to find a new one
-			if ( i == 3 ) {
-				break;
-			}
-		} while ( 1 );
-	}
+		idDrawVert *oldVerts = (idDrawVert *)Mem_Alloc16( tri->numVerts * sizeof( oldVerts[0] ) );
+		SIMDProcessor->Memcpy( oldVerts, tri->verts, tri->numVerts * sizeof( oldVerts[0] ) );
+		for ( i = 0 ; i < tri->numVerts ; i++ ) {
+			tri->verts[remap[i]] = oldVerts[i];
+		}
+		Mem_Free16( oldVerts );
+		Mem_Free( remap );
 
-	//c_cost = R_MeshCost( numIndexes, indexes );
+		for ( i = 0 ; i < tri->numIndexes ; i++ ) {
+			tri->indexes[i] = intIndexes[i];
+		}
+	}
 
+	Mem_Free( intIndexes );
 }
 
-
 /*
+===============
+R_MeshCost
 
-  add all triangles that can be specified by the vertexes in the last 14 cache positions
+Returns the number of vertexes a FIFO post-transform cache of the given size
+has to transform for the index list.  Divided by the triangle count this is
+the average cache miss ratio (ACMR).
+===============
+*/
+int R_MeshCost( int numIndexes, const glIndex_t *indexes, int cacheSize ) {
+	int	*inCache;
+	int	i, j, v;
+	int	c_loads;
+	int	fifo;
 
-  pick a new vert to add to the cache
-  don't pick one in the 24 previous cache positions
-  try to pick one that will enable the creation of as many triangles as possible
+	inCache = (int *)_alloca( cacheSize * sizeof( inCache[0] ) );
+	for ( i = 0 ; i < cacheSize ; i++ ) {
+		inCache[i] = -1;
+	}
 
-  look for a vert that shares an edge with the vert about to be evicted
+	c_loads = 0;
+	fifo = 0;
 
+	for ( i = 0 ; i < numIndexes ; i++ ) {
+		v = indexes[i];
+		for ( j = 0 ; j < cacheSize ; j++ ) {
+			if ( inCache[j] == v ) {
+				break;
+			}
+		}
+		if ( j == cacheSize ) {
+			c_loads++;
+			inCache[ fifo % cacheSize ] = v;
+			fifo++;
+		}
+	}
 
-*/
+	return c_loads;
+}
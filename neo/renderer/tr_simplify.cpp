@@ -0,0 +1,489 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "sys/platform.h"
+
+#include "renderer/tr_local.h"
+
+/*
+===============================================================================
+
+	Mesh simplification for model LODs
+
+	Triangles are removed by collapsing a vertex into one of its neighbours,
+	choosing the collapses with the smallest quadric error first (Garland and
+	Heckbert).  A vertex is only ever moved onto an existing vertex, so the
+	reduced mesh uses a subset of the original vertexes and keeps their
+	texture coordinates, normals and skinning weights unchanged.
+
+	Vertexes on open or texture seam edges are locked, so the reduced mesh
+	never opens cracks along seams.
+
+===============================================================================
+*/
+
+#define SIMPLIFY_MAX_PASSES			32
+#define SIMPLIFY_MIN_NORMAL_DOT		0.2f
+
+typedef struct {
+	double			q[10];		// symmetric 4x4: aa ab ac ad bb bc bd cc cd dd
+} quadric_t;
+
+typedef struct {
+	float			cost;
+	int				from;
+	int				to;
+} collapse_t;
+
+/*
+===============
+R_QuadricAddPlane
+===============
+*/
+static void R_QuadricAddPlane( quadric_t &quadric, const idVec3 &normal, float dist, double weight ) {
+	const double a = normal.x, b = normal.y, c = normal.z, d = dist;
+	double *q = quadric.q;
+
+	q[0] += weight * a * a;	q[1] += weight * a * b;	q[2] += weight * a * c;	q[3] += weight * a * d;
+	q[4] += weight * b * b;	q[5] += weight * b * c;	q[6] += weight * b * d;
+	q[7] += weight * c * c;	q[8] += weight * c * d;
+	q[9] += weight * d * d;
+}
+
+/*
+===============
+R_QuadricError
+===============
+*/
+static double R_QuadricError( const quadric_t &a, const quadric_t &b, const idVec3 &v ) {
+	double q[10];
+	for ( int i = 0 ; i < 10 ; i++ ) {
+		q[i] = a.q[i] + b.q[i];
+	}
+	const double x = v.x, y = v.y, z = v.z;
+	return q[0] * x * x + 2.0 * q[1] * x * y + 2.0 * q[2] * x * z + 2.0 * q[3] * x
+			+ q[4] * y * y + 2.0 * q[5] * y * z + 2.0 * q[6] * y
+				+ q[7] * z * z + 2.0 * q[8] * z
+					+ q[9];
+}
+
+/*
+===============
+R_SortCollapses
+===============
+*/
+static int R_SortCollapses( const void *a, const void *b ) {
+	const float ca = ((const collapse_t *)a)->cost;
+	const float cb = ((const collapse_t *)b)->cost;
+	return ( ca < cb ) ? -1 : ( ( ca > cb ) ? 1 : 0 );
+}
+
+/*
+===============
+idMeshSimplifier
+
+Working state for one call of R_SimplifyTriangles
+===============
+*/
+class idMeshSimplifier {
+public:
+					idMeshSimplifier( const idDrawVert *verts, int numVerts, const int *indexes, int numIndexes );
+					~idMeshSimplifier();
+
+	int				Simplify( int targetIndexes, int *outIndexes );
+
+private:
+	const idDrawVert *	verts;
+	int				numVerts;
+	int				numTris;
+	int				numAliveTris;
+	int *			tris;
+	bool *			triAlive;
+	idList<int> *	vertTris;
+	quadric_t *		quadrics;
+	bool *			locked;
+
+	bool			TriUses( int t, int v ) const { return tris[t*3+0] == v || tris[t*3+1] == v || tris[t*3+2] == v; }
+	void			Neighbours( int v, idList<int> &list ) const;
+	bool			CanCollapse( int from, int to ) const;
+	void			Collapse( int from, int to );
+};
+
+/*
+===============
+idMeshSimplifier::idMeshSimplifier
+===============
+*/
+idMeshSimplifier::idMeshSimplifier( const idDrawVert *verts, int numVerts, const int *indexes, int numIndexes ) {
+	int i, j, k;
+
+	this->verts = verts;
+	this->numVerts = numVerts;
+	numTris = numIndexes / 3;
+
+	tris = (int *)Mem_Alloc( numTris * 3 * sizeof( tris[0] ) );
+	memcpy( tris, indexes, numTris * 3 * sizeof( tris[0] ) );
+	triAlive = (bool *)Mem_Alloc( numTris * sizeof( triAlive[0] ) );
+	vertTris = new idList<int>[numVerts];
+	quadrics = (quadric_t *)Mem_ClearedAlloc( numVerts * sizeof( quadrics[0] ) );
+	locked = (bool *)Mem_ClearedAlloc( numVerts * sizeof( locked[0] ) );
+
+	numAliveTris = 0;
+	for ( i = 0 ; i < numTris ; i++ ) {
+		const int *t = tris + i * 3;
+
+		// degenerate triangles are dropped
+		triAlive[i] = ( t[0] != t[1] && t[1] != t[2] && t[2] != t[0] );
+		if ( !triAlive[i] ) {
+			continue;
+		}
+		numAliveTris++;
+
+		for ( j = 0 ; j < 3 ; j++ ) {
+			vertTris[t[j]].Append( i );
+		}
+
+		// area weighted plane quadric
+		const idVec3 &p0 = verts[t[0]].xyz;
+		idVec3 normal = ( verts[t[1]].xyz - p0 ).Cross( verts[t[2]].xyz - p0 );
+		float area = normal.Normalize() * 0.5f;
+		if ( area > 0.0f ) {
+			for ( j = 0 ; j < 3 ; j++ ) {
+				R_QuadricAddPlane( quadrics[t[j]], normal, -( normal * p0 ), area );
+			}
+		}
+	}
+
+	// lock the vertexes of edges that don't have exactly two triangles,
+	// which are open borders, texture seams and non-manifold edges
+	for ( i = 0 ; i < numVerts ; i++ ) {
+		for ( j = 0 ; j < vertTris[i].Num() && !locked[i] ; j++ ) {
+			const int *t = tris + vertTris[i][j] * 3;
+			for ( k = 0 ; k < 3 ; k++ ) {
+				int other = t[k];
+				if ( other == i ) {
+					continue;
+				}
+				int count = 0;
+				for ( int l = 0 ; l < vertTris[i].Num() ; l++ ) {
+					if ( TriUses( vertTris[i][l], other ) ) {
+						count++;
+					}
+				}
+				if ( count != 2 ) {
+					locked[i] = true;
+					locked[other] = true;
+				}
+			}
+		}
+	}
+}
+
+/*
+===============
+idMeshSimplifier::~idMeshSimplifier
+===============
+*/
+idMeshSimplifier::~idMeshSimplifier() {
+	Mem_Free( tris );
+	Mem_Free( triAlive );
+	delete[] vertTris;
+	Mem_Free( quadrics );
+	Mem_Free( locked );
+}
+
+/*
+===============
+idMeshSimplifier::Neighbours
+===============
+*/
+void idMeshSimplifier::Neighbours( int v, idList<int> &list ) const {
+	list.Clear();
+	for ( int i = 0 ; i < vertTris[v].Num() ; i++ ) {
+		int t = vertTris[v][i];
+		if ( !triAlive[t] ) {
+			continue;
+		}
+		for ( int j = 0 ; j < 3 ; j++ ) {
+			if ( tris[t*3+j] != v ) {
+				list.AddUnique( tris[t*3+j] );
+			}
+		}
+	}
+}
+
+/*
+===============
+idMeshSimplifier::CanCollapse
+===============
+*/
+bool idMeshSimplifier::CanCollapse( int from, int to ) const {
+	int				i, j, shared;
+	idList<int>		fromNeighbours, toNeighbours;
+
+	// the edge must still exist
+	shared = 0;
+	for ( i = 0 ; i < vertTris[from].Num() ; i++ ) {
+		int t = vertTris[from][i];
+		if ( triAlive[t] && TriUses( t, to ) ) {
+			shared++;
+		}
+	}
+	if ( shared == 0 ) {
+		return false;
+	}
+
+	// the only common neighbours may be the vertexes opposite the edge,
+	// anything else would fold the surface onto itself
+	Neighbours( from, fromNeighbours );
+	Neighbours( to, toNeighbours );
+	int common = 0;
+	for ( i = 0 ; i < fromNeighbours.Num() ; i++ ) {
+		if ( toNeighbours.FindIndex( fromNeighbours[i] ) != -1 ) {
+			common++;
+		}
+	}
+	if ( common != shared ) {
+		return false;
+	}
+
+	// the remaining triangles must not flip or degenerate
+	for ( i = 0 ; i < vertTris[from].Num() ; i++ ) {
+		int t = vertTris[from][i];
+		if ( !triAlive[t] || TriUses( t, to ) ) {
+			continue;
+		}
+
+		idVec3 p[3], moved[3];
+		for ( j = 0 ; j < 3 ; j++ ) {
+			int v = tris[t*3+j];
+			p[j] = verts[v].xyz;
+			moved[j] = ( v == from ) ? verts[to].xyz : p[j];
+		}
+
+		idVec3 oldNormal = ( p[1] - p[0] ).Cross( p[2] - p[0] );
+		idVec3 newNormal = ( moved[1] - moved[0] ).Cross( moved[2] - moved[0] );
+		if ( newNormal.Normalize() == 0.0f || oldNormal.Normalize() == 0.0f ) {
+			return false;
+		}
+		if ( newNormal * oldNormal < SIMPLIFY_MIN_NORMAL_DOT ) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+===============
+idMeshSimplifier::Collapse
+===============
+*/
+void idMeshSimplifier::Collapse( int from, int to ) {
+	for ( int i = 0 ; i < vertTris[from].Num() ; i++ ) {
+		int t = vertTris[from][i];
+		if ( !triAlive[t] ) {
+			continue;
+		}
+		if ( TriUses( t, to ) ) {
+			triAlive[t] = false;
+			numAliveTris--;
+			continue;
+		}
+		for ( int j = 0 ; j < 3 ; j++ ) {
+			if ( tris[t*3+j] == from ) {
+				tris[t*3+j] = to;
+			}
+		}
+		vertTris[to].Append( t );
+	}
+	vertTris[from].Clear();
+
+	for ( int i = 0 ; i < 10 ; i++ ) {
+		quadrics[to].q[i] += quadrics[from].q[i];
+	}
+}
+
+/*
+===============
+idMeshSimplifier::Simplify
+
+Each pass sorts all possible collapses by their error and performs the
+cheapest ones that don't touch a vertex already changed in the pass.
+===============
+*/
+int idMeshSimplifier::Simplify( int targetIndexes, int *outIndexes ) {
+	int		i, j, pass;
+	bool *	dirty;
+
+	collapse_t *collapses = (collapse_t *)Mem_Alloc( numTris * 6 * sizeof( collapses[0] ) );
+	dirty = (bool *)Mem_Alloc( numVerts * sizeof( dirty[0] ) );
+
+	for ( pass = 0 ; pass < SIMPLIFY_MAX_PASSES && numAliveTris * 3 > targetIndexes ; pass++ ) {
+		int numCollapses = 0;
+
+		for ( i = 0 ; i < numTris ; i++ ) {
+			if ( !triAlive[i] ) {
+				continue;
+			}
+			for ( j = 0 ; j < 3 ; j++ ) {
+				int a = tris[i*3+j];
+				int b = tris[i*3+(j+1)%3];
+				if ( !locked[a] ) {
+					collapse_t &c = collapses[numCollapses++];
+					c.from = a;
+					c.to = b;
+					c.cost = (float)R_QuadricError( quadrics[a], quadrics[b], verts[b].xyz );
+				}
+				if ( !locked[b] ) {
+					collapse_t &c = collapses[numCollapses++];
+					c.from = b;
+					c.to = a;
+					c.cost = (float)R_QuadricError( quadrics[a], quadrics[b], verts[a].xyz );
+				}
+			}
+		}
+
+		qsort( collapses, numCollapses, sizeof( collapses[0] ), R_SortCollapses );
+		memset( dirty, 0, numVerts * sizeof( dirty[0] ) );
+
+		int numCollapsed = 0;
+		for ( i = 0 ; i < numCollapses && numAliveTris * 3 > targetIndexes ; i++ ) {
+			const collapse_t &c = collapses[i];
+			if ( dirty[c.from] || dirty[c.to] ) {
+				continue;
+			}
+			if ( !CanCollapse( c.from, c.to ) ) {
+				continue;
+			}
+
+			// everything around the collapse gets new errors
+			for ( j = 0 ; j < vertTris[c.from].Num() ; j++ ) {
+				int t = vertTris[c.from][j];
+				if ( triAlive[t] ) {
+					dirty[tris[t*3+0]] = dirty[tris[t*3+1]] = dirty[tris[t*3+2]] = true;
+				}
+			}
+			Collapse( c.from, c.to );
+			numCollapsed++;
+		}
+
+		if ( !numCollapsed ) {
+			break;
+		}
+	}
+
+	Mem_Free( dirty );
+	Mem_Free( collapses );
+
+	int numOut = 0;
+	for ( i = 0 ; i < numTris ; i++ ) {
+		if ( triAlive[i] ) {
+			outIndexes[numOut++] = tris[i*3+0];
+			outIndexes[numOut++] = tris[i*3+1];
+			outIndexes[numOut++] = tris[i*3+2];
+		}
+	}
+	return numOut;
+}
+
+/*
+===============
+R_SimplifyTriangles
+
+Writes a reduced triangle list that tries to get down to targetIndexes and
+returns the number of indexes written.  outIndexes must have room for
+numIndexes and refers to the original vertex numbers.
+===============
+*/
+int R_SimplifyTriangles( const idDrawVert *verts, int numVerts, const int *indexes, int numIndexes, int targetIndexes, int *outIndexes ) {
+	for ( int i = 0 ; i < numIndexes ; i++ ) {
+		if ( indexes[i] < 0 || indexes[i] >= numVerts ) {
+			memcpy( outIndexes, indexes, numIndexes * sizeof( outIndexes[0] ) );
+			return numIndexes;
+		}
+	}
+
+	idMeshSimplifier simplifier( verts, numVerts, indexes, numIndexes );
+	return simplifier.Simplify( targetIndexes, outIndexes );
+}
+
+/*
+===============
+R_SimplifyStaticTriSurf
+
+Creates a cleaned up reduced copy of a static surface
+===============
+*/
+srfTriangles_t *R_SimplifyStaticTriSurf( const srfTriangles_t *tri, int targetIndexes, bool useUnsmoothedTangents ) {
+	int		i, numIndexes, numVerts;
+	int		*intIndexes, *outIndexes, *remap;
+
+	intIndexes = (int *)Mem_Alloc( tri->numIndexes * sizeof( intIndexes[0] ) );
+	outIndexes = (int *)Mem_Alloc( tri->numIndexes * sizeof( outIndexes[0] ) );
+	remap = (int *)Mem_Alloc( tri->numVerts * sizeof( remap[0] ) );
+
+	for ( i = 0 ; i < tri->numIndexes ; i++ ) {
+		intIndexes[i] = tri->indexes[i];
+	}
+	numIndexes = R_SimplifyTriangles( tri->verts, tri->numVerts, intIndexes, tri->numIndexes, targetIndexes, outIndexes );
+
+	// keep only the vertexes that are still used
+	for ( i = 0 ; i < tri->numVerts ; i++ ) {
+		remap[i] = -1;
+	}
+	numVerts = 0;
+	for ( i = 0 ; i < numIndexes ; i++ ) {
+		if ( remap[outIndexes[i]] == -1 ) {
+			remap[outIndexes[i]] = numVerts++;
+		}
+	}
+
+	srfTriangles_t *newTri = R_AllocStaticTriSurf();
+	R_AllocStaticTriSurfVerts( newTri, numVerts );
+	R_AllocStaticTriSurfIndexes( newTri, numIndexes );
+	newTri->numVerts = numVerts;
+	newTri->numIndexes = numIndexes;
+	for ( i = 0 ; i < tri->numVerts ; i++ ) {
+		if ( remap[i] != -1 ) {
+			newTri->verts[remap[i]] = tri->verts[i];
+		}
+	}
+	for ( i = 0 ; i < numIndexes ; i++ ) {
+		newTri->indexes[i] = remap[outIndexes[i]];
+	}
+
+	Mem_Free( intIndexes );
+	Mem_Free( outIndexes );
+	Mem_Free( remap );
+
+	newTri->generateNormals = tri->generateNormals;
+	R_CleanupTriangles( newTri, newTri->generateNormals, true, useUnsmoothedTangents );
+
+	return newTri;
+}
@@ -27,6 +27,7 @@ If you have questions concerning this license or the applicable additional terms
 */
 
 #include "sys/platform.h"
+#include "framework/Session.h"
 
 #include "renderer/tr_local.h"
 
@@ -278,12 +279,186 @@ static viewDef_t *R_XrayViewBySurface( drawSurf_t *drawSurf ) {
 	return parms;
 }
 
+/*
+===============================================================================
+
+Subview refresh policies
+
+A texture subview (remote camera, mirror or xray map) normally re-renders
+the whole world every frame it is seen.  With r_subviewMaxHz set, each
+stage captures into an image of its own and is only refreshed as often as
+its distance and screen size call for; frames in between keep drawing the
+last capture.  r_subviewBudget additionally caps the front end time spent
+on subviews of the primary view each frame.
+
+===============================================================================
+*/
+
+#define	SUBVIEW_IMAGE_SIZE	16
+
+static int	subviewBudgetFrame = -1;
+static int	subviewBudgetMsec;
+
+/*
+=================
+R_SubviewImage
+=================
+*/
+static void R_SubviewImage( idImage *image ) {
+	byte	data[SUBVIEW_IMAGE_SIZE][SUBVIEW_IMAGE_SIZE][4];
+
+	memset( data, 0, sizeof( data ) );
+
+	image->GenerateImage( (byte *)data, SUBVIEW_IMAGE_SIZE, SUBVIEW_IMAGE_SIZE,
+		TF_DEFAULT, false, TR_REPEAT, TD_HIGH_QUALITY );
+}
+
+/*
+=================
+R_UseSubviewPolicies
+
+Demos reference capture images by name, so keep the shared scratch images
+while recording one.
+=================
+*/
+static bool R_UseSubviewPolicies( void ) {
+	return r_subviewMaxHz.GetInteger() > 0 && !session->writeDemo;
+}
+
+/*
+=================
+R_SubviewBudgetMsec
+
+Front end msec already spent on subviews of the primary view this frame.
+=================
+*/
+static int R_SubviewBudgetMsec( void ) {
+	if ( subviewBudgetFrame != tr.frameCount ) {
+		subviewBudgetFrame = tr.frameCount;
+		subviewBudgetMsec = 0;
+	}
+	return subviewBudgetMsec;
+}
+
+/*
+=================
+R_SpendSubviewBudget
+
+Nested subviews are already included in the time of their parent.
+=================
+*/
+static void R_SpendSubviewBudget( int startMsec ) {
+	if ( tr.viewDef->isSubview ) {
+		return;
+	}
+	R_SubviewBudgetMsec();
+	subviewBudgetMsec += Sys_Milliseconds() - startMsec;
+}
+
+/*
+=================
+R_SubviewNeedsRefresh
+
+Returns false if the stage can keep showing its last capture this frame.
+=================
+*/
+static bool R_SubviewNeedsRefresh( const drawSurf_t *surf, const textureStage_t *stage, const idScreenRect &scissor ) {
+	if ( !R_UseSubviewPolicies() ) {
+		return true;
+	}
+
+	// nothing to fall back to yet
+	if ( !stage->dynamicRenderTime ) {
+		return true;
+	}
+
+	int maxHz = r_subviewMaxHz.GetInteger();
+	int minHz = idMath::ClampInt( 1, maxHz, r_subviewMinHz.GetInteger() );
+	int elapsed = Sys_Milliseconds() - stage->dynamicRenderTime;
+
+	// over the frame budget, only refresh captures that are getting too old
+	if ( r_subviewBudget.GetInteger() > 0 && R_SubviewBudgetMsec() >= r_subviewBudget.GetInteger() ) {
+		return elapsed * minHz >= 1000;
+	}
+
+	float scale = 1.0f;
+
+	// scale the rate down with distance
+	float fullRateDistance = r_subviewFullRateDistance.GetFloat();
+	if ( fullRateDistance > 0.0f ) {
+		idVec3 center;
+		R_LocalPointToGlobal( surf->space->modelMatrix, surf->geoFrontEnd->bounds.GetCenter(), center );
+		float distance = ( center - tr.viewDef->renderView.vieworg ).LengthFast();
+		if ( distance > fullRateDistance ) {
+			scale = fullRateDistance / distance;
+		}
+	}
+
+	// and with the fraction of the view it covers
+	float fullRateSize = r_subviewFullRateSize.GetFloat();
+	if ( fullRateSize > 0.0f ) {
+		const idScreenRect &v = tr.viewDef->viewport;
+		float viewArea = (float)( v.x2 - v.x1 + 1 ) * (float)( v.y2 - v.y1 + 1 );
+		float area = (float)( scissor.x2 - scissor.x1 + 1 ) * (float)( scissor.y2 - scissor.y1 + 1 );
+		float size = area / viewArea;
+		if ( size < fullRateSize ) {
+			scale = Min( scale, size / fullRateSize );
+		}
+	}
+
+	float hz = Max( (float)minHz, maxHz * scale );
+
+	return elapsed * hz >= 1000.0f;
+}
+
+/*
+=================
+R_SkipSubview
+
+The stage keeps drawing its last capture.
+=================
+*/
+static void R_SkipSubview( textureStage_t *stage ) {
+	stage->dynamicFrameCount = tr.frameCount;
+	tr.pc.c_subviewsSkipped++;
+}
+
+/*
+=================
+R_CaptureSubview
+
+Copies the current crop to the image of the stage.  Shared scratch images
+are overwritten by other views, so with refresh policies active the stage
+gets an image of its own that stays valid while it is skipped.  A stage
+that names an image of its own always captures into it.
+=================
+*/
+static void R_CaptureSubview( const idMaterial *shader, int stageNum, textureStage_t *stage, idImage *sharedImage ) {
+	bool	policies = R_UseSubviewPolicies();
+
+	if ( !stage->image || stage->image == sharedImage || stage->image->generatorFunction == R_SubviewImage ) {
+		if ( !policies ) {
+			stage->image = sharedImage;
+		} else if ( !stage->image || stage->image->generatorFunction != R_SubviewImage ) {
+			stage->image = globalImages->ImageFromFunction( va( "_subview/%s/%i", shader->GetName(), stageNum ), R_SubviewImage );
+		}
+	}
+
+	stage->dynamicFrameCount = tr.frameCount;
+	stage->dynamicRenderTime = policies ? Sys_Milliseconds() : 0;
+
+	tr.pc.c_subviewsRendered++;
+
+	tr.CaptureRenderToImage( stage->image->imgName );
+	tr.UnCrop();
+}
+
 /*
 ===============
 R_RemoteRender
 ===============
 */
-static void R_RemoteRender( drawSurf_t *surf, textureStage_t *stage ) {
+static void R_RemoteRender( drawSurf_t *surf, const idMaterial *shader, int stageNum, textureStage_t *stage, idScreenRect scissor ) {
 	viewDef_t		*parms;
 
 	// remote views can be reused in a single frame
@@ -296,6 +471,11 @@ static void R_RemoteRender( drawSurf_t *surf, textureStage_t *stage ) {
 		return;
 	}
 
+	if ( !R_SubviewNeedsRefresh( surf, stage, scissor ) ) {
+		R_SkipSubview( stage );
+		return;
+	}
+
 	// copy the viewport size from the original
 	parms = (viewDef_t *)R_FrameAlloc( sizeof( *parms ) );
 	*parms = *tr.viewDef;
@@ -328,13 +508,7 @@ static void R_RemoteRender( drawSurf_t *surf, textureStage_t *stage ) {
 	R_RenderView(parms);
 
 	// copy this rendering to the image
-	stage->dynamicFrameCount = tr.frameCount;
-	if (!stage->image) {
-		stage->image = globalImages->scratchImage;
-	}
-
-	tr.CaptureRenderToImage( stage->image->imgName );
-	tr.UnCrop();
+	R_CaptureSubview( shader, stageNum, stage, globalImages->scratchImage );
 }
 
 /*
@@ -342,7 +516,7 @@ static void R_RemoteRender( drawSurf_t *surf, textureStage_t *stage ) {
 R_MirrorRender
 =================
 */
-void R_MirrorRender( drawSurf_t *surf, textureStage_t *stage, idScreenRect scissor ) {
+static void R_MirrorRender( drawSurf_t *surf, const idMaterial *shader, int stageNum, textureStage_t *stage, idScreenRect scissor ) {
 	viewDef_t		*parms;
 
 	// remote views can be reused in a single frame
@@ -350,6 +524,11 @@ void R_MirrorRender( drawSurf_t *surf, textureStage_t *stage, idScreenRect sciss
 		return;
 	}
 
+	if ( !R_SubviewNeedsRefresh( surf, stage, scissor ) ) {
+		R_SkipSubview( stage );
+		return;
+	}
+
 	// issue a new view command
 	parms = R_MirrorViewBySurface( surf );
 	if ( !parms ) {
@@ -380,11 +559,7 @@ void R_MirrorRender( drawSurf_t *surf, textureStage_t *stage, idScreenRect sciss
 	R_RenderView( parms );
 
 	// copy this rendering to the image
-	stage->dynamicFrameCount = tr.frameCount;
-	stage->image = globalImages->scratchImage;
-
-	tr.CaptureRenderToImage( stage->image->imgName );
-	tr.UnCrop();
+	R_CaptureSubview( shader, stageNum, stage, globalImages->scratchImage );
 }
 
 /*
@@ -392,7 +567,7 @@ void R_MirrorRender( drawSurf_t *surf, textureStage_t *stage, idScreenRect sciss
 R_XrayRender
 =================
 */
-void R_XrayRender( drawSurf_t *surf, textureStage_t *stage, idScreenRect scissor ) {
+static void R_XrayRender( drawSurf_t *surf, const idMaterial *shader, int stageNum, textureStage_t *stage, idScreenRect scissor ) {
 	viewDef_t		*parms;
 
 	// remote views can be reused in a single frame
@@ -400,6 +575,11 @@ void R_XrayRender( drawSurf_t *surf, textureStage_t *stage, idScreenRect scissor
 		return;
 	}
 
+	if ( !R_SubviewNeedsRefresh( surf, stage, scissor ) ) {
+		R_SkipSubview( stage );
+		return;
+	}
+
 	// issue a new view command
 	parms = R_XrayViewBySurface( surf );
 	if ( !parms ) {
@@ -430,11 +610,7 @@ void R_XrayRender( drawSurf_t *surf, textureStage_t *stage, idScreenRect scissor
 	R_RenderView( parms );
 
 	// copy this rendering to the image
-	stage->dynamicFrameCount = tr.frameCount;
-	stage->image = globalImages->scratchImage2;
-
-	tr.CaptureRenderToImage( stage->image->imgName );
-	tr.UnCrop();
+	R_CaptureSubview( shader, stageNum, stage, globalImages->scratchImage2 );
 }
 
 /*
@@ -523,22 +699,25 @@ bool	R_GenerateSurfaceSubview( drawSurf_t *drawSurf ) {
 		tr.viewDef = origViewDef;
 	} // DG end
 
+	int startMsec = Sys_Milliseconds();
+
 	// see what kind of subview we are making
 	if ( shader->GetSort() != SS_SUBVIEW ) {
 		for ( int i = 0 ; i < shader->GetNumStages() ; i++ ) {
 			const shaderStage_t	*stage = shader->GetStage( i );
 			switch ( stage->texture.dynamic ) {
 			case DI_REMOTE_RENDER:
-				R_RemoteRender( drawSurf, const_cast<textureStage_t *>(&stage->texture) );
+				R_RemoteRender( drawSurf, shader, i, const_cast<textureStage_t *>(&stage->texture), scissor );
 				break;
 			case DI_MIRROR_RENDER:
-				R_MirrorRender( drawSurf, const_cast<textureStage_t *>(&stage->texture), scissor );
+				R_MirrorRender( drawSurf, shader, i, const_cast<textureStage_t *>(&stage->texture), scissor );
 				break;
 			case DI_XRAY_RENDER:
-				R_XrayRender( drawSurf, const_cast<textureStage_t *>(&stage->texture), scissor );
+				R_XrayRender( drawSurf, shader, i, const_cast<textureStage_t *>(&stage->texture), scissor );
 				break;
 			}
 		}
+		R_SpendSubviewBudget( startMsec );
 		return true;
 	}
 
@@ -558,6 +737,11 @@ bool	R_GenerateSurfaceSubview( drawSurf_t *drawSurf ) {
 	// generate render commands for it
 	R_RenderView( parms );
 
+	// stencil subviews draw straight into this view and can't be skipped,
+	// but still count against the budget
+	tr.pc.c_subviewsRendered++;
+	R_SpendSubviewBudget( startMsec );
+
 	return true;
 }
 
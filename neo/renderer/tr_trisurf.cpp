@@ -365,6 +365,8 @@ void R_FreeStaticTriSurfVertexCaches( srfTriangles_t *tri ) {
 		vertexCache.Free( tri->shadowCache );
 		tri->shadowCache = NULL;
 	}
+
+	R_FreeDeformCache( tri );
 }
 
 /*
@@ -2110,6 +2112,9 @@ FIXME: allow createFlat and createSmooth normals, as well as explicit
 void R_CleanupTriangles( srfTriangles_t *tri, bool createNormals, bool identifySilEdges, bool useUnsmoothedTangents ) {
 	R_RangeCheckIndexes( tri );
 
+	// optimize the triangle and vertex order before anything refers to triangle or vertex numbers
+	R_OrderTriSurf( tri );
+
 	R_CreateSilIndexes( tri );
 
 //	R_RemoveDuplicatedTriangles( tri );	// this may remove valid overlapped transparent triangles
@@ -2127,9 +2132,6 @@ void R_CleanupTriangles( srfTriangles_t *tri, bool createNormals, bool identifyS
 	// bust vertexes that share a mirrored edge into separate vertexes
 	R_DuplicateMirroredVertexes( tri );
 
-	// optimize the index order (not working?)
-//	R_OrderIndexes( tri->numIndexes, tri->indexes );
-
 	R_CreateDupVerts( tri );
 
 	R_BoundTriSurf( tri );
@@ -2285,3 +2287,180 @@ int R_DeformInfoMemoryUsed( deformInfo_t *deformInfo ) {
 	total += sizeof( *deformInfo );
 	return total;
 }
+
+/*
+===================================================================================
+
+BINARY MODEL CACHE
+
+Fully processed surfaces are written in native layout, so every array
+is read back with a single copy into memory from the usual allocators.
+The model files check the layout and the source timestamp, see
+idRenderModelStatic::OpenBinaryModel.
+
+===================================================================================
+*/
+
+/*
+===================
+R_WriteTriArray
+===================
+*/
+static void R_WriteTriArray( idFile *f, const void *data, int count, int elementSize ) {
+	if ( data == NULL ) {
+		f->WriteInt( -1 );
+		return;
+	}
+	f->WriteInt( count );
+	f->Write( data, count * elementSize );
+}
+
+/*
+===================
+R_ReadTriArray
+
+Returns false if the array doesn't have the expected size or runs past the end of the file
+===================
+*/
+template< class type, class allocator >
+static bool R_ReadTriArray( idFile *f, type *&data, int count, allocator &alloc ) {
+	int num;
+
+	data = NULL;
+	if ( f->ReadInt( num ) != sizeof( num ) ) {
+		return false;
+	}
+	if ( num == -1 ) {
+		return true;
+	}
+	if ( num != count || count < 0 || count > ( f->Length() - f->Tell() ) / (int)sizeof( type ) ) {
+		return false;
+	}
+	data = alloc.Alloc( count );
+	f->Read( data, count * sizeof( type ) );
+	return true;
+}
+
+/*
+===================
+R_WriteStaticTriSurf
+===================
+*/
+void R_WriteStaticTriSurf( idFile *f, const srfTriangles_t *tri ) {
+	f->WriteVec3( tri->bounds[0] );
+	f->WriteVec3( tri->bounds[1] );
+	f->WriteBool( tri->generateNormals );
+	f->WriteBool( tri->tangentsCalculated );
+	f->WriteBool( tri->facePlanesCalculated );
+	f->WriteBool( tri->perfectHull );
+	f->WriteInt( tri->numVerts );
+	f->WriteInt( tri->numIndexes );
+	f->WriteInt( tri->numMirroredVerts );
+	f->WriteInt( tri->numDupVerts );
+	f->WriteInt( tri->numSilEdges );
+	f->WriteInt( tri->numShadowIndexesNoFrontCaps );
+	f->WriteInt( tri->numShadowIndexesNoCaps );
+	f->WriteInt( tri->shadowCapPlaneBits );
+
+	R_WriteTriArray( f, tri->verts, tri->numVerts, sizeof( tri->verts[0] ) );
+	R_WriteTriArray( f, tri->indexes, tri->numIndexes, sizeof( tri->indexes[0] ) );
+	R_WriteTriArray( f, tri->silIndexes, tri->numIndexes, sizeof( tri->silIndexes[0] ) );
+	R_WriteTriArray( f, tri->mirroredVerts, tri->numMirroredVerts, sizeof( tri->mirroredVerts[0] ) );
+	R_WriteTriArray( f, tri->dupVerts, tri->numDupVerts * 2, sizeof( tri->dupVerts[0] ) );
+	R_WriteTriArray( f, tri->silEdges, tri->numSilEdges, sizeof( tri->silEdges[0] ) );
+	R_WriteTriArray( f, tri->facePlanes, tri->numIndexes / 3, sizeof( tri->facePlanes[0] ) );
+	R_WriteTriArray( f, tri->dominantTris, tri->numVerts, sizeof( tri->dominantTris[0] ) );
+	R_WriteTriArray( f, tri->shadowVertexes, tri->numVerts, sizeof( tri->shadowVertexes[0] ) );
+}
+
+/*
+===================
+R_ReadStaticTriSurf
+
+Returns NULL if the data is bad
+===================
+*/
+srfTriangles_t *R_ReadStaticTriSurf( idFile *f ) {
+	srfTriangles_t *tri = R_AllocStaticTriSurf();
+
+	f->ReadVec3( tri->bounds[0] );
+	f->ReadVec3( tri->bounds[1] );
+	f->ReadBool( tri->generateNormals );
+	f->ReadBool( tri->tangentsCalculated );
+	f->ReadBool( tri->facePlanesCalculated );
+	f->ReadBool( tri->perfectHull );
+	f->ReadInt( tri->numVerts );
+	f->ReadInt( tri->numIndexes );
+	f->ReadInt( tri->numMirroredVerts );
+	f->ReadInt( tri->numDupVerts );
+	f->ReadInt( tri->numSilEdges );
+	f->ReadInt( tri->numShadowIndexesNoFrontCaps );
+	f->ReadInt( tri->numShadowIndexesNoCaps );
+	f->ReadInt( tri->shadowCapPlaneBits );
+
+	if ( !R_ReadTriArray( f, tri->verts, tri->numVerts, triVertexAllocator )
+			|| !R_ReadTriArray( f, tri->indexes, tri->numIndexes, triIndexAllocator )
+			|| !R_ReadTriArray( f, tri->silIndexes, tri->numIndexes, triSilIndexAllocator )
+			|| !R_ReadTriArray( f, tri->mirroredVerts, tri->numMirroredVerts, triMirroredVertAllocator )
+			|| !R_ReadTriArray( f, tri->dupVerts, tri->numDupVerts * 2, triDupVertAllocator )
+			|| !R_ReadTriArray( f, tri->silEdges, tri->numSilEdges, triSilEdgeAllocator )
+			|| !R_ReadTriArray( f, tri->facePlanes, tri->numIndexes / 3, triPlaneAllocator )
+			|| !R_ReadTriArray( f, tri->dominantTris, tri->numVerts, triDominantTrisAllocator )
+			|| !R_ReadTriArray( f, tri->shadowVertexes, tri->numVerts, triShadowVertexAllocator ) ) {
+		R_FreeStaticTriSurf( tri );
+		return NULL;
+	}
+
+	return tri;
+}
+
+/*
+===================
+R_WriteDeformInfo
+===================
+*/
+void R_WriteDeformInfo( idFile *f, const deformInfo_t *deform ) {
+	f->WriteInt( deform->numSourceVerts );
+	f->WriteInt( deform->numOutputVerts );
+	f->WriteInt( deform->numIndexes );
+	f->WriteInt( deform->numMirroredVerts );
+	f->WriteInt( deform->numDupVerts );
+	f->WriteInt( deform->numSilEdges );
+
+	R_WriteTriArray( f, deform->indexes, deform->numIndexes, sizeof( deform->indexes[0] ) );
+	R_WriteTriArray( f, deform->silIndexes, deform->numIndexes, sizeof( deform->silIndexes[0] ) );
+	R_WriteTriArray( f, deform->mirroredVerts, deform->numMirroredVerts, sizeof( deform->mirroredVerts[0] ) );
+	R_WriteTriArray( f, deform->dupVerts, deform->numDupVerts * 2, sizeof( deform->dupVerts[0] ) );
+	R_WriteTriArray( f, deform->silEdges, deform->numSilEdges, sizeof( deform->silEdges[0] ) );
+	R_WriteTriArray( f, deform->dominantTris, deform->numOutputVerts, sizeof( deform->dominantTris[0] ) );
+}
+
+/*
+===================
+R_ReadDeformInfo
+
+Returns NULL if the data is bad
+===================
+*/
+deformInfo_t *R_ReadDeformInfo( idFile *f ) {
+	deformInfo_t *deform = (deformInfo_t *)R_ClearedStaticAlloc( sizeof( *deform ) );
+
+	f->ReadInt( deform->numSourceVerts );
+	f->ReadInt( deform->numOutputVerts );
+	f->ReadInt( deform->numIndexes );
+	f->ReadInt( deform->numMirroredVerts );
+	f->ReadInt( deform->numDupVerts );
+	f->ReadInt( deform->numSilEdges );
+
+	if ( !R_ReadTriArray( f, deform->indexes, deform->numIndexes, triIndexAllocator )
+			|| !R_ReadTriArray( f, deform->silIndexes, deform->numIndexes, triSilIndexAllocator )
+			|| !R_ReadTriArray( f, deform->mirroredVerts, deform->numMirroredVerts, triMirroredVertAllocator )
+			|| !R_ReadTriArray( f, deform->dupVerts, deform->numDupVerts * 2, triDupVertAllocator )
+			|| !R_ReadTriArray( f, deform->silEdges, deform->numSilEdges, triSilEdgeAllocator )
+			|| !R_ReadTriArray( f, deform->dominantTris, deform->numOutputVerts, triDominantTrisAllocator ) ) {
+		R_FreeDeformInfo( deform );
+		return NULL;
+	}
+
+	return deform;
+}
@@ -28,6 +28,7 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "sys/platform.h"
 #include "framework/FileSystem.h"
+#include "framework/ResourceManifest.h"
 
 #include "sound/snd_local.h"
 
@@ -92,6 +93,10 @@ idSoundSample *idSoundCache::FindSound( const idStr& filename, bool loadOnDemand
 
 	declManager->MediaPrint( "%s\n", fname.c_str() );
 
+	if ( resourceManifest.IsRecording() ) {
+		resourceManifest.AddSample( fname );
+	}
+
 	// check to see if object is already in cache
 	for( int i = 0; i < listCache.Num(); i++ ) {
 		idSoundSample *def = listCache[i];
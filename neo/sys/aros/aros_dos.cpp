@@ -195,6 +195,25 @@ void Sys_Mkdir( const char *path ) {
     }
 }
 
+/*
+================
+Sys_MapFile
+
+Not supported, pak files are read through minizip
+================
+*/
+const void *Sys_MapFile( const char *path, int *length ) {
+    return NULL;
+}
+
+/*
+================
+Sys_UnmapFile
+================
+*/
+void Sys_UnmapFile( const void *data, int length ) {
+}
+
 char *Sys_GetClipboardData(void) {
     struct IFFHandle *IFFHandle;
     struct ContextNode  *cn;
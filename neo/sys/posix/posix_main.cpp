@@ -350,6 +350,42 @@ ID_TIME_T Sys_FileTimeStamp(FILE * fp) {
 	return st.st_mtime;
 }
 
+/*
+================
+Sys_MapFile
+================
+*/
+const void *Sys_MapFile( const char *path, int *length ) {
+	struct stat st;
+	void *data;
+
+	int fd = open( path, O_RDONLY );
+	if ( fd == -1 ) {
+		return NULL;
+	}
+	if ( fstat( fd, &st ) == -1 || st.st_size <= 0 || st.st_size > 0x7fffffff ) {
+		close( fd );
+		return NULL;
+	}
+	data = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+	// the mapping keeps the file referenced
+	close( fd );
+	if ( data == MAP_FAILED ) {
+		return NULL;
+	}
+	*length = (int)st.st_size;
+	return data;
+}
+
+/*
+================
+Sys_UnmapFile
+================
+*/
+void Sys_UnmapFile( const void *data, int length ) {
+	munmap( const_cast<void *>( data ), length );
+}
+
 char *Sys_GetClipboardData(void) {
 #if SDL_VERSION_ATLEAST(2, 0, 0)
 	return SDL_GetClipboardText();
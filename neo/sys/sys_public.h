@@ -213,6 +213,9 @@ void			Sys_ShowConsole( int visLevel, bool quitOnClose );
 
 void			Sys_Mkdir( const char *path );
 ID_TIME_T			Sys_FileTimeStamp( FILE *fp );
+// maps a whole file read only, returns NULL if the file can't be mapped
+const void *	Sys_MapFile( const char *path, int *length );
+void			Sys_UnmapFile( const void *data, int length );
 // NOTE: do we need to guarantee the same output on all platforms?
 const char *	Sys_TimeStampToStr( ID_TIME_T timeStamp );
 
@@ -335,20 +338,23 @@ extern void Sys_ShutdownThreads();
 
 bool Sys_IsMainThread();
 
-const int MAX_CRITICAL_SECTIONS		= 5;
+const int MAX_CRITICAL_SECTIONS		= 8;
 
 enum {
 	CRITICAL_SECTION_ZERO = 0,
 	CRITICAL_SECTION_ONE,
 	CRITICAL_SECTION_TWO,
 	CRITICAL_SECTION_THREE,
+	CRITICAL_SECTION_DECL_PARSE,	// decl folder hand-off between the main and the decl parse threads
+	CRITICAL_SECTION_FS_ASYNC,		// asynchronous file read queue
+	CRITICAL_SECTION_LOAD_PREFETCH,	// level load prefetch stages finishing
 	CRITICAL_SECTION_SYS
 };
 
 void				Sys_EnterCriticalSection( int index = CRITICAL_SECTION_ZERO );
 void				Sys_LeaveCriticalSection( int index = CRITICAL_SECTION_ZERO );
 
-const int MAX_TRIGGER_EVENTS		= 7;
+const int MAX_TRIGGER_EVENTS		= 14;
 
 enum {
 	TRIGGER_EVENT_ZERO = 0,
@@ -357,7 +363,14 @@ enum {
 	TRIGGER_EVENT_THREE,
 	TRIGGER_EVENT_RUN_BACKEND,
 	TRIGGER_EVENT_BACKEND_FINISHED,
-	TRIGGER_EVENT_IMAGES_PROCESSES
+	TRIGGER_EVENT_IMAGES_PROCESSES,
+	TRIGGER_EVENT_DECL_SCANNED,		// a decl parse thread finished a file
+	TRIGGER_EVENT_DECL_LOADED0,		// a file was loaded for decl parse thread 0, one event per thread
+	TRIGGER_EVENT_DECL_LOADED1,
+	TRIGGER_EVENT_DECL_LOADED2,
+	TRIGGER_EVENT_DECL_LOADED3,
+	TRIGGER_EVENT_FS_ASYNC0,		// a read was queued for asynchronous read thread 0, one event per thread
+	TRIGGER_EVENT_FS_ASYNC1
 };
 
 void				Sys_WaitForEvent( int index = TRIGGER_EVENT_ZERO );
@@ -317,6 +317,45 @@ ID_TIME_T Sys_FileTimeStamp( FILE *fp ) {
 	return (long) st.st_mtime;
 }
 
+/*
+=================
+Sys_MapFile
+=================
+*/
+const void *Sys_MapFile( const char *path, int *length ) {
+	HANDLE file = CreateFile( path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if ( file == INVALID_HANDLE_VALUE ) {
+		return NULL;
+	}
+	LARGE_INTEGER size;
+	if ( !GetFileSizeEx( file, &size ) || size.QuadPart <= 0 || size.QuadPart > 0x7fffffff ) {
+		CloseHandle( file );
+		return NULL;
+	}
+	HANDLE mapping = CreateFileMapping( file, NULL, PAGE_READONLY, 0, 0, NULL );
+	CloseHandle( file );
+	if ( mapping == NULL ) {
+		return NULL;
+	}
+	// the view keeps the mapping and the file referenced
+	const void *data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+	CloseHandle( mapping );
+	if ( data == NULL ) {
+		return NULL;
+	}
+	*length = (int)size.QuadPart;
+	return data;
+}
+
+/*
+=================
+Sys_UnmapFile
+=================
+*/
+void Sys_UnmapFile( const void *data, int length ) {
+	UnmapViewOfFile( data );
+}
+
 /*
 ==============
 Sys_Cwd
@@ -27,6 +27,7 @@ If you have questions concerning this license or the applicable additional terms
 */
 
 #include "sys/platform.h"
+#include "idlib/Timer.h"
 #include "framework/FileSystem.h"
 #include "framework/DeclEntityDef.h"
 
@@ -745,6 +746,8 @@ bool idAASFileLocal::Write( const idStr &fileName, unsigned int mapFileCRC ) {
 	// close file
 	fileSystem->CloseFile( aasFile );
 
+	WriteBinary( fileName, mapFileCRC );
+
 	common->Printf( "done.\n" );
 
 	return true;
@@ -1105,6 +1108,7 @@ bool idAASFileLocal::Load( const idStr &fileName, unsigned int mapFileCRC ) {
 	idToken token;
 	int depth;
 	unsigned int c;
+	idTimer timer;
 
 	name = fileName;
 	crc = mapFileCRC;
@@ -1112,6 +1116,14 @@ bool idAASFileLocal::Load( const idStr &fileName, unsigned int mapFileCRC ) {
 	common->Printf( "[Load AAS]\n" );
 	common->Printf( "loading %s\n", name.c_str() );
 
+	timer.Start();
+
+	if ( LoadBinary( fileName, mapFileCRC ) ) {
+		timer.Stop();
+		common->Printf( "done in %d msec (binary).\n", (int)timer.Milliseconds() );
+		return true;
+	}
+
 	if ( !src.LoadFile( name ) ) {
 		return false;
 	}
@@ -1195,7 +1207,486 @@ bool idAASFileLocal::Load( const idStr &fileName, unsigned int mapFileCRC ) {
 		src.Error( "idAASFileLocal::Load: tree depth = %d", depth );
 	}
 
-	common->Printf( "done.\n" );
+	timer.Stop();
+	common->Printf( "done in %d msec.\n", (int)timer.Milliseconds() );
+
+	return true;
+}
+
+/*
+===============================================================================
+
+	Binary AAS file
+
+	Written next to the text file by the AAS compiler as <name>.b<ext>.  The
+	plain arrays are stored in native byte order and layout so they are read
+	straight into the lists, the header records the structure sizes and any
+	mismatch falls back to the text file.
+
+===============================================================================
+*/
+
+#define AAS_BINARYFILE_ID		( ( 'S' << 24 ) | ( 'A' << 16 ) | ( 'A' << 8 ) | 'B' )
+#define AAS_BINARYFILE_VERSION	1
+
+typedef struct aasBinaryHeader_s {
+	int							ident;
+	int							version;
+	unsigned int				mapFileCRC;
+	int							structSizes[9];
+} aasBinaryHeader_t;
+
+/*
+================
+AAS_BinaryFileName
+================
+*/
+static idStr AAS_BinaryFileName( const idStr &fileName ) {
+	idStr extension, binaryName;
+
+	fileName.ExtractFileExtension( extension );
+	binaryName = fileName;
+	binaryName.StripFileExtension();
+	binaryName += ".b";
+	binaryName += extension;
+	return binaryName;
+}
+
+/*
+================
+AAS_SetBinaryHeader
+================
+*/
+static void AAS_SetBinaryHeader( aasBinaryHeader_t &header, unsigned int mapFileCRC ) {
+	memset( &header, 0, sizeof( header ) );
+	header.ident = AAS_BINARYFILE_ID;
+	header.version = AAS_BINARYFILE_VERSION;
+	header.mapFileCRC = mapFileCRC;
+	header.structSizes[0] = sizeof( idPlane );
+	header.structSizes[1] = sizeof( aasVertex_t );
+	header.structSizes[2] = sizeof( aasEdge_t );
+	header.structSizes[3] = sizeof( aasIndex_t );
+	header.structSizes[4] = sizeof( aasFace_t );
+	header.structSizes[5] = sizeof( aasArea_t );
+	header.structSizes[6] = sizeof( aasNode_t );
+	header.structSizes[7] = sizeof( aasPortal_t );
+	header.structSizes[8] = sizeof( aasCluster_t );
+}
+
+/*
+================
+AAS_WriteBinaryList
+================
+*/
+template< class type >
+static void AAS_WriteBinaryList( idFile *fp, const idList<type> &list ) {
+	fp->WriteInt( list.Num() );
+	fp->Write( list.Ptr(), list.Num() * sizeof( type ) );
+}
+
+/*
+================
+AAS_ReadBinaryList
+================
+*/
+template< class type >
+static bool AAS_ReadBinaryList( idFile *fp, idList<type> &list ) {
+	int num;
+
+	if ( fp->ReadInt( num ) != sizeof( num ) || num < 0 || num > ( fp->Length() - fp->Tell() ) / (int)sizeof( type ) ) {
+		return false;
+	}
+	list.SetNum( num );
+	return ( fp->Read( list.Ptr(), num * sizeof( type ) ) == (int)( num * sizeof( type ) ) );
+}
+
+/*
+================
+AAS_WriteBinarySettings
+================
+*/
+static void AAS_WriteBinarySettings( idFile *fp, const idAASSettings &settings ) {
+	int i;
+
+	fp->WriteInt( settings.numBoundingBoxes );
+	for ( i = 0; i < settings.numBoundingBoxes; i++ ) {
+		fp->WriteVec3( settings.boundingBoxes[i][0] );
+		fp->WriteVec3( settings.boundingBoxes[i][1] );
+	}
+	fp->WriteBool( settings.usePatches );
+	fp->WriteBool( settings.writeBrushMap );
+	fp->WriteBool( settings.playerFlood );
+	fp->WriteBool( settings.allowSwimReachabilities );
+	fp->WriteBool( settings.allowFlyReachabilities );
+	fp->WriteString( settings.fileExtension );
+	fp->WriteVec3( settings.gravity );
+	fp->WriteFloat( settings.maxStepHeight );
+	fp->WriteFloat( settings.maxBarrierHeight );
+	fp->WriteFloat( settings.maxWaterJumpHeight );
+	fp->WriteFloat( settings.maxFallHeight );
+	fp->WriteFloat( settings.minFloorCos );
+	fp->WriteInt( settings.tt_barrierJump );
+	fp->WriteInt( settings.tt_startCrouching );
+	fp->WriteInt( settings.tt_waterJump );
+	fp->WriteInt( settings.tt_startWalkOffLedge );
+}
+
+/*
+================
+AAS_ReadBinarySettings
+================
+*/
+static bool AAS_ReadBinarySettings( idFile *fp, idAASSettings &settings ) {
+	int i;
+
+	fp->ReadInt( settings.numBoundingBoxes );
+	if ( settings.numBoundingBoxes <= 0 || settings.numBoundingBoxes > MAX_AAS_BOUNDING_BOXES ) {
+		return false;
+	}
+	for ( i = 0; i < settings.numBoundingBoxes; i++ ) {
+		fp->ReadVec3( settings.boundingBoxes[i][0] );
+		fp->ReadVec3( settings.boundingBoxes[i][1] );
+	}
+	fp->ReadBool( settings.usePatches );
+	fp->ReadBool( settings.writeBrushMap );
+	fp->ReadBool( settings.playerFlood );
+	fp->ReadBool( settings.allowSwimReachabilities );
+	fp->ReadBool( settings.allowFlyReachabilities );
+	fp->ReadString( settings.fileExtension );
+	fp->ReadVec3( settings.gravity );
+	settings.gravityDir = settings.gravity;
+	settings.gravityValue = settings.gravityDir.Normalize();
+	settings.invGravityDir = -settings.gravityDir;
+	fp->ReadFloat( settings.maxStepHeight );
+	fp->ReadFloat( settings.maxBarrierHeight );
+	fp->ReadFloat( settings.maxWaterJumpHeight );
+	fp->ReadFloat( settings.maxFallHeight );
+	fp->ReadFloat( settings.minFloorCos );
+	fp->ReadInt( settings.tt_barrierJump );
+	fp->ReadInt( settings.tt_startCrouching );
+	fp->ReadInt( settings.tt_waterJump );
+	return ( fp->ReadInt( settings.tt_startWalkOffLedge ) == sizeof( int ) );
+}
+
+/*
+================
+idAASFileLocal::WriteBinary
+================
+*/
+bool idAASFileLocal::WriteBinary( const idStr &fileName, unsigned int mapFileCRC ) const {
+	aasBinaryHeader_t header;
+	idStr binaryName;
+	idFile *fp;
+	int i, j, num;
+	idReachability *reach;
+
+	binaryName = AAS_BinaryFileName( fileName );
+
+	common->Printf( "writing %s\n", binaryName.c_str() );
+
+	fp = fileSystem->OpenFileWrite( binaryName, "fs_devpath" );
+	if ( !fp ) {
+		common->Warning( "Error opening %s", binaryName.c_str() );
+		return false;
+	}
+
+	AAS_SetBinaryHeader( header, mapFileCRC );
+	fp->Write( &header, sizeof( header ) );
+
+	AAS_WriteBinarySettings( fp, settings );
+
+	AAS_WriteBinaryList( fp, planeList );
+	AAS_WriteBinaryList( fp, vertices );
+	AAS_WriteBinaryList( fp, edges );
+	AAS_WriteBinaryList( fp, edgeIndex );
+	AAS_WriteBinaryList( fp, faces );
+	AAS_WriteBinaryList( fp, faceIndex );
+
+	// the reachability pointers and the values calculated at load time are cleared
+	idList<aasArea_t> binaryAreas = areas;
+	for ( i = 0; i < binaryAreas.Num(); i++ ) {
+		binaryAreas[i].bounds.Zero();
+		binaryAreas[i].center.Zero();
+		binaryAreas[i].travelFlags = 0;
+		binaryAreas[i].reach = NULL;
+		binaryAreas[i].rev_reach = NULL;
+	}
+	AAS_WriteBinaryList( fp, binaryAreas );
+
+	AAS_WriteBinaryList( fp, nodes );
+	AAS_WriteBinaryList( fp, portals );
+	AAS_WriteBinaryList( fp, portalIndex );
+	AAS_WriteBinaryList( fp, clusters );
+
+	// reachabilities are written in list order like the text file
+	for ( i = 0; i < areas.Num(); i++ ) {
+		for ( num = 0, reach = areas[i].reach; reach; reach = reach->next ) {
+			num++;
+		}
+		fp->WriteInt( num );
+		for ( reach = areas[i].reach; reach; reach = reach->next ) {
+			fp->WriteInt( reach->travelType );
+			fp->WriteShort( reach->toAreaNum );
+			fp->WriteVec3( reach->start );
+			fp->WriteVec3( reach->end );
+			fp->WriteInt( reach->edgeNum );
+			fp->WriteUnsignedShort( reach->travelTime );
+			if ( reach->travelType == TFL_SPECIAL ) {
+				const idDict &dict = static_cast<idReachability_Special *>(reach)->dict;
+				fp->WriteInt( dict.GetNumKeyVals() );
+				for ( j = 0; j < dict.GetNumKeyVals(); j++ ) {
+					fp->WriteString( dict.GetKeyVal( j )->GetKey() );
+					fp->WriteString( dict.GetKeyVal( j )->GetValue() );
+				}
+			}
+		}
+	}
+
+	fileSystem->CloseFile( fp );
+
+	return true;
+}
+
+/*
+================
+AAS_ValidRange
+
+True if the count entries starting at first are all below num.
+================
+*/
+static bool AAS_ValidRange( int first, int count, int num ) {
+	return first >= 0 && count >= 0 && first <= num - count;
+}
+
+/*
+================
+AAS_ValidIndex
+
+True if the signed index refers to one of the num elements.
+================
+*/
+static bool AAS_ValidIndex( int index, int num ) {
+	return index > -num && index < num;
+}
+
+/*
+================
+idAASFileLocal::ValidateBinary
+
+The binary lists are read straight into memory, so every number that is
+used to index another list is checked before anything follows it.  The
+node children have to come after their parent and every node can only have
+a single parent, like the compiler stores the tree, so MaxTreeDepth can't
+recurse endlessly.
+================
+*/
+bool idAASFileLocal::ValidateBinary( void ) const {
+	int i, j;
+
+	for ( i = 0; i < edges.Num(); i++ ) {
+		if ( edges[i].vertexNum[0] < 0 || edges[i].vertexNum[0] >= vertices.Num() ||
+				edges[i].vertexNum[1] < 0 || edges[i].vertexNum[1] >= vertices.Num() ) {
+			return false;
+		}
+	}
+	for ( i = 0; i < edgeIndex.Num(); i++ ) {
+		if ( !AAS_ValidIndex( edgeIndex[i], edges.Num() ) ) {
+			return false;
+		}
+	}
+	for ( i = 0; i < faces.Num(); i++ ) {
+		const aasFace_t &face = faces[i];
+		if ( face.planeNum >= planeList.Num() || !AAS_ValidRange( face.firstEdge, face.numEdges, edgeIndex.Num() ) ) {
+			return false;
+		}
+		if ( face.areas[0] < 0 || face.areas[0] >= areas.Num() || face.areas[1] < 0 || face.areas[1] >= areas.Num() ) {
+			return false;
+		}
+	}
+	for ( i = 0; i < faceIndex.Num(); i++ ) {
+		if ( !AAS_ValidIndex( faceIndex[i], faces.Num() ) ) {
+			return false;
+		}
+	}
+	for ( i = 0; i < areas.Num(); i++ ) {
+		const aasArea_t &area = areas[i];
+		if ( !AAS_ValidRange( area.firstFace, area.numFaces, faceIndex.Num() ) ) {
+			return false;
+		}
+		if ( ( area.cluster > 0 && area.cluster >= clusters.Num() ) || ( area.cluster < 0 && -area.cluster >= portals.Num() ) ) {
+			return false;
+		}
+	}
+
+	idList<bool> hasParent;
+	hasParent.AssureSize( nodes.Num(), false );
+	for ( i = 0; i < nodes.Num(); i++ ) {
+		if ( nodes[i].planeNum >= planeList.Num() ) {
+			return false;
+		}
+		for ( j = 0; j < 2; j++ ) {
+			int child = nodes[i].children[j];
+			if ( child > 0 ) {
+				if ( child <= i || child >= nodes.Num() || hasParent[child] ) {
+					return false;
+				}
+				hasParent[child] = true;
+			} else if ( child < 0 && -child >= areas.Num() ) {
+				return false;
+			}
+		}
+	}
+
+	for ( i = 0; i < portals.Num(); i++ ) {
+		const aasPortal_t &portal = portals[i];
+		if ( portal.areaNum < 0 || portal.areaNum >= areas.Num() ) {
+			return false;
+		}
+		for ( j = 0; j < 2; j++ ) {
+			if ( portal.clusters[j] < 0 || portal.clusters[j] >= clusters.Num() ) {
+				return false;
+			}
+		}
+	}
+	for ( i = 0; i < portalIndex.Num(); i++ ) {
+		if ( portalIndex[i] < 0 || portalIndex[i] >= portals.Num() ) {
+			return false;
+		}
+	}
+	for ( i = 0; i < clusters.Num(); i++ ) {
+		if ( !AAS_ValidRange( clusters[i].firstPortal, clusters[i].numPortals, portalIndex.Num() ) ) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+================
+idAASFileLocal::LoadBinary
+
+Returns false if there is no usable binary file, the text file is loaded instead
+================
+*/
+bool idAASFileLocal::LoadBinary( const idStr &fileName, unsigned int mapFileCRC ) {
+	aasBinaryHeader_t header, expected;
+	idStr binaryName, key, value;
+	ID_TIME_T textTimeStamp, binaryTimeStamp;
+	void *buffer;
+	int i, j, num, numKeyVals, length;
+	idReachability reach, *newReach;
+	idReachability_Special *special;
+
+	binaryName = AAS_BinaryFileName( fileName );
+
+	// a text file written after the binary one was edited or compiled by an older tool
+	fileSystem->ReadFile( fileName, NULL, &textTimeStamp );
+	length = fileSystem->ReadFile( binaryName, &buffer, &binaryTimeStamp );
+	if ( !buffer ) {
+		return false;
+	}
+	if ( length < (int)sizeof( header ) || ( textTimeStamp != FILE_NOT_FOUND_TIMESTAMP && textTimeStamp > binaryTimeStamp ) ) {
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
+	memcpy( &header, buffer, sizeof( header ) );
+	AAS_SetBinaryHeader( expected, header.mapFileCRC );
+	if ( memcmp( &header, &expected, sizeof( header ) ) != 0 ) {
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
+	if ( mapFileCRC && header.mapFileCRC != mapFileCRC ) {
+		common->Warning( "AAS file '%s' is out of date", binaryName.c_str() );
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
+	idFile_Memory fp( binaryName, (const char *)buffer + sizeof( header ), length - sizeof( header ) );
+
+	Clear();
+
+	bool ok = AAS_ReadBinarySettings( &fp, settings ) &&
+				AAS_ReadBinaryList( &fp, planeList ) &&
+				AAS_ReadBinaryList( &fp, vertices ) &&
+				AAS_ReadBinaryList( &fp, edges ) &&
+				AAS_ReadBinaryList( &fp, edgeIndex ) &&
+				AAS_ReadBinaryList( &fp, faces ) &&
+				AAS_ReadBinaryList( &fp, faceIndex ) &&
+				AAS_ReadBinaryList( &fp, areas ) &&
+				AAS_ReadBinaryList( &fp, nodes ) &&
+				AAS_ReadBinaryList( &fp, portals ) &&
+				AAS_ReadBinaryList( &fp, portalIndex ) &&
+				AAS_ReadBinaryList( &fp, clusters ) &&
+				ValidateBinary();
+
+	for ( i = 0; i < areas.Num(); i++ ) {
+		areas[i].reach = NULL;
+		areas[i].rev_reach = NULL;
+	}
+
+	for ( i = 0; i < portals.Num(); i++ ) {
+		portals[i].maxAreaTravelTime = 0;
+	}
+
+	for ( i = 0; ok && i < areas.Num(); i++ ) {
+		aasArea_t *area = &areas[i];
+
+		area->bounds.Zero();
+		area->center.Zero();
+		area->travelFlags = AreaContentsTravelFlags( i );
+
+		// reachabilities are prepended like ParseReachabilities does
+		if ( fp.ReadInt( num ) != sizeof( num ) || num < 0 ) {
+			ok = false;
+			break;
+		}
+		for ( j = 0; j < num; j++ ) {
+			fp.ReadInt( reach.travelType );
+			fp.ReadShort( reach.toAreaNum );
+			fp.ReadVec3( reach.start );
+			fp.ReadVec3( reach.end );
+			fp.ReadInt( reach.edgeNum );
+			if ( fp.ReadUnsignedShort( reach.travelTime ) != sizeof( reach.travelTime ) || reach.toAreaNum < 0 || reach.toAreaNum >= areas.Num() ||
+					!AAS_ValidIndex( reach.edgeNum, edges.Num() ) ) {
+				ok = false;
+				break;
+			}
+			switch( reach.travelType ) {
+				case TFL_SPECIAL:
+					newReach = special = new idReachability_Special();
+					fp.ReadInt( numKeyVals );
+					for ( int k = 0; k < numKeyVals && fp.Tell() < fp.Length(); k++ ) {
+						fp.ReadString( key );
+						fp.ReadString( value );
+						special->dict.Set( key, value );
+					}
+					break;
+				default:
+					newReach = new idReachability();
+					break;
+			}
+			newReach->CopyBase( reach );
+			newReach->fromAreaNum = i;
+			newReach->next = area->reach;
+			area->reach = newReach;
+		}
+	}
+
+	fileSystem->FreeFile( buffer );
+
+	if ( !ok || MaxTreeDepth() > MAX_AAS_TREE_DEPTH ) {
+		common->Warning( "AAS file '%s' is corrupt", binaryName.c_str() );
+		DeleteReachabilities();
+		Clear();
+		return false;
+	}
+
+	LinkReversedReachability();
+
+	FinishAreas();
 
 	return true;
 }
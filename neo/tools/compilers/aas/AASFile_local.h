@@ -88,6 +88,9 @@ private:
 	bool						ParseNodes( idLexer &src );
 	bool						ParsePortals( idLexer &src );
 	bool						ParseClusters( idLexer &src );
+	bool						LoadBinary( const idStr &fileName, unsigned int mapFileCRC );
+	bool						ValidateBinary( void ) const;
+	bool						WriteBinary( const idStr &fileName, unsigned int mapFileCRC ) const;
 
 private:
 	int							BoundsReachableAreaNum_r( int nodeNum, const idBounds &bounds, const int areaFlags, const int excludeTravelFlags ) const;
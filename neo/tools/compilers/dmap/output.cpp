@@ -651,6 +651,11 @@ void WriteOutputFile( void ) {
 
 	procFile->WriteFloatString( "%s\n\n", PROC_FILE_ID );
 
+	// the binary version is rebuilt from the new .proc the next time the map is loaded
+	idStr bprocPath;
+	sprintf( bprocPath, "%s." BPROC_FILE_EXT, dmapGlobals.mapFileBase );
+	fileSystem->RemoveFile( bprocPath );
+
 	// write the entity models and information, writing entities first
 	for ( i=dmapGlobals.num_entities - 1 ; i >= 0 ; i-- ) {
 		entity = &dmapGlobals.uEntities[i];